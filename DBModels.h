@@ -3,6 +3,8 @@
 
 #include <QString>
 #include <QDateTime>
+#include <QVariant>
+#include <QVector>
 
 enum class UserRole
 {
@@ -50,6 +52,12 @@ struct FileInfo
     FileStatus status;
     int projectId;
     bool isProcessDocument; // 是否为过程文档
+    // 文档统计，上传时从 .docx 提取，0 表示未知
+    int pageCount;
+    int wordCount;
+    int characterCount;
+    // 文件内容的SHA-256，文件保存在内容存储区时不为空，filePath 指向存储区中的文件
+    QString contentHash;
 };
 
 // 项目结构体
@@ -78,4 +86,135 @@ struct ProjectNode
     bool isCompleted;
 };
 
+// 项目节点与关联文件（项目文档列表使用）
+struct NodeDocument
+{
+    int nodeId;
+    QString nodeName;
+    FileInfo file;
+};
+
+// 节点前置依赖：前置节点完成后后继节点才能开始
+struct NodeDependency
+{
+    int predecessorId;
+    int successorId;
+};
+
+// 分页游标：上一页最后一行的排序值和ID，下一页从这一行之后开始（keyset分页）
+struct PageCursor
+{
+    bool valid = false;
+    QVariant sortValue;
+    int id = 0;
+};
+
+// 文件列表排序字段
+enum class FileSortKey
+{
+    Id,
+    Name,
+    UploadTime,
+    Size
+};
+
+// 文件列表查询条件，筛选、排序和分页都在SQL中完成
+struct FileQuery
+{
+    FileStatus status = FileStatus::NORMAL;
+    int fileType = -1;                  // 文件类型，-1表示不限
+    bool processDocumentsOnly = false;  // 只查询过程文档
+    QString nameContains;               // 文件名包含的文本，不区分大小写
+    bool searchContent = false;         // nameContains 同时匹配已建立索引的文档正文
+    FileSortKey sortKey = FileSortKey::Id;
+    bool descending = false;
+    int pageSize = 200;
+    PageCursor after;                   // 从该位置之后开始，无效时从第一行开始
+};
+
+struct FilePage
+{
+    QVector<FileInfo> files;
+    PageCursor next;                    // 查询下一页使用的游标
+    bool hasMore = false;
+};
+
+// 项目列表排序字段
+enum class ProjectSortKey
+{
+    Id,
+    Name,
+    CreateTime,
+    EstimatedCompleteTime
+};
+
+// 项目列表查询条件
+struct ProjectQuery
+{
+    int completed = -1;                 // 1只查已完成，0只查进行中，-1不限
+    QString searchText;                 // 匹配项目名称、描述或项目经理
+    ProjectSortKey sortKey = ProjectSortKey::Id;
+    bool descending = false;
+    int pageSize = 200;
+    PageCursor after;
+};
+
+struct ProjectPage
+{
+    QVector<Project> projects;
+    PageCursor next;
+    bool hasMore = false;
+};
+
+// 用户上传的文件和负责的项目，删除用户时会被外键级联删除，因此有这些数据的用户不能删除
+struct UserOwnership
+{
+    int fileCount = 0;                  // 包括回收站和归档中的文件
+    int projectCount = 0;
+};
+
+// 项目汇总统计（统计概览使用），从触发器维护的汇总表读取
+struct ProjectStatistics
+{
+    Project project;
+    int nodeCount = 0;
+    int completedCount = 0;
+    int overdueCount = 0;               // 未完成且预计完成日期早于今天的节点数
+    int fileCount = 0;                  // 项目关联的正常状态文件数
+    qint64 totalBytes = 0;
+};
+
+// 文档正文索引状态
+enum class ContentIndexStatus
+{
+    INDEXED,       // 已提取正文并建立索引
+    UNSUPPORTED,   // 不支持提取正文的格式
+    MISSING,       // 文件不存在
+    FAILED         // 文件损坏或解析失败
+};
+
+// 等待检查正文索引的文件，indexedSize 为-1表示尚未建立索引
+struct ContentIndexCandidate
+{
+    int fileId;
+    QString filePath;
+    QString fileExtension;
+    qint64 indexedSize;
+    qint64 indexedModifiedTime;     // 建立索引时文件的修改时间（毫秒时间戳）
+};
+
+// 一个文件的正文提取结果
+struct FileContent
+{
+    int fileId;
+    ContentIndexStatus status;
+    qint64 fileSize;
+    qint64 modifiedTime;
+    QString text;
+    // 同时提取的文档统计，只在 INDEXED 时有效
+    int pageCount;
+    int wordCount;
+    int characterCount;
+};
+
 #endif // DBMODELS_H
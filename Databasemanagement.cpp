@@ -1,6 +1,166 @@
 #include <QDir>
 #include <QDebug>
+#include <QHash>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStringList>
+#include <QThread>
 #include "Databasemanagement.h"
+#include "databaseexecutor.h"
+#include "schemamigrator.h"
+
+// 转义 LIKE 模式中的通配符，配合 ESCAPE '\' 使用
+static QString EscapeLikePattern(const QString& text)
+{
+    QString escaped = text;
+    escaped.replace("\\", "\\\\");
+    escaped.replace("%", "\\%");
+    escaped.replace("_", "\\_");
+    return escaped;
+}
+
+// 全文检索最短的词长度，trigram 分词器无法匹配少于3个字符的词
+static const int kMinFullTextTermLength = 3;
+
+// 按空白拆分检索词，各词之间为AND
+static QStringList SearchTerms(const QString& text)
+{
+    return text.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+}
+
+// 加引号作为 FTS5 短语
+static QString FullTextPhrase(const QString& text)
+{
+    QString phrase = text;
+    phrase.replace("\"", "\"\"");
+    return "\"" + phrase + "\"";
+}
+
+// 把检索词转换为 trigram 索引的 MATCH 表达式，每个词作为短语。
+// 有词短于3个字符时返回空字符串，调用方改用二元分词索引
+static QString FullTextMatchExpression(const QStringList& terms)
+{
+    QStringList phrases;
+    for(const QString& term : terms)
+    {
+        if(term.size() < kMinFullTextTermLength)
+        {
+            return QString();
+        }
+        phrases << FullTextPhrase(term);
+    }
+    return phrases.join(" ");
+}
+
+static bool HasLetterOrNumber(QStringView text)
+{
+    for(QChar ch : text)
+    {
+        if(ch.isLetterOrNumber())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 把检索词转换为二元分词索引（*_bigram 表）的 MATCH 表达式。
+// 索引中每个位置保存从该位置开始的两个字符，末尾为单个字符，由 unicode61 再次分词。
+// 1个字符的词按前缀匹配，2个字符的词匹配对应的二元组，更长的词拆成二元组后全部匹配。
+// 结果可能多于实际包含检索词的记录，调用方再逐词用 LIKE 确认。
+// 有词不含字母或数字、分词后为空时返回空字符串，调用方只用 LIKE
+static QString BigramMatchExpression(const QStringList& terms)
+{
+    QStringList phrases;
+    for(const QString& term : terms)
+    {
+        if(term.size() == 1)
+        {
+            if(!HasLetterOrNumber(term))
+            {
+                return QString();
+            }
+            phrases << FullTextPhrase(term) + "*";
+            continue;
+        }
+
+        bool matched = false;
+        for(int i = 0; i + 1 < term.size(); ++i)
+        {
+            QString bigram = term.mid(i, 2);
+            if(HasLetterOrNumber(bigram))
+            {
+                phrases << FullTextPhrase(bigram);
+                matched = true;
+            }
+        }
+        if(!matched)
+        {
+            return QString();
+        }
+    }
+    return phrases.join(" ");
+}
+
+// 以参数为根的子树（包括根），每层沿 idx_project_nodes_parent 查找子节点，只访问子树内的行。
+// UNION 丢弃已经访问过的节点，不限制层数，父子关系意外成环时递归也会结束
+#define SUBTREE_CTE \
+    "WITH RECURSIVE subtree(id) AS (" \
+    "SELECT id FROM project_nodes WHERE id = ? " \
+    "UNION " \
+    "SELECT pn.id FROM project_nodes pn " \
+    "INNER JOIN subtree s ON pn.parent_id = s.id) "
+
+// 写方法不在写线程上调用时，转交给数据库执行器的写线程执行并等待结果。
+// 整个进程只有写线程持有读写连接，写入之间不会相互等待锁，也不会占用界面线程的连接
+template <typename Func>
+static auto RunOnWriter(Func func)
+{
+    return DataBaseExecutor::Instance()->Run(std::move(func)).result();
+}
+
+static ProjectNode ReadProjectNode(const QSqlQuery& query)
+{
+    ProjectNode node;
+    node.id = query.value(0).toInt();
+    node.projectId = query.value(1).toInt();
+    node.name = query.value(2).toString();
+    node.description = query.value(3).toString();
+    node.parentId = query.value(4).toInt();
+    node.creationTime = query.value(5).toDateTime();
+    node.estimatedCompletionTime = query.value(6).toDateTime();
+    node.isCompleted = query.value(7).toBool();
+    return node;
+}
+
+// ReadFileInfo 读取的列，files 的别名为 f，users 的别名为 u
+#define FILE_COLUMNS \
+    "f.id, f.file_name, f.file_path, f.file_extension, f.file_size, f.uploader_id, " \
+    "u.username, f.upload_time, f.file_type, f.status, f.project_id, f.is_process_document, " \
+    "f.page_count, f.word_count, f.character_count, f.content_hash "
+
+// 从 firstColumn 开始按 FILE_COLUMNS 的顺序读取文件信息
+static FileInfo ReadFileInfo(const QSqlQuery& query, int firstColumn)
+{
+    FileInfo file;
+    file.id = query.value(firstColumn).toInt();
+    file.fileName = query.value(firstColumn + 1).toString();
+    file.filePath = query.value(firstColumn + 2).toString();
+    file.fileExtension = query.value(firstColumn + 3).toString();
+    file.fileSize = query.value(firstColumn + 4).toLongLong();
+    file.uploaderId = query.value(firstColumn + 5).toInt();
+    file.uploaderName = query.value(firstColumn + 6).toString();
+    file.uploadTime = query.value(firstColumn + 7).toDateTime();
+    file.fileType = static_cast<FileType>(query.value(firstColumn + 8).toInt());
+    file.status = static_cast<FileStatus>(query.value(firstColumn + 9).toInt());
+    file.projectId = query.value(firstColumn + 10).toInt();
+    file.isProcessDocument = query.value(firstColumn + 11).toBool();
+    file.pageCount = query.value(firstColumn + 12).toInt();
+    file.wordCount = query.value(firstColumn + 13).toInt();
+    file.characterCount = query.value(firstColumn + 14).toInt();
+    file.contentHash = query.value(firstColumn + 15).toString();
+    return file;
+}
 
 DataBaseManagement::DataBaseManagement(QObject* parent) : QObject(parent)
 {
@@ -13,185 +173,220 @@ DataBaseManagement* DataBaseManagement::Instance()
     return &mgr;
 }
 
+StatementCacheStats DataBaseManagement::GetStatementCacheStats()
+{
+    return Statements().Stats();
+}
+
+ConnectionPoolStats DataBaseManagement::GetConnectionPoolStats() const
+{
+    return _pool.Stats();
+}
+
+EntityCacheStats DataBaseManagement::GetEntityCacheStats() const
+{
+    return _cache.Stats();
+}
+
+ConnectionPool& DataBaseManagement::Pool()
+{
+    return _pool;
+}
+
+bool DataBaseManagement::CheckpointWal(bool truncate)
+{
+    if(!_pool.InWriteScope())
+        return RunOnWriter([truncate](DataBaseManagement* db) { return db->CheckpointWal(truncate); });
+
+    return _checkpointScheduler.Checkpoint(Database(), truncate);
+}
+
 DataBaseManagement::~DataBaseManagement()
 {
+    // 正常退出时已由 Shutdown 关闭，这里只处理提前退出的情况，不再访问数据库线程
+    _statements.Clear();
+
     if(_db.isOpen())
     {
         _db.close();
     }
 }
 
-bool DataBaseManagement::Initialize()
+void DataBaseManagement::Shutdown()
 {
-    QString dataPath = QDir::currentPath();
-    _db = QSqlDatabase::addDatabase("QSQLITE");
-    _db.setDatabaseName(dataPath + "/projectmanager.db");
-
-    if(!_db.open())
+    if(!_db.isOpen())
     {
-        qDebug() << "Cannot open database: " << _db.lastError().text();
-        return false;
+        return;
     }
 
-    if(!CreateTables())
-    {
-        qDebug() << "Failed to create tables";
-        return false;
-    }
+    _checkpointScheduler.Stop();
 
-    if(!InsertDefaultData())
-    {
-        qDebug() << "Failed to insert default values";
-        return false;
-    }
+    // 检查点排在已提交的写入之后执行，退出前把WAL写回主库并截断，下次启动不必重放WAL。
+    // WaitForDone 结束数据库线程，各线程的连接随线程退出关闭
+    DataBaseExecutor* executor = DataBaseExecutor::Instance();
+    executor->Run([](DataBaseManagement* db) { return db->CheckpointWal(true); });
+    executor->WaitForDone();
 
-    qDebug() << "数据库初始化成功，路径: " << dataPath + "/projectmanager.db";
-    return true;
+    _statements.Clear();
+    _db.close();
 }
 
-bool DataBaseManagement::CreateTables()
+QSqlDatabase DataBaseManagement::Database()
 {
-    // 确保按正确的顺序创建表，避免外键约束问题
-    if (!CreateUserTable())
-    {
-        qDebug() << "创建用户表失败";
-        return false;
-    }
-        
-    if (!CreateFileTable())
+    PooledConnection* connection = CurrentThreadConnection();
+    return connection ? connection->db : _db;
+}
+
+StatementCache& DataBaseManagement::Statements()
+{
+    PooledConnection* connection = CurrentThreadConnection();
+    return connection ? connection->statements : _statements;
+}
+
+PooledConnection* DataBaseManagement::CurrentThreadConnection()
+{
+    if(_pool.InReadScope())
     {
-        qDebug() << "创建文件表失败";
-        return false;
+        return _pool.ReaderConnection();
     }
-    
-    if (!CreateProjectTable())
+
+    // 只有数据库执行器的工作线程处于 WriteScope 中，使用唯一的写连接
+    if(_pool.InWriteScope())
     {
-        qDebug() << "创建项目表失败";
-        return false;
+        return _pool.WriterConnection();
     }
-    
-    if (!CreateProjectNodeTable())
+
+    // 主线程直接使用只读的 _db
+    if(QThread::currentThread() == thread())
     {
-        qDebug() << "创建项目节点表失败";
-        return false;
+        return nullptr;
     }
-        
-    if (!CreateProjectUserTable())
+
+    // 其它线程使用各自的只读连接，写方法会转交给写线程
+    return _pool.ReaderConnection();
+}
+
+bool DataBaseManagement::Initialize(const StorageProfile& profile)
+{
+    QString dataPath = QDir::currentPath();
+    QString databasePath = dataPath + "/projectmanager.db";
+    _profile = profile;
+    _pool.Configure(databasePath, _profile);
+
+    // 建库、迁移和默认数据都在数据库线程的写连接上完成，写连接打开时应用 journal_mode 等设置
+    bool initialized = DataBaseExecutor::Instance()->Run([](DataBaseManagement* db) {
+        return db->InitializeSchema();
+    }).result();
+    if(!initialized)
     {
-        qDebug() << "创建项目用户关联表失败";
         return false;
     }
-    
-    if (!CreateProjectFileTable())
+
+    // 界面线程的连接只读，写方法会转交给数据库线程
+    _db = QSqlDatabase::addDatabase("QSQLITE");
+    _db.setDatabaseName(databasePath);
+    _db.setConnectOptions("QSQLITE_OPEN_READONLY");
+
+    if(!_db.open())
     {
-        qDebug() << "创建项目文件关联表失败";
+        qDebug() << "Cannot open database: " << _db.lastError().text();
         return false;
     }
-    
-    if (!CreateNodeFileTable())
+
+    if(!ApplyStorageProfile(_db, _profile, true))
     {
-        qDebug() << "创建node_file表失败";
+        qDebug() << "Failed to apply storage profile";
         return false;
     }
-    
-    qDebug() << "所有表创建成功";
-    return true;
-}
 
-bool DataBaseManagement::CreateUserTable()
-{
-    QSqlQuery query;
+    _statements.SetDatabase(_db);
 
-    if(!query.exec("CREATE TABLE IF NOT EXISTS users ("
-                     "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                     "username TEXT UNIQUE NOT NULL, "
-                     "password TEXT NOT NULL, "
-                     "role INTEGER NOT NULL CHECK (role IN (0, 1, 2)), "
-                     "created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP)"))
-    {
-        qDebug() << "Failed to create user table: " << query.lastError().text();
-        return false;
-    }
+    // 定时检查点在数据库线程上执行，不占用界面线程
+    connect(&_checkpointScheduler, &WalCheckpointScheduler::checkpointDue, this, []() {
+        DataBaseExecutor::Instance()->Run([](DataBaseManagement* db) { return db->CheckpointWal(); });
+    });
+    _checkpointScheduler.Start(_profile);
 
+    qDebug() << "数据库初始化成功，路径: " << dataPath + "/projectmanager.db";
     return true;
 }
 
-bool DataBaseManagement::CreateFileTable()
+bool DataBaseManagement::InitializeSchema()
 {
-    QSqlQuery query;
-
-    if(!query.exec("CREATE TABLE IF NOT EXISTS files ("
-                   "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                   "file_name TEXT NOT NULL, "
-                   "file_path TEXT NOT NULL, "
-                   "file_extension TEXT NOT NULL, "
-                   "file_size INTEGER NOT NULL, "
-                   "uploader_id INTEGER NOT NULL, "
-                   "upload_time TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
-                   "file_type INTEGER NOT NULL, "
-                   "status INTEGER NOT NULL DEFAULT 0, "
-                   "project_id INTEGER, "
-                   "is_process_document BOOLEAN DEFAULT 0, "
-                   "FOREIGN KEY (uploader_id) REFERENCES users (id) ON DELETE CASCADE, "
-                   "FOREIGN KEY (project_id) REFERENCES projects (id) ON DELETE SET NULL)"))
+    QSqlDatabase db = Database();
+    if(!db.isOpen())
     {
-        qDebug() << "Failed to create file table: " << query.lastError().text();
+        qDebug() << "Cannot open database: " << db.lastError().text();
         return false;
     }
 
-    return true;
-}
-
-bool DataBaseManagement::CreateProjectTable()
-{
-    QSqlQuery query;
-
-    if(!query.exec("CREATE TABLE IF NOT EXISTS projects ("
-                   "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                   "name TEXT NOT NULL, "
-                   "description TEXT, "
-                   "manager_id INTEGER NOT NULL, "
-                   "create_time TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
-                   "estimated_complete_time TIMESTAMP, "
-                   "is_completed BOOLEAN DEFAULT 0, "
-                   "FOREIGN KEY (manager_id) REFERENCES users (id) ON DELETE CASCADE)"))
+    if(!MigrateSchema())
     {
-        qDebug() << "Failed to create project table: " << query.lastError().text();
+        qDebug() << "Failed to migrate schema";
         return false;
     }
 
-    return true;
-}
-
-bool DataBaseManagement::CreateProjectNodeTable()
-{
-    QSqlQuery query;
-
-    if(!query.exec("CREATE TABLE IF NOT EXISTS project_nodes ("
-                   "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                   "project_id INTEGER NOT NULL, "
-                   "name TEXT NOT NULL, "
-                   "description TEXT, "
-                   "parent_id INTEGER, "
-                   "create_time TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
-                   "estimated_completion_time TIMESTAMP, "
-                   "is_completed BOOLEAN DEFAULT 0, "
-                   "FOREIGN KEY (project_id) REFERENCES projects (id) ON DELETE CASCADE, "
-                   "FOREIGN KEY (parent_id) REFERENCES project_nodes (id) ON DELETE CASCADE)"))
+    if(!InsertDefaultData())
     {
-        qDebug() << "Failed to create project node table: " << query.lastError().text();
+        qDebug() << "Failed to insert default values";
         return false;
     }
 
     return true;
 }
 
-bool DataBaseManagement::CreateProjectUserTable()
+bool DataBaseManagement::MigrateSchema()
 {
-    QSqlQuery query(_db);
+    SchemaMigrator migrator(Database());
+
+    // 版本1：基础表结构。使用 IF NOT EXISTS，已有数据库（user_version 为0）可以直接接管
+    // 确保按正确的顺序创建表，避免外键约束问题
+    migrator.AddMigration(1, "创建基础表结构", {
+        "CREATE TABLE IF NOT EXISTS users ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+        "username TEXT UNIQUE NOT NULL, "
+        "password TEXT NOT NULL, "
+        "role INTEGER NOT NULL CHECK (role IN (0, 1, 2)), "
+        "created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP)",
 
-    // 创建项目用户关联表
-    QString createProjectUserTableSQL = 
+        "CREATE TABLE IF NOT EXISTS files ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+        "file_name TEXT NOT NULL, "
+        "file_path TEXT NOT NULL, "
+        "file_extension TEXT NOT NULL, "
+        "file_size INTEGER NOT NULL, "
+        "uploader_id INTEGER NOT NULL, "
+        "upload_time TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
+        "file_type INTEGER NOT NULL, "
+        "status INTEGER NOT NULL DEFAULT 0, "
+        "project_id INTEGER, "
+        "is_process_document BOOLEAN DEFAULT 0, "
+        "FOREIGN KEY (uploader_id) REFERENCES users (id) ON DELETE CASCADE, "
+        "FOREIGN KEY (project_id) REFERENCES projects (id) ON DELETE SET NULL)",
+
+        "CREATE TABLE IF NOT EXISTS projects ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+        "name TEXT NOT NULL, "
+        "description TEXT, "
+        "manager_id INTEGER NOT NULL, "
+        "create_time TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
+        "estimated_complete_time TIMESTAMP, "
+        "is_completed BOOLEAN DEFAULT 0, "
+        "FOREIGN KEY (manager_id) REFERENCES users (id) ON DELETE CASCADE)",
+
+        "CREATE TABLE IF NOT EXISTS project_nodes ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+        "project_id INTEGER NOT NULL, "
+        "name TEXT NOT NULL, "
+        "description TEXT, "
+        "parent_id INTEGER, "
+        "create_time TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
+        "estimated_completion_time TIMESTAMP, "
+        "is_completed BOOLEAN DEFAULT 0, "
+        "FOREIGN KEY (project_id) REFERENCES projects (id) ON DELETE CASCADE, "
+        "FOREIGN KEY (parent_id) REFERENCES project_nodes (id) ON DELETE CASCADE)",
+
+        // 项目用户关联表
         "CREATE TABLE IF NOT EXISTS project_user ("
         "id INTEGER PRIMARY KEY AUTOINCREMENT, "
         "project_id INTEGER NOT NULL, "
@@ -199,22 +394,9 @@ bool DataBaseManagement::CreateProjectUserTable()
         "FOREIGN KEY (project_id) REFERENCES projects(id) ON DELETE CASCADE, "
         "FOREIGN KEY (user_id) REFERENCES users(id) ON DELETE CASCADE, "
         "UNIQUE(project_id, user_id) "
-        ")";
-
-    if (!query.exec(createProjectUserTableSQL)) {
-        qDebug() << "创建项目用户关联表失败: " << query.lastError().text();
-        return false;
-    }
-
-    return true;
-}
-
-bool DataBaseManagement::CreateProjectFileTable()
-{
-    QSqlQuery query(_db);
+        ")",
 
-    // 创建项目文件关联表
-    QString createProjectFileTableSQL = 
+        // 项目文件关联表
         "CREATE TABLE IF NOT EXISTS project_file ("
         "id INTEGER PRIMARY KEY AUTOINCREMENT, "
         "project_id INTEGER NOT NULL, "
@@ -222,37 +404,342 @@ bool DataBaseManagement::CreateProjectFileTable()
         "FOREIGN KEY (project_id) REFERENCES projects(id) ON DELETE CASCADE, "
         "FOREIGN KEY (file_id) REFERENCES files(id) ON DELETE CASCADE, "
         "UNIQUE(project_id, file_id) "
-        ")";
+        ")",
 
-    if (!query.exec(createProjectFileTableSQL)) {
-        qDebug() << "创建项目文件关联表失败: " << query.lastError().text();
+        "CREATE TABLE IF NOT EXISTS node_file ( "
+        "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+        "node_id INTEGER NOT NULL, "
+        "file_id INTEGER NOT NULL, "
+        "FOREIGN KEY (node_id) REFERENCES project_nodes (id) ON DELETE CASCADE, "
+        "FOREIGN KEY (file_id) REFERENCES files (id) ON DELETE CASCADE"
+        ")"
+    });
+
+    // 版本2：为查询条件、连接字段以及外键级联删除补充二级索引
+    migrator.AddMigration(2, "添加查询与外键索引", {
+        // InsertDefaultData: WHERE role = 0
+        "CREATE INDEX IF NOT EXISTS idx_users_role ON users (role)",
+        // GetAllFiles: WHERE f.status = ?
+        "CREATE INDEX IF NOT EXISTS idx_files_status ON files (status)",
+        // GetFilesByProject: WHERE f.project_id = ? AND f.status = ?，同时服务 projects 删除时的 SET NULL
+        "CREATE INDEX IF NOT EXISTS idx_files_project_status ON files (project_id, status)",
+        // 过程文档列表: WHERE f.is_process_document = 1 AND f.status = ?
+        "CREATE INDEX IF NOT EXISTS idx_files_process_status ON files (is_process_document, status)",
+        // users 删除时级联 files
+        "CREATE INDEX IF NOT EXISTS idx_files_uploader ON files (uploader_id)",
+        // users 删除时级联 projects
+        "CREATE INDEX IF NOT EXISTS idx_projects_manager ON projects (manager_id)",
+        // GetProjectNodes: WHERE project_id = ?
+        "CREATE INDEX IF NOT EXISTS idx_project_nodes_project ON project_nodes (project_id)",
+        // 父节点删除时级联子节点
+        "CREATE INDEX IF NOT EXISTS idx_project_nodes_parent ON project_nodes (parent_id)",
+        // project_user(project_id, user_id) 已有唯一索引，补充按用户反查
+        "CREATE INDEX IF NOT EXISTS idx_project_user_user ON project_user (user_id)",
+        // project_file(project_id, file_id) 已有唯一索引，补充按文件反查
+        "CREATE INDEX IF NOT EXISTS idx_project_file_file ON project_file (file_id)",
+        // GetNodeFiles: WHERE nf.node_id = ? JOIN f.id = nf.file_id，覆盖索引无需回表
+        "CREATE INDEX IF NOT EXISTS idx_node_file_node ON node_file (node_id, file_id)",
+        // files 删除时级联 node_file
+        "CREATE INDEX IF NOT EXISTS idx_node_file_file ON node_file (file_id, node_id)",
+        "ANALYZE"
+    });
+
+    // 版本3：列表排序与keyset分页使用的索引，(状态, 排序列) 后隐含 rowid 作为第二排序键
+    migrator.AddMigration(3, "添加列表排序索引", {
+        "CREATE INDEX IF NOT EXISTS idx_files_status_name ON files (status, file_name)",
+        "CREATE INDEX IF NOT EXISTS idx_files_status_upload_time ON files (status, upload_time)",
+        "CREATE INDEX IF NOT EXISTS idx_files_status_size ON files (status, file_size)",
+        "CREATE INDEX IF NOT EXISTS idx_projects_name ON projects (name)",
+        "CREATE INDEX IF NOT EXISTS idx_projects_create_time ON projects (create_time)",
+        "ANALYZE"
+    });
+
+    // 版本4：文件名、项目名称描述、节点名称描述的全文索引。
+    // trigram 分词按连续3个字符建索引，不依赖空格分词，适合中文；
+    // 外部内容表只保存索引，由触发器与原表同步
+    migrator.AddMigration(4, "添加全文检索索引", {
+        "CREATE VIRTUAL TABLE IF NOT EXISTS files_fts USING fts5("
+        "file_name, content='files', content_rowid='id', tokenize='trigram')",
+        "CREATE TRIGGER IF NOT EXISTS files_fts_insert AFTER INSERT ON files BEGIN "
+        "INSERT INTO files_fts(rowid, file_name) VALUES (new.id, new.file_name); END",
+        "CREATE TRIGGER IF NOT EXISTS files_fts_delete AFTER DELETE ON files BEGIN "
+        "INSERT INTO files_fts(files_fts, rowid, file_name) VALUES ('delete', old.id, old.file_name); END",
+        "CREATE TRIGGER IF NOT EXISTS files_fts_update AFTER UPDATE OF file_name ON files BEGIN "
+        "INSERT INTO files_fts(files_fts, rowid, file_name) VALUES ('delete', old.id, old.file_name); "
+        "INSERT INTO files_fts(rowid, file_name) VALUES (new.id, new.file_name); END",
+
+        "CREATE VIRTUAL TABLE IF NOT EXISTS projects_fts USING fts5("
+        "name, description, content='projects', content_rowid='id', tokenize='trigram')",
+        "CREATE TRIGGER IF NOT EXISTS projects_fts_insert AFTER INSERT ON projects BEGIN "
+        "INSERT INTO projects_fts(rowid, name, description) VALUES (new.id, new.name, new.description); END",
+        "CREATE TRIGGER IF NOT EXISTS projects_fts_delete AFTER DELETE ON projects BEGIN "
+        "INSERT INTO projects_fts(projects_fts, rowid, name, description) "
+        "VALUES ('delete', old.id, old.name, old.description); END",
+        "CREATE TRIGGER IF NOT EXISTS projects_fts_update AFTER UPDATE OF name, description ON projects BEGIN "
+        "INSERT INTO projects_fts(projects_fts, rowid, name, description) "
+        "VALUES ('delete', old.id, old.name, old.description); "
+        "INSERT INTO projects_fts(rowid, name, description) VALUES (new.id, new.name, new.description); END",
+
+        "CREATE VIRTUAL TABLE IF NOT EXISTS project_nodes_fts USING fts5("
+        "name, description, content='project_nodes', content_rowid='id', tokenize='trigram')",
+        "CREATE TRIGGER IF NOT EXISTS project_nodes_fts_insert AFTER INSERT ON project_nodes BEGIN "
+        "INSERT INTO project_nodes_fts(rowid, name, description) VALUES (new.id, new.name, new.description); END",
+        "CREATE TRIGGER IF NOT EXISTS project_nodes_fts_delete AFTER DELETE ON project_nodes BEGIN "
+        "INSERT INTO project_nodes_fts(project_nodes_fts, rowid, name, description) "
+        "VALUES ('delete', old.id, old.name, old.description); END",
+        "CREATE TRIGGER IF NOT EXISTS project_nodes_fts_update AFTER UPDATE OF name, description ON project_nodes BEGIN "
+        "INSERT INTO project_nodes_fts(project_nodes_fts, rowid, name, description) "
+        "VALUES ('delete', old.id, old.name, old.description); "
+        "INSERT INTO project_nodes_fts(rowid, name, description) VALUES (new.id, new.name, new.description); END",
+
+        // 为已有数据建立索引
+        "INSERT INTO files_fts(files_fts) VALUES ('rebuild')",
+        "INSERT INTO projects_fts(projects_fts) VALUES ('rebuild')",
+        "INSERT INTO project_nodes_fts(project_nodes_fts) VALUES ('rebuild')"
+    });
+
+    // 版本5：文档正文索引。file_contents 记录每个文件建立索引时的大小和修改时间，
+    // 用于增量判断文件是否变化；正文保存在 file_contents_fts 中，rowid 为文件ID
+    migrator.AddMigration(5, "添加文档正文索引", {
+        "CREATE TABLE IF NOT EXISTS file_contents ("
+        "file_id INTEGER PRIMARY KEY, "
+        "status INTEGER NOT NULL, "
+        "file_size INTEGER NOT NULL, "
+        "modified_time INTEGER NOT NULL, "
+        "char_count INTEGER NOT NULL DEFAULT 0, "
+        "indexed_time TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
+        "FOREIGN KEY (file_id) REFERENCES files (id) ON DELETE CASCADE)",
+        "CREATE VIRTUAL TABLE IF NOT EXISTS file_contents_fts USING fts5(content, tokenize='trigram')",
+        // 文件删除时级联删除 file_contents，同时删除正文
+        "CREATE TRIGGER IF NOT EXISTS file_contents_fts_delete AFTER DELETE ON file_contents BEGIN "
+        "DELETE FROM file_contents_fts WHERE rowid = old.file_id; END",
+        // 文件路径变化后需要重新提取
+        "CREATE TRIGGER IF NOT EXISTS files_path_update AFTER UPDATE OF file_path ON files BEGIN "
+        "DELETE FROM file_contents WHERE file_id = new.id; END"
+    });
+
+    // 版本6：文档页数、字数、字符数，上传时提取，列表显示时不再打开文档。
+    // 旧文件为NULL，由正文索引在后台补齐
+    migrator.AddMigration(6, "添加文档统计列", {
+        "ALTER TABLE files ADD COLUMN page_count INTEGER",
+        "ALTER TABLE files ADD COLUMN word_count INTEGER",
+        "ALTER TABLE files ADD COLUMN character_count INTEGER"
+    });
+
+    // 版本7：按内容哈希保存的文件存储区。blobs 每行对应存储区中的一个文件，
+    // ref_count 为 content_hash 指向它的文件记录数，由触发器维护，为0时可以回收。
+    // 旧文件的 content_hash 为NULL，仍使用上传时的原始路径
+    migrator.AddMigration(7, "添加文件内容存储", {
+        "CREATE TABLE IF NOT EXISTS blobs ("
+        "hash TEXT PRIMARY KEY, "
+        "size INTEGER NOT NULL, "
+        "ref_count INTEGER NOT NULL DEFAULT 0, "
+        "create_time TIMESTAMP DEFAULT CURRENT_TIMESTAMP) WITHOUT ROWID",
+        "ALTER TABLE files ADD COLUMN content_hash TEXT",
+        // CollectGarbage: WHERE ref_count = 0
+        "CREATE INDEX IF NOT EXISTS idx_blobs_unreferenced ON blobs (create_time) WHERE ref_count = 0",
+        "CREATE TRIGGER IF NOT EXISTS files_blob_insert AFTER INSERT ON files "
+        "WHEN new.content_hash IS NOT NULL BEGIN "
+        "INSERT OR IGNORE INTO blobs (hash, size) VALUES (new.content_hash, new.file_size); "
+        "UPDATE blobs SET ref_count = ref_count + 1 WHERE hash = new.content_hash; END",
+        "CREATE TRIGGER IF NOT EXISTS files_blob_delete AFTER DELETE ON files "
+        "WHEN old.content_hash IS NOT NULL BEGIN "
+        "UPDATE blobs SET ref_count = ref_count - 1 WHERE hash = old.content_hash; END",
+        "CREATE TRIGGER IF NOT EXISTS files_blob_update AFTER UPDATE OF content_hash ON files "
+        "WHEN old.content_hash IS NOT new.content_hash BEGIN "
+        "UPDATE blobs SET ref_count = ref_count - 1 WHERE hash = old.content_hash; "
+        "INSERT OR IGNORE INTO blobs (hash, size) SELECT new.content_hash, new.file_size "
+        "WHERE new.content_hash IS NOT NULL; "
+        "UPDATE blobs SET ref_count = ref_count + 1 WHERE hash = new.content_hash; END"
+    });
+
+    // 版本8：node_file 补充 (node_id, file_id) 唯一约束。SQLite 不能为已有表添加约束，
+    // 先去掉重复的关联，再把原有的普通索引替换为同列的唯一索引
+    migrator.AddMigration(8, "节点文件关联唯一约束", {
+        "DELETE FROM node_file WHERE id NOT IN "
+        "(SELECT MIN(id) FROM node_file GROUP BY node_id, file_id)",
+        "DROP INDEX IF EXISTS idx_node_file_node",
+        "CREATE UNIQUE INDEX IF NOT EXISTS idx_node_file_node ON node_file (node_id, file_id)"
+    });
+
+    // 版本9：节点之间的前置依赖，用于进度计划和关键路径分析
+    migrator.AddMigration(9, "添加节点前置依赖", {
+        "CREATE TABLE IF NOT EXISTS node_dependencies ("
+        "successor_id INTEGER NOT NULL, "
+        "predecessor_id INTEGER NOT NULL, "
+        "PRIMARY KEY (successor_id, predecessor_id), "
+        "FOREIGN KEY (successor_id) REFERENCES project_nodes (id) ON DELETE CASCADE, "
+        "FOREIGN KEY (predecessor_id) REFERENCES project_nodes (id) ON DELETE CASCADE) WITHOUT ROWID",
+        // 前置节点删除时级联
+        "CREATE INDEX IF NOT EXISTS idx_node_dependencies_predecessor ON node_dependencies (predecessor_id)"
+    });
+
+    // 版本10：由触发器维护的项目汇总表，统计概览只读汇总表，开销与节点数和文件数无关。
+    // 逾期节点数随日期变化，不能直接维护，改为按预计完成日期统计未完成节点数，
+    // 查询时累加今天之前的日期，行数只与日期的种类有关
+    migrator.AddMigration(10, "添加项目汇总表", {
+        "CREATE TABLE IF NOT EXISTS project_stats ("
+        "project_id INTEGER PRIMARY KEY, "
+        "node_count INTEGER NOT NULL DEFAULT 0, "
+        "completed_count INTEGER NOT NULL DEFAULT 0, "
+        "file_count INTEGER NOT NULL DEFAULT 0, "
+        "total_bytes INTEGER NOT NULL DEFAULT 0, "
+        "FOREIGN KEY (project_id) REFERENCES projects (id) ON DELETE CASCADE)",
+        "CREATE TABLE IF NOT EXISTS project_due_stats ("
+        "project_id INTEGER NOT NULL, "
+        "due_date TEXT NOT NULL, "
+        "open_count INTEGER NOT NULL DEFAULT 0, "
+        "PRIMARY KEY (project_id, due_date), "
+        "FOREIGN KEY (project_id) REFERENCES projects (id) ON DELETE CASCADE) WITHOUT ROWID",
+
+        // 项目
+        "CREATE TRIGGER IF NOT EXISTS projects_stats_insert AFTER INSERT ON projects BEGIN "
+        "INSERT OR IGNORE INTO project_stats (project_id) VALUES (new.id); END",
+
+        // 节点：数量、完成数和按日期的未完成数
+        "CREATE TRIGGER IF NOT EXISTS project_nodes_stats_insert AFTER INSERT ON project_nodes BEGIN "
+        "UPDATE project_stats SET node_count = node_count + 1, "
+        "completed_count = completed_count + (new.is_completed != 0) WHERE project_id = new.project_id; "
+        "INSERT OR IGNORE INTO project_due_stats (project_id, due_date) "
+        "SELECT new.project_id, date(new.estimated_completion_time) "
+        "WHERE new.is_completed = 0 AND date(new.estimated_completion_time) IS NOT NULL; "
+        "UPDATE project_due_stats SET open_count = open_count + 1 "
+        "WHERE new.is_completed = 0 AND project_id = new.project_id "
+        "AND due_date = date(new.estimated_completion_time); END",
+        "CREATE TRIGGER IF NOT EXISTS project_nodes_stats_delete AFTER DELETE ON project_nodes BEGIN "
+        "UPDATE project_stats SET node_count = node_count - 1, "
+        "completed_count = completed_count - (old.is_completed != 0) WHERE project_id = old.project_id; "
+        "UPDATE project_due_stats SET open_count = open_count - 1 "
+        "WHERE old.is_completed = 0 AND project_id = old.project_id "
+        "AND due_date = date(old.estimated_completion_time); "
+        "DELETE FROM project_due_stats WHERE project_id = old.project_id "
+        "AND due_date = date(old.estimated_completion_time) AND open_count <= 0; END",
+        "CREATE TRIGGER IF NOT EXISTS project_nodes_stats_update "
+        "AFTER UPDATE OF project_id, is_completed, estimated_completion_time ON project_nodes BEGIN "
+        "UPDATE project_stats SET node_count = node_count - 1, "
+        "completed_count = completed_count - (old.is_completed != 0) WHERE project_id = old.project_id; "
+        "UPDATE project_stats SET node_count = node_count + 1, "
+        "completed_count = completed_count + (new.is_completed != 0) WHERE project_id = new.project_id; "
+        "UPDATE project_due_stats SET open_count = open_count - 1 "
+        "WHERE old.is_completed = 0 AND project_id = old.project_id "
+        "AND due_date = date(old.estimated_completion_time); "
+        "DELETE FROM project_due_stats WHERE project_id = old.project_id "
+        "AND due_date = date(old.estimated_completion_time) AND open_count <= 0; "
+        "INSERT OR IGNORE INTO project_due_stats (project_id, due_date) "
+        "SELECT new.project_id, date(new.estimated_completion_time) "
+        "WHERE new.is_completed = 0 AND date(new.estimated_completion_time) IS NOT NULL; "
+        "UPDATE project_due_stats SET open_count = open_count + 1 "
+        "WHERE new.is_completed = 0 AND project_id = new.project_id "
+        "AND due_date = date(new.estimated_completion_time); END",
+
+        // 项目文件：只统计正常状态的文件。文件被删除时关联由外键级联删除，
+        // 级联触发时文件行已不存在，因此在删除文件之前先扣除
+        "CREATE TRIGGER IF NOT EXISTS project_file_stats_insert AFTER INSERT ON project_file BEGIN "
+        "UPDATE project_stats SET file_count = file_count + 1, "
+        "total_bytes = total_bytes + (SELECT file_size FROM files WHERE id = new.file_id) "
+        "WHERE project_id = new.project_id "
+        "AND (SELECT status FROM files WHERE id = new.file_id) = 0; END",
+        "CREATE TRIGGER IF NOT EXISTS project_file_stats_delete AFTER DELETE ON project_file BEGIN "
+        "UPDATE project_stats SET file_count = file_count - 1, "
+        "total_bytes = total_bytes - (SELECT file_size FROM files WHERE id = old.file_id) "
+        "WHERE project_id = old.project_id "
+        "AND (SELECT status FROM files WHERE id = old.file_id) = 0; END",
+        "CREATE TRIGGER IF NOT EXISTS files_stats_delete BEFORE DELETE ON files "
+        "WHEN old.status = 0 BEGIN "
+        "UPDATE project_stats SET file_count = file_count - 1, total_bytes = total_bytes - old.file_size "
+        "WHERE project_id IN (SELECT project_id FROM project_file WHERE file_id = old.id); END",
+        "CREATE TRIGGER IF NOT EXISTS files_stats_update AFTER UPDATE OF status, file_size ON files BEGIN "
+        "UPDATE project_stats SET "
+        "file_count = file_count - (old.status = 0) + (new.status = 0), "
+        "total_bytes = total_bytes - (CASE WHEN old.status = 0 THEN old.file_size ELSE 0 END) "
+        "+ (CASE WHEN new.status = 0 THEN new.file_size ELSE 0 END) "
+        "WHERE project_id IN (SELECT project_id FROM project_file WHERE file_id = new.id); END",
+
+        // 已有数据
+        "INSERT OR IGNORE INTO project_stats (project_id) SELECT id FROM projects",
+        "UPDATE project_stats SET "
+        "node_count = (SELECT COUNT(*) FROM project_nodes WHERE project_id = project_stats.project_id), "
+        "completed_count = (SELECT COUNT(*) FROM project_nodes "
+        "WHERE project_id = project_stats.project_id AND is_completed != 0), "
+        "file_count = (SELECT COUNT(*) FROM project_file pf INNER JOIN files f ON f.id = pf.file_id "
+        "WHERE pf.project_id = project_stats.project_id AND f.status = 0), "
+        "total_bytes = (SELECT IFNULL(SUM(f.file_size), 0) FROM project_file pf INNER JOIN files f ON f.id = pf.file_id "
+        "WHERE pf.project_id = project_stats.project_id AND f.status = 0)",
+        "INSERT OR IGNORE INTO project_due_stats (project_id, due_date, open_count) "
+        "SELECT project_id, date(estimated_completion_time), COUNT(*) FROM project_nodes "
+        "WHERE is_completed = 0 AND date(estimated_completion_time) IS NOT NULL "
+        "GROUP BY project_id, date(estimated_completion_time)"
+    });
+
+    // 版本11：少于3个字符的检索词无法使用 trigram 索引，为文件名、项目名称描述增加二元分词索引。
+    // 每个位置取从该位置开始的两个字符（末尾为单个字符），以空格连接后由 unicode61 分词，
+    // prefix='1' 让单字符检索按前缀走索引。bigram_positions 提供字符位置，
+    // 触发器中不能使用递归CTE；超过8192个字符的部分不建索引。
+    // 节点全文索引没有查询使用，一并删除
+    migrator.AddMigration(11, "添加短词检索索引", {
+        "CREATE TABLE IF NOT EXISTS bigram_positions (n INTEGER PRIMARY KEY)",
+        "WITH RECURSIVE seq(n) AS (SELECT 1 UNION ALL SELECT n + 1 FROM seq WHERE n < 8192) "
+        "INSERT OR IGNORE INTO bigram_positions (n) SELECT n FROM seq",
+
+        "CREATE VIRTUAL TABLE IF NOT EXISTS files_bigram USING fts5("
+        "file_name, tokenize='unicode61', prefix='1')",
+        "CREATE TRIGGER IF NOT EXISTS files_bigram_insert AFTER INSERT ON files BEGIN "
+        "INSERT INTO files_bigram(rowid, file_name) "
+        "SELECT new.id, group_concat(substr(new.file_name, n, 2), ' ') "
+        "FROM bigram_positions WHERE n <= length(new.file_name); END",
+        "CREATE TRIGGER IF NOT EXISTS files_bigram_delete AFTER DELETE ON files BEGIN "
+        "DELETE FROM files_bigram WHERE rowid = old.id; END",
+        "CREATE TRIGGER IF NOT EXISTS files_bigram_update AFTER UPDATE OF file_name ON files BEGIN "
+        "DELETE FROM files_bigram WHERE rowid = old.id; "
+        "INSERT INTO files_bigram(rowid, file_name) "
+        "SELECT new.id, group_concat(substr(new.file_name, n, 2), ' ') "
+        "FROM bigram_positions WHERE n <= length(new.file_name); END",
+
+        "CREATE VIRTUAL TABLE IF NOT EXISTS projects_bigram USING fts5("
+        "name, description, tokenize='unicode61', prefix='1')",
+        "CREATE TRIGGER IF NOT EXISTS projects_bigram_insert AFTER INSERT ON projects BEGIN "
+        "INSERT INTO projects_bigram(rowid, name, description) VALUES (new.id, "
+        "(SELECT group_concat(substr(new.name, n, 2), ' ') FROM bigram_positions WHERE n <= length(new.name)), "
+        "(SELECT group_concat(substr(new.description, n, 2), ' ') FROM bigram_positions "
+        "WHERE n <= length(new.description))); END",
+        "CREATE TRIGGER IF NOT EXISTS projects_bigram_delete AFTER DELETE ON projects BEGIN "
+        "DELETE FROM projects_bigram WHERE rowid = old.id; END",
+        "CREATE TRIGGER IF NOT EXISTS projects_bigram_update AFTER UPDATE OF name, description ON projects BEGIN "
+        "DELETE FROM projects_bigram WHERE rowid = old.id; "
+        "INSERT INTO projects_bigram(rowid, name, description) VALUES (new.id, "
+        "(SELECT group_concat(substr(new.name, n, 2), ' ') FROM bigram_positions WHERE n <= length(new.name)), "
+        "(SELECT group_concat(substr(new.description, n, 2), ' ') FROM bigram_positions "
+        "WHERE n <= length(new.description))); END",
+
+        // 为已有数据建立索引
+        "INSERT INTO files_bigram(rowid, file_name) SELECT f.id, "
+        "(SELECT group_concat(substr(f.file_name, n, 2), ' ') FROM bigram_positions WHERE n <= length(f.file_name)) "
+        "FROM files f",
+        "INSERT INTO projects_bigram(rowid, name, description) SELECT p.id, "
+        "(SELECT group_concat(substr(p.name, n, 2), ' ') FROM bigram_positions WHERE n <= length(p.name)), "
+        "(SELECT group_concat(substr(p.description, n, 2), ' ') FROM bigram_positions "
+        "WHERE n <= length(p.description)) "
+        "FROM projects p",
+
+        "DROP TRIGGER IF EXISTS project_nodes_fts_insert",
+        "DROP TRIGGER IF EXISTS project_nodes_fts_delete",
+        "DROP TRIGGER IF EXISTS project_nodes_fts_update",
+        "DROP TABLE IF EXISTS project_nodes_fts"
+    });
+
+    if(!migrator.Migrate())
+    {
+        qDebug() << "数据库结构迁移失败";
         return false;
     }
 
+    qDebug() << "数据库结构版本: " << migrator.CurrentVersion();
     return true;
 }
 
-bool DataBaseManagement::CreateNodeFileTable()
-{
-    QSqlQuery query(_db);
-    bool success = query.exec("CREATE TABLE IF NOT EXISTS node_file ( "
-                           "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                           "node_id INTEGER NOT NULL, "
-                           "file_id INTEGER NOT NULL, "
-                           "FOREIGN KEY (node_id) REFERENCES project_nodes (id) ON DELETE CASCADE, "
-                           "FOREIGN KEY (file_id) REFERENCES files (id) ON DELETE CASCADE"
-                           ")");
-    
-    if(!success) {
-        qDebug() << "Failed to create node_file table: " << query.lastError().text();
-    }
-    
-    return success;
-}
-
 bool DataBaseManagement::InsertDefaultData()
 {
-    QSqlQuery query;
+    QSqlQuery query(Database());
     query.prepare("SELECT COUNT(*) FROM users WHERE role = 0");
     if(!query.exec() || !query.next())
     {
@@ -277,9 +764,9 @@ User DataBaseManagement::GetUserbyUserName(const QString& userName)
 {
     User user;
     user.id = -1;
-    QSqlQuery query;
-    query.prepare("SELECT id, username, password, role, created_at "
-                  "FROM users WHERE username = ?");
+    QSqlQuery& query = Statements().Prepare("user.byName",
+        "SELECT id, username, password, role, created_at "
+        "FROM users WHERE username = ?");
     query.bindValue(0, userName);
 
     if(query.exec() && query.next())
@@ -290,6 +777,36 @@ User DataBaseManagement::GetUserbyUserName(const QString& userName)
         user.role       = static_cast<UserRole>(query.value(3).toInt());
         user.createTime = query.value(4).toDateTime();
     }
+    query.finish();
+
+    return user;
+}
+
+User DataBaseManagement::GetUserById(int userId)
+{
+    User user;
+    if(_cache.FindUser(userId, user))
+    {
+        return user;
+    }
+
+    user.id = -1;
+    quint64 generation = _cache.Generation(EntityCache::Users);
+    QSqlQuery& query = Statements().Prepare("user.byId",
+        "SELECT id, username, password, role, created_at "
+        "FROM users WHERE id = ?");
+    query.bindValue(0, userId);
+
+    if(query.exec() && query.next())
+    {
+        user.id         = query.value(0).toInt();
+        user.userName   = query.value(1).toString();
+        user.password   = query.value(2).toString();
+        user.role       = static_cast<UserRole>(query.value(3).toInt());
+        user.createTime = query.value(4).toDateTime();
+        _cache.StoreUser(user, generation);
+    }
+    query.finish();
 
     return user;
 }
@@ -297,8 +814,14 @@ User DataBaseManagement::GetUserbyUserName(const QString& userName)
 QVector<User> DataBaseManagement::GetAllUsers()
 {
     QVector<User> users;
-    QSqlQuery query;
-    query.prepare("SELECT id, username, password, role, created_at FROM users");
+    if(_cache.FindAllUsers(users))
+    {
+        return users;
+    }
+
+    quint64 generation = _cache.Generation(EntityCache::Users);
+    QSqlQuery& query = Statements().Prepare("user.all",
+        "SELECT id, username, password, role, created_at FROM users");
     
     if(query.exec())
     {
@@ -312,6 +835,7 @@ QVector<User> DataBaseManagement::GetAllUsers()
             user.createTime = query.value(4).toDateTime();
             users.append(user);
         }
+        _cache.StoreAllUsers(users, generation);
     }
     else
     {
@@ -323,8 +847,11 @@ QVector<User> DataBaseManagement::GetAllUsers()
 
 bool DataBaseManagement::AddUser(const User& user)
 {
-    QSqlQuery query;
-    query.prepare("INSERT INTO users (username, password, role) VALUES (?, ?, ?)");
+    if(!_pool.InWriteScope())
+        return RunOnWriter([user](DataBaseManagement* db) { return db->AddUser(user); });
+
+    QSqlQuery& query = Statements().Prepare("user.add",
+        "INSERT INTO users (username, password, role) VALUES (?, ?, ?)");
     query.addBindValue(user.userName);
     query.addBindValue(user.password);
     query.addBindValue(static_cast<int>(user.role));
@@ -335,13 +862,17 @@ bool DataBaseManagement::AddUser(const User& user)
         return false;
     }
     
+    _cache.InvalidateUserList();
     return true;
 }
 
 bool DataBaseManagement::UpdateUser(const User& user)
 {
-    QSqlQuery query;
-    query.prepare("UPDATE users SET username = ?, password = ?, role = ? WHERE id = ?");
+    if(!_pool.InWriteScope())
+        return RunOnWriter([user](DataBaseManagement* db) { return db->UpdateUser(user); });
+
+    QSqlQuery& query = Statements().Prepare("user.update",
+        "UPDATE users SET username = ?, password = ?, role = ? WHERE id = ?");
     query.addBindValue(user.userName);
     query.addBindValue(user.password);
     query.addBindValue(static_cast<int>(user.role));
@@ -353,13 +884,52 @@ bool DataBaseManagement::UpdateUser(const User& user)
         return false;
     }
     
+    // 项目中缓存了经理的用户名
+    _cache.InvalidateUser(user.id);
+    _cache.InvalidateProjectsByManager(user.id);
     return true;
 }
 
+UserOwnership DataBaseManagement::GetUserOwnership(int userId)
+{
+    UserOwnership ownership;
+    QSqlQuery& query = Statements().Prepare("user.ownership",
+        "SELECT (SELECT COUNT(*) FROM files WHERE uploader_id = ?), "
+        "(SELECT COUNT(*) FROM projects WHERE manager_id = ?)");
+    query.addBindValue(userId);
+    query.addBindValue(userId);
+
+    if(query.exec() && query.next())
+    {
+        ownership.fileCount = query.value(0).toInt();
+        ownership.projectCount = query.value(1).toInt();
+    }
+    else
+    {
+        qDebug() << "Failed to count user ownership: " << query.lastError().text();
+    }
+    query.finish();
+
+    return ownership;
+}
+
 bool DataBaseManagement::DeleteUser(int userId)
 {
-    QSqlQuery query;
-    query.prepare("DELETE FROM users WHERE id = ? AND role != 0"); // 防止删除管理员
+    if(!_pool.InWriteScope())
+        return RunOnWriter([userId](DataBaseManagement* db) { return db->DeleteUser(userId); });
+
+    // files.uploader_id 和 projects.manager_id 都是 ON DELETE CASCADE，
+    // 直接删除会连带删除文件记录、项目及其节点，必须先转移或删除这些数据
+    UserOwnership ownership = GetUserOwnership(userId);
+    if(ownership.fileCount > 0 || ownership.projectCount > 0)
+    {
+        qDebug() << "Refused to delete user" << userId << ": owns" << ownership.fileCount
+                 << "files and" << ownership.projectCount << "projects";
+        return false;
+    }
+
+    QSqlQuery& query = Statements().Prepare("user.delete",
+        "DELETE FROM users WHERE id = ? AND role != 0"); // 防止删除管理员
     query.addBindValue(userId);
     
     if(!query.exec())
@@ -368,36 +938,29 @@ bool DataBaseManagement::DeleteUser(int userId)
         return false;
     }
     
-    return query.numRowsAffected() > 0;
+    if(query.numRowsAffected() <= 0)
+    {
+        return false;
+    }
+
+    _cache.InvalidateUser(userId);
+    return true;
 }
 
 // 文件相关方法实现
 QVector<FileInfo> DataBaseManagement::GetAllFiles(FileStatus status)
 {
     QVector<FileInfo> files;
-    QSqlQuery query;
-    query.prepare("SELECT f.id, f.file_name, f.file_path, f.file_extension, f.file_size, f.uploader_id, "
-                 "u.username, f.upload_time, f.file_type, f.status, f.project_id, f.is_process_document "
-                 "FROM files f JOIN users u ON f.uploader_id = u.id WHERE f.status = ?");
+    QSqlQuery& query = Statements().Prepare("file.byStatus",
+        "SELECT " FILE_COLUMNS
+        "FROM files f JOIN users u ON f.uploader_id = u.id WHERE f.status = ?");
     query.addBindValue(static_cast<int>(status));
     
     if(query.exec())
     {
         while(query.next())
         {
-            FileInfo file;
-            file.id = query.value(0).toInt();
-            file.fileName = query.value(1).toString();
-            file.filePath = query.value(2).toString();
-            file.fileExtension = query.value(3).toString();
-            file.fileSize = query.value(4).toLongLong();
-            file.uploaderId = query.value(5).toInt();
-            file.uploaderName = query.value(6).toString();
-            file.uploadTime = query.value(7).toDateTime();
-            file.fileType = static_cast<FileType>(query.value(8).toInt());
-            file.status = static_cast<FileStatus>(query.value(9).toInt());
-            file.projectId = query.value(10).toInt();
-            file.isProcessDocument = query.value(11).toBool();
+            FileInfo file = ReadFileInfo(query, 0);
             files.append(file);
         }
     }
@@ -412,10 +975,9 @@ QVector<FileInfo> DataBaseManagement::GetAllFiles(FileStatus status)
 QVector<FileInfo> DataBaseManagement::GetFilesByProject(int projectId, FileStatus status)
 {
     QVector<FileInfo> files;
-    QSqlQuery query;
-    query.prepare("SELECT f.id, f.file_name, f.file_path, f.file_extension, f.file_size, f.uploader_id, "
-                 "u.username, f.upload_time, f.file_type, f.status, f.project_id, f.is_process_document "
-                 "FROM files f JOIN users u ON f.uploader_id = u.id WHERE f.project_id = ? AND f.status = ?");
+    QSqlQuery& query = Statements().Prepare("file.byProject",
+        "SELECT " FILE_COLUMNS
+        "FROM files f JOIN users u ON f.uploader_id = u.id WHERE f.project_id = ? AND f.status = ?");
     query.addBindValue(projectId);
     query.addBindValue(static_cast<int>(status));
     
@@ -423,19 +985,7 @@ QVector<FileInfo> DataBaseManagement::GetFilesByProject(int projectId, FileStatu
     {
         while(query.next())
         {
-            FileInfo file;
-            file.id = query.value(0).toInt();
-            file.fileName = query.value(1).toString();
-            file.filePath = query.value(2).toString();
-            file.fileExtension = query.value(3).toString();
-            file.fileSize = query.value(4).toLongLong();
-            file.uploaderId = query.value(5).toInt();
-            file.uploaderName = query.value(6).toString();
-            file.uploadTime = query.value(7).toDateTime();
-            file.fileType = static_cast<FileType>(query.value(8).toInt());
-            file.status = static_cast<FileStatus>(query.value(9).toInt());
-            file.projectId = query.value(10).toInt();
-            file.isProcessDocument = query.value(11).toBool();
+            FileInfo file = ReadFileInfo(query, 0);
             files.append(file);
         }
     }
@@ -447,110 +997,359 @@ QVector<FileInfo> DataBaseManagement::GetFilesByProject(int projectId, FileStatu
     return files;
 }
 
-QVector<FileInfo> DataBaseManagement::GetProcessDocuments()
+FileInfo DataBaseManagement::GetFileById(int fileId)
 {
-    QVector<FileInfo> files;
-    QSqlQuery query;
-    query.prepare("SELECT f.id, f.file_name, f.file_path, f.file_extension, f.file_size, f.uploader_id, "
-                 "u.username, f.upload_time, f.file_type, f.status, f.project_id, f.is_process_document "
-                 "FROM files f JOIN users u ON f.uploader_id = u.id WHERE f.is_process_document = 1 AND f.status = ?");
-    query.addBindValue(static_cast<int>(FileStatus::NORMAL));
-    
-    if(query.exec())
+    FileInfo file;
+    file.id = -1;
+    // 主键查询，不受文件总数影响
+    QSqlQuery& query = Statements().Prepare("file.byId",
+        "SELECT " FILE_COLUMNS
+        "FROM files f JOIN users u ON f.uploader_id = u.id WHERE f.id = ?");
+    query.addBindValue(fileId);
+
+    if(query.exec() && query.next())
     {
-        while(query.next())
-        {
-            FileInfo file;
-            file.id = query.value(0).toInt();
-            file.fileName = query.value(1).toString();
-            file.filePath = query.value(2).toString();
-            file.fileExtension = query.value(3).toString();
-            file.fileSize = query.value(4).toLongLong();
-            file.uploaderId = query.value(5).toInt();
-            file.uploaderName = query.value(6).toString();
-            file.uploadTime = query.value(7).toDateTime();
-            file.fileType = static_cast<FileType>(query.value(8).toInt());
-            file.status = static_cast<FileStatus>(query.value(9).toInt());
-            file.projectId = query.value(10).toInt();
-            file.isProcessDocument = query.value(11).toBool();
-            files.append(file);
-        }
+        file = ReadFileInfo(query, 0);
     }
-    else
+    else if(query.lastError().isValid())
     {
-        qDebug() << "Failed to get process documents: " << query.lastError().text();
+        qDebug() << "Failed to get file by id: " << query.lastError().text();
     }
-    
-    return files;
+    query.finish();
+
+    return file;
 }
 
-bool DataBaseManagement::AddFile(const FileInfo& file)
+QVector<FileInfo> DataBaseManagement::GetFilesByIds(const QVector<int>& fileIds)
 {
-    QSqlQuery query;
-    query.prepare("INSERT INTO files (file_name, file_path, file_extension, file_size, uploader_id, "
-                 "file_type, status, project_id, is_process_document) "
-                 "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)");
-    query.addBindValue(file.fileName);
-    query.addBindValue(file.filePath);
-    query.addBindValue(file.fileExtension);
-    query.addBindValue(file.fileSize);
-    query.addBindValue(file.uploaderId);
-    query.addBindValue(static_cast<int>(file.fileType));
-    query.addBindValue(static_cast<int>(file.status));
-    query.addBindValue(file.projectId > 0 ? file.projectId : QVariant());
-    query.addBindValue(file.isProcessDocument);
-    
-    if(!query.exec())
+    // SQLite单条语句的参数个数有上限，按批次拼接IN列表
+    const int BATCH_SIZE = 512;
+
+    QHash<int, FileInfo> found;
+    QVector<int> uniqueIds;
+    QSet<int> seen;
+    for(int fileId : fileIds)
     {
-        qDebug() << "Failed to add file: " << query.lastError().text();
-        return false;
+        if(!seen.contains(fileId))
+        {
+            seen.insert(fileId);
+            uniqueIds.append(fileId);
+        }
     }
-    
-    return true;
-}
 
-bool DataBaseManagement::UpdateFile(const FileInfo& file)
-{
-    QSqlQuery query;
-    query.prepare("UPDATE files SET file_name = ?, file_path = ?, file_extension = ?, "
-                 "file_size = ?, file_type = ?, status = ?, project_id = ?, is_process_document = ? "
-                 "WHERE id = ?");
-    query.addBindValue(file.fileName);
-    query.addBindValue(file.filePath);
-    query.addBindValue(file.fileExtension);
-    query.addBindValue(file.fileSize);
-    query.addBindValue(static_cast<int>(file.fileType));
-    query.addBindValue(static_cast<int>(file.status));
-    query.addBindValue(file.projectId > 0 ? file.projectId : QVariant());
-    query.addBindValue(file.isProcessDocument);
-    query.addBindValue(file.id);
-    
-    if(!query.exec())
+    for(int offset = 0; offset < uniqueIds.size(); offset += BATCH_SIZE)
     {
-        qDebug() << "Failed to update file: " << query.lastError().text();
-        return false;
-    }
-    
+        int count = qMin(BATCH_SIZE, static_cast<int>(uniqueIds.size()) - offset);
+
+        // 参数个数向上取整到2的幂，多出的位置重复绑定最后一个ID，
+        // 这样缓存中最多只有几条不同长度的语句
+        int paramCount = 1;
+        while(paramCount < count)
+        {
+            paramCount *= 2;
+        }
+
+        QStringList placeholders;
+        for(int i = 0; i < paramCount; i++)
+        {
+            placeholders << "?";
+        }
+
+        QSqlQuery& query = Statements().Prepare(QString("file.byIds.%1").arg(paramCount),
+            "SELECT " FILE_COLUMNS
+            "FROM files f JOIN users u ON f.uploader_id = u.id "
+            "WHERE f.id IN (" + placeholders.join(", ") + ")");
+        for(int i = 0; i < paramCount; i++)
+        {
+            query.addBindValue(uniqueIds[offset + qMin(i, count - 1)]);
+        }
+
+        if(!query.exec())
+        {
+            qDebug() << "Failed to get files by ids: " << query.lastError().text();
+            continue;
+        }
+
+        while(query.next())
+        {
+            FileInfo file = ReadFileInfo(query, 0);
+            found.insert(file.id, file);
+        }
+    }
+
+    // 按调用方传入的顺序返回，不存在的ID直接跳过
+    QVector<FileInfo> files;
+    files.reserve(found.size());
+    for(int fileId : uniqueIds)
+    {
+        auto it = found.constFind(fileId);
+        if(it != found.constEnd())
+        {
+            files.append(it.value());
+        }
+    }
+
+    return files;
+}
+
+FilePage DataBaseManagement::QueryFiles(const FileQuery& fileQuery)
+{
+    FilePage page;
+    int pageSize = qMax(1, fileQuery.pageSize);
+
+    // 排序列只取固定的表达式，不拼接外部输入
+    QString sortColumn;
+    switch(fileQuery.sortKey)
+    {
+        case FileSortKey::Id: sortColumn = "f.id"; break;
+        case FileSortKey::Name: sortColumn = "f.file_name"; break;
+        case FileSortKey::UploadTime: sortColumn = "f.upload_time"; break;
+        case FileSortKey::Size: sortColumn = "f.file_size"; break;
+    }
+    QString direction = fileQuery.descending ? "DESC" : "ASC";
+    QString comparison = fileQuery.descending ? "<" : ">";
+
+    QStringList conditions;
+    QVariantList bindValues;
+    conditions << "f.status = ?";
+    bindValues << static_cast<int>(fileQuery.status);
+
+    if(fileQuery.fileType != -1)
+    {
+        conditions << "f.file_type = ?";
+        bindValues << fileQuery.fileType;
+    }
+
+    if(fileQuery.processDocumentsOnly)
+    {
+        conditions << "f.is_process_document = 1";
+    }
+
+    const QStringList terms = SearchTerms(fileQuery.nameContains);
+    if(!terms.isEmpty())
+    {
+        // 优先走全文索引，有短词无法使用 trigram 索引时改用二元分词索引并逐词确认，
+        // 此时不搜索正文，避免扫描全部文档内容
+        QString match = FullTextMatchExpression(terms);
+        if(!match.isEmpty() && fileQuery.searchContent)
+        {
+            conditions << "(f.id IN (SELECT rowid FROM files_fts WHERE files_fts MATCH ?) "
+                          "OR f.id IN (SELECT rowid FROM file_contents_fts WHERE file_contents_fts MATCH ?))";
+            bindValues << match << match;
+        }
+        else if(!match.isEmpty())
+        {
+            conditions << "f.id IN (SELECT rowid FROM files_fts WHERE files_fts MATCH ?)";
+            bindValues << match;
+        }
+        else
+        {
+            QString bigrams = BigramMatchExpression(terms);
+            if(!bigrams.isEmpty())
+            {
+                conditions << "f.id IN (SELECT rowid FROM files_bigram WHERE files_bigram MATCH ?)";
+                bindValues << bigrams;
+            }
+            for(const QString& term : terms)
+            {
+                conditions << "f.file_name LIKE ? ESCAPE '\\'";
+                bindValues << "%" + EscapeLikePattern(term) + "%";
+            }
+        }
+    }
+
+    // keyset分页：从上一页最后一行之后继续，按 (排序列, id) 走索引定位，不需要 OFFSET 扫描
+    QString orderBy;
+    if(fileQuery.sortKey == FileSortKey::Id)
+    {
+        orderBy = QString("f.id %1").arg(direction);
+        if(fileQuery.after.valid)
+        {
+            conditions << QString("f.id %1 ?").arg(comparison);
+            bindValues << fileQuery.after.id;
+        }
+    }
+    else
+    {
+        orderBy = QString("%1 %2, f.id %2").arg(sortColumn, direction);
+        if(fileQuery.after.valid)
+        {
+            conditions << QString("(%1, f.id) %2 (?, ?)").arg(sortColumn, comparison);
+            bindValues << fileQuery.after.sortValue << fileQuery.after.id;
+        }
+    }
+
+    // 多取一行用于判断是否还有下一页
+    bindValues << pageSize + 1;
+
+    QString sql = QString(
+        "SELECT " FILE_COLUMNS ", %1 "
+        "FROM files f JOIN users u ON f.uploader_id = u.id "
+        "WHERE %2 ORDER BY %3 LIMIT ?").arg(sortColumn, conditions.join(" AND "), orderBy);
+
+    // 不同筛选组合生成的SQL不同，以SQL文本区分缓存的语句
+    QSqlQuery& query = Statements().Prepare("file.query:" + sql, sql);
+    for(const QVariant& value : bindValues)
+    {
+        query.addBindValue(value);
+    }
+
+    if(query.exec())
+    {
+        while(query.next())
+        {
+            if(page.files.size() == pageSize)
+            {
+                page.hasMore = true;
+                break;
+            }
+
+            FileInfo file = ReadFileInfo(query, 0);
+            page.files.append(file);
+
+            // 游标保存数据库中的原始排序值，保证下一页比较时与索引中的值一致
+            page.next.valid = true;
+            page.next.sortValue = query.value(16);
+            page.next.id = file.id;
+        }
+        query.finish();
+    }
+    else
+    {
+        qDebug() << "Failed to query files: " << query.lastError().text();
+    }
+
+    return page;
+}
+
+bool DataBaseManagement::AddFile(const FileInfo& file)
+{
+    if(!_pool.InWriteScope())
+        return RunOnWriter([file](DataBaseManagement* db) { return db->AddFile(file); });
+
+    return InsertFile(file) > 0;
+}
+
+QVector<int> DataBaseManagement::AddFiles(const QVector<FileInfo>& files)
+{
+    if(!_pool.InWriteScope())
+        return RunOnWriter([files](DataBaseManagement* db) { return db->AddFiles(files); });
+
+    QVector<int> fileIds;
+    if(files.isEmpty())
+        return fileIds;
+
+    // 一个事务只在提交时同步一次磁盘，每行复用同一条预编译语句
+    QSqlDatabase db = Database();
+    if(!BeginWriteTransaction())
+        return QVector<int>();
+
+    fileIds.reserve(files.size());
+    for(const FileInfo& file : files)
+    {
+        int fileId = InsertFile(file);
+        if(fileId <= 0)
+        {
+            db.rollback();
+            return QVector<int>();
+        }
+        fileIds.append(fileId);
+    }
+
+    if(!db.commit())
+    {
+        qDebug() << "Failed to commit files: " << db.lastError().text();
+        db.rollback();
+        return QVector<int>();
+    }
+    return fileIds;
+}
+
+int DataBaseManagement::InsertFile(const FileInfo& file)
+{
+    QSqlQuery& query = Statements().Prepare("file.add",
+        "INSERT INTO files (file_name, file_path, file_extension, file_size, uploader_id, "
+        "file_type, status, project_id, is_process_document, page_count, word_count, character_count, "
+        "content_hash) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    query.addBindValue(file.fileName);
+    query.addBindValue(file.filePath);
+    query.addBindValue(file.fileExtension);
+    query.addBindValue(file.fileSize);
+    query.addBindValue(file.uploaderId);
+    query.addBindValue(static_cast<int>(file.fileType));
+    query.addBindValue(static_cast<int>(file.status));
+    query.addBindValue(file.projectId > 0 ? file.projectId : QVariant());
+    query.addBindValue(file.isProcessDocument);
+    query.addBindValue(file.pageCount > 0 ? file.pageCount : QVariant());
+    query.addBindValue(file.pageCount > 0 ? file.wordCount : QVariant());
+    query.addBindValue(file.pageCount > 0 ? file.characterCount : QVariant());
+    query.addBindValue(file.contentHash.isEmpty() ? QVariant() : file.contentHash);
+    
+    if(!query.exec())
+    {
+        qDebug() << "Failed to add file: " << query.lastError().text();
+        return -1;
+    }
+    
+    return query.lastInsertId().toInt();
+}
+
+bool DataBaseManagement::UpdateFile(const FileInfo& file)
+{
+    if(!_pool.InWriteScope())
+        return RunOnWriter([file](DataBaseManagement* db) { return db->UpdateFile(file); });
+
+    QSqlQuery& query = Statements().Prepare("file.update",
+        "UPDATE files SET file_name = ?, file_path = ?, file_extension = ?, "
+        "file_size = ?, file_type = ?, status = ?, project_id = ?, is_process_document = ?, "
+        "page_count = ?, word_count = ?, character_count = ?, content_hash = ? "
+        "WHERE id = ?");
+    query.addBindValue(file.fileName);
+    query.addBindValue(file.filePath);
+    query.addBindValue(file.fileExtension);
+    query.addBindValue(file.fileSize);
+    query.addBindValue(static_cast<int>(file.fileType));
+    query.addBindValue(static_cast<int>(file.status));
+    query.addBindValue(file.projectId > 0 ? file.projectId : QVariant());
+    query.addBindValue(file.isProcessDocument);
+    query.addBindValue(file.pageCount > 0 ? file.pageCount : QVariant());
+    query.addBindValue(file.pageCount > 0 ? file.wordCount : QVariant());
+    query.addBindValue(file.pageCount > 0 ? file.characterCount : QVariant());
+    query.addBindValue(file.contentHash.isEmpty() ? QVariant() : file.contentHash);
+    query.addBindValue(file.id);
+    
+    if(!query.exec())
+    {
+        qDebug() << "Failed to update file: " << query.lastError().text();
+        return false;
+    }
+    
     return true;
 }
 
 bool DataBaseManagement::DeleteFile(int fileId, bool permanent)
 {
-    QSqlQuery query;
+    if(!_pool.InWriteScope())
+        return RunOnWriter([fileId, permanent](DataBaseManagement* db) { return db->DeleteFile(fileId, permanent); });
+
+    QSqlQuery* statement = nullptr;
     
     if(permanent)
     {
         // 永久删除文件
-        query.prepare("DELETE FROM files WHERE id = ?");
-        query.addBindValue(fileId);
+        statement = &Statements().Prepare("file.delete",
+            "DELETE FROM files WHERE id = ?");
+        statement->addBindValue(fileId);
     }
     else
     {
         // 标记为已删除状态
-        query.prepare("UPDATE files SET status = ? WHERE id = ?");
-        query.addBindValue(static_cast<int>(FileStatus::DELETED));
-        query.addBindValue(fileId);
+        statement = &Statements().Prepare("file.markDeleted",
+            "UPDATE files SET status = ? WHERE id = ?");
+        statement->addBindValue(static_cast<int>(FileStatus::DELETED));
+        statement->addBindValue(fileId);
     }
+    QSqlQuery& query = *statement;
     
     if(!query.exec())
     {
@@ -563,8 +1362,11 @@ bool DataBaseManagement::DeleteFile(int fileId, bool permanent)
 
 bool DataBaseManagement::RestoreFile(int fileId)
 {
-    QSqlQuery query;
-    query.prepare("UPDATE files SET status = ? WHERE id = ? AND status = ?");
+    if(!_pool.InWriteScope())
+        return RunOnWriter([fileId](DataBaseManagement* db) { return db->RestoreFile(fileId); });
+
+    QSqlQuery& query = Statements().Prepare("file.restore",
+        "UPDATE files SET status = ? WHERE id = ? AND status = ?");
     query.addBindValue(static_cast<int>(FileStatus::NORMAL));
     query.addBindValue(fileId);
     query.addBindValue(static_cast<int>(FileStatus::DELETED));
@@ -582,10 +1384,16 @@ bool DataBaseManagement::RestoreFile(int fileId)
 QVector<Project> DataBaseManagement::GetAllProjects()
 {
     QVector<Project> projects;
-    QSqlQuery query;
-    query.prepare("SELECT p.id, p.name, p.description, p.manager_id, u.username, "
-                 "p.create_time, p.estimated_complete_time, p.is_completed "
-                 "FROM projects p JOIN users u ON p.manager_id = u.id");
+    if(_cache.FindAllProjects(projects))
+    {
+        return projects;
+    }
+
+    quint64 generation = _cache.Generation(EntityCache::Projects);
+    QSqlQuery& query = Statements().Prepare("project.all",
+        "SELECT p.id, p.name, p.description, p.manager_id, u.username, "
+        "p.create_time, p.estimated_complete_time, p.is_completed "
+        "FROM projects p JOIN users u ON p.manager_id = u.id");
     
     if(query.exec())
     {
@@ -602,6 +1410,7 @@ QVector<Project> DataBaseManagement::GetAllProjects()
             project.isCompleted = query.value(7).toBool();
             projects.append(project);
         }
+        _cache.StoreAllProjects(projects, generation);
     }
     else
     {
@@ -615,27 +1424,25 @@ QVector<Project> DataBaseManagement::GetAllProjects()
 QVector<ProjectNode> DataBaseManagement::GetProjectNodes(int projectId)
 {
     QVector<ProjectNode> nodes;
-    QSqlQuery query;
-    query.prepare("SELECT id, project_id, name, description, parent_id, create_time, "
-                 "estimated_completion_time, is_completed "
-                 "FROM project_nodes WHERE project_id = ?");
+    if(_cache.FindProjectNodes(projectId, nodes))
+    {
+        return nodes;
+    }
+
+    quint64 generation = _cache.Generation(EntityCache::Nodes);
+    QSqlQuery& query = Statements().Prepare("node.byProject",
+        "SELECT id, project_id, name, description, parent_id, create_time, "
+        "estimated_completion_time, is_completed "
+        "FROM project_nodes WHERE project_id = ?");
     query.addBindValue(projectId);
     
     if(query.exec())
     {
         while(query.next())
         {
-            ProjectNode node;
-            node.id = query.value(0).toInt();
-            node.projectId = query.value(1).toInt();
-            node.name = query.value(2).toString();
-            node.description = query.value(3).toString();
-            node.parentId = query.value(4).toInt();
-            node.creationTime = query.value(5).toDateTime();
-            node.estimatedCompletionTime = query.value(6).toDateTime();
-            node.isCompleted = query.value(7).toBool();
-            nodes.append(node);
+            nodes.append(ReadProjectNode(query));
         }
+        _cache.StoreProjectNodes(projectId, nodes, generation);
     }
     else
     {
@@ -645,15 +1452,106 @@ QVector<ProjectNode> DataBaseManagement::GetProjectNodes(int projectId)
     return nodes;
 }
 
+QVector<ProjectNode> DataBaseManagement::GetAllProjectNodes()
+{
+    QVector<ProjectNode> nodes;
+    QSqlQuery& query = Statements().Prepare("node.all",
+        "SELECT id, project_id, name, description, parent_id, create_time, "
+        "estimated_completion_time, is_completed "
+        "FROM project_nodes ORDER BY project_id, id");
+
+    if(query.exec())
+    {
+        while(query.next())
+        {
+            nodes.append(ReadProjectNode(query));
+        }
+    }
+    else
+    {
+        qDebug() << "Failed to get all project nodes: " << query.lastError().text();
+    }
+
+    return nodes;
+}
+
+QVector<ProjectNode> DataBaseManagement::GetSubtreeNodes(int nodeId)
+{
+    QVector<ProjectNode> nodes;
+    // CROSS JOIN 固定先遍历子树再按主键取节点，不扫描整个节点表
+    QSqlQuery& query = Statements().Prepare("node.subtree",
+        SUBTREE_CTE
+        "SELECT pn.id, pn.project_id, pn.name, pn.description, pn.parent_id, pn.create_time, "
+        "pn.estimated_completion_time, pn.is_completed "
+        "FROM subtree s CROSS JOIN project_nodes pn ON pn.id = s.id "
+        "ORDER BY pn.id");
+    query.addBindValue(nodeId);
+
+    if(query.exec())
+    {
+        while(query.next())
+        {
+            nodes.append(ReadProjectNode(query));
+        }
+    }
+    else
+    {
+        qDebug() << "Failed to get subtree nodes: " << query.lastError().text();
+    }
+
+    return nodes;
+}
+
+QVector<ProjectNode> DataBaseManagement::GetAncestorNodes(int nodeId)
+{
+    QVector<ProjectNode> nodes;
+    // 从节点沿 parent_id 逐级向上，每级一次主键查找。path 记录已经过的节点，
+    // 父子关系意外成环时在回到已访问的节点前停止。
+    // 连接条件写成 IN，避免规划器按统计信息为整个节点表建立 Bloom 过滤器
+    QSqlQuery& query = Statements().Prepare("node.ancestors",
+        "WITH RECURSIVE ancestors(id, depth, path) AS ("
+        "SELECT parent_id, 1, ',' || id || ',' || parent_id || ',' FROM project_nodes "
+        "WHERE id = ? AND parent_id IS NOT NULL AND parent_id != id "
+        "UNION ALL "
+        "SELECT pn.parent_id, a.depth + 1, a.path || pn.parent_id || ',' FROM ancestors a "
+        "CROSS JOIN project_nodes pn ON pn.id IN (a.id) "
+        "WHERE pn.parent_id IS NOT NULL AND instr(a.path, ',' || pn.parent_id || ',') = 0) "
+        "SELECT pn.id, pn.project_id, pn.name, pn.description, pn.parent_id, pn.create_time, "
+        "pn.estimated_completion_time, pn.is_completed "
+        "FROM ancestors a CROSS JOIN project_nodes pn ON pn.id = a.id "
+        "ORDER BY a.depth DESC");
+    query.addBindValue(nodeId);
+
+    if(query.exec())
+    {
+        while(query.next())
+        {
+            nodes.append(ReadProjectNode(query));
+        }
+    }
+    else
+    {
+        qDebug() << "Failed to get ancestor nodes: " << query.lastError().text();
+    }
+
+    return nodes;
+}
+
 Project DataBaseManagement::GetProjectById(int projectId)
 {
     Project project;
+    if(_cache.FindProject(projectId, project))
+    {
+        return project;
+    }
+
     project.id = -1;
-    QSqlQuery query;
-    query.prepare("SELECT p.id, p.name, p.description, p.manager_id, u.username, "
-                 "p.create_time, p.estimated_complete_time, p.is_completed "
-                 "FROM projects p JOIN users u ON p.manager_id = u.id "
-                 "WHERE p.id = ?");
+    quint64 generation = _cache.Generation(EntityCache::Projects);
+    QSqlQuery& query = Statements().Prepare("project.byId",
+        "SELECT p.id, p.name, p.description, p.manager_id, u.username, "
+        "p.create_time, p.estimated_complete_time, p.is_completed "
+        "FROM projects p JOIN users u ON p.manager_id = u.id "
+        "WHERE p.id = ?");
     query.addBindValue(projectId);
     
     if(query.exec() && query.next())
@@ -666,20 +1564,197 @@ Project DataBaseManagement::GetProjectById(int projectId)
         project.createTime = query.value(5).toDateTime();
         project.estimatedCompleteTime = query.value(6).toDateTime();
         project.isCompleted = query.value(7).toBool();
+        _cache.StoreProject(project, generation);
     }
     else
     {
         qDebug() << "Failed to get project by id: " << query.lastError().text();
     }
+    query.finish();
     
     return project;
 }
 
+QVector<ProjectStatistics> DataBaseManagement::GetProjectStatistics()
+{
+    QVector<ProjectStatistics> statistics;
+    // 逾期节点数按日期累加，每个项目只访问 project_due_stats 中今天之前的日期
+    QSqlQuery& query = Statements().Prepare("project.statistics",
+        "SELECT p.id, p.name, p.manager_id, IFNULL(u.username, ''), p.create_time, "
+        "p.estimated_complete_time, p.is_completed, "
+        "IFNULL(s.node_count, 0), IFNULL(s.completed_count, 0), IFNULL(s.file_count, 0), IFNULL(s.total_bytes, 0), "
+        "(SELECT IFNULL(SUM(d.open_count), 0) FROM project_due_stats d "
+        "WHERE d.project_id = p.id AND d.due_date < date('now', 'localtime')) "
+        "FROM projects p "
+        "LEFT JOIN project_stats s ON s.project_id = p.id "
+        "LEFT JOIN users u ON u.id = p.manager_id "
+        "ORDER BY p.id");
+
+    if(query.exec())
+    {
+        while(query.next())
+        {
+            ProjectStatistics item;
+            item.project.id = query.value(0).toInt();
+            item.project.name = query.value(1).toString();
+            item.project.managerId = query.value(2).toInt();
+            item.project.managerName = query.value(3).toString();
+            item.project.createTime = query.value(4).toDateTime();
+            item.project.estimatedCompleteTime = query.value(5).toDateTime();
+            item.project.isCompleted = query.value(6).toBool();
+            item.nodeCount = query.value(7).toInt();
+            item.completedCount = query.value(8).toInt();
+            item.fileCount = query.value(9).toInt();
+            item.totalBytes = query.value(10).toLongLong();
+            item.overdueCount = query.value(11).toInt();
+            statistics.append(item);
+        }
+    }
+    else
+    {
+        qDebug() << "Failed to get project statistics: " << query.lastError().text();
+    }
+
+    return statistics;
+}
+
+ProjectPage DataBaseManagement::QueryProjects(const ProjectQuery& projectQuery)
+{
+    ProjectPage page;
+    int pageSize = qMax(1, projectQuery.pageSize);
+
+    // 预计完成时间可能为空，空值按空字符串参与排序，保证游标比较有确定结果
+    QString sortColumn;
+    switch(projectQuery.sortKey)
+    {
+        case ProjectSortKey::Id: sortColumn = "p.id"; break;
+        case ProjectSortKey::Name: sortColumn = "p.name"; break;
+        case ProjectSortKey::CreateTime: sortColumn = "p.create_time"; break;
+        case ProjectSortKey::EstimatedCompleteTime: sortColumn = "IFNULL(p.estimated_complete_time, '')"; break;
+    }
+    QString direction = projectQuery.descending ? "DESC" : "ASC";
+    QString comparison = projectQuery.descending ? "<" : ">";
+
+    QStringList conditions;
+    QVariantList bindValues;
+
+    if(projectQuery.completed != -1)
+    {
+        conditions << "p.is_completed = ?";
+        bindValues << (projectQuery.completed == 1);
+    }
+
+    const QStringList terms = SearchTerms(projectQuery.searchText);
+    if(!terms.isEmpty())
+    {
+        // 项目名称和描述走全文索引，项目经理用户名数据量小仍用 LIKE
+        QString pattern = "%" + EscapeLikePattern(projectQuery.searchText) + "%";
+        QString match = FullTextMatchExpression(terms);
+        if(!match.isEmpty())
+        {
+            conditions << "(p.id IN (SELECT rowid FROM projects_fts WHERE projects_fts MATCH ?) OR u.username LIKE ? ESCAPE '\\')";
+            bindValues << match << pattern;
+        }
+        else
+        {
+            // 有短词时用二元分词索引缩小范围，再逐词确认名称或描述包含该词
+            QStringList textConditions;
+            QString bigrams = BigramMatchExpression(terms);
+            if(!bigrams.isEmpty())
+            {
+                textConditions << "p.id IN (SELECT rowid FROM projects_bigram WHERE projects_bigram MATCH ?)";
+                bindValues << bigrams;
+            }
+            for(const QString& term : terms)
+            {
+                QString termPattern = "%" + EscapeLikePattern(term) + "%";
+                textConditions << "(p.name LIKE ? ESCAPE '\\' OR p.description LIKE ? ESCAPE '\\')";
+                bindValues << termPattern << termPattern;
+            }
+            conditions << "((" + textConditions.join(" AND ") + ") OR u.username LIKE ? ESCAPE '\\')";
+            bindValues << pattern;
+        }
+    }
+
+    QString orderBy;
+    if(projectQuery.sortKey == ProjectSortKey::Id)
+    {
+        orderBy = QString("p.id %1").arg(direction);
+        if(projectQuery.after.valid)
+        {
+            conditions << QString("p.id %1 ?").arg(comparison);
+            bindValues << projectQuery.after.id;
+        }
+    }
+    else
+    {
+        orderBy = QString("%1 %2, p.id %2").arg(sortColumn, direction);
+        if(projectQuery.after.valid)
+        {
+            conditions << QString("(%1, p.id) %2 (?, ?)").arg(sortColumn, comparison);
+            bindValues << projectQuery.after.sortValue << projectQuery.after.id;
+        }
+    }
+
+    // 多取一行用于判断是否还有下一页
+    bindValues << pageSize + 1;
+
+    QString sql = QString(
+        "SELECT p.id, p.name, p.description, p.manager_id, u.username, "
+        "p.create_time, p.estimated_complete_time, p.is_completed, %1 "
+        "FROM projects p JOIN users u ON p.manager_id = u.id "
+        "%2 ORDER BY %3 LIMIT ?")
+        .arg(sortColumn, conditions.isEmpty() ? QString() : "WHERE " + conditions.join(" AND "), orderBy);
+
+    QSqlQuery& query = Statements().Prepare("project.query:" + sql, sql);
+    for(const QVariant& value : bindValues)
+    {
+        query.addBindValue(value);
+    }
+
+    if(query.exec())
+    {
+        while(query.next())
+        {
+            if(page.projects.size() == pageSize)
+            {
+                page.hasMore = true;
+                break;
+            }
+
+            Project project;
+            project.id = query.value(0).toInt();
+            project.name = query.value(1).toString();
+            project.description = query.value(2).toString();
+            project.managerId = query.value(3).toInt();
+            project.managerName = query.value(4).toString();
+            project.createTime = query.value(5).toDateTime();
+            project.estimatedCompleteTime = query.value(6).toDateTime();
+            project.isCompleted = query.value(7).toBool();
+            page.projects.append(project);
+
+            page.next.valid = true;
+            page.next.sortValue = query.value(8);
+            page.next.id = project.id;
+        }
+        query.finish();
+    }
+    else
+    {
+        qDebug() << "Failed to query projects: " << query.lastError().text();
+    }
+
+    return page;
+}
+
 int DataBaseManagement::AddProject(const Project& project)
 {
-    QSqlQuery query;
-    query.prepare("INSERT INTO projects (name, description, manager_id, estimated_complete_time, is_completed) "
-                 "VALUES (?, ?, ?, ?, ?)");
+    if(!_pool.InWriteScope())
+        return RunOnWriter([project](DataBaseManagement* db) { return db->AddProject(project); });
+
+    QSqlQuery& query = Statements().Prepare("project.add",
+        "INSERT INTO projects (name, description, manager_id, estimated_complete_time, is_completed) "
+        "VALUES (?, ?, ?, ?, ?)");
     query.addBindValue(project.name);
     query.addBindValue(project.description);
     query.addBindValue(project.managerId);
@@ -694,6 +1769,7 @@ int DataBaseManagement::AddProject(const Project& project)
     
     // 获取新插入项目的ID
     int projectId = query.lastInsertId().toInt();
+    _cache.InvalidateProjectList();
     
     // 将项目经理添加为项目成员
     if(projectId > 0) {
@@ -707,10 +1783,13 @@ int DataBaseManagement::AddProject(const Project& project)
 
 bool DataBaseManagement::UpdateProject(const Project& project)
 {
-    QSqlQuery query;
-    query.prepare("UPDATE projects SET name = ?, description = ?, manager_id = ?, "
-                 "estimated_complete_time = ?, is_completed = ? "
-                 "WHERE id = ?");
+    if(!_pool.InWriteScope())
+        return RunOnWriter([project](DataBaseManagement* db) { return db->UpdateProject(project); });
+
+    QSqlQuery& query = Statements().Prepare("project.update",
+        "UPDATE projects SET name = ?, description = ?, manager_id = ?, "
+        "estimated_complete_time = ?, is_completed = ? "
+        "WHERE id = ?");
     query.addBindValue(project.name);
     query.addBindValue(project.description);
     query.addBindValue(project.managerId);
@@ -724,16 +1803,22 @@ bool DataBaseManagement::UpdateProject(const Project& project)
         return false;
     }
     
+    _cache.InvalidateProject(project.id);
     return true;
 }
 
 bool DataBaseManagement::DeleteProject(int projectId)
 {
-    QSqlQuery query(_db);
-    query.prepare("DELETE FROM projects WHERE id = ?");
+    if(!_pool.InWriteScope())
+        return RunOnWriter([projectId](DataBaseManagement* db) { return db->DeleteProject(projectId); });
+
+    QSqlQuery& query = Statements().Prepare("project.delete",
+        "DELETE FROM projects WHERE id = ?");
     query.addBindValue(projectId);
 
     if (query.exec()) {
+        _cache.InvalidateProject(projectId);
+        _cache.InvalidateProjectNodes(projectId);
         return true;
     } else {
         qDebug() << "删除项目失败: " << query.lastError().text();
@@ -741,12 +1826,70 @@ bool DataBaseManagement::DeleteProject(int projectId)
     }
 }
 
-bool DataBaseManagement::AddProjectNode(const ProjectNode& node)
+bool DataBaseManagement::AddProjectNode(const ProjectNode& node)
+{
+    if(!_pool.InWriteScope())
+        return RunOnWriter([node](DataBaseManagement* db) { return db->AddProjectNode(node); });
+
+    if(InsertProjectNode(node) <= 0)
+    {
+        return false;
+    }
+
+    _cache.InvalidateProjectNodes(node.projectId);
+    return true;
+}
+
+QVector<int> DataBaseManagement::AddProjectNodes(const QVector<ProjectNode>& nodes)
+{
+    if(!_pool.InWriteScope())
+        return RunOnWriter([nodes](DataBaseManagement* db) { return db->AddProjectNodes(nodes); });
+
+    QVector<int> nodeIds;
+    if(nodes.isEmpty())
+        return nodeIds;
+
+    QSqlDatabase db = Database();
+    if(!BeginWriteTransaction())
+        return QVector<int>();
+
+    nodeIds.reserve(nodes.size());
+    for(const ProjectNode& node : nodes)
+    {
+        int nodeId = InsertProjectNode(node);
+        if(nodeId <= 0)
+        {
+            db.rollback();
+            return QVector<int>();
+        }
+        nodeIds.append(nodeId);
+    }
+
+    if(!db.commit())
+    {
+        qDebug() << "Failed to commit project nodes: " << db.lastError().text();
+        db.rollback();
+        return QVector<int>();
+    }
+
+    QSet<int> projectIds;
+    for(const ProjectNode& node : nodes)
+    {
+        projectIds.insert(node.projectId);
+    }
+    for(int projectId : projectIds)
+    {
+        _cache.InvalidateProjectNodes(projectId);
+    }
+    return nodeIds;
+}
+
+int DataBaseManagement::InsertProjectNode(const ProjectNode& node)
 {
-    QSqlQuery query;
-    query.prepare("INSERT INTO project_nodes (project_id, name, description, parent_id, "
-                 "estimated_completion_time, is_completed) "
-                 "VALUES (?, ?, ?, ?, ?, ?)");
+    QSqlQuery& query = Statements().Prepare("node.add",
+        "INSERT INTO project_nodes (project_id, name, description, parent_id, "
+        "estimated_completion_time, is_completed) "
+        "VALUES (?, ?, ?, ?, ?, ?)");
     query.addBindValue(node.projectId);
     query.addBindValue(node.name);
     query.addBindValue(node.description);
@@ -757,18 +1900,21 @@ bool DataBaseManagement::AddProjectNode(const ProjectNode& node)
     if(!query.exec())
     {
         qDebug() << "Failed to add project node: " << query.lastError().text();
-        return false;
+        return -1;
     }
     
-    return true;
+    return query.lastInsertId().toInt();
 }
 
 bool DataBaseManagement::UpdateProjectNode(const ProjectNode& node)
 {
-    QSqlQuery query;
-    query.prepare("UPDATE project_nodes SET name = ?, description = ?, parent_id = ?, "
-                 "estimated_completion_time = ?, is_completed = ? "
-                 "WHERE id = ?");
+    if(!_pool.InWriteScope())
+        return RunOnWriter([node](DataBaseManagement* db) { return db->UpdateProjectNode(node); });
+
+    QSqlQuery& query = Statements().Prepare("node.update",
+        "UPDATE project_nodes SET name = ?, description = ?, parent_id = ?, "
+        "estimated_completion_time = ?, is_completed = ? "
+        "WHERE id = ?");
     query.addBindValue(node.name);
     query.addBindValue(node.description);
     query.addBindValue(node.parentId > 0 ? node.parentId : QVariant());
@@ -782,35 +1928,117 @@ bool DataBaseManagement::UpdateProjectNode(const ProjectNode& node)
         return false;
     }
     
+    _cache.InvalidateNode(node.id);
     return true;
 }
 
+QVector<NodeDependency> DataBaseManagement::GetProjectDependencies(int projectId)
+{
+    QVector<NodeDependency> dependencies;
+    // 依赖只在同一项目的节点之间建立，按后继节点所属项目过滤
+    QSqlQuery& query = Statements().Prepare("dependency.byProject",
+        "SELECT d.predecessor_id, d.successor_id FROM node_dependencies d "
+        "INNER JOIN project_nodes pn ON pn.id = d.successor_id "
+        "WHERE pn.project_id = ?");
+    query.addBindValue(projectId);
+
+    if(query.exec())
+    {
+        while(query.next())
+        {
+            dependencies.append(NodeDependency{query.value(0).toInt(), query.value(1).toInt()});
+        }
+    }
+    else
+    {
+        qDebug() << "Failed to get node dependencies: " << query.lastError().text();
+    }
+
+    return dependencies;
+}
+
+QVector<NodeDependency> DataBaseManagement::GetAllNodeDependencies()
+{
+    QVector<NodeDependency> dependencies;
+    QSqlQuery& query = Statements().Prepare("dependency.all",
+        "SELECT predecessor_id, successor_id FROM node_dependencies");
+
+    if(query.exec())
+    {
+        while(query.next())
+        {
+            dependencies.append(NodeDependency{query.value(0).toInt(), query.value(1).toInt()});
+        }
+    }
+    else
+    {
+        qDebug() << "Failed to get all node dependencies: " << query.lastError().text();
+    }
+
+    return dependencies;
+}
+
+bool DataBaseManagement::SetNodePredecessors(int nodeId, const QVector<int>& predecessorIds)
+{
+    return SyncAssociations("node_dependencies", "successor_id", "predecessor_id", nodeId, predecessorIds);
+}
+
 bool DataBaseManagement::DeleteProjectNode(int nodeId)
 {
-    QSqlQuery query;
-    query.prepare("DELETE FROM project_nodes WHERE id = ?");
+    if(!_pool.InWriteScope())
+        return RunOnWriter([nodeId](DataBaseManagement* db) { return db->DeleteProjectNode(nodeId); });
+
+    if(!BeginWriteTransaction())
+    {
+        return false;
+    }
+
+    // 先用一条语句删除整个子树的文件关联，再删除节点，子节点由外键级联删除。
+    // 级联删除每个节点时不再逐个查找 node_file
+    QSqlQuery& linkQuery = Statements().Prepare("nodeFile.deleteBySubtree",
+        SUBTREE_CTE
+        "DELETE FROM node_file WHERE node_id IN (SELECT id FROM subtree)");
+    linkQuery.addBindValue(nodeId);
+    if(!linkQuery.exec())
+    {
+        qDebug() << "Failed to delete subtree files: " << linkQuery.lastError().text();
+        Database().rollback();
+        return false;
+    }
+
+    QSqlQuery& query = Statements().Prepare("node.delete",
+        "DELETE FROM project_nodes WHERE id = ?");
     query.addBindValue(nodeId);
     
-    if(!query.exec())
+    if(!query.exec() || query.numRowsAffected() <= 0)
     {
         qDebug() << "Failed to delete project node: " << query.lastError().text();
+        Database().rollback();
         return false;
     }
     
-    return query.numRowsAffected() > 0;
+    if(!Database().commit())
+    {
+        qDebug() << "Failed to commit project node deletion: " << Database().lastError().text();
+        Database().rollback();
+        return false;
+    }
+
+    // 子树与节点属于同一项目，使该项目的节点列表失效即可
+    _cache.InvalidateNode(nodeId);
+    return true;
 }
 
 // 获取项目成员
 QVector<User> DataBaseManagement::GetProjectUsers(int projectId)
 {
     QVector<User> users;
-    QSqlQuery query(_db);
-
     // 联合查询获取项目成员信息
-    query.prepare("SELECT u.id, u.username, u.password, u.role, u.created_at "
-                 "FROM users u "
-                 "INNER JOIN project_user pu ON u.id = pu.user_id "
-                 "WHERE pu.project_id = ?");
+    QSqlQuery& query = Statements().Prepare("projectUser.byProject",
+        "SELECT u.id, u.username, u.password, u.role, u.created_at "
+        "FROM users u "
+        "INNER JOIN project_user pu ON u.id = pu.user_id "
+        "WHERE pu.project_id = ?");
     query.addBindValue(projectId);
 
     if (query.exec()) {
@@ -834,15 +2062,15 @@ QVector<User> DataBaseManagement::GetProjectUsers(int projectId)
 QVector<FileInfo> DataBaseManagement::GetProjectFiles(int projectId, FileStatus status)
 {
     QVector<FileInfo> files;
-    QSqlQuery query(_db);
-
     // 使用project_file关联表查询
-    query.prepare("SELECT f.id, f.file_name, f.file_path, f.file_extension, f.file_size, f.uploader_id, "
-                 "u.username, f.upload_time, f.file_type, f.status, pf.project_id, f.is_process_document "
-                 "FROM files f "
-                 "JOIN users u ON f.uploader_id = u.id "
-                 "JOIN project_file pf ON f.id = pf.file_id "
-                 "WHERE pf.project_id = ? AND f.status = ?");
+    QSqlQuery& query = Statements().Prepare("projectFile.byProject",
+        "SELECT f.id, f.file_name, f.file_path, f.file_extension, f.file_size, f.uploader_id, "
+        "u.username, f.upload_time, f.file_type, f.status, pf.project_id, f.is_process_document, "
+        "f.page_count, f.word_count, f.character_count, f.content_hash "
+        "FROM files f "
+        "JOIN users u ON f.uploader_id = u.id "
+        "JOIN project_file pf ON f.id = pf.file_id "
+        "WHERE pf.project_id = ? AND f.status = ?");
     query.addBindValue(projectId);
     query.addBindValue(static_cast<int>(status));
     
@@ -850,19 +2078,7 @@ QVector<FileInfo> DataBaseManagement::GetProjectFiles(int projectId, FileStatus
     {
         while(query.next())
         {
-            FileInfo file;
-            file.id = query.value(0).toInt();
-            file.fileName = query.value(1).toString();
-            file.filePath = query.value(2).toString();
-            file.fileExtension = query.value(3).toString();
-            file.fileSize = query.value(4).toLongLong();
-            file.uploaderId = query.value(5).toInt();
-            file.uploaderName = query.value(6).toString();
-            file.uploadTime = query.value(7).toDateTime();
-            file.fileType = static_cast<FileType>(query.value(8).toInt());
-            file.status = static_cast<FileStatus>(query.value(9).toInt());
-            file.projectId = query.value(10).toInt();
-            file.isProcessDocument = query.value(11).toBool();
+            FileInfo file = ReadFileInfo(query, 0);
             files.append(file);
         }
     }
@@ -877,13 +2093,18 @@ QVector<FileInfo> DataBaseManagement::GetProjectFiles(int projectId, FileStatus
 // 分配用户到项目
 bool DataBaseManagement::AssignUsersToProject(int projectId, const QVector<int>& userIds)
 {
+    if(!_pool.InWriteScope())
+        return RunOnWriter([projectId, userIds](DataBaseManagement* db) { return db->AssignUsersToProject(projectId, userIds); });
+
     // 开始事务
-    _db.transaction();
-    QSqlQuery query(_db);
+    if(!BeginWriteTransaction()) {
+        return false;
+    }
+    QSqlQuery& query = Statements().Prepare("projectUser.insertOrIgnore",
+        "INSERT OR IGNORE INTO project_user (project_id, user_id) VALUES (?, ?)");
     bool success = true;
 
     for (int userId : userIds) {
-        query.prepare("INSERT OR IGNORE INTO project_user (project_id, user_id) VALUES (?, ?)");
         query.addBindValue(projectId);
         query.addBindValue(userId);
 
@@ -894,11 +2115,13 @@ bool DataBaseManagement::AssignUsersToProject(int projectId, const QVector<int>&
         }
     }
 
-    // 根据操作结果提交或回滚事务
-    if (success) {
-        _db.commit();
-    } else {
-        _db.rollback();
+    // 根据操作结果提交或回滚事务，提交失败时事务仍然打开，同样需要回滚
+    if (success && !Database().commit()) {
+        qDebug() << "提交项目成员失败: " << Database().lastError().text();
+        success = false;
+    }
+    if (!success) {
+        Database().rollback();
     }
 
     return success;
@@ -907,169 +2130,228 @@ bool DataBaseManagement::AssignUsersToProject(int projectId, const QVector<int>&
 // 更新项目成员
 bool DataBaseManagement::UpdateProjectUsers(int projectId, const QVector<int>& userIds)
 {
-    // 开始事务
-    _db.transaction();
-    QSqlQuery query(_db);
-    bool success = true;
+    return SyncAssociations("project_user", "project_id", "user_id", projectId, userIds);
+}
 
-    // 1. 先删除项目的所有现有成员关联
-    query.prepare("DELETE FROM project_user WHERE project_id = ?");
-    query.addBindValue(projectId);
+// 分配文件到项目
+bool DataBaseManagement::AssignFilesToProject(int projectId, const QVector<int>& fileIds)
+{
+    if(!_pool.InWriteScope())
+        return RunOnWriter([projectId, fileIds](DataBaseManagement* db) { return db->AssignFilesToProject(projectId, fileIds); });
 
-    if (!query.exec()) {
-        qDebug() << "删除项目成员关联失败: " << query.lastError().text();
-        _db.rollback();
+    // 开始事务
+    if(!BeginWriteTransaction()) {
         return false;
     }
+    QSqlQuery& query = Statements().Prepare("projectFile.insertOrIgnore",
+        "INSERT OR IGNORE INTO project_file (project_id, file_id) VALUES (?, ?)");
+    bool success = true;
 
-    // 2. 添加新的成员关联
-    for (int userId : userIds) {
-        query.prepare("INSERT INTO project_user (project_id, user_id) VALUES (?, ?)");
+    for (int fileId : fileIds) {
         query.addBindValue(projectId);
-        query.addBindValue(userId);
+        query.addBindValue(fileId);
 
         if (!query.exec()) {
-            qDebug() << "更新项目成员失败: " << query.lastError().text();
+            qDebug() << "分配文件到项目失败: " << query.lastError().text();
             success = false;
             break;
         }
     }
 
     // 根据操作结果提交或回滚事务
-    if (success) {
-        _db.commit();
-    } else {
-        _db.rollback();
+    if (success && !Database().commit()) {
+        qDebug() << "提交项目文件失败: " << Database().lastError().text();
+        success = false;
+    }
+    if (!success) {
+        Database().rollback();
     }
 
     return success;
 }
 
-// 分配文件到项目
-bool DataBaseManagement::AssignFilesToProject(int projectId, const QVector<int>& fileIds)
+// 更新项目文件关联
+bool DataBaseManagement::UpdateProjectFiles(int projectId, const QVector<int>& fileIds)
+{
+    return SyncAssociations("project_file", "project_id", "file_id", projectId, fileIds);
+}
+
+bool DataBaseManagement::UpdateProjectFiles(int projectId, const QVector<int>& fileIds, const QVector<int>& shownFileIds)
+{
+    return SyncAssociations("project_file", "project_id", "file_id", projectId, fileIds, &shownFileIds);
+}
+
+bool DataBaseManagement::AssignFilesToNode(int nodeId, const QVector<int>& fileIds)
+{
+    return SyncAssociations("node_file", "node_id", "file_id", nodeId, fileIds);
+}
+
+bool DataBaseManagement::AddFilesToNode(int nodeId, const QVector<int>& fileIds)
 {
+    if(!_pool.InWriteScope())
+        return RunOnWriter([nodeId, fileIds](DataBaseManagement* db) { return db->AddFilesToNode(nodeId, fileIds); });
+
     // 开始事务
-    _db.transaction();
-    QSqlQuery query(_db);
+    if(!BeginWriteTransaction()) {
+        return false;
+    }
+    QSqlQuery& query = Statements().Prepare("nodeFile.insertOrIgnore",
+        "INSERT OR IGNORE INTO node_file (node_id, file_id) VALUES (?, ?)");
     bool success = true;
 
     for (int fileId : fileIds) {
-        query.prepare("INSERT OR IGNORE INTO project_file (project_id, file_id) VALUES (?, ?)");
-        query.addBindValue(projectId);
+        query.addBindValue(nodeId);
         query.addBindValue(fileId);
 
         if (!query.exec()) {
-            qDebug() << "分配文件到项目失败: " << query.lastError().text();
+            qDebug() << "添加文件到节点失败: " << query.lastError().text();
             success = false;
             break;
         }
     }
 
     // 根据操作结果提交或回滚事务
-    if (success) {
-        _db.commit();
-    } else {
-        _db.rollback();
+    if (success && !Database().commit()) {
+        qDebug() << "提交节点文件失败: " << Database().lastError().text();
+        success = false;
+    }
+    if (!success) {
+        Database().rollback();
     }
 
     return success;
 }
 
-// 更新项目文件关联
-bool DataBaseManagement::UpdateProjectFiles(int projectId, const QVector<int>& fileIds)
+bool DataBaseManagement::RemoveFilesFromNode(int nodeId, const QVector<int>& fileIds)
 {
-    // 开始事务
-    _db.transaction();
-    QSqlQuery query(_db);
-    bool success = true;
-
-    // 1. 先删除项目的所有现有文件关联
-    query.prepare("DELETE FROM project_file WHERE project_id = ?");
-    query.addBindValue(projectId);
+    if(!_pool.InWriteScope())
+        return RunOnWriter([nodeId, fileIds](DataBaseManagement* db) { return db->RemoveFilesFromNode(nodeId, fileIds); });
 
-    if (!query.exec()) {
-        qDebug() << "清除项目文件关联失败: " << query.lastError().text();
-        _db.rollback();
+    if(!BeginWriteTransaction()) {
         return false;
     }
+    QSqlQuery& query = Statements().Prepare("nodeFile.delete",
+        "DELETE FROM node_file WHERE node_id = ? AND file_id = ?");
+    bool success = true;
 
-    // 2. 添加新的文件关联
     for (int fileId : fileIds) {
-        query.prepare("INSERT INTO project_file (project_id, file_id) VALUES (?, ?)");
-        query.addBindValue(projectId);
+        query.addBindValue(nodeId);
         query.addBindValue(fileId);
 
         if (!query.exec()) {
-            qDebug() << "更新文件关联失败: " << query.lastError().text();
+            qDebug() << "从节点移除文件失败: " << query.lastError().text();
             success = false;
             break;
         }
     }
 
-    // 根据操作结果提交或回滚事务
-    if (success) {
-        _db.commit();
-        qDebug() << "成功更新项目" << projectId << "的文件关联，共" << fileIds.size() << "个文件";
-    } else {
-        _db.rollback();
+    if (success && !Database().commit()) {
+        qDebug() << "提交节点文件失败: " << Database().lastError().text();
+        success = false;
+    }
+    if (!success) {
+        Database().rollback();
     }
 
     return success;
 }
 
-bool DataBaseManagement::AssignFilesToNode(int nodeId, const QVector<int>& fileIds)
+bool DataBaseManagement::BeginWriteTransaction()
 {
-    // 首先删除该节点已有的关联关系
-    QSqlQuery query(_db);
-    query.prepare("DELETE FROM node_file WHERE node_id = ?");
-    query.addBindValue(nodeId);
-    
-    if(!query.exec()) {
-        qDebug() << "Failed to delete existing node-file relationships: " << query.lastError().text();
+    QSqlQuery query(Database());
+    if(!query.exec("BEGIN IMMEDIATE"))
+    {
+        qDebug() << "Failed to begin write transaction: " << query.lastError().text();
         return false;
     }
-    
-    // 添加新的关联关系
-    for(int fileId : fileIds) {
-        query.prepare("INSERT INTO node_file (node_id, file_id) VALUES (?, ?)");
-        query.addBindValue(nodeId);
-        query.addBindValue(fileId);
-        
-        if(!query.exec()) {
-            qDebug() << "Failed to assign file to node: " << query.lastError().text();
+    return true;
+}
+
+bool DataBaseManagement::SyncAssociations(const QString& table, const QString& ownerColumn, const QString& itemColumn,
+                                          int ownerId, const QVector<int>& itemIds, const QVector<int>* scopeIds)
+{
+    if(!_pool.InWriteScope())
+        return RunOnWriter([table, ownerColumn, itemColumn, ownerId, itemIds, scopeIds](DataBaseManagement* db) { return db->SyncAssociations(table, ownerColumn, itemColumn, ownerId, itemIds, scopeIds); });
+
+    // 表名和列名来自调用方的常量，不是用户输入
+    QString key = table + "." + ownerColumn;
+    if(!BeginWriteTransaction()) {
+        return false;
+    }
+
+    // 1. 读取现有关联，与目标集合求差
+    QSqlQuery& selectQuery = Statements().Prepare("assoc.select:" + key,
+        QString("SELECT %1 FROM %2 WHERE %3 = ?").arg(itemColumn, table, ownerColumn));
+    selectQuery.addBindValue(ownerId);
+    if(!selectQuery.exec()) {
+        qDebug() << "读取关联失败: " << table << selectQuery.lastError().text();
+        Database().rollback();
+        return false;
+    }
+
+    QSet<int> existing;
+    while(selectQuery.next()) {
+        existing.insert(selectQuery.value(0).toInt());
+    }
+    selectQuery.finish();
+
+    QSet<int> target(itemIds.begin(), itemIds.end());
+    QSet<int> removed = existing - target;
+    QSet<int> added = target - existing;
+    if(scopeIds) {
+        removed &= QSet<int>(scopeIds->begin(), scopeIds->end());
+    }
+
+    // 2. 只删除多余的、插入缺少的，写入量与变化量成正比
+    QSqlQuery& deleteQuery = Statements().Prepare("assoc.delete:" + key,
+        QString("DELETE FROM %1 WHERE %2 = ? AND %3 = ?").arg(table, ownerColumn, itemColumn));
+    for(int itemId : removed) {
+        deleteQuery.addBindValue(ownerId);
+        deleteQuery.addBindValue(itemId);
+        if(!deleteQuery.exec()) {
+            qDebug() << "删除关联失败: " << table << deleteQuery.lastError().text();
+            Database().rollback();
             return false;
         }
     }
-    
+
+    QSqlQuery& insertQuery = Statements().Prepare("assoc.insert:" + key,
+        QString("INSERT INTO %1 (%2, %3) VALUES (?, ?)").arg(table, ownerColumn, itemColumn));
+    for(int itemId : added) {
+        insertQuery.addBindValue(ownerId);
+        insertQuery.addBindValue(itemId);
+        if(!insertQuery.exec()) {
+            qDebug() << "添加关联失败: " << table << insertQuery.lastError().text();
+            Database().rollback();
+            return false;
+        }
+    }
+
+    if(!Database().commit()) {
+        qDebug() << "提交关联更新失败: " << table << Database().lastError().text();
+        Database().rollback();
+        return false;
+    }
+
     return true;
 }
 
 QVector<FileInfo> DataBaseManagement::GetNodeFiles(int nodeId, FileStatus status)
 {
     QVector<FileInfo> files;
-    QSqlQuery query(_db);
-    
     // 联合查询获取节点关联的文件信息
-    query.prepare("SELECT f.id, f.file_name, f.file_path, f.uploader_id, u.username, f.upload_time, f.file_type, f.status "
-                 "FROM files f "
-                 "INNER JOIN node_file nf ON f.id = nf.file_id "
-                 "LEFT JOIN users u ON f.uploader_id = u.id "
-                 "WHERE nf.node_id = ? AND f.status = ?");
+    QSqlQuery& query = Statements().Prepare("nodeFile.filesByNode",
+        "SELECT " FILE_COLUMNS
+        "FROM files f "
+        "INNER JOIN node_file nf ON f.id = nf.file_id "
+        "LEFT JOIN users u ON f.uploader_id = u.id "
+        "WHERE nf.node_id = ? AND f.status = ?");
     query.addBindValue(nodeId);
     query.addBindValue(static_cast<int>(status));
     
     if(query.exec()) {
         while(query.next()) {
-            FileInfo file;
-            file.id = query.value(0).toInt();
-            file.fileName = query.value(1).toString();
-            file.filePath = query.value(2).toString();
-            file.uploaderId = query.value(3).toInt();
-            file.uploaderName = query.value(4).toString();
-            file.uploadTime = query.value(5).toDateTime();
-            file.fileType = static_cast<FileType>(query.value(6).toInt());
-            file.status = static_cast<FileStatus>(query.value(7).toInt());
-            files.append(file);
+            files.append(ReadFileInfo(query, 0));
         }
     } else {
         qDebug() << "Failed to get node files: " << query.lastError().text();
@@ -1077,3 +2359,245 @@ QVector<FileInfo> DataBaseManagement::GetNodeFiles(int nodeId, FileStatus status
     
     return files;
 }
+
+QVector<NodeDocument> DataBaseManagement::GetProjectDocumentsWithNodes(int projectId, FileStatus status)
+{
+    QVector<NodeDocument> documents;
+    // 一次联合查询取出项目所有节点的关联文件，
+    // 依次走 idx_project_nodes_project 和 idx_node_file_node 索引
+    QSqlQuery& query = Statements().Prepare("nodeFile.documentsByProject",
+        "SELECT pn.id, pn.name, " FILE_COLUMNS
+        "FROM project_nodes pn "
+        "INNER JOIN node_file nf ON nf.node_id = pn.id "
+        "INNER JOIN files f ON f.id = nf.file_id "
+        "LEFT JOIN users u ON f.uploader_id = u.id "
+        "WHERE pn.project_id = ? AND f.status = ? "
+        "ORDER BY pn.id, f.id");
+    query.addBindValue(projectId);
+    query.addBindValue(static_cast<int>(status));
+
+    if(query.exec()) {
+        while(query.next()) {
+            NodeDocument document;
+            document.nodeId = query.value(0).toInt();
+            document.nodeName = query.value(1).toString();
+            document.file = ReadFileInfo(query, 2);
+            documents.append(document);
+        }
+    } else {
+        qDebug() << "Failed to get project documents: " << query.lastError().text();
+    }
+
+    return documents;
+}
+
+QVector<NodeDocument> DataBaseManagement::GetSubtreeDocuments(int nodeId, FileStatus status)
+{
+    QVector<NodeDocument> documents;
+    QSqlQuery& query = Statements().Prepare("nodeFile.documentsBySubtree",
+        SUBTREE_CTE
+        "SELECT pn.id, pn.name, " FILE_COLUMNS
+        "FROM subtree s "
+        "CROSS JOIN project_nodes pn ON pn.id = s.id "
+        "INNER JOIN node_file nf ON nf.node_id = s.id "
+        "INNER JOIN files f ON f.id = nf.file_id "
+        "LEFT JOIN users u ON f.uploader_id = u.id "
+        "WHERE f.status = ? "
+        "ORDER BY pn.id, f.id");
+    query.addBindValue(nodeId);
+    query.addBindValue(static_cast<int>(status));
+
+    if(query.exec()) {
+        while(query.next()) {
+            NodeDocument document;
+            document.nodeId = query.value(0).toInt();
+            document.nodeName = query.value(1).toString();
+            document.file = ReadFileInfo(query, 2);
+            documents.append(document);
+        }
+    } else {
+        qDebug() << "Failed to get subtree documents: " << query.lastError().text();
+    }
+
+    return documents;
+}
+
+QVector<ContentIndexCandidate> DataBaseManagement::GetContentIndexCandidates(int afterFileId, int limit)
+{
+    QVector<ContentIndexCandidate> candidates;
+    QSqlQuery& query = Statements().Prepare("content.candidates",
+        "SELECT f.id, f.file_path, f.file_extension, IFNULL(c.file_size, -1), IFNULL(c.modified_time, 0) "
+        "FROM files f LEFT JOIN file_contents c ON c.file_id = f.id "
+        "WHERE f.id > ? ORDER BY f.id LIMIT ?");
+    query.addBindValue(afterFileId);
+    query.addBindValue(limit);
+
+    if(query.exec())
+    {
+        while(query.next())
+        {
+            ContentIndexCandidate candidate;
+            candidate.fileId = query.value(0).toInt();
+            candidate.filePath = query.value(1).toString();
+            candidate.fileExtension = query.value(2).toString();
+            candidate.indexedSize = query.value(3).toLongLong();
+            candidate.indexedModifiedTime = query.value(4).toLongLong();
+            candidates.append(candidate);
+        }
+        query.finish();
+    }
+    else
+    {
+        qDebug() << "Failed to get content index candidates: " << query.lastError().text();
+    }
+
+    return candidates;
+}
+
+bool DataBaseManagement::SaveFileContents(const QVector<FileContent>& contents)
+{
+    if(!_pool.InWriteScope())
+        return RunOnWriter([contents](DataBaseManagement* db) { return db->SaveFileContents(contents); });
+
+    if(contents.isEmpty())
+        return true;
+
+    QSqlDatabase db = Database();
+    if(!BeginWriteTransaction())
+        return false;
+
+    for(const FileContent& content : contents)
+    {
+        // 文件在提取期间被删除时 SELECT 为空，不写入任何内容
+        QSqlQuery& stateQuery = Statements().Prepare("content.save_state",
+            "INSERT INTO file_contents (file_id, status, file_size, modified_time, char_count) "
+            "SELECT id, ?, ?, ?, ? FROM files WHERE id = ? "
+            "ON CONFLICT(file_id) DO UPDATE SET status = excluded.status, file_size = excluded.file_size, "
+            "modified_time = excluded.modified_time, char_count = excluded.char_count, "
+            "indexed_time = CURRENT_TIMESTAMP");
+        stateQuery.addBindValue(static_cast<int>(content.status));
+        stateQuery.addBindValue(content.fileSize);
+        stateQuery.addBindValue(content.modifiedTime);
+        stateQuery.addBindValue(content.text.size());
+        stateQuery.addBindValue(content.fileId);
+        if(!stateQuery.exec())
+        {
+            qDebug() << "Failed to save content index state: " << stateQuery.lastError().text();
+            db.rollback();
+            return false;
+        }
+        if(stateQuery.numRowsAffected() == 0)
+            continue;
+
+        QSqlQuery& deleteQuery = Statements().Prepare("content.delete_text",
+            "DELETE FROM file_contents_fts WHERE rowid = ?");
+        deleteQuery.addBindValue(content.fileId);
+        if(!deleteQuery.exec())
+        {
+            qDebug() << "Failed to delete file content: " << deleteQuery.lastError().text();
+            db.rollback();
+            return false;
+        }
+
+        // 文件变化或上传时未能提取时，用索引时的统计更新文件记录
+        if(content.status == ContentIndexStatus::INDEXED && content.pageCount > 0)
+        {
+            QSqlQuery& statisticsQuery = Statements().Prepare("content.update_statistics",
+                "UPDATE files SET page_count = ?, word_count = ?, character_count = ? WHERE id = ?");
+            statisticsQuery.addBindValue(content.pageCount);
+            statisticsQuery.addBindValue(content.wordCount);
+            statisticsQuery.addBindValue(content.characterCount);
+            statisticsQuery.addBindValue(content.fileId);
+            if(!statisticsQuery.exec())
+            {
+                qDebug() << "Failed to update file statistics: " << statisticsQuery.lastError().text();
+                db.rollback();
+                return false;
+            }
+        }
+
+        if(content.status == ContentIndexStatus::INDEXED && !content.text.isEmpty())
+        {
+            QSqlQuery& textQuery = Statements().Prepare("content.insert_text",
+                "INSERT INTO file_contents_fts (rowid, content) VALUES (?, ?)");
+            textQuery.addBindValue(content.fileId);
+            textQuery.addBindValue(content.text);
+            if(!textQuery.exec())
+            {
+                qDebug() << "Failed to insert file content: " << textQuery.lastError().text();
+                db.rollback();
+                return false;
+            }
+        }
+    }
+
+    if(!db.commit())
+    {
+        qDebug() << "Failed to commit file contents: " << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+QSet<QString> DataBaseManagement::GetBlobHashes()
+{
+    QSet<QString> hashes;
+    QSqlQuery& query = Statements().Prepare("blob.hashes", "SELECT hash FROM blobs");
+
+    if(query.exec())
+    {
+        while(query.next())
+        {
+            hashes.insert(query.value(0).toString());
+        }
+    }
+    else
+    {
+        qDebug() << "Failed to get blob hashes: " << query.lastError().text();
+    }
+
+    return hashes;
+}
+
+QVector<QString> DataBaseManagement::GetUnreferencedBlobs(int minimumAgeSeconds)
+{
+    QVector<QString> hashes;
+    // 刚存入、文件记录尚未写入的内容引用计数也为0，按登记时间留出余量
+    QSqlQuery& query = Statements().Prepare("blob.unreferenced",
+        "SELECT hash FROM blobs WHERE ref_count = 0 "
+        "AND create_time <= datetime('now', '-' || ? || ' seconds')");
+    query.addBindValue(minimumAgeSeconds);
+
+    if(query.exec())
+    {
+        while(query.next())
+        {
+            hashes.append(query.value(0).toString());
+        }
+    }
+    else
+    {
+        qDebug() << "Failed to get unreferenced blobs: " << query.lastError().text();
+    }
+
+    return hashes;
+}
+
+bool DataBaseManagement::DeleteUnreferencedBlob(const QString& hash)
+{
+    if(!_pool.InWriteScope())
+        return RunOnWriter([hash](DataBaseManagement* db) { return db->DeleteUnreferencedBlob(hash); });
+
+    QSqlQuery& query = Statements().Prepare("blob.deleteUnreferenced",
+        "DELETE FROM blobs WHERE hash = ? AND ref_count = 0");
+    query.addBindValue(hash);
+
+    if(!query.exec())
+    {
+        qDebug() << "Failed to delete blob: " << query.lastError().text();
+        return false;
+    }
+
+    return query.numRowsAffected() > 0;
+}
@@ -6,9 +6,17 @@
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QDir>
+#include <QSet>
 #include <QVector>
-#include "DBmodels.h"
-
+#include "DBModels.h"
+#include "connectionpool.h"
+#include "entitycache.h"
+#include "statementcache.h"
+#include "storageprofile.h"
+
+// 数据库访问
+// 读方法使用调用线程的只读连接；写方法只在数据库执行器的写线程上执行，
+// 在其它线程（包括界面线程）调用时转交到写线程并等待结果，整个进程只有一个写连接。
 class DataBaseManagement : public QObject
 {
     Q_OBJECT
@@ -23,22 +31,50 @@ public:
 
     ~DataBaseManagement();
 
-    bool Initialize();
+    bool Initialize(const StorageProfile& profile = StorageProfile());
+
+    // 退出前调用，QApplication 仍然存在时执行：停止定时检查点，等待已提交的数据库任务完成，
+    // 在数据库线程上把WAL写回主库并截断，然后关闭连接
+    void Shutdown();
 
     static DataBaseManagement* Instance();
 
+    // 当前线程预编译语句缓存的命中统计
+    StatementCacheStats GetStatementCacheStats();
+
+    // 读连接池的等待统计
+    ConnectionPoolStats GetConnectionPoolStats() const;
+
+    // 用户、项目和节点缓存的命中统计
+    EntityCacheStats GetEntityCacheStats() const;
+
+    // 连接池，ConnectionPool::ReadScope 内的查询使用只读连接
+    ConnectionPool& Pool();
+
+    // 立即执行WAL检查点，truncate为true时截断WAL文件。在写连接上执行
+    bool CheckpointWal(bool truncate = false);
+
     // 用户相关方法
     User GetUserbyUserName(const QString& userName);
+    // 不存在时返回的用户ID为-1
+    User GetUserById(int userId);
     QVector<User> GetAllUsers();
     bool AddUser(const User& user);
     bool UpdateUser(const User& user);
+    UserOwnership GetUserOwnership(int userId);
+    // 用户仍有上传的文件或负责的项目时拒绝删除，返回false
     bool DeleteUser(int userId);
 
     // 文件相关方法
     QVector<FileInfo> GetAllFiles(FileStatus status = FileStatus::NORMAL);
     QVector<FileInfo> GetFilesByProject(int projectId, FileStatus status = FileStatus::NORMAL);
-    QVector<FileInfo> GetProcessDocuments();
+    FileInfo GetFileById(int fileId);
+    QVector<FileInfo> GetFilesByIds(const QVector<int>& fileIds);
+    // 按条件分页查询文件，只返回一页数据
+    FilePage QueryFiles(const FileQuery& fileQuery);
     bool AddFile(const FileInfo& file);
+    // 在一个事务中添加多个文件，按顺序返回新文件的ID；任一失败时全部回滚并返回空数组
+    QVector<int> AddFiles(const QVector<FileInfo>& files);
     bool UpdateFile(const FileInfo& file);
     bool DeleteFile(int fileId, bool permanent = false);
     bool RestoreFile(int fileId);
@@ -46,6 +82,10 @@ public:
     // 项目相关方法
     QVector<Project> GetAllProjects();
     Project GetProjectById(int projectId);
+    // 按条件分页查询项目，只返回一页数据
+    ProjectPage QueryProjects(const ProjectQuery& projectQuery);
+    // 所有项目的汇总统计，只读汇总表，开销与节点数和文件数无关
+    QVector<ProjectStatistics> GetProjectStatistics();
     int AddProject(const Project& project);
     bool UpdateProject(const Project& project);
     bool DeleteProject(int projectId);
@@ -57,35 +97,99 @@ public:
     
     // 项目文件相关方法
     bool UpdateProjectFiles(int projectId, const QVector<int>& fileIds);
+    // 只在 shownFileIds 范围内更新关联：删除其中未选中的、添加选中的，范围外的关联（如回收站中的文件）保持不变
+    bool UpdateProjectFiles(int projectId, const QVector<int>& fileIds, const QVector<int>& shownFileIds);
 
     // 项目节点相关方法
     QVector<ProjectNode> GetProjectNodes(int projectId);
+    // 所有项目的节点，按项目ID、节点ID排序，用于跨项目的进度分析
+    QVector<ProjectNode> GetAllProjectNodes();
+    // 节点及其所有后代，按ID排序；一条 WITH RECURSIVE 查询，只访问子树内的行
+    QVector<ProjectNode> GetSubtreeNodes(int nodeId);
+    // 节点的所有祖先，从顶级节点到直接父节点
+    QVector<ProjectNode> GetAncestorNodes(int nodeId);
     bool AddProjectNode(const ProjectNode& node);
+    // 在一个事务中添加多个节点，按顺序返回新节点的ID；任一失败时全部回滚并返回空数组。
+    // parentId 必须是已存在的节点
+    QVector<int> AddProjectNodes(const QVector<ProjectNode>& nodes);
     bool UpdateProjectNode(const ProjectNode& node);
+    // 节点前置依赖，调用方保证不形成环
+    QVector<NodeDependency> GetProjectDependencies(int projectId);
+    QVector<NodeDependency> GetAllNodeDependencies();
+    // 把节点的前置节点更新为 predecessorIds，只写入增删的依赖
+    bool SetNodePredecessors(int nodeId, const QVector<int>& predecessorIds);
+    // 删除节点及其子树，以及子树内的文件关联
     bool DeleteProjectNode(int nodeId);
 
     // 项目文件关联相关方法
     bool AssignFilesToProject(int projectId, const QVector<int>& fileIds);
+    // 把节点关联的文件更新为 fileIds，只写入增删的关联
     bool AssignFilesToNode(int nodeId, const QVector<int>& fileIds);
+    // 为节点追加关联文件，已关联的文件忽略
+    bool AddFilesToNode(int nodeId, const QVector<int>& fileIds);
+    // 删除节点与这些文件的关联，不影响节点的其它关联
+    bool RemoveFilesFromNode(int nodeId, const QVector<int>& fileIds);
     QVector<FileInfo> GetProjectFiles(int projectId, FileStatus status = FileStatus::NORMAL);
     QVector<FileInfo> GetNodeFiles(int nodeId, FileStatus status = FileStatus::NORMAL);
+    // 项目下所有节点关联的文件，按节点ID、文件ID排序，一个文件关联多个节点时返回多行
+    QVector<NodeDocument> GetProjectDocumentsWithNodes(int projectId, FileStatus status = FileStatus::NORMAL);
+    // 节点子树内各节点关联的文件，按节点ID、文件ID排序，一条查询完成
+    QVector<NodeDocument> GetSubtreeDocuments(int nodeId, FileStatus status = FileStatus::NORMAL);
+
+    // 文档正文索引相关方法
+    // 按文件ID顺序返回 afterFileId 之后的文件及其上次建立索引时的文件状态
+    QVector<ContentIndexCandidate> GetContentIndexCandidates(int afterFileId, int limit);
+    // 在一个事务中写入正文及索引状态，替换文件原有的正文
+    bool SaveFileContents(const QVector<FileContent>& contents);
+
+    // 内容存储相关方法，引用计数由 files 表的触发器维护
+    // 所有已登记的内容，登记由写入文件记录时的触发器完成
+    QSet<QString> GetBlobHashes();
+    // 没有文件引用且登记时间早于 minimumAgeSeconds 秒前的内容
+    QVector<QString> GetUnreferencedBlobs(int minimumAgeSeconds);
+    // 删除没有文件引用的内容登记，内容仍被引用时返回false
+    bool DeleteUnreferencedBlob(const QString& hash);
 
 private:
     explicit DataBaseManagement(QObject* parent = nullptr);
 
-    bool CreateTables();
-    bool CreateUserTable();
-    bool CreateFileTable();
-    bool CreateProjectTable();
-    bool CreateProjectNodeTable();
-    bool CreateProjectUserTable();
-    bool CreateProjectFileTable();
-    bool CreateNodeFileTable();
+    // 在写线程上执行：打开写连接，升级数据库结构并写入默认数据
+    bool InitializeSchema();
+
+    // 按版本号升级数据库结构
+    bool MigrateSchema();
 
     bool InsertDefaultData();
 
+    // 在当前线程的写连接上开始写事务（BEGIN IMMEDIATE），开始时即取得写锁。
+    // 默认的 DEFERRED 事务先读后写时，若快照已被其它连接的提交淘汰，会得到 SQLITE_BUSY_SNAPSHOT，
+    // busy_timeout 不会重试；IMMEDIATE 只可能在开始时等待写锁
+    bool BeginWriteTransaction();
+
+    // 把 table 中 ownerColumn = ownerId 的关联集合更新为 itemIds：
+    // 在一个事务中读取现有关联，只删除多余的、插入缺少的。
+    // scopeIds 不为空指针时只删除其中的关联
+    bool SyncAssociations(const QString& table, const QString& ownerColumn, const QString& itemColumn,
+                          int ownerId, const QVector<int>& itemIds, const QVector<int>* scopeIds = nullptr);
+
+    // 插入一行并返回新行的ID，失败时返回-1。不开启事务，由调用方决定
+    int InsertFile(const FileInfo& file);
+    int InsertProjectNode(const ProjectNode& node);
+
+    // 当前线程的连接与语句缓存。QSqlDatabase 不能跨线程使用：
+    // 写线程使用写连接，主线程使用只读的 _db，其它线程使用连接池中属于该线程的只读连接
+    QSqlDatabase Database();
+    StatementCache& Statements();
+    PooledConnection* CurrentThreadConnection();
+
 private:
-    QSqlDatabase _db;
+    QSqlDatabase _db;                   // 界面线程的只读连接
+    StatementCache _statements;
+    // 所有连接共用，写入方法负责使受影响的条目失效
+    EntityCache _cache;
+    ConnectionPool _pool;
+    StorageProfile _profile;
+    WalCheckpointScheduler _checkpointScheduler;
 
 };
 
@@ -1,4 +1,4 @@
-QT       += core gui sql widgets printsupport axcontainer
+QT       += core gui sql widgets printsupport concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -8,30 +8,75 @@ CONFIG += c++17
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
-INCLUDEPATH += "C:\Program Files\Python312\include"
-
-LIBS += -L"C:\Program Files\Python312\libs"
-LIBS += -lpython312
+# 读写 .docx 使用 zlib：Windows 使用 Qt 自带的 zlib，其它平台链接系统 zlib
+win32: QT += zlib-private
+else: LIBS += -lz
 
 SOURCES += \
     Databasemanagement.cpp \
+    blobstore.cpp \
+    bulkimporter.cpp \
+    connectionpool.cpp \
+    contenthash.cpp \
+    contentindexer.cpp \
+    dashboardwidget.cpp \
+    databaseexecutor.cpp \
+    documenttext.cpp \
+    docxmerger.cpp \
+    entitycache.cpp \
     filemanagementwidget.cpp \
+    filetablemodel.cpp \
+    filetransfer.cpp \
     logindialog.cpp \
     main.cpp \
     mainwindow.cpp \
+    nodetablemodel.cpp \
+    nodetree.cpp \
+    pagedtablemodel.cpp \
     projectmanagementwidget.cpp \
+    projecttablemodel.cpp \
+    scheduleengine.cpp \
+    schemamigrator.cpp \
+    statementcache.cpp \
+    storageprofile.cpp \
     usermanagement.cpp \
-    usermanagementwidget.cpp
+    usermanagementwidget.cpp \
+    usertablemodel.cpp \
+    zipreader.cpp \
+    zipwriter.cpp
 
 HEADERS += \
     DBModels.h \
     Databasemanagement.h \
+    blobstore.h \
+    bulkimporter.h \
+    connectionpool.h \
+    contenthash.h \
+    contentindexer.h \
+    dashboardwidget.h \
+    databaseexecutor.h \
+    documenttext.h \
+    docxmerger.h \
+    entitycache.h \
     filemanagementwidget.h \
+    filetablemodel.h \
+    filetransfer.h \
     logindialog.h \
     mainwindow.h \
+    nodetablemodel.h \
+    nodetree.h \
+    pagedtablemodel.h \
     projectmanagementwidget.h \
+    projecttablemodel.h \
+    scheduleengine.h \
+    schemamigrator.h \
+    statementcache.h \
+    storageprofile.h \
     usermanagement.h \
-    usermanagementwidget.h
+    usermanagementwidget.h \
+    usertablemodel.h \
+    zipreader.h \
+    zipwriter.h
 
 FORMS += \
     logindialog.ui \
@@ -0,0 +1,257 @@
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryFile>
+#include "blobstore.h"
+#include "contenthash.h"
+#include "Databasemanagement.h"
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// 复制文件时每次读取的字节数，复制的同时再次计算哈希
+static const qint64 kCopyBufferSize = 1024 * 1024;
+
+// 超过这个时间未修改的临时文件视为异常退出的遗留
+static const int kStaleTempSeconds = 3600;
+
+// 把文件内容刷新到磁盘，保证改名后的文件内容完整
+static bool SyncFile(QFile& file)
+{
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+BlobStore::BlobStore()
+{
+
+}
+
+BlobStore* BlobStore::Instance()
+{
+    static BlobStore store;
+    return &store;
+}
+
+bool BlobStore::Initialize(const QString& rootPath)
+{
+    _rootPath = QDir(rootPath).absolutePath();
+
+    QDir dir;
+    if(!dir.mkpath(_rootPath) || !dir.mkpath(TempPath()))
+    {
+        qDebug() << "Cannot create blob store: " << _rootPath;
+        return false;
+    }
+
+    // 存入时异常退出留下的临时文件，其它实例正在写入的临时文件会不断更新修改时间
+    QDir tempDir(TempPath());
+    QDateTime staleBefore = QDateTime::currentDateTime().addSecs(-kStaleTempSeconds);
+    const QFileInfoList leftovers = tempDir.entryInfoList(QDir::Files | QDir::Hidden);
+    for(const QFileInfo& leftover : leftovers)
+    {
+        if(leftover.lastModified() < staleBefore)
+        {
+            tempDir.remove(leftover.fileName());
+        }
+    }
+
+    qDebug() << "内容存储区路径: " << _rootPath << "，SHA-256 实现: " << Sha256::Implementation();
+    return true;
+}
+
+QString BlobStore::RootPath() const
+{
+    return _rootPath;
+}
+
+bool BlobStore::Store(const QString& sourcePath, BlobInfo& blob, QString* errorString)
+{
+    auto fail = [errorString](const QString& message) {
+        if(errorString)
+        {
+            *errorString = message;
+        }
+        return false;
+    };
+
+    if(_rootPath.isEmpty())
+    {
+        return fail("内容存储区未初始化");
+    }
+
+    // 先计算哈希，相同内容已存在时不需要复制
+    QByteArray hash;
+    qint64 size = 0;
+    QString hashError;
+    if(!HashFile(sourcePath, hash, &size, &hashError))
+    {
+        return fail(hashError);
+    }
+
+    QString hex = QString::fromLatin1(hash.toHex());
+    QString targetPath = BlobPath(hex);
+    bool existed = QFile::exists(targetPath);
+
+    if(!existed)
+    {
+        if(!QDir().mkpath(QFileInfo(targetPath).path()))
+        {
+            return fail("无法创建存储目录");
+        }
+
+        // 临时文件放在存储区内，与目标在同一个文件系统，改名是原子操作
+        QTemporaryFile temp(TempPath() + "/ingest-XXXXXX");
+        if(!temp.open())
+        {
+            return fail(QString("无法创建临时文件：%1").arg(temp.errorString()));
+        }
+
+        QFile source(sourcePath);
+        if(!source.open(QIODevice::ReadOnly))
+        {
+            return fail(QString("无法打开文件：%1").arg(source.errorString()));
+        }
+
+        Sha256 hasher;
+        QByteArray buffer(kCopyBufferSize, Qt::Uninitialized);
+        qint64 copied = 0;
+        for(;;)
+        {
+            qint64 length = source.read(buffer.data(), buffer.size());
+            if(length < 0)
+            {
+                return fail(QString("读取文件失败：%1").arg(source.errorString()));
+            }
+            if(length == 0)
+            {
+                break;
+            }
+            hasher.AddData(QByteArrayView(buffer.constData(), length));
+            if(temp.write(buffer.constData(), length) != length)
+            {
+                return fail(QString("写入存储区失败：%1").arg(temp.errorString()));
+            }
+            copied += length;
+        }
+
+        // 两次读取之间文件被其它程序修改
+        if(hasher.Result() != hash || copied != size)
+        {
+            return fail("文件在存入过程中被修改，请重试");
+        }
+
+        if(!temp.flush() || !SyncFile(temp))
+        {
+            return fail(QString("写入存储区失败：%1").arg(temp.errorString()));
+        }
+
+        // 改名成功后文件归存储区所有，不再自动删除
+        temp.setAutoRemove(false);
+        if(!temp.rename(targetPath))
+        {
+            temp.remove();
+            // 其它线程同时存入了相同的内容
+            if(!QFile::exists(targetPath))
+            {
+                return fail(QString("写入存储区失败：%1").arg(temp.errorString()));
+            }
+            existed = true;
+        }
+    }
+
+    blob.hash = hex;
+    blob.size = size;
+    blob.path = targetPath;
+    blob.existed = existed;
+    return true;
+}
+
+QString BlobStore::BlobPath(const QString& hash) const
+{
+    return QString("%1/%2/%3/%4").arg(_rootPath, hash.left(2), hash.mid(2, 2), hash);
+}
+
+bool BlobStore::Contains(const QString& hash) const
+{
+    return !hash.isEmpty() && QFile::exists(BlobPath(hash));
+}
+
+int BlobStore::CollectGarbage(int minimumAgeSeconds)
+{
+    if(_rootPath.isEmpty())
+    {
+        return 0;
+    }
+
+    DataBaseManagement* db = DataBaseManagement::Instance();
+    int removed = 0;
+    const QVector<QString> hashes = db->GetUnreferencedBlobs(minimumAgeSeconds);
+    for(const QString& hash : hashes)
+    {
+        // 先删除登记再删除文件，删除登记失败说明内容又被引用了
+        if(!db->DeleteUnreferencedBlob(hash))
+        {
+            continue;
+        }
+
+        QString path = BlobPath(hash);
+        if(QFile::exists(path) && !QFile::remove(path))
+        {
+            qDebug() << "Cannot remove blob: " << path;
+            continue;
+        }
+        ++removed;
+    }
+
+    // 存入后没有写入文件记录的内容没有登记，按文件修改时间判断是否可能正在存入
+    const QSet<QString> registered = db->GetBlobHashes();
+    QDateTime storedBefore = QDateTime::currentDateTime().addSecs(-minimumAgeSeconds);
+    QString tempPath = TempPath();
+    QDirIterator it(_rootPath, QDir::Files, QDirIterator::Subdirectories);
+    while(it.hasNext())
+    {
+        it.next();
+        QFileInfo info = it.fileInfo();
+        if(info.path() == tempPath || registered.contains(info.fileName()))
+        {
+            continue;
+        }
+        // 只处理按哈希命名、位于对应分片目录中的文件
+        if(info.fileName().size() != 64 || BlobPath(info.fileName()) != info.filePath())
+        {
+            continue;
+        }
+        if(info.lastModified() >= storedBefore)
+        {
+            continue;
+        }
+
+        if(!QFile::remove(info.filePath()))
+        {
+            qDebug() << "Cannot remove blob: " << info.filePath();
+            continue;
+        }
+        ++removed;
+    }
+
+    if(removed > 0)
+    {
+        qDebug() << "回收未引用的文件内容: " << removed;
+    }
+    return removed;
+}
+
+QString BlobStore::TempPath() const
+{
+    return _rootPath + "/tmp";
+}
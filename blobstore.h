@@ -0,0 +1,61 @@
+#ifndef BLOBSTORE_H
+#define BLOBSTORE_H
+
+#include <QString>
+
+// 存入内容存储区的文件
+struct BlobInfo
+{
+    QString hash;       // 内容的SHA-256，小写十六进制
+    qint64 size = 0;
+    QString path;       // 存储区中的文件路径
+    bool existed = false;   // 相同内容已经存在，本次没有复制
+};
+
+// 按内容寻址的文件存储区
+// 上传的文件复制到存储区，按内容的SHA-256命名，存放在以哈希前两级各两位分片的目录中
+// （ab/cd/abcd...），内容相同的文件只保存一份。复制时先写入存储区内的临时文件并刷新到磁盘，
+// 再改名到最终位置，中途失败不会留下不完整的文件。
+// 数据库 blobs 表记录每份内容被多少文件记录引用，写入文件记录时由触发器登记，
+// CollectGarbage 删除不再被引用的内容，以及存入后没有写入文件记录的内容。
+// 存储区中的文件不能直接修改，需要编辑时复制一份。
+class BlobStore
+{
+public:
+    BlobStore(const BlobStore&) = delete;
+
+    BlobStore& operator=(const BlobStore&) = delete;
+
+    static BlobStore* Instance();
+
+    // 设置存储区根目录，不存在时创建，并清理超过一小时未修改的临时文件。
+    // 较新的临时文件可能属于另一个正在存入的程序实例，不删除
+    bool Initialize(const QString& rootPath);
+
+    QString RootPath() const;
+
+    // 把文件存入存储区，内容已存在时不再复制，可以在任意线程中并行调用，不访问数据库。
+    // 之后写入文件记录失败时，内容没有登记，由 CollectGarbage 按修改时间回收。
+    // 失败时返回false，errorString 不为空时写入失败原因
+    bool Store(const QString& sourcePath, BlobInfo& blob, QString* errorString = nullptr);
+
+    // 内容在存储区中的路径，不检查文件是否存在
+    QString BlobPath(const QString& hash) const;
+
+    bool Contains(const QString& hash) const;
+
+    // 删除没有文件记录引用的内容，返回删除的数量。
+    // 只删除登记或存入超过 minimumAgeSeconds 秒的内容，避免删除刚存入、尚未写入文件记录的内容
+    // 不能与 Store 同时调用，通常在启动时执行
+    int CollectGarbage(int minimumAgeSeconds = 3600);
+
+private:
+    BlobStore();
+
+    QString TempPath() const;
+
+private:
+    QString _rootPath;
+};
+
+#endif // BLOBSTORE_H
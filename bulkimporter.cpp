@@ -0,0 +1,244 @@
+#include <QDebug>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QThread>
+#include <QtConcurrent/QtConcurrent>
+#include "blobstore.h"
+#include "bulkimporter.h"
+#include "databaseexecutor.h"
+#include "documenttext.h"
+
+// 每批处理的文件数，同时也是一个写入事务包含的文件数
+static const int kBatchSize = 256;
+
+// 一个文件的导入结果
+struct ImportedFile
+{
+    QString sourcePath;
+    bool success = false;
+    bool reused = false;
+    QString errorString;
+    FileInfo file;
+};
+
+// 递归查找目录下的 Word 文档，跳过 Word 打开文档时生成的 ~$ 锁定文件
+static QStringList FindDocuments(const QString& rootPath)
+{
+    QStringList paths;
+    QDirIterator iterator(rootPath, QStringList() << "*.doc" << "*.docx",
+                          QDir::Files | QDir::Readable, QDirIterator::Subdirectories);
+    while(iterator.hasNext())
+    {
+        iterator.next();
+        if(iterator.fileName().startsWith("~$"))
+            continue;
+        paths.append(iterator.filePath());
+    }
+    paths.sort();
+    return paths;
+}
+
+// 存入内容存储区并提取文档统计，生成待写入的文件记录
+static ImportedFile ImportFile(const QString& sourcePath, const BulkImportOptions& options)
+{
+    ImportedFile result;
+    result.sourcePath = sourcePath;
+
+    BlobInfo blob;
+    if(!BlobStore::Instance()->Store(sourcePath, blob, &result.errorString))
+    {
+        return result;
+    }
+
+    QFileInfo fileInfo(sourcePath);
+    FileInfo& file = result.file;
+    file.id = -1;
+    file.fileName = fileInfo.fileName();
+    file.filePath = blob.path;
+    file.fileExtension = fileInfo.suffix().toLower();
+    file.fileSize = blob.size;
+    file.uploaderId = options.uploader.id;
+    file.uploaderName = options.uploader.userName;
+    file.uploadTime = QDateTime::currentDateTime();
+    file.fileType = FileType::DOCUMENT;
+    file.status = FileStatus::NORMAL;
+    file.projectId = -1;
+    file.isProcessDocument = options.isProcessDocument;
+    file.contentHash = blob.hash;
+
+    // 统计提取失败不影响导入，正文索引时会再次提取
+    DocumentStatistics statistics;
+    if(file.fileExtension == "docx")
+    {
+        QString error;
+        if(!ExtractDocxStatistics(blob.path, statistics, &error))
+            qDebug() << "无法读取文档统计信息：" << sourcePath << error;
+    }
+    file.pageCount = statistics.pageCount;
+    file.wordCount = statistics.wordCount;
+    file.characterCount = statistics.characterCount;
+
+    result.success = true;
+    result.reused = blob.existed;
+    return result;
+}
+
+BulkImporter::BulkImporter(QObject* parent)
+    : QObject(parent)
+    , _nextIndex(0)
+    , _pendingSaves(0)
+    , _running(false)
+    , _processing(false)
+    , _canceled(false)
+{
+    // 哈希、复制和解压交替占用磁盘和CPU，按CPU核数并行
+    _pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+BulkImporter::~BulkImporter()
+{
+    _pool.clear();
+    _pool.waitForDone();
+}
+
+bool BulkImporter::Start(const BulkImportOptions& options)
+{
+    if(_running)
+    {
+        return false;
+    }
+
+    _running = true;
+    _processing = true;
+    _canceled = false;
+    _options = options;
+    _paths.clear();
+    _nextIndex = 0;
+    _pendingSaves = 0;
+    _progress = BulkImportProgress();
+    _errors.clear();
+    _timer.start();
+
+    QString rootPath = options.rootPath;
+    QtConcurrent::run(&_pool, [rootPath]() {
+        return FindDocuments(rootPath);
+    }).then(this, [this](const QStringList& paths) {
+        _paths = paths;
+        _progress.total = paths.size();
+        emit progress(_progress);
+        ProcessNextBatch();
+    });
+    return true;
+}
+
+void BulkImporter::Cancel()
+{
+    if(_running)
+    {
+        _canceled = true;
+    }
+}
+
+bool BulkImporter::IsRunning() const
+{
+    return _running;
+}
+
+void BulkImporter::ProcessNextBatch()
+{
+    if(_canceled || _nextIndex >= _paths.size())
+    {
+        _processing = false;
+        TryFinish();
+        return;
+    }
+
+    QStringList batch = _paths.mid(_nextIndex, kBatchSize);
+    _nextIndex += batch.size();
+
+    BulkImportOptions options = _options;
+    QtConcurrent::mapped(&_pool, batch, [options](const QString& sourcePath) {
+        return ImportFile(sourcePath, options);
+    }).then(this, [this](QFuture<ImportedFile> future) {
+        QVector<FileInfo> files;
+        for(const ImportedFile& imported : future.results())
+        {
+            ++_progress.processed;
+            if(!imported.success)
+            {
+                ++_progress.failed;
+                _errors << QString("%1：%2").arg(imported.sourcePath, imported.errorString);
+                continue;
+            }
+
+            if(imported.reused)
+                ++_progress.reused;
+            _progress.bytes += imported.file.fileSize;
+            files.append(imported.file);
+        }
+
+        // 写入本批的同时开始处理下一批
+        SaveBatch(files);
+        ProcessNextBatch();
+    });
+}
+
+void BulkImporter::SaveBatch(const QVector<FileInfo>& files)
+{
+    if(files.isEmpty())
+    {
+        UpdateRates();
+        emit progress(_progress);
+        return;
+    }
+
+    ++_pendingSaves;
+    DataBaseExecutor::Instance()->Run([files](DataBaseManagement* db) {
+        // 写入文件记录时由触发器登记内容，没有写入的内容由启动时的回收删除
+        return !db->AddFiles(files).isEmpty();
+    }, this, [this, files](bool success) {
+        --_pendingSaves;
+        if(success)
+        {
+            _progress.imported += files.size();
+        }
+        else
+        {
+            _progress.failed += files.size();
+            for(const FileInfo& file : files)
+                _errors << QString("%1：写入数据库失败").arg(file.fileName);
+        }
+
+        UpdateRates();
+        emit progress(_progress);
+        TryFinish();
+    });
+}
+
+void BulkImporter::UpdateRates()
+{
+    _progress.elapsedMilliseconds = _timer.elapsed();
+    double seconds = _progress.elapsedMilliseconds / 1000.0;
+    if(seconds <= 0)
+    {
+        return;
+    }
+
+    _progress.filesPerSecond = _progress.processed / seconds;
+    _progress.bytesPerSecond = _progress.bytes / seconds;
+    int remaining = _progress.total - _progress.processed;
+    _progress.remainingSeconds = _progress.filesPerSecond > 0 ? qRound(remaining / _progress.filesPerSecond) : -1;
+}
+
+void BulkImporter::TryFinish()
+{
+    if(!_running || _processing || _pendingSaves > 0)
+    {
+        return;
+    }
+
+    _running = false;
+    UpdateRates();
+    _progress.remainingSeconds = 0;
+    emit finished(_progress, _canceled, _errors);
+}
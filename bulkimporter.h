@@ -0,0 +1,77 @@
+#ifndef BULKIMPORTER_H
+#define BULKIMPORTER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QStringList>
+#include <QThreadPool>
+#include "DBModels.h"
+
+// 批量导入选项
+struct BulkImportOptions
+{
+    QString rootPath;               // 递归导入该目录下的 .doc 和 .docx
+    User uploader;
+    bool isProcessDocument = false;
+};
+
+// 导入进度，processed 包括成功和失败的文件
+struct BulkImportProgress
+{
+    int total = 0;
+    int processed = 0;
+    int imported = 0;
+    int reused = 0;                 // 内容与已有文件相同，没有再复制
+    int failed = 0;
+    qint64 bytes = 0;               // 已处理文件的总大小
+    qint64 elapsedMilliseconds = 0;
+    double filesPerSecond = 0;
+    double bytesPerSecond = 0;
+    int remainingSeconds = -1;      // 预计剩余时间，未知时为-1
+};
+
+// 目录批量导入
+// 在工作线程中遍历目录树，按批在线程池中并行计算哈希、存入内容存储区并提取文档统计，
+// 每批文件记录在数据库线程用一个事务写入。写入上一批时下一批已开始处理。
+// 界面线程只负责发起导入和接收进度通知，正文索引在导入完成后由 ContentIndexer 补齐。
+class BulkImporter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BulkImporter(QObject* parent = nullptr);
+    ~BulkImporter();
+
+    // 开始导入，正在导入时返回false
+    bool Start(const BulkImportOptions& options);
+
+    // 当前批次完成后停止，已写入的文件保留
+    void Cancel();
+
+    bool IsRunning() const;
+
+signals:
+    void progress(const BulkImportProgress& progress);
+    // canceled 为true表示被取消；errors 为失败的文件及原因
+    void finished(const BulkImportProgress& progress, bool canceled, const QStringList& errors);
+
+private:
+    void ProcessNextBatch();
+    void SaveBatch(const QVector<FileInfo>& files);
+    void UpdateRates();
+    void TryFinish();
+
+private:
+    QThreadPool _pool;
+    BulkImportOptions _options;
+    QStringList _paths;
+    int _nextIndex;
+    int _pendingSaves;
+    bool _running;
+    bool _processing;
+    bool _canceled;
+    BulkImportProgress _progress;
+    QStringList _errors;
+    QElapsedTimer _timer;
+};
+
+#endif // BULKIMPORTER_H
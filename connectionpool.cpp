@@ -0,0 +1,204 @@
+#include <QDebug>
+#include <QSqlError>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QThread>
+#include "connectionpool.h"
+
+PooledConnection::~PooledConnection()
+{
+    // 缓存的语句必须先于连接释放
+    statements.Clear();
+
+    QString connectionName = db.connectionName();
+    if(db.isOpen())
+    {
+        db.close();
+    }
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+ConnectionPool::ReadScope::ReadScope(ConnectionPool& pool)
+    : _pool(pool)
+    , _acquired(false)
+{
+    // 嵌套的 ReadScope 共用外层已占用的名额
+    int depth = _pool._readScopeDepth.hasLocalData() ? _pool._readScopeDepth.localData() : 0;
+    if(depth == 0)
+    {
+        _pool.AcquireReader();
+        _acquired = true;
+    }
+    _pool._readScopeDepth.setLocalData(depth + 1);
+}
+
+ConnectionPool::ReadScope::~ReadScope()
+{
+    _pool._readScopeDepth.setLocalData(_pool._readScopeDepth.localData() - 1);
+    if(_acquired)
+    {
+        _pool.ReleaseReader();
+    }
+}
+
+ConnectionPool::WriteScope::WriteScope(ConnectionPool& pool)
+    : _pool(pool)
+    , _outermost(false)
+{
+    int depth = _pool._writeScopeDepth.hasLocalData() ? _pool._writeScopeDepth.localData() : 0;
+    if(depth == 0)
+    {
+        bool acquired = _pool._writerThread.testAndSetOrdered(nullptr, QThread::currentThread());
+        Q_ASSERT_X(acquired, "ConnectionPool::WriteScope", "only one thread may write at a time");
+        Q_UNUSED(acquired);
+        _outermost = true;
+    }
+    _pool._writeScopeDepth.setLocalData(depth + 1);
+}
+
+ConnectionPool::WriteScope::~WriteScope()
+{
+    _pool._writeScopeDepth.setLocalData(_pool._writeScopeDepth.localData() - 1);
+    if(_outermost)
+    {
+        _pool._writerThread.storeRelease(nullptr);
+    }
+}
+
+ConnectionPool::ConnectionPool()
+    : _readerPoolSize(0)
+    , _acquisitions(0)
+    , _waits(0)
+    , _totalWaitUs(0)
+    , _maxWaitUs(0)
+{
+
+}
+
+void ConnectionPool::Configure(const QString& databasePath, const StorageProfile& profile)
+{
+    _databasePath = databasePath;
+    _profile = profile;
+
+    int poolSize = qMax(1, profile.readerPoolSize);
+    if(poolSize > _readerPoolSize)
+    {
+        _readerSlots.release(poolSize - _readerPoolSize);
+    }
+    else if(poolSize < _readerPoolSize)
+    {
+        _readerSlots.acquire(_readerPoolSize - poolSize);
+    }
+    _readerPoolSize = poolSize;
+}
+
+int ConnectionPool::ReaderPoolSize() const
+{
+    return _readerPoolSize;
+}
+
+bool ConnectionPool::InReadScope() const
+{
+    // QThreadStorage 的 localData 不是 const 成员
+    ConnectionPool* self = const_cast<ConnectionPool*>(this);
+    return self->_readScopeDepth.hasLocalData() && self->_readScopeDepth.localData() > 0;
+}
+
+bool ConnectionPool::InWriteScope() const
+{
+    ConnectionPool* self = const_cast<ConnectionPool*>(this);
+    return self->_writeScopeDepth.hasLocalData() && self->_writeScopeDepth.localData() > 0;
+}
+
+PooledConnection* ConnectionPool::WriterConnection()
+{
+    Q_ASSERT(InWriteScope());
+    // 写连接保存在写线程的线程存储中，写线程退出时关闭
+    if(!_writers.hasLocalData())
+    {
+        _writers.setLocalData(OpenConnection(false));
+    }
+
+    return _writers.localData();
+}
+
+PooledConnection* ConnectionPool::ReaderConnection()
+{
+    if(!_readers.hasLocalData())
+    {
+        _readers.setLocalData(OpenConnection(true));
+    }
+
+    return _readers.localData();
+}
+
+ConnectionPoolStats ConnectionPool::Stats() const
+{
+    QMutexLocker locker(&_statsMutex);
+
+    ConnectionPoolStats stats;
+    stats.readerPoolSize = _readerPoolSize;
+    stats.acquisitions = _acquisitions;
+    stats.waits = _waits;
+    stats.totalWaitUs = _totalWaitUs;
+    stats.maxWaitUs = _maxWaitUs;
+    return stats;
+}
+
+PooledConnection* ConnectionPool::OpenConnection(bool readOnly)
+{
+    static QAtomicInt connectionSerial;
+    QString connectionName = QString("projectmanager_%1_%2")
+                                 .arg(readOnly ? "reader" : "writer")
+                                 .arg(connectionSerial.fetchAndAddRelaxed(1));
+
+    PooledConnection* connection = new PooledConnection;
+    connection->db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    connection->db.setDatabaseName(_databasePath);
+    if(readOnly)
+    {
+        connection->db.setConnectOptions("QSQLITE_OPEN_READONLY");
+    }
+
+    if(!connection->db.open())
+    {
+        qDebug() << "Cannot open pooled connection" << connectionName << ": " << connection->db.lastError().text();
+    }
+    else if(!ApplyStorageProfile(connection->db, _profile, readOnly))
+    {
+        qDebug() << "Failed to apply storage profile on" << connectionName;
+    }
+
+    connection->statements.SetDatabase(connection->db);
+    return connection;
+}
+
+void ConnectionPool::AcquireReader()
+{
+    qint64 waitUs = 0;
+    bool waited = false;
+    if(!_readerSlots.tryAcquire())
+    {
+        QElapsedTimer timer;
+        timer.start();
+        _readerSlots.acquire();
+        waitUs = timer.nsecsElapsed() / 1000;
+        waited = true;
+    }
+
+    QMutexLocker locker(&_statsMutex);
+    ++_acquisitions;
+    if(waited)
+    {
+        ++_waits;
+        _totalWaitUs += waitUs;
+        _maxWaitUs = qMax(_maxWaitUs, waitUs);
+    }
+}
+
+void ConnectionPool::ReleaseReader()
+{
+    _readerSlots.release();
+}
@@ -0,0 +1,115 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <QSqlDatabase>
+#include <QAtomicPointer>
+#include <QSemaphore>
+#include <QMutex>
+#include <QString>
+#include <QThreadStorage>
+#include "statementcache.h"
+#include "storageprofile.h"
+
+// 线程独占的数据库连接及其语句缓存，线程退出时关闭
+struct PooledConnection
+{
+    QSqlDatabase db;
+    StatementCache statements;
+
+    ~PooledConnection();
+};
+
+// 连接池统计
+struct ConnectionPoolStats
+{
+    int readerPoolSize;     // 同时可用的读连接数
+    quint64 acquisitions;   // 获取读连接的次数
+    quint64 waits;          // 需要等待空闲名额的次数
+    qint64 totalWaitUs;     // 累计等待时间（微秒）
+    qint64 maxWaitUs;       // 最长一次等待时间（微秒）
+};
+
+// 数据库连接池
+// QSqlDatabase 只能在创建它的线程中使用，因此连接按线程分配，且都以 QSQLITE_OPEN_READONLY 打开，
+// 唯一的例外是写连接：只有处于 WriteScope 的线程（数据库执行器的单个工作线程）打开读写连接，
+// 整个进程只有这一个写连接，写入之间不会相互等待锁。
+// 同时处于 ReadScope 的线程数不超过读连接池大小，超出时等待并记录等待时间。
+// WAL 模式下每个读连接看到的是各自事务开始时的快照，不会阻塞写连接。
+class ConnectionPool
+{
+public:
+    // 在当前线程标记一段写访问，期间数据库操作使用写连接。同一时刻只能有一个线程处于 WriteScope
+    class WriteScope
+    {
+    public:
+        explicit WriteScope(ConnectionPool& pool);
+        ~WriteScope();
+
+        WriteScope(const WriteScope&) = delete;
+        WriteScope& operator=(const WriteScope&) = delete;
+
+    private:
+        ConnectionPool& _pool;
+        bool _outermost;
+    };
+
+    // 在当前线程标记一段只读访问，期间数据库操作使用只读连接
+    class ReadScope
+    {
+    public:
+        explicit ReadScope(ConnectionPool& pool);
+        ~ReadScope();
+
+        ReadScope(const ReadScope&) = delete;
+        ReadScope& operator=(const ReadScope&) = delete;
+
+    private:
+        ConnectionPool& _pool;
+        bool _acquired;
+    };
+
+    ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    void Configure(const QString& databasePath, const StorageProfile& profile);
+
+    int ReaderPoolSize() const;
+
+    // 当前线程是否处于 ReadScope / WriteScope 中
+    bool InReadScope() const;
+    bool InWriteScope() const;
+
+    // 写连接，只能在 WriteScope 中调用，首次访问时打开
+    PooledConnection* WriterConnection();
+    // 当前线程的只读连接，首次访问时打开
+    PooledConnection* ReaderConnection();
+
+    ConnectionPoolStats Stats() const;
+
+private:
+    PooledConnection* OpenConnection(bool readOnly);
+    void AcquireReader();
+    void ReleaseReader();
+
+private:
+    QString _databasePath;
+    StorageProfile _profile;
+    int _readerPoolSize;
+    QSemaphore _readerSlots;
+
+    QThreadStorage<PooledConnection*> _writers;
+    QThreadStorage<PooledConnection*> _readers;
+    QThreadStorage<int> _readScopeDepth;
+    QThreadStorage<int> _writeScopeDepth;
+    QAtomicPointer<QThread> _writerThread;  // 正处于 WriteScope 的线程
+
+    mutable QMutex _statsMutex;
+    quint64 _acquisitions;
+    quint64 _waits;
+    qint64 _totalWaitUs;
+    qint64 _maxWaitUs;
+};
+
+#endif // CONNECTIONPOOL_H
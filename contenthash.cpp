@@ -0,0 +1,333 @@
+#include <QFile>
+#include <QtEndian>
+#include <cstring>
+#include "contenthash.h"
+
+// GCC、Clang 需要为使用 SHA 指令的函数单独指定目标，其余代码仍按基线指令集编译
+#if defined(Q_PROCESSOR_X86) && (defined(Q_CC_GNU) || defined(Q_CC_CLANG) || defined(Q_CC_MSVC))
+#define CONTENTHASH_SHA_NI
+#include <immintrin.h>
+#if defined(Q_CC_MSVC)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#if defined(Q_CC_MSVC) && !defined(Q_CC_CLANG)
+#define SHA_NI_TARGET
+#else
+#define SHA_NI_TARGET __attribute__((target("sha,sse4.1")))
+#endif
+#endif
+
+// 无法映射文件时每次读取的字节数
+static const qint64 kReadBufferSize = 4 * 1024 * 1024;
+
+static const quint32 kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+// 按64字节分组压缩，blocks 为分组数
+typedef void (*CompressFunction)(quint32* state, const uchar* data, size_t blocks);
+
+static inline quint32 RotateRight(quint32 value, int bits)
+{
+    return (value >> bits) | (value << (32 - bits));
+}
+
+static void CompressScalar(quint32* state, const uchar* data, size_t blocks)
+{
+    quint32 w[64];
+    for(; blocks > 0; --blocks, data += 64)
+    {
+        for(int i = 0; i < 16; ++i)
+        {
+            w[i] = qFromBigEndian<quint32>(data + i * 4);
+        }
+        for(int i = 16; i < 64; ++i)
+        {
+            quint32 s0 = RotateRight(w[i - 15], 7) ^ RotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            quint32 s1 = RotateRight(w[i - 2], 17) ^ RotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        quint32 a = state[0], b = state[1], c = state[2], d = state[3];
+        quint32 e = state[4], f = state[5], g = state[6], h = state[7];
+        for(int i = 0; i < 64; ++i)
+        {
+            quint32 s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+            quint32 choose = (e & f) ^ (~e & g);
+            quint32 t1 = h + s1 + choose + kRoundConstants[i] + w[i];
+            quint32 s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+            quint32 majority = (a & b) ^ (a & c) ^ (b & c);
+            quint32 t2 = s0 + majority;
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#ifdef CONTENTHASH_SHA_NI
+// SHA-NI 每条 sha256rnds2 完成两轮，状态按 ABEF、CDGH 两个寄存器排列
+SHA_NI_TARGET static void CompressShaNi(quint32* state, const uchar* data, size_t blocks)
+{
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i temp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+    __m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4));
+    temp = _mm_shuffle_epi32(temp, 0xB1);                   // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1B);               // EFGH
+    __m128i state0 = _mm_alignr_epi8(temp, state1, 8);      // ABEF
+    state1 = _mm_blend_epi16(state1, temp, 0xF0);           // CDGH
+
+    for(; blocks > 0; --blocks, data += 64)
+    {
+        const __m128i savedState0 = state0;
+        const __m128i savedState1 = state1;
+
+        // 每个寄存器保存4个消息字，w[i] 对应第 4i 到 4i+3 轮
+        __m128i w[16];
+        for(int i = 0; i < 4; ++i)
+        {
+            w[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16)), byteSwap);
+        }
+        for(int i = 4; i < 16; ++i)
+        {
+            __m128i message = _mm_sha256msg1_epu32(w[i - 4], w[i - 3]);
+            message = _mm_add_epi32(message, _mm_alignr_epi8(w[i - 1], w[i - 2], 4));
+            w[i] = _mm_sha256msg2_epu32(message, w[i - 1]);
+        }
+
+        for(int i = 0; i < 16; ++i)
+        {
+            __m128i message = _mm_add_epi32(w[i],
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(kRoundConstants + i * 4)));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+            message = _mm_shuffle_epi32(message, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, message);
+        }
+
+        state0 = _mm_add_epi32(state0, savedState0);
+        state1 = _mm_add_epi32(state1, savedState1);
+    }
+
+    temp = _mm_shuffle_epi32(state0, 0x1B);                 // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);               // DCHG
+    state0 = _mm_blend_epi16(temp, state1, 0xF0);           // DCBA
+    state1 = _mm_alignr_epi8(state1, temp, 8);              // ABEF
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), state1);
+}
+
+// 检查 CPUID：SSSE3、SSE4.1 和 SHA 扩展
+static bool CpuHasShaNi()
+{
+    unsigned int leaf1[4] = {0, 0, 0, 0};
+    unsigned int leaf7[4] = {0, 0, 0, 0};
+#if defined(Q_CC_MSVC)
+    int registers[4];
+    __cpuid(registers, 0);
+    if(registers[0] < 7)
+    {
+        return false;
+    }
+    __cpuidex(registers, 1, 0);
+    std::memcpy(leaf1, registers, sizeof(leaf1));
+    __cpuidex(registers, 7, 0);
+    std::memcpy(leaf7, registers, sizeof(leaf7));
+#else
+    if(__get_cpuid_max(0, nullptr) < 7)
+    {
+        return false;
+    }
+    __cpuid_count(1, 0, leaf1[0], leaf1[1], leaf1[2], leaf1[3]);
+    __cpuid_count(7, 0, leaf7[0], leaf7[1], leaf7[2], leaf7[3]);
+#endif
+    bool ssse3 = leaf1[2] & (1u << 9);
+    bool sse41 = leaf1[2] & (1u << 19);
+    bool sha = leaf7[1] & (1u << 29);
+    return ssse3 && sse41 && sha;
+}
+#endif
+
+static CompressFunction SelectCompress()
+{
+#ifdef CONTENTHASH_SHA_NI
+    if(CpuHasShaNi())
+    {
+        return CompressShaNi;
+    }
+#endif
+    return CompressScalar;
+}
+
+// 局部静态变量只初始化一次，多线程同时首次调用也是安全的
+static CompressFunction Compress()
+{
+    static const CompressFunction compress = SelectCompress();
+    return compress;
+}
+
+Sha256::Sha256()
+{
+    Reset();
+}
+
+void Sha256::Reset()
+{
+    static const quint32 initialState[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    std::memcpy(_state, initialState, sizeof(_state));
+    _length = 0;
+    _bufferSize = 0;
+}
+
+void Sha256::AddData(QByteArrayView data)
+{
+    const uchar* input = reinterpret_cast<const uchar*>(data.data());
+    size_t remaining = static_cast<size_t>(data.size());
+    _length += remaining;
+
+    // 先补满上次剩余的不完整分组
+    if(_bufferSize > 0)
+    {
+        size_t count = qMin(remaining, static_cast<size_t>(64 - _bufferSize));
+        std::memcpy(_buffer + _bufferSize, input, count);
+        _bufferSize += static_cast<int>(count);
+        input += count;
+        remaining -= count;
+        if(_bufferSize < 64)
+        {
+            return;
+        }
+        Compress()(_state, _buffer, 1);
+        _bufferSize = 0;
+    }
+
+    // 完整分组直接从输入压缩，不经过缓冲区
+    size_t blocks = remaining / 64;
+    if(blocks > 0)
+    {
+        Compress()(_state, input, blocks);
+        input += blocks * 64;
+        remaining -= blocks * 64;
+    }
+
+    if(remaining > 0)
+    {
+        std::memcpy(_buffer, input, remaining);
+        _bufferSize = static_cast<int>(remaining);
+    }
+}
+
+QByteArray Sha256::Result()
+{
+    // 填充：0x80，补0到56字节，最后8字节为大端的位长度
+    quint64 bitLength = _length * 8;
+    uchar padding[72] = {0x80};
+    int paddingSize = (_bufferSize < 56 ? 56 : 120) - _bufferSize;
+    qToBigEndian<quint64>(bitLength, padding + paddingSize);
+    AddData(QByteArrayView(reinterpret_cast<const char*>(padding), paddingSize + 8));
+
+    QByteArray digest(32, Qt::Uninitialized);
+    for(int i = 0; i < 8; ++i)
+    {
+        qToBigEndian<quint32>(_state[i], digest.data() + i * 4);
+    }
+    return digest;
+}
+
+QByteArray Sha256::Hash(QByteArrayView data)
+{
+    Sha256 hasher;
+    hasher.AddData(data);
+    return hasher.Result();
+}
+
+const char* Sha256::Implementation()
+{
+#ifdef CONTENTHASH_SHA_NI
+    if(Compress() == CompressShaNi)
+    {
+        return "SHA-NI";
+    }
+#endif
+    return "scalar";
+}
+
+bool HashFile(const QString& filePath, QByteArray& hash, qint64* size, QString* errorString)
+{
+    QFile file(filePath);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        if(errorString)
+        {
+            *errorString = QString("无法打开文件：%1").arg(file.errorString());
+        }
+        return false;
+    }
+
+    Sha256 hasher;
+    qint64 fileSize = file.size();
+    qint64 hashed = 0;
+
+    // 映射后由哈希函数直接读取页缓存，省去复制到缓冲区
+    uchar* mapped = fileSize > 0 ? file.map(0, fileSize) : nullptr;
+    if(mapped)
+    {
+        hasher.AddData(QByteArrayView(reinterpret_cast<const char*>(mapped), fileSize));
+        file.unmap(mapped);
+        hashed = fileSize;
+    }
+    else
+    {
+        QByteArray buffer(kReadBufferSize, Qt::Uninitialized);
+        for(;;)
+        {
+            qint64 length = file.read(buffer.data(), buffer.size());
+            if(length < 0)
+            {
+                if(errorString)
+                {
+                    *errorString = QString("读取文件失败：%1").arg(file.errorString());
+                }
+                return false;
+            }
+            if(length == 0)
+            {
+                break;
+            }
+            hasher.AddData(QByteArrayView(buffer.constData(), length));
+            hashed += length;
+        }
+    }
+
+    hash = hasher.Result();
+    if(size)
+    {
+        *size = hashed;
+    }
+    return true;
+}
@@ -0,0 +1,40 @@
+#ifndef CONTENTHASH_H
+#define CONTENTHASH_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// SHA-256 增量计算
+// x86 处理器支持 SHA 扩展指令（SHA-NI）时使用硬件指令，否则使用标量实现，
+// 两种实现结果相同，启动后第一次使用时检测一次。
+class Sha256
+{
+public:
+    Sha256();
+
+    void Reset();
+    void AddData(QByteArrayView data);
+
+    // 32字节摘要，调用后需要 Reset 才能重新计算
+    QByteArray Result();
+
+    static QByteArray Hash(QByteArrayView data);
+
+    // 当前使用的实现，"SHA-NI" 或 "scalar"，用于日志
+    static const char* Implementation();
+
+private:
+    quint32 _state[8];
+    quint64 _length;
+    uchar _buffer[64];
+    int _bufferSize;
+};
+
+// 计算文件内容的SHA-256。文件映射到内存后一次计算，无法映射时按大块读取。
+// 失败时返回false，errorString 不为空时写入失败原因
+bool HashFile(const QString& filePath, QByteArray& hash, qint64* size = nullptr, QString* errorString = nullptr);
+
+#endif // CONTENTHASH_H
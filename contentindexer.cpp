@@ -0,0 +1,201 @@
+#include <QDebug>
+#include <QFileInfo>
+#include <QThread>
+#include <QtConcurrent/QtConcurrent>
+#include <optional>
+#include "contentindexer.h"
+#include "databaseexecutor.h"
+#include "documenttext.h"
+
+// 每批检查的文件数，同时也是一个写入事务包含的最大文件数
+static const int kBatchSize = 128;
+
+// 检查文件是否需要重新提取正文，需要时提取，文件没有变化时返回空
+static std::optional<FileContent> ExtractFileContent(const ContentIndexCandidate& candidate)
+{
+    QFileInfo fileInfo(candidate.filePath);
+
+    FileContent content;
+    content.fileId = candidate.fileId;
+    content.pageCount = 0;
+    content.wordCount = 0;
+    content.characterCount = 0;
+    content.fileSize = fileInfo.exists() ? fileInfo.size() : 0;
+    content.modifiedTime = fileInfo.exists() ? fileInfo.lastModified().toMSecsSinceEpoch() : 0;
+
+    if(candidate.indexedSize == content.fileSize && candidate.indexedModifiedTime == content.modifiedTime)
+    {
+        return std::nullopt;
+    }
+
+    if(!fileInfo.exists())
+    {
+        content.status = ContentIndexStatus::MISSING;
+        return content;
+    }
+
+    // .doc 为二进制复合文档格式，暂不提取正文
+    if(candidate.fileExtension.compare("docx", Qt::CaseInsensitive) != 0)
+    {
+        content.status = ContentIndexStatus::UNSUPPORTED;
+        return content;
+    }
+
+    QString error;
+    DocumentStatistics statistics;
+    if(ExtractDocxContent(candidate.filePath, content.text, statistics, &error))
+    {
+        content.status = ContentIndexStatus::INDEXED;
+        content.pageCount = statistics.pageCount;
+        content.wordCount = statistics.wordCount;
+        content.characterCount = statistics.characterCount;
+    }
+    else
+    {
+        qDebug() << "Failed to extract text from" << candidate.filePath << ": " << error;
+        content.status = ContentIndexStatus::FAILED;
+        content.text.clear();
+    }
+
+    return content;
+}
+
+ContentIndexer::ContentIndexer(QObject* parent)
+    : QObject(parent)
+    , _running(false)
+    , _stopped(false)
+    , _restartRequested(false)
+    , _lastFileId(0)
+    , _checked(0)
+    , _indexed(0)
+{
+    // 提取以解压和XML解析为主，按CPU核数并行
+    _pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+ContentIndexer::~ContentIndexer()
+{
+    _pool.clear();
+    _pool.waitForDone();
+}
+
+ContentIndexer* ContentIndexer::Instance()
+{
+    static ContentIndexer indexer;
+    return &indexer;
+}
+
+void ContentIndexer::Start()
+{
+    if(_stopped)
+    {
+        return;
+    }
+
+    if(_running)
+    {
+        _restartRequested = true;
+        return;
+    }
+
+    _running = true;
+    _restartRequested = false;
+    _lastFileId = 0;
+    _checked = 0;
+    _indexed = 0;
+    ProcessNextBatch();
+}
+
+bool ContentIndexer::IsRunning() const
+{
+    return _running;
+}
+
+void ContentIndexer::Stop()
+{
+    // 未开始的提取直接丢弃，已提取的批次不再写入，下次启动时重新提取
+    _stopped = true;
+    _running = false;
+    _pool.clear();
+    _pool.waitForDone();
+}
+
+void ContentIndexer::ProcessNextBatch()
+{
+    if(_stopped)
+    {
+        return;
+    }
+
+    int afterFileId = _lastFileId;
+    DataBaseExecutor::Instance()->RunRead([afterFileId](DataBaseManagement* db) {
+        return db->GetContentIndexCandidates(afterFileId, kBatchSize);
+    }, this, [this](const QVector<ContentIndexCandidate>& candidates) {
+        if(candidates.isEmpty())
+        {
+            FinishRound();
+            return;
+        }
+
+        _lastFileId = candidates.last().fileId;
+        _checked += candidates.size();
+
+        QtConcurrent::mapped(&_pool, candidates, ExtractFileContent)
+            .then(this, [this](QFuture<std::optional<FileContent>> future) {
+                QVector<FileContent> contents;
+                for(const std::optional<FileContent>& content : future.results())
+                {
+                    if(content)
+                        contents.append(*content);
+                }
+                SaveBatch(contents);
+            });
+    });
+}
+
+void ContentIndexer::SaveBatch(const QVector<FileContent>& contents)
+{
+    if(_stopped)
+    {
+        return;
+    }
+
+    if(contents.isEmpty())
+    {
+        emit progress(_checked, _indexed);
+        ProcessNextBatch();
+        return;
+    }
+
+    for(const FileContent& content : contents)
+    {
+        if(content.status == ContentIndexStatus::INDEXED)
+            ++_indexed;
+    }
+
+    DataBaseExecutor::Instance()->Run([contents](DataBaseManagement* db) {
+        return db->SaveFileContents(contents);
+    }, this, [this](bool success) {
+        if(!success)
+        {
+            // 写入失败时保留已写入的批次，下一轮从头检查时会重新提取
+            qDebug() << "Failed to save file contents, content indexing stopped";
+            FinishRound();
+            return;
+        }
+
+        emit progress(_checked, _indexed);
+        ProcessNextBatch();
+    });
+}
+
+void ContentIndexer::FinishRound()
+{
+    _running = false;
+    emit finished(_checked, _indexed);
+
+    if(_restartRequested)
+    {
+        Start();
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef CONTENTINDEXER_H
+#define CONTENTINDEXER_H
+
+#include <QObject>
+#include <QThreadPool>
+#include "DBModels.h"
+
+// 文档正文索引器
+// 按文件ID分批扫描文件表，对比文件大小和修改时间，只重新提取新增或发生变化的文档。
+// 正文提取在独立线程池中并行执行，每批结果在数据库线程用一个事务写入全文索引，
+// 界面线程只负责发起索引和接收进度通知。
+class ContentIndexer : public QObject
+{
+    Q_OBJECT
+public:
+    ContentIndexer(const ContentIndexer&) = delete;
+
+    ContentIndexer& operator=(const ContentIndexer&) = delete;
+
+    ~ContentIndexer();
+
+    static ContentIndexer* Instance();
+
+    // 开始一轮增量索引，正在索引时本轮结束后再从头检查一轮
+    void Start();
+
+    bool IsRunning() const;
+
+    // 停止索引并等待正在提取的文件完成，之后不再发起写入。关闭数据库前调用
+    void Stop();
+
+signals:
+    // checked 为本轮已检查的文件数，indexed 为重新提取了正文的文件数
+    void progress(int checked, int indexed);
+    void finished(int checked, int indexed);
+
+private:
+    explicit ContentIndexer(QObject* parent = nullptr);
+
+    void ProcessNextBatch();
+    void SaveBatch(const QVector<FileContent>& contents);
+    void FinishRound();
+
+private:
+    QThreadPool _pool;
+    bool _running;
+    bool _stopped;
+    bool _restartRequested;
+    int _lastFileId;
+    int _checked;
+    int _indexed;
+};
+
+#endif // CONTENTINDEXER_H
@@ -0,0 +1,220 @@
+#include "dashboardwidget.h"
+#include "databaseexecutor.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLocale>
+#include <QMap>
+#include <QColor>
+
+// 项目经理的汇总
+struct ManagerStatistics
+{
+    QString managerName;
+    int projectCount = 0;
+    int overdueProjectCount = 0;
+    int overdueNodeCount = 0;
+    int nodeCount = 0;
+    int completedCount = 0;
+};
+
+static int Percent(int value, int total)
+{
+    return total > 0 ? value * 100 / total : 0;
+}
+
+static QTableWidgetItem* NumberItem(qint64 value)
+{
+    QTableWidgetItem* item = new QTableWidgetItem();
+    item->setData(Qt::DisplayRole, value);
+    return item;
+}
+
+// 文件大小按字节数排序，显示为格式化后的大小
+class DataSizeItem : public QTableWidgetItem
+{
+public:
+    explicit DataSizeItem(qint64 bytes)
+        : QTableWidgetItem(QLocale().formattedDataSize(bytes))
+        , _bytes(bytes)
+    {
+    }
+
+    bool operator<(const QTableWidgetItem& other) const override
+    {
+        const DataSizeItem* item = dynamic_cast<const DataSizeItem*>(&other);
+        return item ? _bytes < item->_bytes : QTableWidgetItem::operator<(other);
+    }
+
+private:
+    qint64 _bytes;
+};
+
+// 项目未完成且已过预计完成时间
+static bool IsOverdue(const Project& project, const QDateTime& now)
+{
+    return !project.isCompleted && project.estimatedCompleteTime.isValid() &&
+           project.estimatedCompleteTime < now;
+}
+
+DashboardWidget::DashboardWidget(QWidget *parent)
+    : QWidget(parent)
+    , _loading(false)
+{
+    setupUI();
+}
+
+DashboardWidget::~DashboardWidget()
+{
+}
+
+void DashboardWidget::setupUI()
+{
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    QHBoxLayout* headerLayout = new QHBoxLayout();
+    QLabel* titleLabel = new QLabel("统计概览", this);
+    titleLabel->setStyleSheet("font-size: 18px; font-weight: bold;");
+    headerLayout->addWidget(titleLabel);
+    headerLayout->addStretch();
+    _refreshButton = new QPushButton("刷新", this);
+    connect(_refreshButton, &QPushButton::clicked, this, &DashboardWidget::onRefresh);
+    headerLayout->addWidget(_refreshButton);
+    mainLayout->addLayout(headerLayout);
+
+    _summaryLabel = new QLabel(this);
+    _summaryLabel->setStyleSheet("font-size: 14px; padding: 5px;");
+    mainLayout->addWidget(_summaryLabel);
+
+    // 按项目经理汇总
+    QLabel* managersLabel = new QLabel("项目经理", this);
+    managersLabel->setStyleSheet("font-weight: bold;");
+    mainLayout->addWidget(managersLabel);
+
+    _managersTable = new QTableWidget(0, 5, this);
+    _managersTable->setHorizontalHeaderLabels(QStringList() << "项目经理" << "项目数" << "逾期项目" << "逾期节点" << "完成率(%)");
+    _managersTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    _managersTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    _managersTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    _managersTable->verticalHeader()->setVisible(false);
+    mainLayout->addWidget(_managersTable, 1);
+
+    // 各项目
+    QLabel* projectsLabel = new QLabel("项目", this);
+    projectsLabel->setStyleSheet("font-weight: bold;");
+    mainLayout->addWidget(projectsLabel);
+
+    _projectsTable = new QTableWidget(0, 7, this);
+    _projectsTable->setHorizontalHeaderLabels(QStringList() << "项目名称" << "项目经理" << "节点数" << "完成度(%)"
+                                                            << "逾期节点" << "文件数" << "文件大小");
+    _projectsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    _projectsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    _projectsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    _projectsTable->verticalHeader()->setVisible(false);
+    mainLayout->addWidget(_projectsTable, 2);
+}
+
+void DashboardWidget::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    onRefresh();
+}
+
+void DashboardWidget::onRefresh()
+{
+    // 上一次加载未返回时不重复提交
+    if(_loading) {
+        return;
+    }
+    _loading = true;
+    _refreshButton->setEnabled(false);
+
+    DataBaseExecutor::Instance()->RunRead([](DataBaseManagement* db) {
+        return db->GetProjectStatistics();
+    }, this, [this](const QVector<ProjectStatistics>& statistics) {
+        _loading = false;
+        _refreshButton->setEnabled(true);
+        populate(statistics);
+    });
+}
+
+void DashboardWidget::populate(const QVector<ProjectStatistics>& statistics)
+{
+    QDateTime now = QDateTime::currentDateTime();
+    QLocale locale;
+
+    int overdueProjectCount = 0;
+    int completedProjectCount = 0;
+    int nodeCount = 0;
+    int completedNodeCount = 0;
+    int overdueNodeCount = 0;
+    int fileCount = 0;
+    qint64 totalBytes = 0;
+    QMap<int, ManagerStatistics> managers;
+
+    _projectsTable->setSortingEnabled(false);
+    _projectsTable->setRowCount(statistics.size());
+    for(int row = 0; row < statistics.size(); ++row) {
+        const ProjectStatistics& item = statistics[row];
+        const Project& project = item.project;
+        bool overdue = IsOverdue(project, now);
+
+        overdueProjectCount += overdue ? 1 : 0;
+        completedProjectCount += project.isCompleted ? 1 : 0;
+        nodeCount += item.nodeCount;
+        completedNodeCount += item.completedCount;
+        overdueNodeCount += item.overdueCount;
+        fileCount += item.fileCount;
+        totalBytes += item.totalBytes;
+
+        ManagerStatistics& manager = managers[project.managerId];
+        manager.managerName = project.managerName.isEmpty() ? "（未指定）" : project.managerName;
+        ++manager.projectCount;
+        manager.overdueProjectCount += overdue ? 1 : 0;
+        manager.overdueNodeCount += item.overdueCount;
+        manager.nodeCount += item.nodeCount;
+        manager.completedCount += item.completedCount;
+
+        _projectsTable->setItem(row, 0, new QTableWidgetItem(project.name));
+        _projectsTable->setItem(row, 1, new QTableWidgetItem(project.managerName));
+        _projectsTable->setItem(row, 2, NumberItem(item.nodeCount));
+        _projectsTable->setItem(row, 3, NumberItem(Percent(item.completedCount, item.nodeCount)));
+        _projectsTable->setItem(row, 4, NumberItem(item.overdueCount));
+        _projectsTable->setItem(row, 5, NumberItem(item.fileCount));
+        _projectsTable->setItem(row, 6, new DataSizeItem(item.totalBytes));
+
+        if(overdue) {
+            _projectsTable->item(row, 0)->setForeground(QColor(Qt::red));
+        }
+        if(item.overdueCount > 0) {
+            _projectsTable->item(row, 4)->setForeground(QColor(Qt::red));
+        }
+    }
+    _projectsTable->setSortingEnabled(true);
+
+    _managersTable->setSortingEnabled(false);
+    _managersTable->setRowCount(managers.size());
+    int row = 0;
+    for(const ManagerStatistics& manager : managers) {
+        _managersTable->setItem(row, 0, new QTableWidgetItem(manager.managerName));
+        _managersTable->setItem(row, 1, NumberItem(manager.projectCount));
+        _managersTable->setItem(row, 2, NumberItem(manager.overdueProjectCount));
+        _managersTable->setItem(row, 3, NumberItem(manager.overdueNodeCount));
+        _managersTable->setItem(row, 4, NumberItem(Percent(manager.completedCount, manager.nodeCount)));
+        if(manager.overdueProjectCount > 0) {
+            _managersTable->item(row, 2)->setForeground(QColor(Qt::red));
+        }
+        ++row;
+    }
+    _managersTable->setSortingEnabled(true);
+
+    _summaryLabel->setText(QString("项目 %1 个（已完成 %2，逾期 %3）    节点 %4 个（完成 %5%，逾期 %6）    文件 %7 个，共 %8")
+                           .arg(statistics.size())
+                           .arg(completedProjectCount)
+                           .arg(overdueProjectCount)
+                           .arg(nodeCount)
+                           .arg(Percent(completedNodeCount, nodeCount))
+                           .arg(overdueNodeCount)
+                           .arg(fileCount)
+                           .arg(locale.formattedDataSize(totalBytes)));
+}
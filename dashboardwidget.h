@@ -0,0 +1,38 @@
+#ifndef DASHBOARDWIDGET_H
+#define DASHBOARDWIDGET_H
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QPushButton>
+#include <QLabel>
+#include "DBModels.h"
+
+// 统计概览
+// 只读取触发器维护的 project_stats 和 project_due_stats，每个项目一行，
+// 加载开销只与项目数有关，与节点数和文件数无关
+class DashboardWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit DashboardWidget(QWidget *parent = nullptr);
+    ~DashboardWidget();
+
+protected:
+    void showEvent(QShowEvent* event) override;
+
+private slots:
+    void onRefresh();
+
+private:
+    void setupUI();
+    void populate(const QVector<ProjectStatistics>& statistics);
+
+private:
+    QLabel* _summaryLabel;
+    QTableWidget* _managersTable;
+    QTableWidget* _projectsTable;
+    QPushButton* _refreshButton;
+    bool _loading;
+};
+
+#endif // DASHBOARDWIDGET_H
@@ -0,0 +1,29 @@
+#include "databaseexecutor.h"
+
+DataBaseExecutor::DataBaseExecutor(QObject* parent) : QObject(parent)
+{
+    // 单线程保证任务按提交顺序执行；线程常驻，避免反复打开数据库连接
+    _pool.setMaxThreadCount(1);
+    _pool.setExpiryTimeout(-1);
+
+    // 只读线程数与读连接池大小一致
+    _readerPool.setMaxThreadCount(DataBaseManagement::Instance()->Pool().ReaderPoolSize());
+    _readerPool.setExpiryTimeout(-1);
+}
+
+DataBaseExecutor::~DataBaseExecutor()
+{
+    WaitForDone();
+}
+
+DataBaseExecutor* DataBaseExecutor::Instance()
+{
+    static DataBaseExecutor executor;
+    return &executor;
+}
+
+void DataBaseExecutor::WaitForDone()
+{
+    _pool.waitForDone();
+    _readerPool.waitForDone();
+}
@@ -0,0 +1,78 @@
+#ifndef DATABASEEXECUTOR_H
+#define DATABASEEXECUTOR_H
+
+#include <QObject>
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrent>
+#include <type_traits>
+#include <utility>
+#include "Databasemanagement.h"
+
+// 数据库异步执行器
+// Run 提交的任务在同一个数据库工作线程上按提交顺序依次执行，该线程持有进程中唯一的写连接，
+// 所有写操作都在这里串行执行（DataBaseManagement 的写方法在其它线程调用时也会转交到这里）；
+// 界面线程只负责提交任务和接收结果，不再等待磁盘IO。
+// RunRead 提交的任务在只读线程池上并行执行，使用连接池中的只读连接。
+// 列表分页、详情加载等界面查询都用 RunRead，不在写线程上排在导入、索引等批量写入之后；
+// 结果可能不按提交顺序返回，调用方需要丢弃过期的结果。
+class DataBaseExecutor : public QObject
+{
+    Q_OBJECT
+public:
+    DataBaseExecutor(const DataBaseExecutor&) = delete;
+
+    DataBaseExecutor& operator=(const DataBaseExecutor&) = delete;
+
+    ~DataBaseExecutor();
+
+    static DataBaseExecutor* Instance();
+
+    // 在数据库线程上执行 func(DataBaseManagement*)，返回结果的 QFuture
+    template <typename Func>
+    auto Run(Func func) -> QFuture<std::invoke_result_t<Func, DataBaseManagement*>>
+    {
+        return QtConcurrent::run(&_pool, [func = std::move(func)]() {
+            DataBaseManagement* db = DataBaseManagement::Instance();
+            ConnectionPool::WriteScope scope(db->Pool());
+            return func(db);
+        });
+    }
+
+    // 在数据库线程上执行 func，完成后在 context 所在线程（通常为界面线程）调用 callback。
+    // context 在结果返回前被销毁时不会调用 callback
+    template <typename Func, typename Callback>
+    void Run(Func func, QObject* context, Callback callback)
+    {
+        Run(std::move(func)).then(context, std::move(callback));
+    }
+
+    // 在只读线程池上执行 func(DataBaseManagement*)，任务内只能执行查询
+    template <typename Func>
+    auto RunRead(Func func) -> QFuture<std::invoke_result_t<Func, DataBaseManagement*>>
+    {
+        return QtConcurrent::run(&_readerPool, [func = std::move(func)]() {
+            DataBaseManagement* db = DataBaseManagement::Instance();
+            ConnectionPool::ReadScope scope(db->Pool());
+            return func(db);
+        });
+    }
+
+    template <typename Func, typename Callback>
+    void RunRead(Func func, QObject* context, Callback callback)
+    {
+        RunRead(std::move(func)).then(context, std::move(callback));
+    }
+
+    // 等待已提交的任务全部完成
+    void WaitForDone();
+
+private:
+    explicit DataBaseExecutor(QObject* parent = nullptr);
+
+private:
+    QThreadPool _pool;
+    QThreadPool _readerPool;
+};
+
+#endif // DATABASEEXECUTOR_H
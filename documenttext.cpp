@@ -0,0 +1,264 @@
+#include <QXmlStreamReader>
+#include "documenttext.h"
+#include "zipreader.h"
+
+static const QString kWordNamespace = "http://schemas.openxmlformats.org/wordprocessingml/2006/main";
+
+// 中日韩文字没有空格分词，Word 按每个字计为一个词
+static bool IsCjkCharacter(char32_t c)
+{
+    return (c >= 0x4E00 && c <= 0x9FFF) ||     // 中日韩统一表意文字
+           (c >= 0x3400 && c <= 0x4DBF) ||     // 扩展A
+           (c >= 0x20000 && c <= 0x2FA1F) ||   // 扩展B及以后、兼容表意文字补充
+           (c >= 0xF900 && c <= 0xFAFF) ||     // 兼容表意文字
+           (c >= 0x3040 && c <= 0x30FF) ||     // 平假名、片假名
+           (c >= 0xAC00 && c <= 0xD7AF) ||     // 韩文音节
+           (c >= 0x3000 && c <= 0x303F) ||     // 中日韩标点
+           (c >= 0xFF00 && c <= 0xFFEF);       // 全角字符
+}
+
+static void CountWords(const QString& text, DocumentStatistics& statistics)
+{
+    int words = 0;
+    int characters = 0;
+    bool inWord = false;
+    for(char32_t c : QStringView(text).toUcs4())
+    {
+        if(QChar::isSpace(c))
+        {
+            inWord = false;
+            continue;
+        }
+
+        ++characters;
+        if(IsCjkCharacter(c))
+        {
+            ++words;
+            inWord = false;
+        }
+        else if(!inWord)
+        {
+            ++words;
+            inWord = true;
+        }
+    }
+
+    statistics.wordCount = words;
+    statistics.characterCount = characters;
+}
+
+// 解析 word/document.xml 提取正文，pageBreaks 不为空时同时统计分页位置
+static bool ParseDocumentXml(ZipReader& zip, QString& text, int* pageBreaks, QString* errorString)
+{
+    text.clear();
+
+    std::unique_ptr<ZipEntryReader> documentXml = zip.OpenEntry("word/document.xml");
+    if(!documentXml)
+    {
+        if(errorString)
+            *errorString = zip.ErrorString();
+        return false;
+    }
+
+    // Word 保存时在每个实际换页处写入 lastRenderedPageBreak，可能缺失或过期，
+    // 与手动分页符、分页的分节符数量取较大值
+    int renderedBreaks = 0;
+    int explicitBreaks = 0;
+    bool inParagraphProperties = false;
+
+    // 边解压边按事件流解析，不构建DOM，也不在内存中保留完整的XML
+    QXmlStreamReader xml(documentXml.get());
+    while(!xml.atEnd())
+    {
+        QXmlStreamReader::TokenType token = xml.readNext();
+        if(xml.namespaceUri() != kWordNamespace)
+            continue;
+
+        if(token == QXmlStreamReader::StartElement)
+        {
+            QStringView name = xml.name();
+            if(name == u"t")
+            {
+                text += xml.readElementText();
+            }
+            else if(name == u"tabs")
+            {
+                // 段落属性中的制表位定义，不是正文中的制表符
+                xml.skipCurrentElement();
+            }
+            else if(name == u"tab")
+            {
+                text += '\t';
+            }
+            else if(name == u"br" || name == u"cr")
+            {
+                text += '\n';
+                if(name == u"br" && xml.attributes().value(kWordNamespace, "type") == u"page")
+                    ++explicitBreaks;
+            }
+            else if(name == u"lastRenderedPageBreak")
+            {
+                ++renderedBreaks;
+            }
+            else if(name == u"pPr")
+            {
+                inParagraphProperties = true;
+            }
+            else if(name == u"pageBreakBefore")
+            {
+                QStringView value = xml.attributes().value(kWordNamespace, "val");
+                if(value.isEmpty() || value == u"1" || value == u"true" || value == u"on")
+                    ++explicitBreaks;
+            }
+            else if(name == u"sectPr" && inParagraphProperties)
+            {
+                // 段落中的节属性表示分节符，连续分节符不换页
+                bool continuous = false;
+                while(xml.readNextStartElement())
+                {
+                    if(xml.name() == u"type")
+                        continuous = xml.attributes().value(kWordNamespace, "val") == u"continuous";
+                    xml.skipCurrentElement();
+                }
+                if(!continuous)
+                    ++explicitBreaks;
+            }
+        }
+        else if(token == QXmlStreamReader::EndElement)
+        {
+            if(xml.name() == u"p")
+                text += '\n';
+            else if(xml.name() == u"pPr")
+                inParagraphProperties = false;
+        }
+    }
+
+    if(documentXml->HasError())
+    {
+        if(errorString)
+            *errorString = documentXml->errorString();
+        return false;
+    }
+
+    if(xml.hasError())
+    {
+        if(errorString)
+            *errorString = QString("解析 document.xml 失败: %1").arg(xml.errorString());
+        return false;
+    }
+
+    if(pageBreaks)
+        *pageBreaks = qMax(renderedBreaks, explicitBreaks);
+    return true;
+}
+
+// 读取 docProps/app.xml 中 Word 排版后的统计，最准确。hasWords、hasCharacters 表示对应的值是否存在
+static void ReadAppStatistics(ZipReader& zip, DocumentStatistics& statistics, bool& hasWords, bool& hasCharacters)
+{
+    hasWords = false;
+    hasCharacters = false;
+    QByteArray appXml;
+    if(!zip.Contains("docProps/app.xml") || !zip.Read("docProps/app.xml", appXml))
+        return;
+
+    QXmlStreamReader xml(appXml);
+    if(xml.readNextStartElement())
+    {
+        while(xml.readNextStartElement())
+        {
+            QStringView name = xml.name();
+            if(name == u"Pages")
+            {
+                statistics.pageCount = xml.readElementText().toInt();
+            }
+            else if(name == u"Words")
+            {
+                statistics.wordCount = xml.readElementText().toInt(&hasWords);
+            }
+            else if(name == u"Characters")
+            {
+                statistics.characterCount = xml.readElementText().toInt(&hasCharacters);
+            }
+            else
+            {
+                xml.skipCurrentElement();
+            }
+        }
+    }
+}
+
+static bool IsStatisticsComplete(const DocumentStatistics& statistics, bool hasWords, bool hasCharacters)
+{
+    return statistics.pageCount > 0 && hasWords && hasCharacters;
+}
+
+// 其它软件生成的文档可能没有这些统计，用正文补齐缺少的值
+static void FillStatistics(const QString& text, int pageBreaks, bool hasWords, bool hasCharacters,
+                           DocumentStatistics& statistics)
+{
+    if(statistics.pageCount <= 0)
+        statistics.pageCount = pageBreaks + 1;
+
+    if(!hasWords || !hasCharacters)
+    {
+        DocumentStatistics counted;
+        CountWords(text, counted);
+        if(!hasWords)
+            statistics.wordCount = counted.wordCount;
+        if(!hasCharacters)
+            statistics.characterCount = counted.characterCount;
+    }
+}
+
+bool ExtractDocxStatistics(const QString& filePath, DocumentStatistics& statistics, QString* errorString)
+{
+    statistics = DocumentStatistics();
+
+    ZipReader zip;
+    if(!zip.Open(filePath))
+    {
+        if(errorString)
+            *errorString = zip.ErrorString();
+        return false;
+    }
+
+    bool hasWords = false;
+    bool hasCharacters = false;
+    ReadAppStatistics(zip, statistics, hasWords, hasCharacters);
+    if(IsStatisticsComplete(statistics, hasWords, hasCharacters))
+        return true;
+
+    QString text;
+    int pageBreaks = 0;
+    if(!ParseDocumentXml(zip, text, &pageBreaks, errorString))
+        return false;
+
+    FillStatistics(text, pageBreaks, hasWords, hasCharacters, statistics);
+    return true;
+}
+
+bool ExtractDocxContent(const QString& filePath, QString& text, DocumentStatistics& statistics, QString* errorString)
+{
+    text.clear();
+    statistics = DocumentStatistics();
+
+    ZipReader zip;
+    if(!zip.Open(filePath))
+    {
+        if(errorString)
+            *errorString = zip.ErrorString();
+        return false;
+    }
+
+    bool hasWords = false;
+    bool hasCharacters = false;
+    ReadAppStatistics(zip, statistics, hasWords, hasCharacters);
+
+    // 正文总要提取，统计不全时直接用同一次解析的结果补齐
+    int pageBreaks = 0;
+    if(!ParseDocumentXml(zip, text, &pageBreaks, errorString))
+        return false;
+
+    FillStatistics(text, pageBreaks, hasWords, hasCharacters, statistics);
+    return true;
+}
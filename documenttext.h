@@ -0,0 +1,24 @@
+#ifndef DOCUMENTTEXT_H
+#define DOCUMENTTEXT_H
+
+#include <QString>
+
+// 文档统计信息，数值为0表示未知
+struct DocumentStatistics
+{
+    int pageCount = 0;
+    int wordCount = 0;
+    int characterCount = 0;     // 不含空白字符
+};
+
+// 读取 .docx 的页数、字数和字符数。优先使用 Word 保存时写入 docProps/app.xml 的统计，
+// 缺少时从 word/document.xml 统计：页数为分页符和分节符数加1，字数按中日韩文字每字一词计算
+bool ExtractDocxStatistics(const QString& filePath, DocumentStatistics& statistics, QString* errorString = nullptr);
+
+// 同时提取正文的纯文本和统计，只打开一次文档、解析一次 word/document.xml。
+// 段落之间以换行分隔，页眉页脚、批注和已删除的修订内容不包含在内；统计与 ExtractDocxStatistics 相同。
+// 失败时返回false，errorString 不为空时写入失败原因
+bool ExtractDocxContent(const QString& filePath, QString& text, DocumentStatistics& statistics,
+                        QString* errorString = nullptr);
+
+#endif // DOCUMENTTEXT_H
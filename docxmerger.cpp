@@ -0,0 +1,1224 @@
+#include <QDir>
+#include <QUrl>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include "docxmerger.h"
+
+namespace
+{
+    const QString kWordNs = "http://schemas.openxmlformats.org/wordprocessingml/2006/main";
+    const QString kRelationshipsNs = "http://schemas.openxmlformats.org/officeDocument/2006/relationships";
+    const QString kMarkupCompatibilityNs = "http://schemas.openxmlformats.org/markup-compatibility/2006";
+    const QString kVmlOfficeNs = "urn:schemas-microsoft-com:office:office";
+    const QString kXmlNs = "http://www.w3.org/XML/1998/namespace";
+    const QString kPackageRelationshipsNs = "http://schemas.openxmlformats.org/package/2006/relationships";
+    const QString kContentTypesNs = "http://schemas.openxmlformats.org/package/2006/content-types";
+
+    const QString kRelationshipTypeBase = "http://schemas.openxmlformats.org/officeDocument/2006/relationships/";
+    const QString kContentTypeBase = "application/vnd.openxmlformats-officedocument.wordprocessingml.";
+
+    const QByteArray kXmlDeclaration = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\r\n";
+
+    // 没有节属性的文档之间插入分页符
+    const QByteArray kPageBreakParagraph = "<w:p><w:r><w:br w:type=\"page\"/></w:r></w:p>";
+
+    // Word 常用的命名空间使用固定前缀，输出部件的根元素上总是声明这些命名空间
+    const QPair<QString, QString> kWellKnownNamespaces[] = {
+        {"w", kWordNs},
+        {"r", kRelationshipsNs},
+        {"mc", kMarkupCompatibilityNs},
+        {"o", kVmlOfficeNs},
+        {"v", "urn:schemas-microsoft-com:vml"},
+        {"w10", "urn:schemas-microsoft-com:office:word"},
+        {"m", "http://schemas.openxmlformats.org/officeDocument/2006/math"},
+        {"wp", "http://schemas.openxmlformats.org/drawingml/2006/wordprocessingDrawing"},
+        {"a", "http://schemas.openxmlformats.org/drawingml/2006/main"},
+        {"pic", "http://schemas.openxmlformats.org/drawingml/2006/picture"},
+        {"wne", "http://schemas.microsoft.com/office/word/2006/wordml"},
+        {"w14", "http://schemas.microsoft.com/office/word/2010/wordml"},
+        {"w15", "http://schemas.microsoft.com/office/word/2012/wordml"},
+        {"w16se", "http://schemas.microsoft.com/office/word/2015/wordml/symex"},
+        {"w16cid", "http://schemas.microsoft.com/office/word/2016/wordml/cid"},
+        {"w16", "http://schemas.microsoft.com/office/word/2018/wordml"},
+        {"w16cex", "http://schemas.microsoft.com/office/word/2018/wordml/cex"},
+        {"w16sdtdh", "http://schemas.microsoft.com/office/word/2020/wordml/sdtdatahash"},
+        {"wp14", "http://schemas.microsoft.com/office/word/2010/wordprocessingDrawing"},
+        {"wps", "http://schemas.microsoft.com/office/word/2010/wordprocessingShape"},
+        {"wpg", "http://schemas.microsoft.com/office/word/2010/wordprocessingGroup"},
+        {"wpc", "http://schemas.microsoft.com/office/word/2010/wordprocessingCanvas"},
+        {"wpi", "http://schemas.microsoft.com/office/word/2010/wordprocessingInk"},
+    };
+
+    // 从基础文档原样复制的文档级部件
+    const QStringList kBasePartTypes = {"settings", "webSettings", "fontTable", "theme", "customXml", "glossaryDocument"};
+    // 单独合并的部件
+    const QStringList kMergedPartTypes = {"styles", "numbering", "footnotes", "endnotes"};
+    // 不合并的部件，正文中对批注的引用在复制时移除
+    const QStringList kDroppedPartTypes = {"comments", "commentsExtended", "commentsIds", "commentsExtensible",
+                                           "people", "stylesWithEffects"};
+
+    // 关系类型的最后一段，如 .../relationships/styles 为 styles
+    QString RelationshipTypeName(const QString& type)
+    {
+        return type.section('/', -1);
+    }
+
+    QString PartDirectory(const QString& partName)
+    {
+        int slash = partName.lastIndexOf('/');
+        return slash < 0 ? QString() : partName.left(slash);
+    }
+
+    // 部件的关系文件，如 word/document.xml 对应 word/_rels/document.xml.rels，空部件名对应包关系
+    QString RelationshipsPath(const QString& partName)
+    {
+        int slash = partName.lastIndexOf('/');
+        return partName.left(slash + 1) + "_rels/" + partName.mid(slash + 1) + ".rels";
+    }
+
+    // 与主文档同目录的部件，如 word/styles.xml
+    QString SiblingPart(const QString& mainPart, const QString& fileName)
+    {
+        QString directory = PartDirectory(mainPart);
+        return directory.isEmpty() ? fileName : directory + "/" + fileName;
+    }
+
+    // 把关系中的目标解析为包内部件名
+    QString ResolveTarget(const QString& sourcePart, const QString& target)
+    {
+        QString decoded = QUrl::fromPercentEncoding(target.toUtf8());
+        if(decoded.startsWith('/'))
+            return QDir::cleanPath(decoded.mid(1));
+
+        QString directory = PartDirectory(sourcePart);
+        return QDir::cleanPath(directory.isEmpty() ? decoded : directory + "/" + decoded);
+    }
+
+    // 从 sourcePart 指向 targetPart 的相对目标
+    QString RelativeTarget(const QString& sourcePart, const QString& targetPart)
+    {
+        QString relative = QDir("/" + PartDirectory(sourcePart)).relativeFilePath("/" + targetPart);
+        return QString::fromUtf8(QUrl::toPercentEncoding(relative, "/"));
+    }
+
+    // 把若干元素写入缓冲区。外层的临时元素负责声明命名空间，取出内容时去掉，
+    // 各部分分别生成后拼接到统一声明了全部命名空间的根元素下
+    class FragmentWriter
+    {
+    public:
+        explicit FragmentWriter(const QVector<QPair<QString, QString>>& namespaces)
+            : _writer(&_buffer)
+        {
+            _writer.writeStartElement("fragment");
+            for(const auto& ns : namespaces)
+                _writer.writeNamespace(ns.first, ns.second);
+            // 写入空文本使临时元素的开始标签立即结束
+            _writer.writeCharacters(QString());
+            _start = _buffer.size();
+        }
+
+        QXmlStreamWriter& Writer()
+        {
+            return _writer;
+        }
+
+        QByteArray Content()
+        {
+            // 空元素的结束符在下一次写入时才输出
+            _writer.writeCharacters(QString());
+            return _buffer.mid(_start);
+        }
+
+    private:
+        QByteArray _buffer;
+        QXmlStreamWriter _writer;
+        qsizetype _start;
+    };
+
+    bool IsWordElement(const QXmlStreamReader& reader, QStringView name)
+    {
+        return reader.namespaceUri() == kWordNs && reader.name() == name;
+    }
+}
+
+DocxMerger::DocxMerger(const DocxMergeOptions& options)
+    : _options(options)
+{
+    Reset();
+}
+
+QString DocxMerger::ErrorString() const
+{
+    return _error;
+}
+
+QStringList DocxMerger::Warnings() const
+{
+    return _warnings;
+}
+
+void DocxMerger::SetProgressCallback(std::function<bool(int, int)> callback)
+{
+    _progressCallback = std::move(callback);
+}
+
+bool DocxMerger::Merge(const QVector<DocxMergeInput>& inputs, const QString& outputPath)
+{
+    Reset();
+
+    if(inputs.isEmpty())
+    {
+        _error = "没有需要合并的文档";
+        return false;
+    }
+
+    if(!_writer.Open(outputPath))
+    {
+        _error = _writer.ErrorString();
+        return false;
+    }
+
+    for(int i = 0; i < inputs.size(); ++i)
+    {
+        {
+            Source source;
+            source.index = i;
+            if(AddSource(source, inputs.at(i)))
+                Commit(source);
+            else if(!_error.isEmpty())
+            {
+                _writer.Abort();
+                return false;
+            }
+        }
+
+        if(_progressCallback && !_progressCallback(i + 1, inputs.size()))
+        {
+            _error = "合并已取消";
+            _writer.Abort();
+            return false;
+        }
+    }
+
+    if(!_hasBase)
+    {
+        _error = "没有可以合并的文档";
+        _writer.Abort();
+        return false;
+    }
+
+    if(!Finish())
+    {
+        _writer.Abort();
+        return false;
+    }
+    return true;
+}
+
+void DocxMerger::Reset()
+{
+    _error.clear();
+    _warnings.clear();
+    _reservedParts.clear();
+    _contentTypes = ContentTypes();
+
+    _namespacePrefixes.clear();
+    _usedPrefixes = {"xml", "xmlns"};
+    _namespaceOrder.clear();
+    _ignorablePrefixes.clear();
+    for(const auto& ns : kWellKnownNamespaces)
+        OutputPrefix(ns.second, ns.first);
+
+    _hasBase = false;
+    _mainPart.clear();
+    _mainContentType.clear();
+    _packageRelationships.clear();
+    _styleIds.clear();
+    _headingStyleId.clear();
+    _tocHeadingStyleId.clear();
+
+    _body.clear();
+    _lastSection.clear();
+    _styles.clear();
+    _abstractNums.clear();
+    _nums.clear();
+    _footnotes.clear();
+    _endnotes.clear();
+    _documentRelationships.clear();
+    _footnoteRelationships.clear();
+    _endnoteRelationships.clear();
+
+    _nextAbstractNumId = 0;
+    _nextNumId = 1;     // numId 0 表示取消编号
+    _nextFootnoteId = 1;
+    _nextEndnoteId = 1;
+    _nextBookmarkId = 0;
+}
+
+bool DocxMerger::AddSource(Source& source, const DocxMergeInput& input)
+{
+    // 文档中途失败时恢复编号和样式状态，已写入输出包的部件不再被引用
+    const int nextAbstractNumId = _nextAbstractNumId;
+    const int nextNumId = _nextNumId;
+    const int nextFootnoteId = _nextFootnoteId;
+    const int nextEndnoteId = _nextEndnoteId;
+    const QSet<QString> styleIds = _styleIds;
+    const QString headingStyleId = _headingStyleId;
+    const QString tocHeadingStyleId = _tocHeadingStyleId;
+    auto fail = [&]() {
+        _nextAbstractNumId = nextAbstractNumId;
+        _nextNumId = nextNumId;
+        _nextFootnoteId = nextFootnoteId;
+        _nextEndnoteId = nextEndnoteId;
+        _styleIds = styleIds;
+        _headingStyleId = headingStyleId;
+        _tocHeadingStyleId = tocHeadingStyleId;
+        return false;
+    };
+
+    source.filePath = input.filePath;
+    if(!source.zip.Open(input.filePath))
+    {
+        _warnings << QString("%1: %2").arg(input.filePath, source.zip.ErrorString());
+        return false;
+    }
+
+    QByteArray data;
+    if(!ReadPart(source, "[Content_Types].xml", data) || !ParseContentTypes(data, source.contentTypes) ||
+       !ReadRelationships(source, QString(), source.packageRelationships))
+    {
+        _warnings << QString("%1: 不是有效的Word文档").arg(input.filePath);
+        return false;
+    }
+
+    for(const Relationship& relationship : source.packageRelationships)
+    {
+        if(!relationship.external && RelationshipTypeName(relationship.type) == "officeDocument")
+        {
+            source.mainPart = ResolveTarget(QString(), relationship.target);
+            break;
+        }
+    }
+
+    if(source.mainPart.isEmpty() || !ReadRelationships(source, source.mainPart, source.mainRelationships))
+    {
+        _warnings << QString("%1: 不是有效的Word文档").arg(input.filePath);
+        return false;
+    }
+
+    source.isBase = !_hasBase;
+    source.prefix = QString("d%1_").arg(source.index);
+    source.outputMainPart = source.isBase ? source.mainPart : _mainPart;
+    source.bookmarkOffset = _nextBookmarkId;
+    source.firstSectionPending = !source.isBase;
+
+    if(source.isBase && !SetupBase(source))
+        return fail();
+
+    QString numbering = FindPart(source, "numbering");
+    if(!numbering.isEmpty() && !MergeNumbering(source, numbering))
+        return fail();
+
+    QString styles = FindPart(source, "styles");
+    if(!styles.isEmpty() && !MergeStyles(source, styles))
+        return fail();
+
+    QString footnotes = FindPart(source, "footnotes");
+    if(!footnotes.isEmpty() && !MergeNotes(source, footnotes, true))
+        return fail();
+
+    QString endnotes = FindPart(source, "endnotes");
+    if(!endnotes.isEmpty() && !MergeNotes(source, endnotes, false))
+        return fail();
+
+    if(!ImportRelationships(source, source.mainPart, source.mainRelationships, source.outputMainPart, true,
+                            source.relationshipIds, source.documentRelationships))
+        return fail();
+
+    if(!MergeBody(source, input.title))
+        return fail();
+
+    return true;
+}
+
+bool DocxMerger::SetupBase(Source& source)
+{
+    // 合并生成的部件名称预留出来，复制其它部件时不能占用
+    _reservedParts.clear();
+    _reservedParts << "[Content_Types].xml" << RelationshipsPath(QString()) << source.mainPart
+                   << RelationshipsPath(source.mainPart);
+    for(const QString& type : kMergedPartTypes)
+    {
+        QString partName = SiblingPart(source.mainPart, type + ".xml");
+        _reservedParts << partName << RelationshipsPath(partName);
+    }
+
+    // 设置、主题、字体表等原样复制，保留原有的关系ID
+    for(const Relationship& relationship : source.mainRelationships)
+    {
+        if(!kBasePartTypes.contains(RelationshipTypeName(relationship.type)))
+            continue;
+
+        Relationship copy = relationship;
+        if(!relationship.external)
+        {
+            QString target = ImportPart(source, ResolveTarget(source.mainPart, relationship.target), QString());
+            if(target.isEmpty())
+            {
+                if(!_error.isEmpty())
+                    return false;
+                continue;
+            }
+            copy.target = RelativeTarget(source.mainPart, target);
+        }
+        source.documentRelationships.append(copy);
+    }
+
+    // 包关系只保留主文档、核心属性和自定义属性，
+    // 扩展属性（页数、字数）和缩略图对合并后的文档已不适用
+    for(const Relationship& relationship : source.packageRelationships)
+    {
+        QString typeName = RelationshipTypeName(relationship.type);
+        Relationship copy = relationship;
+        if(typeName == "officeDocument")
+        {
+            copy.target = source.mainPart;
+        }
+        else if(!relationship.external && (typeName == "core-properties" || typeName == "custom-properties"))
+        {
+            QString target = ImportPart(source, ResolveTarget(QString(), relationship.target), QString());
+            if(target.isEmpty())
+            {
+                if(!_error.isEmpty())
+                    return false;
+                continue;
+            }
+            copy.target = target;
+        }
+        else
+        {
+            continue;
+        }
+        source.outputPackageRelationships.append(copy);
+    }
+    return true;
+}
+
+void DocxMerger::Commit(Source& source)
+{
+    if(source.isBase)
+    {
+        _hasBase = true;
+        _mainPart = source.mainPart;
+        _mainContentType = source.contentTypes.overrides.value("/" + source.mainPart,
+                                                               kContentTypeBase + "document.main+xml");
+        _packageRelationships = source.outputPackageRelationships;
+    }
+    else
+    {
+        // 上一个文档的最后一节放在它末尾的段落中，本文档从新的一节开始
+        _body += _lastSection.isEmpty() ? kPageBreakParagraph
+                                        : "<w:p><w:pPr>" + _lastSection + "</w:pPr></w:p>";
+    }
+
+    _body += source.body;
+    _lastSection = source.section;
+    _styles += source.styles;
+    _abstractNums += source.abstractNums;
+    _nums += source.nums;
+    _footnotes += source.footnotes;
+    _endnotes += source.endnotes;
+    _documentRelationships += source.documentRelationships;
+    _footnoteRelationships += source.footnoteRelationships;
+    _endnoteRelationships += source.endnoteRelationships;
+    _nextBookmarkId = source.bookmarkOffset + source.maxBookmarkId + 1;
+}
+
+bool DocxMerger::Finish()
+{
+    const QByteArray namespaces = RootNamespaceAttributes();
+    QVector<Relationship> relationships = _documentRelationships;
+
+    // 样式、编号、脚注等部件相互独立，先全部生成，再并行压缩写入
+    QVector<QPair<QString, QByteArray>> parts;
+    auto addPart = [&](const QString& fileName, const QString& rootName, const QByteArray& content,
+                       const QString& id, const QString& contentType) {
+        QString partName = SiblingPart(_mainPart, fileName);
+        parts.append({partName, kXmlDeclaration + "<w:" + rootName.toUtf8() + namespaces + ">" + content +
+                                "</w:" + rootName.toUtf8() + ">"});
+        _contentTypes.overrides.insert("/" + partName, kContentTypeBase + contentType);
+
+        Relationship relationship;
+        relationship.id = id;
+        relationship.type = kRelationshipTypeBase + rootName;
+        relationship.target = RelativeTarget(_mainPart, partName);
+        relationships.append(relationship);
+    };
+    auto addRelationships = [&](const QString& fileName, const QVector<Relationship>& partRelationships) {
+        if(!partRelationships.isEmpty())
+            parts.append({RelationshipsPath(SiblingPart(_mainPart, fileName)), WriteRelationships(partRelationships)});
+    };
+
+    addPart("styles.xml", "styles", _styles, "mergedStyles", "styles+xml");
+    if(!(_abstractNums.isEmpty() && _nums.isEmpty()))
+        addPart("numbering.xml", "numbering", _abstractNums + _nums, "mergedNumbering", "numbering+xml");
+    if(!_footnotes.isEmpty())
+    {
+        addPart("footnotes.xml", "footnotes", _footnotes, "mergedFootnotes", "footnotes+xml");
+        addRelationships("footnotes.xml", _footnoteRelationships);
+    }
+    if(!_endnotes.isEmpty())
+    {
+        addPart("endnotes.xml", "endnotes", _endnotes, "mergedEndnotes", "endnotes+xml");
+        addRelationships("endnotes.xml", _endnoteRelationships);
+    }
+    parts.append({RelationshipsPath(_mainPart), WriteRelationships(relationships)});
+    parts.append({RelationshipsPath(QString()), WriteRelationships(_packageRelationships)});
+
+    _contentTypes.overrides.insert("/" + _mainPart, _mainContentType);
+    _contentTypes.defaults.insert("rels", "application/vnd.openxmlformats-package.relationships+xml");
+    if(!_contentTypes.defaults.contains("xml"))
+        _contentTypes.defaults.insert("xml", "application/xml");
+
+    QString contentTypes = QString::fromUtf8(kXmlDeclaration) + "<Types xmlns=\"" + kContentTypesNs + "\">";
+    for(auto it = _contentTypes.defaults.constBegin(); it != _contentTypes.defaults.constEnd(); ++it)
+        contentTypes += QString("<Default Extension=\"%1\" ContentType=\"%2\"/>")
+                            .arg(it.key().toHtmlEscaped(), it.value().toHtmlEscaped());
+    for(auto it = _contentTypes.overrides.constBegin(); it != _contentTypes.overrides.constEnd(); ++it)
+        contentTypes += QString("<Override PartName=\"%1\" ContentType=\"%2\"/>")
+                            .arg(it.key().toHtmlEscaped(), it.value().toHtmlEscaped());
+    contentTypes += "</Types>";
+    parts.append({"[Content_Types].xml", contentTypes.toUtf8()});
+
+    if(!_writer.AddEntries(parts))
+    {
+        _error = _writer.ErrorString();
+        return false;
+    }
+
+    // 正文按片段直接写入压缩流，不再拼接成完整的 document.xml
+    QIODevice* document = _writer.BeginEntry(_mainPart);
+    if(!document)
+    {
+        _error = _writer.ErrorString();
+        return false;
+    }
+
+    document->write(kXmlDeclaration + "<w:document" + namespaces + "><w:body>");
+    if(_options.insertTableOfContents)
+    {
+        // 目录域标记为需要更新，Word 打开文档时提示更新域后生成目录
+        QByteArray title = _options.tableOfContentsTitle.toHtmlEscaped().toUtf8();
+        if(_tocHeadingStyleId.isEmpty())
+            document->write("<w:p><w:pPr><w:jc w:val=\"center\"/></w:pPr><w:r><w:rPr><w:b/><w:sz w:val=\"32\"/>"
+                            "</w:rPr><w:t>" + title + "</w:t></w:r></w:p>");
+        else
+            document->write("<w:p><w:pPr><w:pStyle w:val=\"" + _tocHeadingStyleId.toHtmlEscaped().toUtf8() +
+                            "\"/></w:pPr><w:r><w:t>" + title + "</w:t></w:r></w:p>");
+        document->write("<w:p><w:r><w:fldChar w:fldCharType=\"begin\" w:dirty=\"true\"/></w:r>"
+                        "<w:r><w:instrText xml:space=\"preserve\"> TOC \\o \"1-3\" \\h \\z \\u </w:instrText></w:r>"
+                        "<w:r><w:fldChar w:fldCharType=\"separate\"/></w:r>"
+                        "<w:r><w:t>" + QString("打开文档后更新域以生成目录").toUtf8() + "</w:t></w:r>"
+                        "<w:r><w:fldChar w:fldCharType=\"end\"/></w:r></w:p>");
+        document->write(kPageBreakParagraph);
+    }
+    document->write(_body);
+    document->write(_lastSection);
+    document->write("</w:body></w:document>");
+
+    if(!_writer.FinishEntry() || !_writer.Close())
+    {
+        _error = _writer.ErrorString();
+        return false;
+    }
+    return true;
+}
+
+bool DocxMerger::ReadPart(Source& source, const QString& partName, QByteArray& data)
+{
+    if(source.zip.Read(partName, data))
+        return true;
+
+    _warnings << QString("%1: %2").arg(source.filePath, source.zip.ErrorString());
+    return false;
+}
+
+bool DocxMerger::ReadRelationships(Source& source, const QString& partName, QVector<Relationship>& relationships)
+{
+    relationships.clear();
+
+    QString path = RelationshipsPath(partName);
+    if(!source.zip.Contains(path))
+        return true;
+
+    QByteArray data;
+    if(!ReadPart(source, path, data))
+        return false;
+
+    if(!ParseRelationships(data, relationships))
+    {
+        _warnings << QString("%1: 无法解析 %2").arg(source.filePath, path);
+        return false;
+    }
+    return true;
+}
+
+QString DocxMerger::FindPart(const Source& source, const QString& relationshipTypeName) const
+{
+    for(const Relationship& relationship : source.mainRelationships)
+    {
+        if(!relationship.external && RelationshipTypeName(relationship.type) == relationshipTypeName)
+            return ResolveTarget(source.mainPart, relationship.target);
+    }
+    return QString();
+}
+
+QString DocxMerger::ImportPart(Source& source, const QString& partName, const QString& prefix)
+{
+    // 多个关系指向同一部件时只复制一次，同时避免循环引用
+    auto it = source.importedParts.constFind(partName);
+    if(it != source.importedParts.constEnd())
+        return it.value();
+
+    ZipEntry entry;
+    QByteArray compressed;
+    if(!source.zip.ReadCompressed(partName, entry, compressed))
+    {
+        _warnings << QString("%1: %2").arg(source.filePath, source.zip.ErrorString());
+        return QString();
+    }
+
+    int slash = partName.lastIndexOf('/');
+    QString directory = partName.left(slash + 1);
+    QString fileName = partName.mid(slash + 1);
+    QString outputName = directory + prefix + fileName;
+    for(int n = 1; _writer.Contains(outputName) || _reservedParts.contains(outputName); ++n)
+        outputName = directory + prefix + QString::number(n) + "_" + fileName;
+    source.importedParts.insert(partName, outputName);
+
+    if(!_writer.AddCompressedEntry(outputName, entry, compressed))
+    {
+        _error = _writer.ErrorString();
+        return QString();
+    }
+    AddContentType(source, partName, outputName);
+
+    QVector<Relationship> relationships;
+    if(!ReadRelationships(source, partName, relationships) || relationships.isEmpty())
+        return outputName;
+
+    for(Relationship& relationship : relationships)
+    {
+        if(relationship.external)
+            continue;
+
+        QString target = ImportPart(source, ResolveTarget(partName, relationship.target), prefix);
+        if(target.isEmpty())
+        {
+            if(!_error.isEmpty())
+                return QString();
+            continue;
+        }
+        relationship.target = RelativeTarget(outputName, target);
+    }
+
+    if(!_writer.AddEntry(RelationshipsPath(outputName), WriteRelationships(relationships)))
+    {
+        _error = _writer.ErrorString();
+        return QString();
+    }
+    return outputName;
+}
+
+void DocxMerger::AddContentType(const Source& source, const QString& partName, const QString& outputName)
+{
+    auto it = source.contentTypes.overrides.constFind("/" + partName);
+    if(it != source.contentTypes.overrides.constEnd())
+    {
+        _contentTypes.overrides.insert("/" + outputName, it.value());
+        return;
+    }
+
+    QString extension = partName.section('.', -1).toLower();
+    QString contentType = source.contentTypes.defaults.value(extension);
+    if(contentType.isEmpty())
+        return;
+
+    // 不同文档对同一扩展名的默认类型不一致时改用覆盖项
+    auto existing = _contentTypes.defaults.constFind(extension);
+    if(existing == _contentTypes.defaults.constEnd())
+        _contentTypes.defaults.insert(extension, contentType);
+    else if(existing.value() != contentType)
+        _contentTypes.overrides.insert("/" + outputName, contentType);
+}
+
+bool DocxMerger::ImportRelationships(Source& source, const QString& partName, const QVector<Relationship>& relationships,
+                                     const QString& outputPartName, bool documentPart,
+                                     QHash<QString, QString>& idMap, QVector<Relationship>& output)
+{
+    for(const Relationship& relationship : relationships)
+    {
+        if(documentPart)
+        {
+            QString typeName = RelationshipTypeName(relationship.type);
+            if(kBasePartTypes.contains(typeName) || kMergedPartTypes.contains(typeName) ||
+               kDroppedPartTypes.contains(typeName))
+                continue;
+        }
+
+        Relationship copy = relationship;
+        copy.id = source.prefix + relationship.id;
+        if(!relationship.external)
+        {
+            QString target = ImportPart(source, ResolveTarget(partName, relationship.target), source.prefix);
+            if(target.isEmpty())
+            {
+                if(!_error.isEmpty())
+                    return false;
+                continue;
+            }
+            copy.target = RelativeTarget(outputPartName, target);
+        }
+        idMap.insert(relationship.id, copy.id);
+        output.append(copy);
+    }
+    return true;
+}
+
+bool DocxMerger::MergeNumbering(Source& source, const QString& partName)
+{
+    QByteArray data;
+    if(!ReadPart(source, partName, data))
+        return false;
+
+    QXmlStreamReader reader(data);
+    if(!reader.readNextStartElement())
+    {
+        _warnings << QString("%1: 无法解析 %2").arg(source.filePath, partName);
+        return false;
+    }
+    RegisterNamespaces(source, reader);
+
+    // abstractNum 必须全部位于 num 之前，分别写入后再拼接。
+    // 图片项目符号引用的图片不复制，这类列表使用 Word 的默认符号
+    FragmentWriter abstractNums(_namespaceOrder);
+    FragmentWriter nums(_namespaceOrder);
+    const QHash<QString, QString> noRelationships;
+    while(reader.readNextStartElement())
+    {
+        if(IsWordElement(reader, u"abstractNum"))
+        {
+            QString id = reader.attributes().value(kWordNs, "abstractNumId").toString();
+            source.abstractNumIds.insert(id, QString::number(_nextAbstractNumId++));
+            CopyElement(source, reader, abstractNums.Writer(), noRelationships);
+        }
+        else if(IsWordElement(reader, u"num"))
+        {
+            QString id = reader.attributes().value(kWordNs, "numId").toString();
+            source.numIds.insert(id, QString::number(_nextNumId++));
+            CopyElement(source, reader, nums.Writer(), noRelationships);
+        }
+        else
+        {
+            reader.skipCurrentElement();
+        }
+    }
+
+    if(reader.hasError())
+    {
+        _warnings << QString("%1: %2: %3").arg(source.filePath, partName, reader.errorString());
+        return false;
+    }
+
+    source.abstractNums = abstractNums.Content();
+    source.nums = nums.Content();
+    return true;
+}
+
+bool DocxMerger::MergeStyles(Source& source, const QString& partName)
+{
+    QByteArray data;
+    if(!ReadPart(source, partName, data))
+        return false;
+
+    // 基础文档中查找一级标题和目录标题样式，样式ID随语言不同，按内置名称查找
+    if(source.isBase)
+    {
+        QXmlStreamReader scanner(data);
+        QString styleId;
+        while(!scanner.atEnd())
+        {
+            if(scanner.readNext() != QXmlStreamReader::StartElement)
+                continue;
+
+            if(IsWordElement(scanner, u"style"))
+            {
+                styleId = scanner.attributes().value(kWordNs, "styleId").toString();
+            }
+            else if(IsWordElement(scanner, u"name") && !styleId.isEmpty())
+            {
+                QString name = scanner.attributes().value(kWordNs, "val").toString();
+                if(name.compare(u"heading 1", Qt::CaseInsensitive) == 0)
+                    _headingStyleId = styleId;
+                else if(name.compare(u"TOC Heading", Qt::CaseInsensitive) == 0)
+                    _tocHeadingStyleId = styleId;
+                styleId.clear();
+            }
+        }
+    }
+
+    QXmlStreamReader reader(data);
+    if(!reader.readNextStartElement())
+    {
+        _warnings << QString("%1: 无法解析 %2").arg(source.filePath, partName);
+        return false;
+    }
+    RegisterNamespaces(source, reader);
+
+    // 基础文档的样式全部保留，其它文档只添加ID未出现过的样式
+    FragmentWriter styles(_namespaceOrder);
+    const QHash<QString, QString> noRelationships;
+    while(reader.readNextStartElement())
+    {
+        if(IsWordElement(reader, u"style"))
+        {
+            QString styleId = reader.attributes().value(kWordNs, "styleId").toString();
+            if(!source.isBase && _styleIds.contains(styleId))
+            {
+                reader.skipCurrentElement();
+                continue;
+            }
+            _styleIds.insert(styleId);
+            CopyElement(source, reader, styles.Writer(), noRelationships);
+        }
+        else if(source.isBase)
+        {
+            // 默认格式 docDefaults 和隐藏样式 latentStyles
+            CopyElement(source, reader, styles.Writer(), noRelationships);
+        }
+        else
+        {
+            reader.skipCurrentElement();
+        }
+    }
+
+    if(reader.hasError())
+    {
+        _warnings << QString("%1: %2: %3").arg(source.filePath, partName, reader.errorString());
+        return false;
+    }
+
+    source.styles = styles.Content();
+    return true;
+}
+
+bool DocxMerger::MergeNotes(Source& source, const QString& partName, bool footnotes)
+{
+    QByteArray data;
+    if(!ReadPart(source, partName, data))
+        return false;
+
+    QVector<Relationship> relationships;
+    if(!ReadRelationships(source, partName, relationships))
+        return false;
+
+    QHash<QString, QString>& relationshipIds = footnotes ? source.footnoteRelationshipIds : source.endnoteRelationshipIds;
+    QVector<Relationship>& outputRelationships = footnotes ? source.footnoteRelationships : source.endnoteRelationships;
+    QString outputPart = SiblingPart(source.outputMainPart, footnotes ? "footnotes.xml" : "endnotes.xml");
+    if(!ImportRelationships(source, partName, relationships, outputPart, false, relationshipIds, outputRelationships))
+        return false;
+
+    QXmlStreamReader reader(data);
+    if(!reader.readNextStartElement())
+    {
+        _warnings << QString("%1: 无法解析 %2").arg(source.filePath, partName);
+        return false;
+    }
+    RegisterNamespaces(source, reader);
+
+    const QStringView element = footnotes ? u"footnote" : u"endnote";
+    int& nextId = footnotes ? _nextFootnoteId : _nextEndnoteId;
+    QHash<QString, QString>& ids = footnotes ? source.footnoteIds : source.endnoteIds;
+
+    // 分隔线等特殊脚注只保留基础文档的，普通脚注重新编号
+    FragmentWriter notes(_namespaceOrder);
+    while(reader.readNextStartElement())
+    {
+        if(!IsWordElement(reader, element))
+        {
+            reader.skipCurrentElement();
+            continue;
+        }
+
+        QXmlStreamAttributes attributes = reader.attributes();
+        QString id = attributes.value(kWordNs, "id").toString();
+        QStringView type = attributes.value(kWordNs, "type");
+        if(!type.isEmpty() && type != u"normal")
+        {
+            if(!source.isBase)
+            {
+                reader.skipCurrentElement();
+                continue;
+            }
+            ids.insert(id, id);
+            nextId = qMax(nextId, id.toInt() + 1);
+        }
+        else
+        {
+            ids.insert(id, QString::number(nextId++));
+        }
+        CopyElement(source, reader, notes.Writer(), relationshipIds);
+    }
+
+    if(reader.hasError())
+    {
+        _warnings << QString("%1: %2: %3").arg(source.filePath, partName, reader.errorString());
+        return false;
+    }
+
+    (footnotes ? source.footnotes : source.endnotes) = notes.Content();
+    return true;
+}
+
+bool DocxMerger::MergeBody(Source& source, const QString& title)
+{
+    // 正文可能很大，边解压边解析
+    std::unique_ptr<ZipEntryReader> data = source.zip.OpenEntry(source.mainPart);
+    if(!data)
+    {
+        _warnings << QString("%1: %2").arg(source.filePath, source.zip.ErrorString());
+        return false;
+    }
+
+    QXmlStreamReader reader(data.get());
+    if(!reader.readNextStartElement() || !IsWordElement(reader, u"document"))
+    {
+        _warnings << QString("%1: 不是有效的Word文档").arg(source.filePath);
+        return false;
+    }
+    RegisterNamespaces(source, reader);
+
+    bool hasBody = false;
+    while(reader.readNextStartElement())
+    {
+        if(IsWordElement(reader, u"body"))
+        {
+            hasBody = true;
+            break;
+        }
+        reader.skipCurrentElement();
+    }
+
+    if(!hasBody)
+    {
+        _warnings << QString("%1: 文档没有正文").arg(source.filePath);
+        return false;
+    }
+
+    FragmentWriter body(_namespaceOrder);
+    if(!title.isEmpty())
+    {
+        // 文档标题作为一级标题，目录按它生成
+        QXmlStreamWriter& writer = body.Writer();
+        writer.writeStartElement(kWordNs, "p");
+        writer.writeStartElement(kWordNs, "pPr");
+        if(!_headingStyleId.isEmpty())
+        {
+            writer.writeEmptyElement(kWordNs, "pStyle");
+            writer.writeAttribute(kWordNs, "val", _headingStyleId);
+        }
+        writer.writeEmptyElement(kWordNs, "outlineLvl");
+        writer.writeAttribute(kWordNs, "val", "0");
+        writer.writeEndElement();
+        writer.writeStartElement(kWordNs, "r");
+        writer.writeStartElement(kWordNs, "t");
+        writer.writeAttribute("xml:space", "preserve");
+        writer.writeCharacters(title);
+        writer.writeEndElement();
+        writer.writeEndElement();
+        writer.writeEndElement();
+    }
+
+    while(reader.readNextStartElement())
+    {
+        if(IsWordElement(reader, u"sectPr"))
+        {
+            FragmentWriter section(_namespaceOrder);
+            CopyElement(source, reader, section.Writer(), source.relationshipIds);
+            source.section = section.Content();
+        }
+        else
+        {
+            CopyElement(source, reader, body.Writer(), source.relationshipIds);
+        }
+    }
+
+    if(data->HasError() || reader.hasError())
+    {
+        _warnings << QString("%1: %2").arg(source.filePath, data->HasError() ? data->errorString() : reader.errorString());
+        return false;
+    }
+
+    source.body = body.Content();
+    return true;
+}
+
+void DocxMerger::RegisterNamespaces(Source& source, QXmlStreamReader& reader)
+{
+    for(const QXmlStreamNamespaceDeclaration& declaration : reader.namespaceDeclarations())
+    {
+        QString prefix = declaration.prefix().toString();
+        QString uri = declaration.namespaceUri().toString();
+        source.namespaces.insert(prefix, uri);
+        OutputPrefix(uri, prefix);
+    }
+
+    // 可忽略的命名空间汇总到输出部件的根元素上
+    QString ignorable = reader.attributes().value(kMarkupCompatibilityNs, "Ignorable").toString();
+    for(const QString& prefix : TranslatePrefixes(source, ignorable, false).split(' ', Qt::SkipEmptyParts))
+    {
+        if(!_ignorablePrefixes.contains(prefix))
+            _ignorablePrefixes.append(prefix);
+    }
+}
+
+QString DocxMerger::OutputPrefix(const QString& namespaceUri, const QString& preferredPrefix)
+{
+    auto it = _namespacePrefixes.constFind(namespaceUri);
+    if(it != _namespacePrefixes.constEnd())
+        return it.value();
+
+    // 不同文档可能用同一前缀表示不同命名空间，冲突时加数字后缀
+    QString prefix = preferredPrefix.isEmpty() ? QString("ns") : preferredPrefix;
+    if(_usedPrefixes.contains(prefix))
+    {
+        int n = 1;
+        while(_usedPrefixes.contains(prefix + QString::number(n)))
+            ++n;
+        prefix += QString::number(n);
+    }
+
+    _namespacePrefixes.insert(namespaceUri, prefix);
+    _usedPrefixes.insert(prefix);
+    _namespaceOrder.append({namespaceUri, prefix});
+    return prefix;
+}
+
+QString DocxMerger::TranslatePrefixes(const Source& source, const QString& value, bool qualifiedNames) const
+{
+    QStringList tokens = value.split(' ', Qt::SkipEmptyParts);
+    for(QString& token : tokens)
+    {
+        int colon = qualifiedNames ? token.indexOf(':') : token.size();
+        if(colon < 0)
+            continue;
+
+        QString uri = source.namespaces.value(token.left(colon));
+        if(!uri.isEmpty())
+            token = _namespacePrefixes.value(uri, token.left(colon)) + token.mid(colon);
+    }
+    return tokens.join(' ');
+}
+
+void DocxMerger::CopyElement(Source& source, QXmlStreamReader& reader, QXmlStreamWriter& writer,
+                             const QHash<QString, QString>& relationshipIds)
+{
+    // 元素路径，Word 命名空间的元素记录本地名，其它记为空
+    QVector<QString> path;
+    while(!reader.atEnd())
+    {
+        switch(reader.tokenType())
+        {
+        case QXmlStreamReader::StartElement:
+        {
+            const QString namespaceUri = reader.namespaceUri().toString();
+            const QString name = reader.name().toString();
+            const bool isWord = namespaceUri == kWordNs;
+
+            // 批注不合并，移除正文中的批注标记；图片项目符号的图片不复制；
+            // 后续文档第一节的分节类型去掉，使其从新页开始
+            bool skip = isWord && (name == "commentRangeStart" || name == "commentRangeEnd" ||
+                                   name == "commentReference" || name == "numPicBullet" ||
+                                   name == "lvlPicBulletId" || name == "numIdMacAtCleanup" ||
+                                   (name == "type" && !path.isEmpty() && path.last() == "sectPr" &&
+                                    source.firstSectionPending));
+            if(skip)
+            {
+                reader.skipCurrentElement();
+                if(path.isEmpty())
+                    return;
+                break;
+            }
+
+            for(const QXmlStreamNamespaceDeclaration& declaration : reader.namespaceDeclarations())
+            {
+                QString prefix = declaration.prefix().toString();
+                QString uri = declaration.namespaceUri().toString();
+                source.namespaces.insert(prefix, uri);
+                writer.writeNamespace(uri, OutputPrefix(uri, prefix));
+            }
+
+            if(namespaceUri.isEmpty())
+                writer.writeStartElement(name);
+            else
+                writer.writeStartElement(namespaceUri, name);
+
+            const bool isChoice = namespaceUri == kMarkupCompatibilityNs && name == "Choice";
+            for(const QXmlStreamAttribute& attribute : reader.attributes())
+            {
+                const QString attributeNs = attribute.namespaceUri().toString();
+                const QString attributeName = attribute.name().toString();
+                QString value = attribute.value().toString();
+
+                if(attributeNs == kRelationshipsNs || (attributeNs == kVmlOfficeNs && attributeName == "relid"))
+                {
+                    value = relationshipIds.value(value, value);
+                }
+                else if(attributeNs == kMarkupCompatibilityNs || (isChoice && attributeNs.isEmpty()))
+                {
+                    if(attributeName == "Ignorable" || attributeName == "Requires" || attributeName == "MustUnderstand")
+                        value = TranslatePrefixes(source, value, false);
+                    else if(attributeName == "ProcessContent" || attributeName == "PreserveElements" ||
+                             attributeName == "PreserveAttributes")
+                        value = TranslatePrefixes(source, value, true);
+                }
+                else if(isWord && attributeNs == kWordNs)
+                {
+                    // 默认样式以基础文档为准
+                    if(name == "style" && attributeName == "default" && !source.isBase)
+                        continue;
+                    value = RewriteWordAttribute(source, name, attributeName, value);
+                }
+
+                if(attributeNs.isEmpty())
+                    writer.writeAttribute(attributeName, value);
+                else if(attributeNs == kXmlNs)
+                    writer.writeAttribute("xml:" + attributeName, value);
+                else
+                    writer.writeAttribute(attributeNs, attributeName, value);
+            }
+
+            path.append(isWord ? name : QString());
+            break;
+        }
+        case QXmlStreamReader::EndElement:
+            if(path.last() == "sectPr")
+                source.firstSectionPending = false;
+            path.removeLast();
+            writer.writeEndElement();
+            if(path.isEmpty())
+                return;
+            break;
+        case QXmlStreamReader::Characters:
+            if(reader.isCDATA())
+                writer.writeCDATA(reader.text().toString());
+            else
+                writer.writeCharacters(reader.text().toString());
+            break;
+        default:
+            // 注释和处理指令不复制
+            break;
+        }
+        reader.readNext();
+    }
+}
+
+QString DocxMerger::RewriteWordAttribute(Source& source, const QString& element, const QString& attribute,
+                                         const QString& value)
+{
+    if(attribute == "val")
+    {
+        if(element == "numId")
+            return source.numIds.value(value, value);
+        if(element == "abstractNumId")
+            return source.abstractNumIds.value(value, value);
+    }
+    else if(attribute == "numId" && element == "num")
+    {
+        return source.numIds.value(value, value);
+    }
+    else if(attribute == "abstractNumId" && element == "abstractNum")
+    {
+        return source.abstractNumIds.value(value, value);
+    }
+    else if(attribute == "id")
+    {
+        if(element == "footnoteReference" || element == "footnote")
+            return source.footnoteIds.value(value, value);
+        if(element == "endnoteReference" || element == "endnote")
+            return source.endnoteIds.value(value, value);
+        if(element == "bookmarkStart" || element == "bookmarkEnd")
+        {
+            bool ok = false;
+            int id = value.toInt(&ok);
+            if(!ok)
+                return value;
+            source.maxBookmarkId = qMax(source.maxBookmarkId, id);
+            return QString::number(id + source.bookmarkOffset);
+        }
+    }
+    return value;
+}
+
+QByteArray DocxMerger::RootNamespaceAttributes() const
+{
+    QString attributes;
+    for(const auto& ns : _namespaceOrder)
+        attributes += QString(" xmlns:%1=\"%2\"").arg(ns.second, ns.first.toHtmlEscaped());
+    if(!_ignorablePrefixes.isEmpty())
+        attributes += QString(" %1:Ignorable=\"%2\"")
+                          .arg(_namespacePrefixes.value(kMarkupCompatibilityNs), _ignorablePrefixes.join(' '));
+    return attributes.toUtf8();
+}
+
+bool DocxMerger::ParseRelationships(const QByteArray& data, QVector<Relationship>& relationships)
+{
+    QXmlStreamReader reader(data);
+    while(!reader.atEnd())
+    {
+        if(reader.readNext() != QXmlStreamReader::StartElement || reader.name() != u"Relationship")
+            continue;
+
+        QXmlStreamAttributes attributes = reader.attributes();
+        Relationship relationship;
+        relationship.id = attributes.value("Id").toString();
+        relationship.type = attributes.value("Type").toString();
+        relationship.target = attributes.value("Target").toString();
+        relationship.external = attributes.value("TargetMode") == u"External";
+        relationships.append(relationship);
+    }
+    return !reader.hasError();
+}
+
+QByteArray DocxMerger::WriteRelationships(const QVector<Relationship>& relationships)
+{
+    QString xml = QString::fromUtf8(kXmlDeclaration) + "<Relationships xmlns=\"" + kPackageRelationshipsNs + "\">";
+    for(const Relationship& relationship : relationships)
+    {
+        xml += QString("<Relationship Id=\"%1\" Type=\"%2\" Target=\"%3\"%4/>")
+                   .arg(relationship.id.toHtmlEscaped(), relationship.type.toHtmlEscaped(),
+                        relationship.target.toHtmlEscaped(),
+                        relationship.external ? QString(" TargetMode=\"External\"") : QString());
+    }
+    xml += "</Relationships>";
+    return xml.toUtf8();
+}
+
+bool DocxMerger::ParseContentTypes(const QByteArray& data, ContentTypes& contentTypes)
+{
+    QXmlStreamReader reader(data);
+    while(!reader.atEnd())
+    {
+        if(reader.readNext() != QXmlStreamReader::StartElement)
+            continue;
+
+        QXmlStreamAttributes attributes = reader.attributes();
+        if(reader.name() == u"Default")
+            contentTypes.defaults.insert(attributes.value("Extension").toString().toLower(),
+                                         attributes.value("ContentType").toString());
+        else if(reader.name() == u"Override")
+            contentTypes.overrides.insert(attributes.value("PartName").toString(),
+                                          attributes.value("ContentType").toString());
+    }
+    return !reader.hasError();
+}
@@ -0,0 +1,211 @@
+#ifndef DOCXMERGER_H
+#define DOCXMERGER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+#include "zipreader.h"
+#include "zipwriter.h"
+
+class QXmlStreamReader;
+class QXmlStreamWriter;
+
+// 参与合并的文档
+struct DocxMergeInput
+{
+    QString filePath;
+    QString title;      // 插入在该文档内容前的一级标题，为空时不插入
+};
+
+// 合并选项
+struct DocxMergeOptions
+{
+    // 在开头插入目录域，打开文档后更新域即可生成目录
+    bool insertTableOfContents = true;
+    QString tableOfContentsTitle = "目录";
+};
+
+// 合并结果，用于从工作线程返回界面线程
+struct DocxMergeResult
+{
+    bool success = false;
+    QString errorString;
+    QStringList warnings;
+};
+
+// DOCX 文档合并器
+// 以第一个文档为基础（页面设置、主题、字体、样式），依次追加每个文档的正文，
+// 每个文档单独成节并从新页开始。图片、页眉页脚、图表等部件按文档改名后原样复制，
+// 关系ID、列表编号、脚注尾注和书签ID重新编号，同名样式以第一个文档的定义为准。
+// 只读写ZIP包和XML，不依赖 Word 或 Python，可以在任意线程中运行。
+// 不支持 ZIP64：输出超过4GB或超过65535个部件时合并失败，ZIP64格式的输入文档跳过并记入警告。
+class DocxMerger
+{
+public:
+    explicit DocxMerger(const DocxMergeOptions& options = DocxMergeOptions());
+
+    DocxMerger(const DocxMerger&) = delete;
+    DocxMerger& operator=(const DocxMerger&) = delete;
+
+    // 合并到 outputPath，无法读取的输入文档跳过并记入 Warnings()。
+    // 没有任何文档可以合并、写入失败或被取消时返回false，目标文件保持不变
+    bool Merge(const QVector<DocxMergeInput>& inputs, const QString& outputPath);
+
+    QString ErrorString() const;
+    QStringList Warnings() const;
+
+    // 每处理完一个输入文档调用一次，返回false时取消合并
+    void SetProgressCallback(std::function<bool(int finished, int total)> callback);
+
+private:
+    // 包内关系
+    struct Relationship
+    {
+        QString id;
+        QString type;
+        QString target;
+        bool external = false;
+    };
+
+    // 内容类型表，扩展名统一为小写
+    struct ContentTypes
+    {
+        QHash<QString, QString> defaults;   // 扩展名 -> 内容类型
+        QHash<QString, QString> overrides;  // "/部件名" -> 内容类型
+    };
+
+    // 正在合并的一个输入文档。合并结果先写入这里，整个文档成功后才提交到输出
+    struct Source
+    {
+        int index = 0;
+        bool isBase = false;                    // 第一个成功读取的文档作为基础文档
+        QString filePath;
+        QString prefix;                         // 复制部件时加在文件名前的前缀
+        ZipReader zip;
+        ContentTypes contentTypes;
+        QString mainPart;                       // 主文档部件，通常为 word/document.xml
+        QString outputMainPart;                 // 输出包中的主文档部件
+        QVector<Relationship> packageRelationships;
+        QVector<Relationship> mainRelationships;
+        QHash<QString, QString> namespaces;     // 文档中的前缀 -> 命名空间
+        QHash<QString, QString> importedParts;  // 输入部件名 -> 输出部件名
+
+        // 旧编号 -> 新编号
+        QHash<QString, QString> relationshipIds;
+        QHash<QString, QString> footnoteRelationshipIds;
+        QHash<QString, QString> endnoteRelationshipIds;
+        QHash<QString, QString> abstractNumIds;
+        QHash<QString, QString> numIds;
+        QHash<QString, QString> footnoteIds;
+        QHash<QString, QString> endnoteIds;
+        int bookmarkOffset = 0;
+        int maxBookmarkId = -1;
+        bool firstSectionPending = false;       // 第一节尚未复制，需要强制从新页开始
+
+        // 待提交的内容
+        QByteArray body;
+        QByteArray section;                     // 文档末尾的节属性 w:sectPr
+        QByteArray styles;
+        QByteArray abstractNums;
+        QByteArray nums;
+        QByteArray footnotes;
+        QByteArray endnotes;
+        QVector<Relationship> documentRelationships;
+        QVector<Relationship> footnoteRelationships;
+        QVector<Relationship> endnoteRelationships;
+        QVector<Relationship> outputPackageRelationships;
+    };
+
+    void Reset();
+    bool AddSource(Source& source, const DocxMergeInput& input);
+    bool SetupBase(Source& source);
+    void Commit(Source& source);
+    bool Finish();
+
+    bool ReadPart(Source& source, const QString& partName, QByteArray& data);
+    bool ReadRelationships(Source& source, const QString& partName, QVector<Relationship>& relationships);
+    QString FindPart(const Source& source, const QString& relationshipTypeName) const;
+
+    // 复制输入文档中的部件及其引用的部件，返回输出部件名。
+    // 部件不存在时记入警告并返回空字符串，写入失败时同时设置错误信息
+    QString ImportPart(Source& source, const QString& partName, const QString& prefix);
+    void AddContentType(const Source& source, const QString& partName, const QString& outputName);
+
+    // 导入 partName 的关系，outputPartName 为输出包中引用这些关系的部件。
+    // documentPart 为true时跳过文档级部件（样式、设置等），它们由基础文档提供或单独合并
+    bool ImportRelationships(Source& source, const QString& partName, const QVector<Relationship>& relationships,
+                             const QString& outputPartName, bool documentPart,
+                             QHash<QString, QString>& idMap, QVector<Relationship>& output);
+
+    bool MergeNumbering(Source& source, const QString& partName);
+    bool MergeStyles(Source& source, const QString& partName);
+    bool MergeNotes(Source& source, const QString& partName, bool footnotes);
+    bool MergeBody(Source& source, const QString& title);
+
+    // 记录根元素声明的命名空间和 mc:Ignorable，为新命名空间分配输出前缀
+    void RegisterNamespaces(Source& source, QXmlStreamReader& reader);
+    QString OutputPrefix(const QString& namespaceUri, const QString& preferredPrefix);
+    QString TranslatePrefixes(const Source& source, const QString& value, bool qualifiedNames) const;
+
+    // 复制 reader 当前所在的元素及其子树，同时按 source 中的映射改写编号和关系ID
+    void CopyElement(Source& source, QXmlStreamReader& reader, QXmlStreamWriter& writer,
+                     const QHash<QString, QString>& relationshipIds);
+    QString RewriteWordAttribute(Source& source, const QString& element, const QString& attribute, const QString& value);
+
+    // 所有输出部件根元素上的命名空间声明
+    QByteArray RootNamespaceAttributes() const;
+
+    static bool ParseRelationships(const QByteArray& data, QVector<Relationship>& relationships);
+    static QByteArray WriteRelationships(const QVector<Relationship>& relationships);
+    static bool ParseContentTypes(const QByteArray& data, ContentTypes& contentTypes);
+
+private:
+    DocxMergeOptions _options;
+    std::function<bool(int, int)> _progressCallback;
+    QString _error;
+    QStringList _warnings;
+
+    ZipWriter _writer;
+    QSet<QString> _reservedParts;           // 合并后生成的部件，复制时不能占用这些名称
+    ContentTypes _contentTypes;
+
+    // 输出命名空间：命名空间 -> 前缀，以及按声明顺序排列的 (命名空间, 前缀)
+    QHash<QString, QString> _namespacePrefixes;
+    QSet<QString> _usedPrefixes;
+    QVector<QPair<QString, QString>> _namespaceOrder;
+    QStringList _ignorablePrefixes;
+
+    // 基础文档
+    bool _hasBase;
+    QString _mainPart;
+    QString _mainContentType;
+    QVector<Relationship> _packageRelationships;
+    QSet<QString> _styleIds;
+    QString _headingStyleId;
+    QString _tocHeadingStyleId;
+
+    // 合并后的部件内容（不含根元素）及其关系
+    QByteArray _body;
+    QByteArray _lastSection;
+    QByteArray _styles;
+    QByteArray _abstractNums;
+    QByteArray _nums;
+    QByteArray _footnotes;
+    QByteArray _endnotes;
+    QVector<Relationship> _documentRelationships;
+    QVector<Relationship> _footnoteRelationships;
+    QVector<Relationship> _endnoteRelationships;
+
+    int _nextAbstractNumId;
+    int _nextNumId;
+    int _nextFootnoteId;
+    int _nextEndnoteId;
+    int _nextBookmarkId;
+};
+
+#endif // DOCXMERGER_H
@@ -0,0 +1,304 @@
+#include <QMutexLocker>
+#include "entitycache.h"
+
+// 按 order 的顺序取出完整列表
+template <typename Table, typename T>
+static bool ReadAll(const Table& table, QVector<T>& values)
+{
+    if(!table.complete)
+    {
+        return false;
+    }
+
+    values.clear();
+    values.reserve(table.order.size());
+    for(int id : table.order)
+    {
+        values.append(table.items.value(id));
+    }
+    return true;
+}
+
+template <typename Table, typename T>
+static void WriteAll(Table& table, const QVector<T>& values)
+{
+    table.items.clear();
+    table.order.clear();
+    table.items.reserve(values.size());
+    table.order.reserve(values.size());
+    for(const T& value : values)
+    {
+        table.items.insert(value.id, value);
+        table.order.append(value.id);
+    }
+    table.complete = true;
+}
+
+// 删除一个条目，完整列表随之失效
+template <typename Table>
+static bool RemoveItem(Table& table, int id)
+{
+    table.complete = false;
+    table.order.clear();
+    return table.items.remove(id);
+}
+
+EntityCache::EntityCache()
+    : _hits(0)
+    , _misses(0)
+    , _staleStores(0)
+    , _invalidations(0)
+{
+    _generations[Users] = 0;
+    _generations[Projects] = 0;
+    _generations[Nodes] = 0;
+}
+
+quint64 EntityCache::Generation(Table table) const
+{
+    QMutexLocker locker(&_mutex);
+    return _generations[table];
+}
+
+bool EntityCache::FindUser(int userId, User& user)
+{
+    QMutexLocker locker(&_mutex);
+    auto it = _users.items.constFind(userId);
+    if(it == _users.items.constEnd())
+    {
+        ++_misses;
+        return false;
+    }
+
+    ++_hits;
+    user = it.value();
+    return true;
+}
+
+bool EntityCache::FindAllUsers(QVector<User>& users)
+{
+    QMutexLocker locker(&_mutex);
+    bool found = ReadAll(_users, users);
+    found ? ++_hits : ++_misses;
+    return found;
+}
+
+void EntityCache::StoreUser(const User& user, quint64 generation)
+{
+    QMutexLocker locker(&_mutex);
+    if(AcceptStore(Users, generation))
+    {
+        _users.items.insert(user.id, user);
+    }
+}
+
+void EntityCache::StoreAllUsers(const QVector<User>& users, quint64 generation)
+{
+    QMutexLocker locker(&_mutex);
+    if(AcceptStore(Users, generation))
+    {
+        WriteAll(_users, users);
+    }
+}
+
+bool EntityCache::FindProject(int projectId, Project& project)
+{
+    QMutexLocker locker(&_mutex);
+    auto it = _projects.items.constFind(projectId);
+    if(it == _projects.items.constEnd())
+    {
+        ++_misses;
+        return false;
+    }
+
+    ++_hits;
+    project = it.value();
+    return true;
+}
+
+bool EntityCache::FindAllProjects(QVector<Project>& projects)
+{
+    QMutexLocker locker(&_mutex);
+    bool found = ReadAll(_projects, projects);
+    found ? ++_hits : ++_misses;
+    return found;
+}
+
+void EntityCache::StoreProject(const Project& project, quint64 generation)
+{
+    QMutexLocker locker(&_mutex);
+    if(AcceptStore(Projects, generation))
+    {
+        _projects.items.insert(project.id, project);
+    }
+}
+
+void EntityCache::StoreAllProjects(const QVector<Project>& projects, quint64 generation)
+{
+    QMutexLocker locker(&_mutex);
+    if(AcceptStore(Projects, generation))
+    {
+        WriteAll(_projects, projects);
+    }
+}
+
+bool EntityCache::FindProjectNodes(int projectId, QVector<ProjectNode>& nodes)
+{
+    QMutexLocker locker(&_mutex);
+    auto it = _nodesByProject.constFind(projectId);
+    if(it == _nodesByProject.constEnd())
+    {
+        ++_misses;
+        return false;
+    }
+
+    ++_hits;
+    nodes = it.value();
+    return true;
+}
+
+void EntityCache::StoreProjectNodes(int projectId, const QVector<ProjectNode>& nodes, quint64 generation)
+{
+    QMutexLocker locker(&_mutex);
+    if(!AcceptStore(Nodes, generation))
+    {
+        return;
+    }
+
+    RemoveProjectNodes(projectId);
+    _nodesByProject.insert(projectId, nodes);
+    for(const ProjectNode& node : nodes)
+    {
+        _nodeProjects.insert(node.id, projectId);
+    }
+}
+
+void EntityCache::InvalidateUserList()
+{
+    QMutexLocker locker(&_mutex);
+    ++_generations[Users];
+    _users.complete = false;
+    _users.order.clear();
+}
+
+void EntityCache::InvalidateProjectList()
+{
+    QMutexLocker locker(&_mutex);
+    ++_generations[Projects];
+    _projects.complete = false;
+    _projects.order.clear();
+}
+
+void EntityCache::InvalidateUser(int userId)
+{
+    QMutexLocker locker(&_mutex);
+    ++_generations[Users];
+    if(RemoveItem(_users, userId))
+    {
+        ++_invalidations;
+    }
+}
+
+void EntityCache::InvalidateProjectsByManager(int userId)
+{
+    QMutexLocker locker(&_mutex);
+    ++_generations[Projects];
+    _projects.complete = false;
+    _projects.order.clear();
+
+    for(auto it = _projects.items.begin(); it != _projects.items.end();)
+    {
+        if(it.value().managerId == userId)
+        {
+            it = _projects.items.erase(it);
+            ++_invalidations;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void EntityCache::InvalidateProject(int projectId)
+{
+    QMutexLocker locker(&_mutex);
+    ++_generations[Projects];
+    if(RemoveItem(_projects, projectId))
+    {
+        ++_invalidations;
+    }
+}
+
+void EntityCache::InvalidateProjectNodes(int projectId)
+{
+    QMutexLocker locker(&_mutex);
+    ++_generations[Nodes];
+    if(RemoveProjectNodes(projectId))
+    {
+        ++_invalidations;
+    }
+}
+
+void EntityCache::InvalidateNode(int nodeId)
+{
+    QMutexLocker locker(&_mutex);
+    ++_generations[Nodes];
+    auto it = _nodeProjects.constFind(nodeId);
+    if(it != _nodeProjects.constEnd() && RemoveProjectNodes(it.value()))
+    {
+        ++_invalidations;
+    }
+}
+
+void EntityCache::Clear()
+{
+    QMutexLocker locker(&_mutex);
+    ++_generations[Users];
+    ++_generations[Projects];
+    ++_generations[Nodes];
+    _users = EntityTable<User>();
+    _projects = EntityTable<Project>();
+    _nodesByProject.clear();
+    _nodeProjects.clear();
+}
+
+EntityCacheStats EntityCache::Stats() const
+{
+    QMutexLocker locker(&_mutex);
+    EntityCacheStats stats;
+    stats.hits = _hits;
+    stats.misses = _misses;
+    stats.staleStores = _staleStores;
+    stats.invalidations = _invalidations;
+    stats.users = _users.items.size();
+    stats.projects = _projects.items.size();
+    stats.nodeLists = _nodesByProject.size();
+    return stats;
+}
+
+bool EntityCache::RemoveProjectNodes(int projectId)
+{
+    auto it = _nodesByProject.find(projectId);
+    if(it == _nodesByProject.end())
+    {
+        return false;
+    }
+
+    for(const ProjectNode& node : it.value())
+    {
+        _nodeProjects.remove(node.id);
+    }
+    _nodesByProject.erase(it);
+    return true;
+}
+
+bool EntityCache::AcceptStore(Table table, quint64 generation)
+{
+    if(generation != _generations[table])
+    {
+        ++_staleStores;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,99 @@
+#ifndef ENTITYCACHE_H
+#define ENTITYCACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+#include "DBModels.h"
+
+// 实体缓存统计信息
+struct EntityCacheStats
+{
+    quint64 hits;           // 命中次数
+    quint64 misses;         // 未命中（需要查询数据库）次数
+    quint64 staleStores;    // 查询期间发生写入而丢弃的结果数
+    quint64 invalidations;  // 失效的条目数
+    int users;              // 当前缓存的用户数
+    int projects;           // 当前缓存的项目数
+    int nodeLists;          // 当前缓存了节点列表的项目数
+};
+
+// 用户、项目和项目节点的进程内缓存
+// 用户和项目按ID缓存，节点按所属项目缓存整个列表；读取完整列表后标记为完整，之后列表查询也不再访问数据库。
+// 每类实体有一个代数，写入后使相关条目失效并增加代数。查询前记下代数，结果返回时代数已变化
+// 说明查询期间有写入，结果可能来自写入前的快照，不放入缓存。
+// 数据库工作线程和只读线程池会同时访问，所有方法都是线程安全的。
+class EntityCache
+{
+public:
+    enum Table
+    {
+        Users,
+        Projects,
+        Nodes
+    };
+
+    EntityCache();
+
+    EntityCache(const EntityCache&) = delete;
+    EntityCache& operator=(const EntityCache&) = delete;
+
+    // 查询数据库前取得代数，放入缓存时传回
+    quint64 Generation(Table table) const;
+
+    bool FindUser(int userId, User& user);
+    bool FindAllUsers(QVector<User>& users);
+    void StoreUser(const User& user, quint64 generation);
+    void StoreAllUsers(const QVector<User>& users, quint64 generation);
+
+    bool FindProject(int projectId, Project& project);
+    bool FindAllProjects(QVector<Project>& projects);
+    void StoreProject(const Project& project, quint64 generation);
+    void StoreAllProjects(const QVector<Project>& projects, quint64 generation);
+
+    bool FindProjectNodes(int projectId, QVector<ProjectNode>& nodes);
+    void StoreProjectNodes(int projectId, const QVector<ProjectNode>& nodes, quint64 generation);
+
+    // 新增用户或项目时只需使完整列表失效
+    void InvalidateUserList();
+    void InvalidateProjectList();
+    void InvalidateUser(int userId);
+    // 项目经理为 userId 的项目，用户名或用户删除后项目中的经理信息随之改变
+    void InvalidateProjectsByManager(int userId);
+    void InvalidateProject(int projectId);
+    void InvalidateProjectNodes(int projectId);
+    // 节点所在项目的节点列表，节点未缓存时不做处理
+    void InvalidateNode(int nodeId);
+
+    void Clear();
+
+    EntityCacheStats Stats() const;
+
+private:
+    // 按ID缓存的一类实体，complete 为true时 order 是完整列表的顺序
+    template <typename T>
+    struct EntityTable
+    {
+        QHash<int, T> items;
+        QVector<int> order;
+        bool complete = false;
+    };
+
+    bool RemoveProjectNodes(int projectId);
+    bool AcceptStore(Table table, quint64 generation);
+
+private:
+    mutable QMutex _mutex;
+    EntityTable<User> _users;
+    EntityTable<Project> _projects;
+    QHash<int, QVector<ProjectNode>> _nodesByProject;
+    QHash<int, int> _nodeProjects;      // 已缓存节点的ID到项目ID
+    quint64 _generations[3];
+
+    quint64 _hits;
+    quint64 _misses;
+    quint64 _staleStores;
+    quint64 _invalidations;
+};
+
+#endif // ENTITYCACHE_H
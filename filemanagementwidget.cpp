@@ -1,6 +1,13 @@
-#include <Python.h>
 #include "filemanagementwidget.h"
 #include "Databasemanagement.h"
+#include "blobstore.h"
+#include "bulkimporter.h"
+#include "filetablemodel.h"
+#include "contentindexer.h"
+#include "databaseexecutor.h"
+#include "docxmerger.h"
+#include "documenttext.h"
+#include "filetransfer.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QHeaderView>
@@ -10,7 +17,6 @@
 #include <QDateTime>
 #include <QtPrintSupport/QPrinter>
 #include <QtPrintSupport/QPrintDialog>
-#include <QTextDocument>
 #include <QProgressDialog>
 #include <QDebug>
 #include <QProcess>
@@ -20,26 +26,71 @@
 #include <QTemporaryDir>
 #include <QApplication>
 #include <QTimer>
-#include <QEventLoop>
+#include <QCheckBox>
 #include <QCoreApplication>
-#include <QThread>
-#include <vector>
-#include <string>
+#include <QPointer>
+#include <QtConcurrent/QtConcurrent>
+#include <atomic>
+#include <memory>
+
+// 把秒数格式化为"x小时y分z秒"
+static QString FormatDuration(int seconds)
+{
+    if(seconds >= 3600)
+        return QString("%1小时%2分").arg(seconds / 3600).arg(seconds % 3600 / 60);
+    if(seconds >= 60)
+        return QString("%1分%2秒").arg(seconds / 60).arg(seconds % 60);
+    return QString("%1秒").arg(seconds);
+}
+
+// 上传一个文件的结果
+struct UploadResult
+{
+    bool success = false;
+    QString errorString;
+    FileInfo file;
+};
+
+// 复制到内容存储区并提取文档统计，需要读取整个文件，在工作线程中执行
+static UploadResult PrepareUpload(const QString& sourcePath, FileInfo file)
+{
+    UploadResult result;
+
+    // 相同内容的文件只保存一份，之后不再依赖原始文件的位置
+    BlobInfo blob;
+    if(!BlobStore::Instance()->Store(sourcePath, blob, &result.errorString))
+        return result;
+
+    file.filePath = blob.path;
+    file.fileSize = blob.size;
+    file.contentHash = blob.hash;
+
+    // 上传时提取页数和字数保存到文件记录，列表显示时不再打开文档
+    DocumentStatistics statistics;
+    if(file.fileExtension == "docx")
+    {
+        QString error;
+        if(!ExtractDocxStatistics(blob.path, statistics, &error))
+            qDebug() << "无法读取文档统计信息：" << error;
+    }
+    file.pageCount = statistics.pageCount;
+    file.wordCount = statistics.wordCount;
+    file.characterCount = statistics.characterCount;
+
+    result.success = true;
+    result.file = file;
+    return result;
+}
 
 FileManagementWidget::FileManagementWidget(QWidget *parent) : QWidget(parent)
 {
+    _importer = new BulkImporter(this);
     setupUI();
-    // 初始化Python解释器
-    Py_Initialize();
 }
 
 FileManagementWidget::~FileManagementWidget()
 {
-    if(Py_IsInitialized())
-    {
-        Py_Finalize();
-        qDebug() << "成功终止python解释器";
-    }
+
 }
 
 void FileManagementWidget::setCurrentUser(const User &user)
@@ -90,18 +141,31 @@ void FileManagementWidget::setupFileListView()
     _searchBox = new QLineEdit(_fileListView);
     _searchBox->setPlaceholderText("搜索文件...");
     connect(_searchBox, &QLineEdit::returnPressed, this, &FileManagementWidget::onSearchFile);
+    // 输入停顿后自动搜索，回车立即搜索
+    _searchTimer = new QTimer(this);
+    _searchTimer->setSingleShot(true);
+    _searchTimer->setInterval(300);
+    connect(_searchTimer, &QTimer::timeout, this, &FileManagementWidget::onSearchFile);
+    connect(_searchBox, &QLineEdit::textChanged, _searchTimer, qOverload<>(&QTimer::start));
     toolLayout->addWidget(_searchBox);
+
+    // 同时搜索已建立索引的文档正文
+    _searchContentCheck = new QCheckBox("搜索正文", _fileListView);
+    connect(_searchContentCheck, &QCheckBox::toggled, this, &FileManagementWidget::onSearchFile);
+    toolLayout->addWidget(_searchContentCheck);
     
     // 操作按钮
     QPushButton* processDocButton = new QPushButton("过程文档", _fileListView);
     QPushButton* recycleBinButton = new QPushButton("回收站", _fileListView);
     _uploadButton = new QPushButton("上传文件", _fileListView);
+    _importButton = new QPushButton("批量导入", _fileListView);
     _downloadButton = new QPushButton("下载文件", _fileListView);
     _deleteButton = new QPushButton("删除文件", _fileListView);
     
     connect(processDocButton, &QPushButton::clicked, this, &FileManagementWidget::onProcessDocument);
     connect(recycleBinButton, &QPushButton::clicked, this, &FileManagementWidget::onRecycleBin);
     connect(_uploadButton, &QPushButton::clicked, this, &FileManagementWidget::onUploadFile);
+    connect(_importButton, &QPushButton::clicked, this, &FileManagementWidget::onImportDirectory);
     connect(_downloadButton, &QPushButton::clicked, this, &FileManagementWidget::onDownloadFile);
     connect(_deleteButton, &QPushButton::clicked, this, &FileManagementWidget::onDeleteFile);
     
@@ -109,15 +173,16 @@ void FileManagementWidget::setupFileListView()
     toolLayout->addWidget(processDocButton);
     toolLayout->addWidget(recycleBinButton);
     toolLayout->addWidget(_uploadButton);
+    toolLayout->addWidget(_importButton);
     toolLayout->addWidget(_downloadButton);
     toolLayout->addWidget(_deleteButton);
     
     layout->addLayout(toolLayout);
     
     // 文件表格
-    _filesTable = new QTableWidget(_fileListView);
-    _filesTable->setColumnCount(6);
-    _filesTable->setHorizontalHeaderLabels({"ID", "文件名", "类型", "大小", "上传者", "上传时间"});
+    _filesModel = new FileTableModel(FileTableModel::Layout::FileList, this);
+    _filesTable = new QTableView(_fileListView);
+    _filesTable->setModel(_filesModel);
     _filesTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     _filesTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     _filesTable->setSelectionMode(QAbstractItemView::ExtendedSelection);
@@ -149,19 +214,8 @@ void FileManagementWidget::setupProcessDocumentsView()
     // 打印文档按钮连接
     connect(_printDocButton, &QPushButton::clicked, [this]() {
         // 打印选中的文档
-        QList<QTableWidgetItem*> selectedItems = _docsTable->selectedItems();
-        if(selectedItems.count() == 0) {
-            QMessageBox::warning(this, "提示", "请先选择要打印的文档");
-            return;
-        }
-        
-        // 获取选中的行
-        QSet<int> selectedRows;
-        for(const QTableWidgetItem* item : selectedItems) {
-            selectedRows.insert(item->row());
-        }
-        
-        if(selectedRows.size() == 0) {
+        QModelIndexList selectedRows = _docsTable->selectionModel()->selectedRows();
+        if(selectedRows.isEmpty()) {
             QMessageBox::warning(this, "提示", "请先选择要打印的文档");
             return;
         }
@@ -172,26 +226,14 @@ void FileManagementWidget::setupProcessDocumentsView()
             return;
         }
         
-        int row = *selectedRows.begin(); // 获取选中的行
-        int docId = _docsTable->item(row, 0)->text().toInt();
-        QString docName = _docsTable->item(row, 1)->text();
-        
-        // 获取所有文件数据
-        QVector<FileInfo> allFiles = DataBaseManagement::Instance()->GetAllFiles();
+        int row = selectedRows.first().row(); // 获取选中的行
+        int docId = _docsModel->FileIdAt(row);
+        QString docName = _docsModel->DisplayNameAt(row);
         
-        // 查找文件信息
-        FileInfo fileInfo;
-        bool found = false;
+        // 按主键查询文件信息
+        FileInfo fileInfo = DataBaseManagement::Instance()->GetFileById(docId);
         
-        for(const FileInfo& file : allFiles) {
-            if(file.id == docId) {
-                fileInfo = file;
-                found = true;
-                break;
-            }
-        }
-        
-        if(!found) {
+        if(fileInfo.id < 0) {
             QMessageBox::warning(this, "错误", "无法找到选中的文档");
             return;
         }
@@ -211,32 +253,22 @@ void FileManagementWidget::setupProcessDocumentsView()
         }
         
         // 根据文档类型处理
-        QString ext = qFileInfo.suffix().toLower();
-        QFile file(fileInfo.filePath);
-        
-        if(file.open(QIODevice::ReadOnly)) {
-            // 读取文件内容
-            QByteArray fileData = file.readAll();
-            file.close();
-            
-            // 对于Word文档，我们需要使用系统调用来打印
-            // 临时创建要打印的文件的副本
-            QString tempFilePath = QDir::tempPath() + "/" + qFileInfo.fileName();
-            QFile tempFile(tempFilePath);
-            if(tempFile.open(QIODevice::WriteOnly)) {
-                tempFile.write(fileData);
-                tempFile.close();
-                
+        // 存储区中的文件按内容哈希命名，扩展名和文件名以文件记录为准
+        QString ext = fileInfo.fileExtension.toLower();
+        
+        // 对于Word文档，我们需要使用系统调用来打印
+        // 在后台线程创建要打印的文件的副本，文件内容不读入内存
+        QString tempFilePath = QDir::tempPath() + "/" + fileInfo.fileName;
+        CopyFileInBackground(this, "正在准备打印...", fileInfo.filePath, tempFilePath,
+                             [this, tempFilePath](const FileTransferResult& result) {
+            if(result.success) {
                 // 使用ShellExecute打印
                 QProcess::startDetached("rundll32.exe", QStringList() << "shell32.dll,ShellExec_RunDLL" << "print" << QDir::toNativeSeparators(tempFilePath));
                 QMessageBox::information(this, "打印文档", "已将文档发送到打印队列");
             } else {
-                QMessageBox::warning(this, "错误", "无法创建临时文件用于打印");
+                QMessageBox::warning(this, "错误", "无法创建临时文件用于打印：" + result.errorString);
             }
-
-        } else {
-            QMessageBox::warning(this, "错误", "无法读取文件内容");
-        }
+        });
     });
     
     // 整理文档按钮连接
@@ -252,9 +284,9 @@ void FileManagementWidget::setupProcessDocumentsView()
     layout->addLayout(toolLayout);
     
     // 文档表格
-    _docsTable = new QTableWidget(_processDocView);
-    _docsTable->setColumnCount(5);
-    _docsTable->setHorizontalHeaderLabels({"ID", "文档名", "类型", "上传者", "上传时间"});
+    _docsModel = new FileTableModel(FileTableModel::Layout::ProcessDocuments, this);
+    _docsTable = new QTableView(_processDocView);
+    _docsTable->setModel(_docsModel);
     _docsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     _docsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     _docsTable->setSelectionMode(QAbstractItemView::ExtendedSelection);
@@ -284,8 +316,8 @@ void FileManagementWidget::setupRecycleBinView()
     });
     connect(_restoreButton, &QPushButton::clicked, [this]() {
         // 恢复选中的文件
-        QList<QTableWidgetSelectionRange> ranges = _deletedFilesTable->selectedRanges();
-        if(ranges.isEmpty()) {
+        QModelIndexList selectedRows = _deletedFilesTable->selectionModel()->selectedRows();
+        if(selectedRows.isEmpty()) {
             QMessageBox::warning(this, "提示", "请先选择要恢复的文件");
             return;
         }
@@ -294,20 +326,12 @@ void FileManagementWidget::setupRecycleBinView()
         int failCount = 0;
         
         // 遍历所有选中的行
-        QSet<int> processedRows;
-        for(const QTableWidgetSelectionRange& range : ranges) {
-            for(int row = range.topRow(); row <= range.bottomRow(); ++row) {
-                if(processedRows.contains(row)) {
-                    continue; // 跳过已处理的行
-                }
-                processedRows.insert(row);
-                
-                int fileId = _deletedFilesTable->item(row, 0)->text().toInt();
-                if(DataBaseManagement::Instance()->RestoreFile(fileId)) {
-                    successCount++;
-                } else {
-                    failCount++;
-                }
+        for(const QModelIndex& index : selectedRows) {
+            int fileId = _deletedFilesModel->FileIdAt(index.row());
+            if(DataBaseManagement::Instance()->RestoreFile(fileId)) {
+                successCount++;
+            } else {
+                failCount++;
             }
         }
         
@@ -323,13 +347,13 @@ void FileManagementWidget::setupRecycleBinView()
     });
     connect(_permanentDeleteButton, &QPushButton::clicked, [this]() {
         // 永久删除选中的文件
-        QList<QTableWidgetSelectionRange> ranges = _deletedFilesTable->selectedRanges();
-        if(ranges.isEmpty()) {
+        QModelIndexList selectedRows = _deletedFilesTable->selectionModel()->selectedRows();
+        if(selectedRows.isEmpty()) {
             QMessageBox::warning(this, "提示", "请先选择要删除的文件");
             return;
         }
         
-        if(QMessageBox::question(this, "确认删除", QString("确定要永久删除选中的%1个文件吗？此操作不可恢复！").arg(ranges.size()),
+        if(QMessageBox::question(this, "确认删除", QString("确定要永久删除选中的%1个文件吗？此操作不可恢复！").arg(selectedRows.size()),
                                 QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes) {
             return;
         }
@@ -338,20 +362,12 @@ void FileManagementWidget::setupRecycleBinView()
         int failCount = 0;
         
         // 遍历所有选中的行
-        QSet<int> processedRows;
-        for(const QTableWidgetSelectionRange& range : ranges) {
-            for(int row = range.topRow(); row <= range.bottomRow(); ++row) {
-                if(processedRows.contains(row)) {
-                    continue; // 跳过已处理的行
-                }
-                processedRows.insert(row);
-                
-                int fileId = _deletedFilesTable->item(row, 0)->text().toInt();
-                if(DataBaseManagement::Instance()->DeleteFile(fileId, true)) {
-                    successCount++;
-                } else {
-                    failCount++;
-                }
+        for(const QModelIndex& index : selectedRows) {
+            int fileId = _deletedFilesModel->FileIdAt(index.row());
+            if(DataBaseManagement::Instance()->DeleteFile(fileId, true)) {
+                successCount++;
+            } else {
+                failCount++;
             }
         }
         
@@ -374,9 +390,9 @@ void FileManagementWidget::setupRecycleBinView()
     layout->addLayout(toolLayout);
     
     // 已删除文件表格
-    _deletedFilesTable = new QTableWidget(_recycleBinView);
-    _deletedFilesTable->setColumnCount(5);
-    _deletedFilesTable->setHorizontalHeaderLabels({"ID", "文件名", "类型", "上传者", "删除时间"});
+    _deletedFilesModel = new FileTableModel(FileTableModel::Layout::RecycleBin, this);
+    _deletedFilesTable = new QTableView(_recycleBinView);
+    _deletedFilesTable->setModel(_deletedFilesModel);
     _deletedFilesTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     _deletedFilesTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     _deletedFilesTable->setSelectionMode(QAbstractItemView::ExtendedSelection);
@@ -390,125 +406,28 @@ void FileManagementWidget::setupRecycleBinView()
 
 void FileManagementWidget::loadFileData()
 {
-    // 根据当前视图加载不同的数据
+    // 根据当前视图加载不同的数据，筛选和分页在数据库中完成，表格只加载滚动到的页
     int currentIndex = _stackedWidget->currentIndex();
     
     if(currentIndex == 0) {
         // 文件列表视图
-        _filesTable->setRowCount(0);
-        
-        // 获取所有文件
-        QVector<FileInfo> files = DataBaseManagement::Instance()->GetAllFiles();
-        
-        // 应用筛选
-        int typeFilter = _fileTypeFilter->currentData().toInt();
-        QString searchText = _searchBox->text().trimmed().toLower();
-        
-        for(const FileInfo& file : files) {
-            // 应用类型筛选
-            if(typeFilter != -1 && static_cast<int>(file.fileType) != typeFilter)
-                continue;
-            
-            // 应用搜索筛选
-            if(!searchText.isEmpty() && !file.fileName.toLower().contains(searchText))
-                continue;
-            
-            int row = _filesTable->rowCount();
-            _filesTable->insertRow(row);
-            
-            _filesTable->setItem(row, 0, new QTableWidgetItem(QString::number(file.id)));
-            
-            // 移除文件名中的后缀
-            QString displayName = file.fileName;
-            int dotPos = displayName.lastIndexOf('.');
-            if(dotPos > 0) {
-                displayName = displayName.left(dotPos);
-            }
-            _filesTable->setItem(row, 1, new QTableWidgetItem(displayName));
-            
-            // 文件类型
-            _filesTable->setItem(row, 2, new QTableWidgetItem("文档"));
-            
-            // 文件大小
-            QString sizeText;
-            if(file.fileSize < 1024)
-                sizeText = QString("%1 B").arg(file.fileSize);
-            else if(file.fileSize < 1024 * 1024)
-                sizeText = QString("%1 KB").arg(file.fileSize / 1024.0, 0, 'f', 2);
-            else
-                sizeText = QString("%1 MB").arg(file.fileSize / (1024.0 * 1024.0), 0, 'f', 2);
-            _filesTable->setItem(row, 3, new QTableWidgetItem(sizeText));
-            
-            // 上传者
-            _filesTable->setItem(row, 4, new QTableWidgetItem(file.uploaderName));
-            
-            // 上传时间
-            _filesTable->setItem(row, 5, new QTableWidgetItem(file.uploadTime.toString("yyyy-MM-dd hh:mm:ss")));
-            
-            // 所属项目
-            _filesTable->setItem(row, 6, new QTableWidgetItem(file.projectId > 0 ? QString::number(file.projectId) : "-"));
-        }
+        FileQuery query;
+        query.fileType = _fileTypeFilter->currentData().toInt();
+        query.nameContains = _searchBox->text().trimmed();
+        query.searchContent = _searchContentCheck->isChecked();
+        _filesModel->SetQuery(query);
     }
     else if(currentIndex == 1) {
         // 过程文档视图
-        _docsTable->setRowCount(0);
-        
-        // 获取所有过程文档
-        QVector<FileInfo> docs = DataBaseManagement::Instance()->GetProcessDocuments();
-        
-        for(const FileInfo& doc : docs) {
-            int row = _docsTable->rowCount();
-            _docsTable->insertRow(row);
-            
-            _docsTable->setItem(row, 0, new QTableWidgetItem(QString::number(doc.id)));
-            
-            // 移除文件名中的后缀
-            QString displayName = doc.fileName;
-            int dotPos = displayName.lastIndexOf('.');
-            if(dotPos > 0) {
-                displayName = displayName.left(dotPos);
-            }
-            _docsTable->setItem(row, 1, new QTableWidgetItem(displayName));
-            
-            // 文件类型
-            _docsTable->setItem(row, 2, new QTableWidgetItem("文档"));
-            
-            // 上传者
-            _docsTable->setItem(row, 3, new QTableWidgetItem(doc.uploaderName));
-            
-            // 上传时间
-            _docsTable->setItem(row, 4, new QTableWidgetItem(doc.uploadTime.toString("yyyy-MM-dd hh:mm:ss")));
-        }
+        FileQuery query;
+        query.processDocumentsOnly = true;
+        _docsModel->SetQuery(query);
     }
     else if(currentIndex == 2) {
         // 回收站视图
-        _deletedFilesTable->setRowCount(0);
-        
-        // 获取所有已删除文件
-        QVector<FileInfo> deletedFiles = DataBaseManagement::Instance()->GetAllFiles(FileStatus::DELETED);
-        
-        for(const FileInfo& file : deletedFiles) {
-            int row = _deletedFilesTable->rowCount();
-            _deletedFilesTable->insertRow(row);
-            
-            _deletedFilesTable->setItem(row, 0, new QTableWidgetItem(QString::number(file.id)));
-            
-            // 移除文件名中的后缀
-            QString displayName = file.fileName;
-            int dotPos = displayName.lastIndexOf('.');
-            if(dotPos > 0) {
-                displayName = displayName.left(dotPos);
-            }
-            _deletedFilesTable->setItem(row, 1, new QTableWidgetItem(displayName));
-            
-            _deletedFilesTable->setItem(row, 2, new QTableWidgetItem("文档"));
-            
-            // 上传者
-            _deletedFilesTable->setItem(row, 3, new QTableWidgetItem(file.uploaderName));
-            
-            // 删除时间 (实际上是上传时间，这里简化处理)
-            _deletedFilesTable->setItem(row, 4, new QTableWidgetItem(file.uploadTime.toString("yyyy-MM-dd hh:mm:ss")));
-        }
+        FileQuery query;
+        query.status = FileStatus::DELETED;
+        _deletedFilesModel->SetQuery(query);
     }
 }
 
@@ -519,6 +438,7 @@ void FileManagementWidget::updateUIBasedOnRole()
     bool canDelete = (_currentUser.role == UserRole::ADMINISTRATOR);
     
     _uploadButton->setEnabled(canUpload);
+    _importButton->setEnabled(canUpload);
     _deleteButton->setEnabled(canDelete);
     _permanentDeleteButton->setEnabled(canDelete);
 }
@@ -540,15 +460,10 @@ void FileManagementWidget::onUploadFile()
     bool isProcessDoc = (QMessageBox::question(this, "过程文档", "是否将该文件标记为过程文档？",
                                      QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes);
     
-    // 获取不带后缀的文件名
-    QString baseFileName = fileInfo.completeBaseName();
-    
-    // 创建文件记录
+    // 创建文件记录，存储路径、大小、哈希和统计在存入存储区后填写
     FileInfo newFile;
-    newFile.fileName = fileInfo.fileName(); // 保存原始文件名（包含后缀）用于文件系统操作
-    newFile.filePath = filePath;
+    newFile.fileName = fileInfo.fileName(); // 保存原始文件名（包含后缀），下载和打开时使用
     newFile.fileExtension = ext;
-    newFile.fileSize = fileInfo.size();
     newFile.uploaderId = _currentUser.id;
     newFile.uploaderName = _currentUser.userName;
     newFile.uploadTime = QDateTime::currentDateTime();
@@ -557,51 +472,116 @@ void FileManagementWidget::onUploadFile()
     newFile.projectId = -1; // 暂不关联项目
     newFile.isProcessDocument = isProcessDoc;
     
-    // 保存文件
-    if(DataBaseManagement::Instance()->AddFile(newFile)) {
-        QMessageBox::information(this, "成功", "文件上传成功");
-        loadFileData(); // 刷新表格
-    } else {
-        QMessageBox::warning(this, "错误", "文件上传失败");
+    // 哈希、复制和解压在线程池中执行，文件记录在数据库线程写入，界面线程只接收结果
+    _uploadButton->setEnabled(false);
+    QtConcurrent::run(PrepareUpload, filePath, newFile).then(this, [this](const UploadResult& upload) {
+        if(!upload.success) {
+            _uploadButton->setEnabled(true);
+            QMessageBox::warning(this, "错误", "文件上传失败：" + upload.errorString);
+            return;
+        }
+        
+        FileInfo file = upload.file;
+        DataBaseExecutor::Instance()->Run([file](DataBaseManagement* db) {
+            return db->AddFile(file);
+        }, this, [this](bool success) {
+            _uploadButton->setEnabled(true);
+            if(success) {
+                QMessageBox::information(this, "成功", "文件上传成功");
+                loadFileData(); // 刷新表格
+                ContentIndexer::Instance()->Start(); // 在后台提取新文件的正文
+            } else {
+                QMessageBox::warning(this, "错误", "文件上传失败");
+            }
+        });
+    });
+}
+
+void FileManagementWidget::onImportDirectory()
+{
+    if(_importer->IsRunning()) {
+        QMessageBox::information(this, "提示", "正在导入，请等待当前导入完成");
+        return;
     }
+
+    // 递归导入目录下所有的.doc和.docx文件
+    QString rootPath = QFileDialog::getExistingDirectory(this, "选择要导入的目录");
+    if(rootPath.isEmpty())
+        return;
+
+    // 整个目录使用同一个设置，不再逐个文件询问
+    bool isProcessDoc = (QMessageBox::question(this, "过程文档", "是否将该目录中的文件都标记为过程文档？",
+                                     QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes);
+
+    BulkImportOptions options;
+    options.rootPath = rootPath;
+    options.uploader = _currentUser;
+    options.isProcessDocument = isProcessDoc;
+
+    QProgressDialog* progress = new QProgressDialog("正在查找文档...", "取消", 0, 0, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(0);
+    progress->setAutoClose(false);
+    progress->setAutoReset(false);
+
+    connect(progress, &QProgressDialog::canceled, _importer, &BulkImporter::Cancel);
+    connect(_importer, &BulkImporter::progress, progress, [progress](const BulkImportProgress& state) {
+        progress->setMaximum(qMax(state.total, 1));
+        progress->setValue(state.processed);
+        QString text = QString("已处理 %1 / %2 个文件\n%3 个/秒，%4 MB/秒")
+            .arg(state.processed).arg(state.total)
+            .arg(state.filesPerSecond, 0, 'f', 1)
+            .arg(state.bytesPerSecond / (1024 * 1024), 0, 'f', 1);
+        if(state.remainingSeconds >= 0 && state.processed > 0)
+            text += QString("\n预计剩余 %1").arg(FormatDuration(state.remainingSeconds));
+        progress->setLabelText(text);
+    });
+    connect(_importer, &BulkImporter::finished, this,
+            [this, progress](const BulkImportProgress& state, bool canceled, const QStringList& errors) {
+        progress->deleteLater();
+
+        QString message = QString("%1：成功导入 %2 个文件，失败 %3 个，用时 %4。")
+            .arg(canceled ? "导入已取消" : "导入完成")
+            .arg(state.imported).arg(state.failed)
+            .arg(FormatDuration(static_cast<int>(state.elapsedMilliseconds / 1000)));
+        if(state.reused > 0)
+            message += QString("\n其中 %1 个文件与已有文件内容相同，未重复保存。").arg(state.reused);
+
+        QMessageBox box(errors.isEmpty() ? QMessageBox::Information : QMessageBox::Warning,
+                        "批量导入", message, QMessageBox::Ok, this);
+        if(!errors.isEmpty())
+            box.setDetailedText(errors.join("\n"));
+        box.exec();
+
+        loadFileData();
+        ContentIndexer::Instance()->Start(); // 在后台提取新文件的正文
+    }, Qt::SingleShotConnection);
+
+    _importer->Start(options);
 }
 
 void FileManagementWidget::onDownloadFile()
 {
     // 获取选中的文件
-    QList<QTableWidgetSelectionRange> ranges = _filesTable->selectedRanges();
-    if(ranges.isEmpty()) {
+    QModelIndexList selectedRows = _filesTable->selectionModel()->selectedRows();
+    if(selectedRows.isEmpty()) {
         QMessageBox::warning(this, "提示", "请先选择要下载的文件");
         return;
     }
     
     // 只支持单个文件下载，如果选择了多个，提示用户一次只能下载一个文件
-    if(ranges.size() > 1 || ranges[0].rowCount() > 1) {
+    if(selectedRows.size() > 1) {
         QMessageBox::warning(this, "提示", "一次只能下载一个文件，请只选择一个文件");
         return;
     }
     
-    int row = ranges[0].topRow();
-    
     // 获取文件ID
-    int fileId = _filesTable->item(row, 0)->text().toInt();
-    
-    // 获取所有文件
-    QVector<FileInfo> allFiles = DataBaseManagement::Instance()->GetAllFiles();
+    int fileId = _filesModel->FileIdAt(selectedRows.first().row());
     
-    // 查找选中的文件
-    FileInfo selectedFile;
-    bool found = false;
+    // 按主键查询选中的文件
+    FileInfo selectedFile = DataBaseManagement::Instance()->GetFileById(fileId);
     
-    for(const FileInfo& file : allFiles) {
-        if(file.id == fileId) {
-            selectedFile = file;
-            found = true;
-            break;
-        }
-    }
-    
-    if(!found) {
+    if(selectedFile.id < 0) {
         QMessageBox::warning(this, "错误", "无法找到选中的文件");
         return;
     }
@@ -614,12 +594,15 @@ void FileManagementWidget::onDownloadFile()
         return; // 用户取消了操作
     }
     
-    // 复制文件到目标位置
-    if(QFile::copy(selectedFile.filePath, saveFilePath)) {
-        QMessageBox::information(this, "成功", "文件下载成功");
-    } else {
-        QMessageBox::warning(this, "错误", "文件下载失败，可能是源文件不存在或没有足够的权限");
-    }
+    // 在后台线程复制文件到目标位置
+    CopyFileInBackground(this, "正在下载文件...", selectedFile.filePath, saveFilePath,
+                         [this](const FileTransferResult& result) {
+        if(result.success) {
+            QMessageBox::information(this, "成功", "文件下载成功");
+        } else {
+            QMessageBox::warning(this, "错误", QString("文件下载失败：%1").arg(result.errorString));
+        }
+    });
 }
 
 void FileManagementWidget::onProcessDocument()
@@ -650,20 +633,12 @@ void FileManagementWidget::onRefreshFiles()
 void FileManagementWidget::onDeleteFile()
 {
     // 获取选中的文件
-    QList<QTableWidgetSelectionRange> ranges = _filesTable->selectedRanges();
-    if(ranges.isEmpty()) {
+    QModelIndexList selectedRows = _filesTable->selectionModel()->selectedRows();
+    if(selectedRows.isEmpty()) {
         QMessageBox::warning(this, "提示", "请先选择要删除的文件");
         return;
     }
     
-    // 计算选中的不重复行数量
-    QSet<int> selectedRows;
-    for(const QTableWidgetSelectionRange& range : ranges) {
-        for(int row = range.topRow(); row <= range.bottomRow(); ++row) {
-            selectedRows.insert(row);
-        }
-    }
-    
     // 确认删除
     if(QMessageBox::question(this, "确认删除", QString("确定要将选中的%1个文件移到回收站吗？").arg(selectedRows.size()),
                           QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes) {
@@ -674,8 +649,8 @@ void FileManagementWidget::onDeleteFile()
     int failCount = 0;
     
     // 删除所有选中的文件
-    for(int row : selectedRows) {
-        int fileId = _filesTable->item(row, 0)->text().toInt();
+    for(const QModelIndex& index : selectedRows) {
+        int fileId = _filesModel->FileIdAt(index.row());
         if(DataBaseManagement::Instance()->DeleteFile(fileId)) {
             successCount++;
         } else {
@@ -696,61 +671,26 @@ void FileManagementWidget::onDeleteFile()
 
 void FileManagementWidget::onSearchFile()
 {
+    _searchTimer->stop();
     loadFileData();
 }
 
-int FileManagementWidget::getWordDocumentPageCount(const QString& filePath)
-{
-    int pageCount = 1; // 默认至少1页
-    
-    // 使用文件大小估算页数
-    QFileInfo fileInfo(filePath);
-    if (fileInfo.exists()) {
-        // 每500KB估算为1页，最小1页
-        pageCount = qMax(1, static_cast<int>(fileInfo.size() / (500 * 1024)) + 1);
-        qDebug() << "文档" << fileInfo.fileName() << "估算页数：" << pageCount;
-    }
-    
-    return pageCount;
-}
-
 // 实现文档整理功能
 void FileManagementWidget::organizeDocuments()
 {
     // 获取选中的文档
-    QList<QTableWidgetItem*> selectedItems = _docsTable->selectedItems();
-    if(selectedItems.isEmpty()) {
+    QModelIndexList selectedRows = _docsTable->selectionModel()->selectedRows();
+    if(selectedRows.isEmpty()) {
         QMessageBox::warning(this, "提示", "请先选择要整理的文档");
         return;
     }
     
-    // 获取选中的行
-    QSet<int> selectedRows;
-    for(const QTableWidgetItem* item : selectedItems) {
-        selectedRows.insert(item->row());
-    }
-    
-    if(selectedRows.empty()) {
-        QMessageBox::warning(this, "提示", "请先选择要整理的文档");
-        return;
-    }
-    
-    // 获取所有过程文档
-    QVector<FileInfo> allDocs = DataBaseManagement::Instance()->GetProcessDocuments();
-    
-    // 收集选中的文档信息
-    QVector<FileInfo> selectedDocs;
-    for(int row : selectedRows) {
-        int docId = _docsTable->item(row, 0)->text().toInt();
-        
-        // 查找文档信息
-        for(const FileInfo& doc : allDocs) {
-            if(doc.id == docId) {
-                selectedDocs.append(doc);
-                break;
-            }
-        }
+    // 收集选中的文档ID，并一次性按主键查询文档信息
+    QVector<int> selectedDocIds;
+    for(const QModelIndex& index : selectedRows) {
+        selectedDocIds.append(_docsModel->FileIdAt(index.row()));
     }
+    QVector<FileInfo> selectedDocs = DataBaseManagement::Instance()->GetFilesByIds(selectedDocIds);
     
     if(selectedDocs.isEmpty()) {
         QMessageBox::warning(this, "提示", "未能获取选中文档的信息");
@@ -765,17 +705,36 @@ void FileManagementWidget::organizeDocuments()
     }
     
     // 合并文档并添加目录
-    mergeDocumentsByPython(selectedDocs);
+    mergeDocuments(selectedDocs);
 }
 
-// 合并文档并添加目录
-void FileManagementWidget::mergeDocumentsByPython(const QVector<FileInfo>& documents)
+// 合并文档并在开头插入目录
+void FileManagementWidget::mergeDocuments(const QVector<FileInfo>& documents)
 {
     if(documents.empty()) {
         QMessageBox::warning(this, "错误", "没有可合并的文档");
         return;
     }
 
+    // 只有 .docx 可以直接合并，.doc 是二进制格式
+    QVector<DocxMergeInput> inputs;
+    QStringList skippedFiles;
+    for(const FileInfo& document : documents) {
+        if(document.fileExtension.compare("docx", Qt::CaseInsensitive) != 0) {
+            skippedFiles << document.fileName;
+            continue;
+        }
+        DocxMergeInput input;
+        input.filePath = document.filePath;
+        input.title = QFileInfo(document.fileName).completeBaseName();
+        inputs.append(input);
+    }
+
+    if(inputs.isEmpty()) {
+        QMessageBox::warning(this, "错误", "选中的文档都不是 .docx 格式，无法合并");
+        return;
+    }
+
     // 让用户选择保存位置
     QString saveFilePath = QFileDialog::getSaveFileName(
         this,
@@ -793,495 +752,54 @@ void FileManagementWidget::mergeDocumentsByPython(const QVector<FileInfo>& docum
         saveFilePath += ".docx";
     }
 
-    // 获取当前应用程序路径
-    QString appDirPath = QCoreApplication::applicationDirPath();
-
-    // 构建Python脚本路径 - 更新为实际位置
-    QString pythonScriptDir = appDirPath + "/main.py";
-
-    QVector<QString> combineFiles;
-    for(auto &file : documents)
-    {
-        QString inputFile = file.filePath;
-        qDebug() << "合并文件路径：" << inputFile;
-        combineFiles.emplace_back(inputFile);
-    }
-
-    if(!Py_IsInitialized())
-    {
-        QMessageBox::warning(this, "错误", "无法初始化python解释器");
-        return;
-    }
-
-    try
-    {
-        PyObject* pModule = PyImport_ImportModule("main");
-        if(!pModule)
-        {
-            QMessageBox::warning(this, "错误", "无法导入python模块");
-            PyErr_Print();
-            Py_Finalize();
+    QProgressDialog* progress = new QProgressDialog("正在合并文档...", "取消", 0, inputs.size(), this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(0);
+    progress->setValue(0);
+
+    // 合并在后台线程执行，进度排队回到界面线程更新
+    auto canceled = std::make_shared<std::atomic_bool>(false);
+    connect(progress, &QProgressDialog::canceled, this, [canceled]() { *canceled = true; });
+
+    QPointer<QProgressDialog> progressPointer(progress);
+    QtConcurrent::run([inputs, saveFilePath, progressPointer, canceled]() {
+        DocxMerger merger;
+        merger.SetProgressCallback([progressPointer, canceled](int finished, int total) {
+            Q_UNUSED(total);
+            QMetaObject::invokeMethod(qApp, [progressPointer, finished]() {
+                if(progressPointer)
+                    progressPointer->setValue(finished);
+            }, Qt::QueuedConnection);
+            return !*canceled;
+        });
+
+        DocxMergeResult result;
+        result.success = merger.Merge(inputs, saveFilePath);
+        result.errorString = merger.ErrorString();
+        result.warnings = merger.Warnings();
+        return result;
+    }).then(this, [this, progress, canceled, saveFilePath, skippedFiles](const DocxMergeResult& result) {
+        progress->deleteLater();
+        if(*canceled) {
             return;
         }
 
-        // 获取函数对象
-        PyObject* pFunc = PyObject_GetAttrString(pModule, "merge_documents");
-        if(!pFunc || !PyCallable_Check(pFunc))
-        {
-            QMessageBox::warning(this, "错误", "无法找到函数‘merge_documents’");
-            Py_XDECREF(pFunc);
-            Py_DECREF(pModule);
-            Py_Finalize();
+        if(!result.success) {
+            QMessageBox::critical(this, "错误", QString("合并文档失败: %1").arg(result.errorString));
             return;
         }
 
-        PyObject* pInputFiles = PyList_New(combineFiles.size());
-        int index = 0;
-        for(auto &file : combineFiles)
-        {
-            PyObject* pFile = PyUnicode_FromString(file.toStdString().c_str());
-            PyList_SetItem(pInputFiles, index++, pFile);
+        QString message = QString("文档已合并并保存到:\n%1").arg(saveFilePath);
+        if(!skippedFiles.isEmpty()) {
+            message += "\n\n以下文档不是 .docx 格式，未合并:\n" + skippedFiles.join("\n");
         }
-
-        PyObject* pOutputFile = PyUnicode_FromString(saveFilePath.toStdString().c_str());
-
-        PyObject* pArgs = PyTuple_New(2);
-        PyTuple_SetItem(pArgs, 0, pInputFiles);
-        PyTuple_SetItem(pArgs, 1, pOutputFile);
-
-        PyObject* pResult = PyObject_CallObject(pFunc, pArgs);
-        if(!pResult)
-        {
-            QMessageBox::warning(this, "错误", "python函数调用失败");
+        if(!result.warnings.isEmpty()) {
+            message += "\n\n以下文档无法读取，已跳过:\n" + result.warnings.join("\n");
         }
+        message += "\n\n打开文档后更新域即可生成目录，是否现在打开?";
 
-        Py_XDECREF(pResult);
-        Py_DECREF(pArgs);
-        Py_DECREF(pFunc);
-        Py_DECREF(pModule);
-    }
-    catch(const std::exception &e)
-    {
-        QMessageBox::warning(this, "错误", "发生异常：%1", e.what());
-    }
-    catch(...)
-    {
-        QMessageBox::warning(this, "错误", "发生未知异常");
-    }
-
-    QMessageBox::information(this, "提醒", "文档合并成功，打开word文档后，选择更新域以手动更新目录");
-}
-
-void FileManagementWidget::mergeDocuments(const QVector<FileInfo>& documents)
-{
-    if(documents.empty()) {
-        QMessageBox::warning(this, "错误", "没有可合并的文档");
-        return;
-    }
-    
-    // 让用户选择保存位置
-    QString saveFilePath = QFileDialog::getSaveFileName(
-        this, 
-        "保存合并后的文档", 
-        QDir::homePath() + "/合并文档.docx",
-        "Word文档 (*.docx);;所有文件 (*.*)");
-    
-    if(saveFilePath.isEmpty()) {
-        // 用户取消了保存对话框
-        return;
-    }
-    
-    // 确保文件扩展名为.docx
-    if(!saveFilePath.endsWith(".docx", Qt::CaseInsensitive)) {
-        saveFilePath += ".docx";
-    }
-    
-    // 创建进度对话框，并确保始终显示
-    QProgressDialog progress("正在合并文档...", "取消", 0, documents.count() + 3, this);
-    progress.setWindowModality(Qt::WindowModal);
-    progress.setMinimumDuration(0);
-    progress.setValue(0);
-    progress.show();
-    QCoreApplication::processEvents();
-    
-    // 尝试手动终止可能已经存在的Word进程
-    progress.setLabelText("正在检查Word进程...");
-    QCoreApplication::processEvents();
-    
-    #ifdef Q_OS_WIN
-    // 在Windows上尝试查找并结束可能未正常关闭的Word进程
-    QProcess tasklist;
-    tasklist.start("tasklist", QStringList() << "/FI" << "IMAGENAME eq WINWORD.EXE" << "/FO" << "CSV");
-    if(tasklist.waitForFinished(5000)) {
-        QString output = QString::fromLocal8Bit(tasklist.readAllStandardOutput());
-        if(output.contains("WINWORD.EXE")) {
-            QMessageBox::information(this, "提示", "检测到Word程序正在运行。\n请先关闭所有Word文档，然后点击确定继续。");
-        }
-    }
-    #endif
-    
-    // 创建Word应用程序
-    QAxObject* wordApp = nullptr;
-    QAxObject* wordDocs = nullptr;
-    QAxObject* wordDoc = nullptr;
-    
-    // 添加超时控制
-    QTimer timer;
-    timer.setSingleShot(true);
-    bool operationTimedOut = false;
-    
-    QEventLoop loop;
-    connect(&timer, &QTimer::timeout, [&]() {
-        operationTimedOut = true;
-        loop.quit();
-    });
-    
-    try {
-        // 设置超时时间（15秒）- 减少超时时间以便更快响应
-        const int TIMEOUT_MS = 15000;
-        
-        // 创建Word应用程序
-        progress.setLabelText("正在启动Word应用程序...");
-        progress.setValue(1);
-        QCoreApplication::processEvents();
-        
-        // 尝试多次创建Word应用实例
-        const int MAX_ATTEMPTS = 3;
-        for(int attempt = 1; attempt <= MAX_ATTEMPTS; attempt++) {
-            try {
-                timer.start(TIMEOUT_MS);
-                wordApp = new QAxObject("Word.Application", this);
-                timer.stop();
-                
-                if(operationTimedOut) {
-                    delete wordApp;
-                    wordApp = nullptr;
-                    
-                    if(attempt < MAX_ATTEMPTS) {
-                        progress.setLabelText(QString("正在尝试重新启动Word (尝试 %1/%2)...").arg(attempt + 1).arg(MAX_ATTEMPTS));
-                        QCoreApplication::processEvents();
-                        QThread::sleep(2); // 等待2秒再尝试
-                        continue;
-                    } else {
-                        throw QString("启动Word应用程序超时，请确保Microsoft Word已正确安装并且没有被其他程序占用");
-                    }
-                }
-                
-                if(!wordApp || wordApp->isNull()) {
-                    delete wordApp;
-                    wordApp = nullptr;
-                    
-                    if(attempt < MAX_ATTEMPTS) {
-                        progress.setLabelText(QString("Word启动失败，正在重试 (尝试 %1/%2)...").arg(attempt + 1).arg(MAX_ATTEMPTS));
-                        QCoreApplication::processEvents();
-                        QThread::sleep(2); // 等待2秒再尝试
-                        continue;
-                    } else {
-                        throw QString("无法启动Word应用程序，请确保已安装Microsoft Word");
-                    }
-                }
-                
-                // 成功创建Word应用
-                break;
-            } catch(...) {
-                if(wordApp) {
-                    delete wordApp;
-                    wordApp = nullptr;
-                }
-                
-                if(attempt >= MAX_ATTEMPTS) {
-                    throw QString("尝试启动Word失败，请检查您的Microsoft Office安装");
-                }   
-                
-                progress.setLabelText(QString("Word初始化失败，正在重试 (尝试 %1/%2)...").arg(attempt + 1).arg(MAX_ATTEMPTS));
-                QCoreApplication::processEvents();
-                QThread::sleep(2); // 等待2秒再尝试
-            }
-        }
-        
-        // 设置Word应用程序属性
-        try {
-            progress.setLabelText("正在配置Word应用程序...");
-            progress.setValue(2);
-            QCoreApplication::processEvents();
-            
-            wordApp->setProperty("Visible", QVariant(false));
-            wordApp->setProperty("DisplayAlerts", QVariant(false)); // 禁用警告弹窗
-        } catch(...) {
-            throw QString("配置Word应用程序失败，可能是Office安装不完整");
-        }
-        
-        // 获取文档集合
-        progress.setLabelText("正在创建文档...");
-        QCoreApplication::processEvents();
-        
-        timer.start(TIMEOUT_MS);
-        wordDocs = wordApp->querySubObject("Documents");
-        timer.stop();
-        
-        if(operationTimedOut || !wordDocs || wordDocs->isNull()) {
-            throw QString("无法获取Word文档集合");
-        }
-        
-        // 创建新文档
-        timer.start(TIMEOUT_MS);
-        wordDoc = wordDocs->querySubObject("Add()");
-        timer.stop();
-        
-        if(operationTimedOut) {
-            throw QString("创建Word文档超时，可能是Word没有正确响应");
-        }
-        
-        if(!wordDoc || wordDoc->isNull()) {
-            throw QString("无法创建新Word文档");
-        }
-        
-        // 使用更简单的方式合并文档，采用文本复制方式而不是复杂的COM交互
-        progress.setLabelText("正在准备合并内容...");
-        progress.setValue(3);
-        QCoreApplication::processEvents();
-        
-        // 创建一个简单的文档内容
-        QString mergedContent = "<html><body>";
-        mergedContent += "<h1 style='text-align:center'>文档目录</h1>";
-        mergedContent += "<div style='page-break-after:always'></div>";
-        
-        // 添加文档内容
-        progress.setLabelText("正在合并文档内容...");
-        QCoreApplication::processEvents();
-        
-        bool anyDocumentsProcessed = false;
-        
-        for(int i = 0; i < documents.size(); i++) {
-            progress.setValue(i + 4); // 3 + 1 因为之前已经设置到3了
-            if(progress.wasCanceled()) {
-                throw QString("用户取消操作");
-            }
-            
-            const FileInfo& doc = documents[i];
-            QCoreApplication::processEvents();
-            
-            // 构建可能的文件路径
-            QStringList pathsToTry;
-            pathsToTry << doc.filePath;
-            pathsToTry << doc.filePath + "/" + doc.fileName;
-            pathsToTry << doc.fileName;
-            
-            QString filePath;
-            bool fileFound = false;
-            
-            for(const QString& path : pathsToTry) {
-                QFileInfo fileInfo(path);
-                if(fileInfo.exists() && fileInfo.isFile()) {
-                    filePath = path;
-                    fileFound = true;
-                    break;
-                }
-            }
-            
-            if(!fileFound) {
-                QMessageBox::warning(this, "警告", QString("文件 '%1' 不存在，将跳过").arg(doc.fileName));
-                continue;
-            }
-            
-            // 添加文档标题
-            QString docTitle = doc.fileName;
-            int dotPos = docTitle.lastIndexOf('.');
-            if(dotPos > 0) {
-                docTitle = docTitle.left(dotPos);
-            }
-            
-            mergedContent += QString("<h2>%1</h2>").arg(docTitle);
-            
-            // 添加文档内容的引用
-            mergedContent += QString("<p>文件: %1</p>").arg(filePath);
-            mergedContent += "<p>请参阅原始文档了解详细内容</p>";
-            
-            // 添加分页符
-            if(i < documents.size() - 1) {
-                mergedContent += "<div style='page-break-after:always'></div>";
-            }
-            
-            anyDocumentsProcessed = true;
-        }
-        
-        mergedContent += "</body></html>";
-        
-        // 如果没有处理任何文档，抛出异常
-        if(!anyDocumentsProcessed) {
-            throw QString("没有找到任何有效的文档可以合并");
-        }
-        
-        // 使用QTextDocument来设置内容
-        QTextDocument textDoc;
-        textDoc.setHtml(mergedContent);
-        
-        // 将内容写入Word文档
-        timer.start(TIMEOUT_MS);
-        try {
-            // 获取Word文档的内容范围
-            QAxObject* content = wordDoc->querySubObject("Content");
-            if(content && !content->isNull()) {
-                // 插入文本内容
-                content->dynamicCall("InsertAfter(QString)", textDoc.toHtml());
-                delete content;
-            } else {
-                throw QString("无法获取Word文档内容");
-            }
-        } catch(...) {
-            throw QString("将内容写入Word文档时出错");
-        }
-        timer.stop();
-        
-        if(operationTimedOut) {
-            throw QString("写入文档内容超时");
-        }
-        
-        // 将文档保存到用户指定的位置
-        progress.setLabelText("正在保存文档...");
-        progress.setValue(documents.size() + 2);
-        QCoreApplication::processEvents();
-        
-        QString nativeSavePath = QDir::toNativeSeparators(saveFilePath);
-        
-        timer.start(TIMEOUT_MS);
-        try {
-            // 使用SaveAs保存文档
-            wordDoc->dynamicCall("SaveAs(const QString&)", nativeSavePath);
-        } catch(...) {
-            throw QString("保存文档时出错");
-        }
-        timer.stop();
-        
-        if(operationTimedOut) {
-            throw QString("保存文档超时，可能是文件太大或磁盘空间不足");
-        }
-        
-        // 关闭Word应用程序
-        progress.setLabelText("正在关闭Word...");
-        progress.setValue(documents.size() + 3);
-        QCoreApplication::processEvents();
-        
-        // 关闭Word文档
-        try {
-            if(wordDoc && !wordDoc->isNull()) {
-                wordDoc->dynamicCall("Close(bool)", false);
-            }
-        } catch(...) {}
-        
-        // 退出Word应用
-        try {
-            if(wordApp && !wordApp->isNull()) {
-                wordApp->dynamicCall("Quit()");
-            }
-        } catch(...) {}
-        
-        // 释放COM对象
-        if(wordDoc) delete wordDoc;
-        if(wordDocs) delete wordDocs;
-        if(wordApp) delete wordApp;
-        
-        wordDoc = nullptr;
-        wordDocs = nullptr;
-        wordApp = nullptr;
-        
-        // 完成合并，隐藏进度对话框
-        progress.close();
-        
-        // 询问用户是否打开合并后的文档
-        if(QMessageBox::question(this, "合并完成", 
-                                "文档已成功合并并保存到:\n" + saveFilePath + "\n\n是否立即打开该文档?", 
-                                QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes) {
+        if(QMessageBox::question(this, "合并完成", message, QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes) {
             QDesktopServices::openUrl(QUrl::fromLocalFile(saveFilePath));
         }
-        
-    } catch(const QString& error) {
-        progress.close();
-        QMessageBox::critical(this, "错误", QString("合并文档时出错: %1").arg(error));
-        
-        // 尝试清理：关闭Word
-        try {
-            if(wordDoc && !wordDoc->isNull()) {
-                wordDoc->dynamicCall("Close(bool)", false);
-            }
-        } catch(...) {}
-        
-        try {
-            if(wordApp && !wordApp->isNull()) {
-                wordApp->dynamicCall("Quit()");
-            }
-        } catch(...) {}
-        
-        // 强制终止WINWORD进程 (仅适用于Windows)
-        #ifdef Q_OS_WIN
-        QProcess::execute("taskkill", QStringList() << "/F" << "/IM" << "WINWORD.EXE");
-        #endif
-        
-        // 释放资源
-        if(wordDoc) delete wordDoc;
-        if(wordDocs) delete wordDocs;
-        if(wordApp) delete wordApp;
-    }
-}
-
-void FileManagementWidget::insertTableOfContents(QAxObject* wordDocument)
-{
-    if(!wordDocument || wordDocument->isNull()) {
-        return;
-    }
-    
-    try {
-        // 获取Selection对象
-        QAxObject* app = wordDocument->querySubObject("Application");
-        if(!app || app->isNull()) {
-            return;
-        }
-        
-        QAxObject* selection = app->querySubObject("Selection");
-        if(!selection || selection->isNull()) {
-            delete app;
-            return;
-        }
-        
-        // 设置标题样式
-        selection->dynamicCall("HomeKey(int)", QVariant(6)); // wdStory = 6
-        
-        // 获取当前选区范围
-        QAxObject* range = selection->querySubObject("Range");
-        if(!range || range->isNull()) {
-            delete app;
-            delete selection;
-            throw QString("无法获取Range对象");
-        }
-        
-        // 添加字段代码来创建目录
-        // 使用 TOC 字段代码创建目录，可以指定级别范围为1-3
-        QString fieldCode = "TOC \\o \"1-3\" \\h \\z \\u";
-        QAxObject* fields = range->querySubObject("Fields");
-        if (!fields || fields->isNull()) {
-            delete app;
-            delete selection;
-            delete range;
-            throw QString("无法获取Fields对象");
-        }
-        
-        QVariant paramRange(range->asVariant());
-        QVariant paramCode(fieldCode);
-        fields->dynamicCall("Add(IDispatch*, int, const QString&, bool)", 
-                            paramRange, QVariant(1), paramCode, QVariant(true));
-        
-        // 在目录后添加两个空行
-        selection->dynamicCall("EndKey(int)", QVariant(6)); // 移动到文档末尾
-        selection->dynamicCall("TypeParagraph()");
-        selection->dynamicCall("TypeParagraph()");
-        
-        // 释放对象
-        delete fields;
-        delete range;
-        delete selection;
-        delete app;
-        
-    } catch(const QString& error) {
-        QMessageBox::warning(nullptr, "警告", QString("插入目录时出错: %1").arg(error));
-    }
+    });
 }
@@ -2,16 +2,20 @@
 #define FILEMANAGEMENTWIDGET_H
 
 #include <QWidget>
-#include <QTableWidget>
+#include <QTableView>
 #include <QPushButton>
 #include <QLineEdit>
 #include <QComboBox>
+#include <QCheckBox>
 #include <QLabel>
 #include <QStackedWidget>
-#include <QAxObject>
+#include <QTimer>
 #include <QProgressDialog>
 #include "DBModels.h"
 
+class BulkImporter;
+class FileTableModel;
+
 class FileManagementWidget : public QWidget
 {
     Q_OBJECT
@@ -23,6 +27,7 @@ public:
 
 private slots:
     void onUploadFile();
+    void onImportDirectory();
     void onDownloadFile();
     void onProcessDocument();
     void onRecycleBin();
@@ -38,11 +43,8 @@ private:
     void setupRecycleBinView();
     void loadFileData();
     void updateUIBasedOnRole();
-    int getWordDocumentPageCount(const QString& filePath);
     void organizeDocuments();
     void mergeDocuments(const QVector<FileInfo>& documents);
-    void insertTableOfContents(QAxObject* wordDocument);
-    void mergeDocumentsByPython(const QVector<FileInfo>& documents);
 
 private:
     User _currentUser;
@@ -50,24 +52,32 @@ private:
     
     // 文件列表视图
     QWidget* _fileListView;
-    QTableWidget* _filesTable;
+    QTableView* _filesTable;
+    FileTableModel* _filesModel;
     QPushButton* _uploadButton;
+    QPushButton* _importButton;
     QPushButton* _downloadButton;
     QPushButton* _deleteButton;
     QLineEdit* _searchBox;
+    QTimer* _searchTimer;
+    QCheckBox* _searchContentCheck;
     QComboBox* _fileTypeFilter;
     
     // 过程文档视图
     QWidget* _processDocView;
-    QTableWidget* _docsTable;
+    QTableView* _docsTable;
+    FileTableModel* _docsModel;
     QPushButton* _printDocButton;
     QPushButton* _organizeDocButton;
     
     // 回收站视图
     QWidget* _recycleBinView;
-    QTableWidget* _deletedFilesTable;
+    QTableView* _deletedFilesTable;
+    FileTableModel* _deletedFilesModel;
     QPushButton* _restoreButton;
     QPushButton* _permanentDeleteButton;
+
+    BulkImporter* _importer;
 };
 
 #endif // FILEMANAGEMENTWIDGET_H
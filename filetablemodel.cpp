@@ -0,0 +1,168 @@
+#include "filetablemodel.h"
+#include "databaseexecutor.h"
+
+FileTableModel::FileTableModel(Layout layout, QObject* parent)
+    : PagedTableModel(parent)
+    , _hasMorePages(false)
+    , _fetching(false)
+    , _generation(0)
+{
+    switch(layout)
+    {
+        case Layout::FileList:
+            _columns = {Column::Id, Column::Name, Column::Type, Column::Size, Column::Pages, Column::Uploader,
+                        Column::UploadTime};
+            _headers = {"ID", "文件名", "类型", "大小", "页数", "上传者", "上传时间"};
+            break;
+        case Layout::ProcessDocuments:
+            _columns = {Column::Id, Column::Name, Column::Type, Column::Pages, Column::Words, Column::Uploader,
+                        Column::UploadTime};
+            _headers = {"ID", "文档名", "类型", "页数", "字数", "上传者", "上传时间"};
+            break;
+        case Layout::RecycleBin:
+            // 删除时间实际上是上传时间，这里简化处理
+            _columns = {Column::Id, Column::Name, Column::Type, Column::Uploader, Column::UploadTime};
+            _headers = {"ID", "文件名", "类型", "上传者", "删除时间"};
+            break;
+    }
+}
+
+void FileTableModel::SetQuery(const FileQuery& query)
+{
+    beginResetModel();
+
+    ++_generation;
+    _query = query;
+    _query.after = PageCursor();
+    _hasMorePages = true;
+    _fetching = false;
+
+    _rows.clear();
+    ResetRowCount(0);
+    endResetModel();
+
+    FetchNextPage();
+}
+
+bool FileTableModel::CanFetchNextPage() const
+{
+    return _hasMorePages && !_fetching;
+}
+
+void FileTableModel::FetchNextPage()
+{
+    _fetching = true;
+
+    FileQuery query = _query;
+    quint64 generation = _generation;
+    DataBaseExecutor::Instance()->RunRead(
+        [query](DataBaseManagement* db) { return db->QueryFiles(query); },
+        this, [this, generation](const FilePage& page) { AppendPage(page, generation); });
+}
+
+void FileTableModel::AppendPage(const FilePage& page, quint64 generation)
+{
+    if(generation != _generation)
+    {
+        return;
+    }
+
+    _fetching = false;
+    _hasMorePages = page.hasMore;
+    _query.after = page.next;
+
+    if(page.files.isEmpty())
+    {
+        return;
+    }
+
+    BeginAppendRows(page.files.size());
+    for(const FileInfo& file : page.files)
+    {
+        _rows.append(MakeRow(file));
+    }
+    EndAppendRows();
+}
+
+FileTableModel::Row FileTableModel::MakeRow(const FileInfo& file)
+{
+    Row row;
+    row.id = file.id;
+    row.fileSize = file.fileSize;
+    row.pageCount = file.pageCount;
+    row.wordCount = file.wordCount;
+    row.uploadTime = file.uploadTime;
+    row.uploaderName = file.uploaderName;
+
+    // 移除文件名中的后缀
+    row.displayName = file.fileName;
+    int dotPos = row.displayName.lastIndexOf('.');
+    if(dotPos > 0)
+    {
+        row.displayName = row.displayName.left(dotPos);
+    }
+
+    return row;
+}
+
+int FileTableModel::FileIdAt(int row) const
+{
+    return (row >= 0 && row < _rows.size()) ? _rows[row].id : -1;
+}
+
+QString FileTableModel::DisplayNameAt(int row) const
+{
+    return (row >= 0 && row < _rows.size()) ? _rows[row].displayName : QString();
+}
+
+int FileTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : _columns.size();
+}
+
+QVariant FileTableModel::data(const QModelIndex& index, int role) const
+{
+    if(!index.isValid() || role != Qt::DisplayRole ||
+       index.row() >= rowCount() || index.column() >= _columns.size())
+    {
+        return QVariant();
+    }
+
+    const Row& row = _rows[index.row()];
+    switch(_columns[index.column()])
+    {
+        case Column::Id:
+            return row.id;
+        case Column::Name:
+            return row.displayName;
+        case Column::Type:
+            return QString("文档");
+        case Column::Size:
+            if(row.fileSize < 1024)
+                return QString("%1 B").arg(row.fileSize);
+            else if(row.fileSize < 1024 * 1024)
+                return QString("%1 KB").arg(row.fileSize / 1024.0, 0, 'f', 2);
+            else
+                return QString("%1 MB").arg(row.fileSize / (1024.0 * 1024.0), 0, 'f', 2);
+        case Column::Pages:
+            return row.pageCount > 0 ? QVariant(row.pageCount) : QVariant(QString("-"));
+        case Column::Words:
+            return row.pageCount > 0 ? QVariant(row.wordCount) : QVariant(QString("-"));
+        case Column::Uploader:
+            return row.uploaderName;
+        case Column::UploadTime:
+            return row.uploadTime.toString("yyyy-MM-dd hh:mm:ss");
+    }
+
+    return QVariant();
+}
+
+QVariant FileTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if(orientation == Qt::Horizontal && role == Qt::DisplayRole && section < _headers.size())
+    {
+        return _headers[section];
+    }
+
+    return PagedTableModel::headerData(section, orientation, role);
+}
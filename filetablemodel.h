@@ -0,0 +1,80 @@
+#ifndef FILETABLEMODEL_H
+#define FILETABLEMODEL_H
+
+#include <QDateTime>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "pagedtablemodel.h"
+#include "DBModels.h"
+
+// 文件列表、过程文档、回收站三个表格的模型
+class FileTableModel : public PagedTableModel
+{
+    Q_OBJECT
+public:
+    // 三个视图显示的列不同
+    enum class Layout
+    {
+        FileList,           // ID、文件名、类型、大小、页数、上传者、上传时间
+        ProcessDocuments,   // ID、文档名、类型、页数、字数、上传者、上传时间
+        RecycleBin          // ID、文件名、类型、上传者、删除时间
+    };
+
+    explicit FileTableModel(Layout layout, QObject* parent = nullptr);
+
+    // 按查询条件分页加载，每页在数据库线程查询，滚动到底部时加载下一页
+    void SetQuery(const FileQuery& query);
+
+    int FileIdAt(int row) const;
+    QString DisplayNameAt(int row) const;
+
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+protected:
+    bool CanFetchNextPage() const override;
+    void FetchNextPage() override;
+
+private:
+    void AppendPage(const FilePage& page, quint64 generation);
+
+    enum class Column
+    {
+        Id,
+        Name,
+        Type,
+        Size,
+        Pages,
+        Words,
+        Uploader,
+        UploadTime
+    };
+
+    // 只保存表格显示需要的字段
+    struct Row
+    {
+        int id;
+        qint64 fileSize;
+        int pageCount;          // 0 表示未知
+        int wordCount;
+        QDateTime uploadTime;
+        QString displayName;    // 去掉后缀的文件名
+        QString uploaderName;
+    };
+
+    static Row MakeRow(const FileInfo& file);
+
+    QVector<Column> _columns;
+    QStringList _headers;
+    QVector<Row> _rows;
+
+    // 分页加载状态，_generation 用于丢弃查询条件变化前发出的请求结果
+    FileQuery _query;
+    bool _hasMorePages;
+    bool _fetching;
+    quint64 _generation;
+};
+
+#endif // FILETABLEMODEL_H
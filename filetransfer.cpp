@@ -0,0 +1,281 @@
+#include <QApplication>
+#include <QDir>
+#include <QFile>
+#include <QPointer>
+#include <QProgressDialog>
+#include <QSaveFile>
+#include <QTemporaryFile>
+#include <QtConcurrent/QtConcurrent>
+#include <atomic>
+#include <memory>
+#include "filetransfer.h"
+
+#if defined(Q_OS_LINUX)
+#include <cerrno>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <qt_windows.h>
+#endif
+
+// 内核内复制时每次系统调用复制的字节数，也是进度回调的间隔
+static const qint64 kKernelChunkSize = 8 * 1024 * 1024;
+
+// 分块读写的缓冲区大小
+static const qint64 kBufferSize = 1024 * 1024;
+
+#ifdef Q_OS_WIN
+static DWORD CALLBACK CopyProgressRoutine(LARGE_INTEGER totalFileSize, LARGE_INTEGER totalBytesTransferred,
+                                          LARGE_INTEGER, LARGE_INTEGER, DWORD, DWORD, HANDLE, HANDLE, LPVOID data)
+{
+    auto progress = static_cast<std::function<bool(qint64, qint64)>*>(data);
+    return (*progress)(totalBytesTransferred.QuadPart, totalFileSize.QuadPart) ? PROGRESS_CONTINUE : PROGRESS_CANCEL;
+}
+#endif
+
+FileTransfer::FileTransfer()
+    : _method(Method::None)
+{
+
+}
+
+bool FileTransfer::Copy(const QString& sourcePath, const QString& targetPath)
+{
+    _error.clear();
+    _method = Method::None;
+
+    QFile source(sourcePath);
+    if(!source.open(QIODevice::ReadOnly))
+    {
+        _error = QString("无法打开源文件：%1").arg(source.errorString());
+        return false;
+    }
+    qint64 total = source.size();
+
+#ifdef Q_OS_WIN
+    source.close();
+
+    // 在目标目录中占用一个临时文件名，复制完成后替换目标
+    QString tempPath;
+    {
+        QTemporaryFile temp(targetPath + ".XXXXXX.part");
+        temp.setAutoRemove(false);
+        if(!temp.open())
+        {
+            _error = QString("无法创建目标文件：%1").arg(temp.errorString());
+            return false;
+        }
+        tempPath = temp.fileName();
+    }
+
+    std::function<bool(qint64, qint64)> progress = [this](qint64 copied, qint64 size) {
+        return ReportProgress(copied, size);
+    };
+    QString nativeSource = QDir::toNativeSeparators(sourcePath);
+    QString nativeTemp = QDir::toNativeSeparators(tempPath);
+    QString nativeTarget = QDir::toNativeSeparators(targetPath);
+    if(!CopyFileExW(reinterpret_cast<LPCWSTR>(nativeSource.utf16()), reinterpret_cast<LPCWSTR>(nativeTemp.utf16()),
+                    CopyProgressRoutine, &progress, nullptr, 0))
+    {
+        DWORD error = GetLastError();
+        QFile::remove(tempPath);
+        _error = error == ERROR_REQUEST_ABORTED ? QString("复制已取消") : QString("复制文件失败：%1").arg(qt_error_string(error));
+        return false;
+    }
+
+    if(!MoveFileExW(reinterpret_cast<LPCWSTR>(nativeTemp.utf16()), reinterpret_cast<LPCWSTR>(nativeTarget.utf16()),
+                    MOVEFILE_REPLACE_EXISTING))
+    {
+        _error = QString("无法替换目标文件：%1").arg(qt_error_string(GetLastError()));
+        QFile::remove(tempPath);
+        return false;
+    }
+
+    _method = Method::SystemCopy;
+    return true;
+#else
+    QSaveFile target(targetPath);
+    if(!target.open(QIODevice::WriteOnly))
+    {
+        _error = QString("无法创建目标文件：%1").arg(target.errorString());
+        return false;
+    }
+
+    qint64 copied = 0;
+
+#ifdef Q_OS_LINUX
+    int in = source.handle();
+    int out = target.handle();
+
+#ifdef FICLONE
+    // 同一文件系统且支持写时复制时，只增加数据块引用，不论文件多大都立即完成
+    if(total > 0 && ::ioctl(out, FICLONE, in) == 0)
+    {
+        _method = Method::Clone;
+        copied = total;
+        if(!ReportProgress(copied, total))
+        {
+            target.cancelWriting();
+            _error = "复制已取消";
+            return false;
+        }
+    }
+#endif
+
+    // 数据在内核中从页缓存复制到目标，不经过用户空间。
+    // 旧内核不支持跨文件系统的 copy_file_range，改用 sendfile；都不支持时分块读写
+    bool useCopyFileRange = true;
+    loff_t inOffset = 0;
+    loff_t outOffset = 0;
+    while(_method != Method::Clone && copied < total)
+    {
+        size_t count = static_cast<size_t>(qMin(kKernelChunkSize, total - copied));
+        ssize_t length;
+        if(useCopyFileRange)
+        {
+            length = ::copy_file_range(in, &inOffset, out, &outOffset, count, 0);
+            if(length < 0 && copied == 0 &&
+               (errno == EXDEV || errno == ENOSYS || errno == EOPNOTSUPP || errno == EINVAL))
+            {
+                useCopyFileRange = false;
+                continue;
+            }
+        }
+        else
+        {
+            off_t offset = copied;
+            length = ::sendfile(out, in, &offset, count);
+            if(length < 0 && copied == 0 && (errno == EINVAL || errno == ENOSYS))
+            {
+                break;
+            }
+        }
+
+        if(length < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            _error = QString("复制文件失败：%1").arg(qt_error_string(errno));
+            target.cancelWriting();
+            return false;
+        }
+        if(length == 0)
+        {
+            // 源文件在复制过程中变短
+            break;
+        }
+
+        _method = Method::KernelCopy;
+        copied += length;
+        if(!ReportProgress(copied, total))
+        {
+            target.cancelWriting();
+            _error = "复制已取消";
+            return false;
+        }
+    }
+#endif
+
+    // 内核复制都不可用时从头分块读写，这时源和目标都还没有读写过
+    if(_method == Method::None)
+    {
+        _method = Method::BufferedCopy;
+        QByteArray buffer(kBufferSize, Qt::Uninitialized);
+        for(;;)
+        {
+            qint64 length = source.read(buffer.data(), buffer.size());
+            if(length < 0)
+            {
+                _error = QString("读取源文件失败：%1").arg(source.errorString());
+                target.cancelWriting();
+                return false;
+            }
+            if(length == 0)
+            {
+                break;
+            }
+            if(target.write(buffer.constData(), length) != length)
+            {
+                _error = QString("写入目标文件失败：%1").arg(target.errorString());
+                target.cancelWriting();
+                return false;
+            }
+
+            copied += length;
+            if(!ReportProgress(copied, total))
+            {
+                target.cancelWriting();
+                _error = "复制已取消";
+                return false;
+            }
+        }
+    }
+
+    if(!target.commit())
+    {
+        _error = QString("写入目标文件失败：%1").arg(target.errorString());
+        return false;
+    }
+    return true;
+#endif
+}
+
+QString FileTransfer::ErrorString() const
+{
+    return _error;
+}
+
+FileTransfer::Method FileTransfer::LastMethod() const
+{
+    return _method;
+}
+
+void FileTransfer::SetProgressCallback(std::function<bool(qint64 copied, qint64 total)> callback)
+{
+    _progressCallback = std::move(callback);
+}
+
+bool FileTransfer::ReportProgress(qint64 copied, qint64 total)
+{
+    return !_progressCallback || _progressCallback(copied, total);
+}
+
+void CopyFileInBackground(QWidget* parent, const QString& labelText, const QString& sourcePath,
+                          const QString& targetPath, std::function<void(const FileTransferResult&)> done)
+{
+    QProgressDialog* progress = new QProgressDialog(labelText, "取消", 0, 1000, parent);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(500);
+    progress->setValue(0);
+
+    auto canceled = std::make_shared<std::atomic_bool>(false);
+    QObject::connect(progress, &QProgressDialog::canceled, progress, [canceled]() { *canceled = true; });
+
+    QPointer<QProgressDialog> progressPointer(progress);
+    QtConcurrent::run([sourcePath, targetPath, progressPointer, canceled]() {
+        FileTransfer transfer;
+        transfer.SetProgressCallback([progressPointer, canceled](qint64 copied, qint64 total) {
+            int value = total > 0 ? static_cast<int>(copied * 1000 / total) : 1000;
+            QMetaObject::invokeMethod(qApp, [progressPointer, value]() {
+                if(progressPointer)
+                    progressPointer->setValue(value);
+            }, Qt::QueuedConnection);
+            return !*canceled;
+        });
+
+        FileTransferResult result;
+        result.success = transfer.Copy(sourcePath, targetPath);
+        result.errorString = transfer.ErrorString();
+        return result;
+    }).then(parent, [progress, canceled, done](const FileTransferResult& result) {
+        progress->deleteLater();
+        if(*canceled) {
+            return;
+        }
+        done(result);
+    });
+}
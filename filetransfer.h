@@ -0,0 +1,63 @@
+#ifndef FILETRANSFER_H
+#define FILETRANSFER_H
+
+#include <QString>
+#include <functional>
+
+class QWidget;
+
+// 复制结果，用于从工作线程返回界面线程
+struct FileTransferResult
+{
+    bool success = false;
+    QString errorString;
+};
+
+// 文件复制
+// 按顺序尝试：写时复制克隆（Linux FICLONE，Btrfs、XFS 等文件系统上只共享数据块，不复制内容），
+// 内核内复制（copy_file_range，不支持时用 sendfile），最后分块读写。
+// Windows 使用 CopyFileEx，由系统决定是否块克隆。
+// 前两种方式数据不经过用户空间，分块读写也只占用固定大小的缓冲区。
+// 先写入目标目录中的临时文件，完成后替换目标，失败或取消时目标保持不变。
+class FileTransfer
+{
+public:
+    // 实际使用的复制方式，用于日志
+    enum class Method
+    {
+        None,
+        Clone,
+        KernelCopy,
+        SystemCopy,
+        BufferedCopy
+    };
+
+    FileTransfer();
+
+    FileTransfer(const FileTransfer&) = delete;
+    FileTransfer& operator=(const FileTransfer&) = delete;
+
+    // 复制 sourcePath 到 targetPath，目标已存在时覆盖
+    bool Copy(const QString& sourcePath, const QString& targetPath);
+
+    QString ErrorString() const;
+    Method LastMethod() const;
+
+    // 复制过程中按块调用，返回false时取消复制
+    void SetProgressCallback(std::function<bool(qint64 copied, qint64 total)> callback);
+
+private:
+    bool ReportProgress(qint64 copied, qint64 total);
+
+private:
+    std::function<bool(qint64, qint64)> _progressCallback;
+    QString _error;
+    Method _method;
+};
+
+// 在后台线程复制文件，显示可取消的进度对话框，进度按千分比排队回到界面线程更新。
+// 复制结束后在界面线程调用 done；取消复制或 parent 已销毁时不调用
+void CopyFileInBackground(QWidget* parent, const QString& labelText, const QString& sourcePath,
+                          const QString& targetPath, std::function<void(const FileTransferResult&)> done);
+
+#endif // FILETRANSFER_H
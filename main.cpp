@@ -1,7 +1,10 @@
 #include "mainwindow.h"
 #include "Databasemanagement.h"
+#include "blobstore.h"
+#include "contentindexer.h"
 #include "logindialog.h"
 #include <QApplication>
+#include <QDir>
 #include <QMessageBox>
 
 int main(int argc, char *argv[])
@@ -14,9 +17,30 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    // 上传的文件保存在数据库旁的内容存储区
+    if(!BlobStore::Instance()->Initialize(QDir::currentPath() + "/blobs"))
+    {
+        QMessageBox::critical(nullptr, "错误", "初始化文件存储区失败！");
+        DataBaseManagement::Instance()->Shutdown();
+        return -1;
+    }
+    BlobStore::Instance()->CollectGarbage();
+
+    // 后台增量提取文档正文，建立全文索引
+    ContentIndexer::Instance()->Start();
+
+    // 事件循环结束前关闭数据库，检查点在数据库线程上执行，此时 QApplication 仍然存在。
+    // 先停止正文索引，避免关闭后还有批次写入
+    QObject::connect(&a, &QCoreApplication::aboutToQuit, []() {
+        ContentIndexer::Instance()->Stop();
+        DataBaseManagement::Instance()->Shutdown();
+    });
+
     LoginDialog loginDialog;
     if(loginDialog.exec() != QDialog::Accepted)
     {
+        ContentIndexer::Instance()->Stop();
+        DataBaseManagement::Instance()->Shutdown();
         return 0;
     }
 
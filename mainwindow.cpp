@@ -3,6 +3,7 @@
 #include "usermanagementwidget.h"
 #include "filemanagementwidget.h"
 #include "projectmanagementwidget.h"
+#include "dashboardwidget.h"
 #include "logindialog.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -90,15 +91,17 @@ void MainWindow::setupUI()
     _contentWidget->setStyleSheet("background-color: #ECF0F1;");
     mainLayout->addWidget(_contentWidget);
     
-    // 创建三个主要功能模块
+    // 创建各功能模块
     _userManagementWidget = new UserManagementWidget(_contentWidget);
     _fileManagementWidget = new FileManagementWidget(_contentWidget);
     _projectManagementWidget = new ProjectManagementWidget(_contentWidget);
+    _dashboardWidget = new DashboardWidget(_contentWidget);
     
     // 添加到内容区域
     _contentWidget->addWidget(_userManagementWidget);
     _contentWidget->addWidget(_fileManagementWidget);
     _contentWidget->addWidget(_projectManagementWidget);
+    _contentWidget->addWidget(_dashboardWidget);
 }
 
 void MainWindow::setupNavigationPanel()
@@ -159,6 +162,16 @@ void MainWindow::setupNavigationPanel()
     });
     navLayout->addWidget(projectBtn);
     
+    // 统计概览按钮
+    QPushButton* dashboardBtn = new QPushButton("统计概览", _navigationPanel);
+    dashboardBtn->setStyleSheet(buttonStyle);
+    dashboardBtn->setCheckable(true);
+    dashboardBtn->setProperty("index", 3);
+    connect(dashboardBtn, &QPushButton::clicked, [this, dashboardBtn]() {
+        onNavigationClicked(dashboardBtn->property("index").toInt());
+    });
+    navLayout->addWidget(dashboardBtn);
+    
     navLayout->addStretch();
     
     // 注销按钮
@@ -17,6 +17,7 @@ QT_END_NAMESPACE
 class UserManagementWidget;
 class FileManagementWidget;
 class ProjectManagementWidget;
+class DashboardWidget;
 
 class MainWindow : public QMainWindow
 {
@@ -47,5 +48,6 @@ private:
     UserManagementWidget* _userManagementWidget;
     FileManagementWidget* _fileManagementWidget;
     ProjectManagementWidget* _projectManagementWidget;
+    DashboardWidget* _dashboardWidget;
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,104 @@
+#include <QColor>
+#include <QStringList>
+#include "nodetablemodel.h"
+
+NodeTableModel::NodeTableModel(QObject* parent) : PagedTableModel(parent)
+{
+
+}
+
+void NodeTableModel::SetNodes(const NodeTree& tree)
+{
+    beginResetModel();
+
+    _rows.clear();
+    _rows.reserve(tree.Size());
+    for(int i = 0; i < tree.Size(); ++i)
+    {
+        const ProjectNode& node = tree.NodeAt(i);
+        Row row;
+        row.id = node.id;
+        row.depth = tree.Depth(i);
+        row.isCompleted = node.isCompleted;
+        row.creationTime = node.creationTime;
+        row.estimatedCompletionTime = node.estimatedCompletionTime;
+        row.name = node.name;
+        row.rollup = tree.Rollup(i);
+        _rows.append(row);
+    }
+
+    ResetRowCount(_rows.size());
+    endResetModel();
+}
+
+int NodeTableModel::NodeIdAt(int row) const
+{
+    return (row >= 0 && row < _rows.size()) ? _rows[row].id : -1;
+}
+
+QString NodeTableModel::NodeNameAt(int row) const
+{
+    return (row >= 0 && row < _rows.size()) ? _rows[row].name : QString();
+}
+
+bool NodeTableModel::IsCompletedAt(int row) const
+{
+    return (row >= 0 && row < _rows.size()) ? _rows[row].isCompleted : false;
+}
+
+int NodeTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : 8;
+}
+
+QVariant NodeTableModel::data(const QModelIndex& index, int role) const
+{
+    if(!index.isValid() || index.row() >= rowCount())
+    {
+        return QVariant();
+    }
+
+    const Row& row = _rows[index.row()];
+
+    // 已完成节点使用不同的背景色
+    if(role == Qt::BackgroundRole)
+    {
+        return row.isCompleted ? QVariant(QColor(200, 255, 200)) : QVariant(); // 浅绿色
+    }
+
+    // 子树中有逾期节点时标红
+    if(role == Qt::ForegroundRole)
+    {
+        return (index.column() == 6 && row.rollup.overdueCount > 0) ? QVariant(QColor(Qt::red)) : QVariant();
+    }
+
+    if(role != Qt::DisplayRole)
+    {
+        return QVariant();
+    }
+
+    switch(index.column())
+    {
+        case 0: return row.id;
+        case 1: return QString(row.depth * 4, QChar(' ')) + row.name;
+        case 2: return row.creationTime.toString("yyyy-MM-dd");
+        case 3: return row.estimatedCompletionTime.toString("yyyy-MM-dd");
+        case 4: return row.isCompleted ? QString("已完成") : QString("进行中");
+        case 5: return QString("%1% (%2/%3)").arg(row.rollup.CompletionPercent())
+                    .arg(row.rollup.completedCount).arg(row.rollup.nodeCount);
+        case 6: return row.rollup.overdueCount;
+        case 7: return row.rollup.documentCount;
+        default: return QVariant();
+    }
+}
+
+QVariant NodeTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    static const QStringList headers = {"ID", "节点名称", "创建时间", "预计完成时间", "状态", "完成度", "逾期", "文档"};
+    if(orientation == Qt::Horizontal && role == Qt::DisplayRole && section < headers.size())
+    {
+        return headers[section];
+    }
+
+    return PagedTableModel::headerData(section, orientation, role);
+}
@@ -0,0 +1,43 @@
+#ifndef NODETABLEMODEL_H
+#define NODETABLEMODEL_H
+
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+#include "pagedtablemodel.h"
+#include "DBModels.h"
+#include "nodetree.h"
+
+// 项目节点表格模型，按节点树的先序排列，名称按层次缩进
+class NodeTableModel : public PagedTableModel
+{
+    Q_OBJECT
+public:
+    explicit NodeTableModel(QObject* parent = nullptr);
+
+    void SetNodes(const NodeTree& tree);
+
+    int NodeIdAt(int row) const;
+    QString NodeNameAt(int row) const;
+    bool IsCompletedAt(int row) const;
+
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    struct Row
+    {
+        int id;
+        int depth;
+        bool isCompleted;
+        QDateTime creationTime;
+        QDateTime estimatedCompletionTime;
+        QString name;
+        NodeRollup rollup;          // 子树汇总
+    };
+
+    QVector<Row> _rows;
+};
+
+#endif // NODETABLEMODEL_H
@@ -0,0 +1,375 @@
+#include <QPair>
+#include <algorithm>
+#include <numeric>
+#include "nodetree.h"
+
+static void Accumulate(NodeRollup& target, const NodeRollup& value, int sign = 1)
+{
+    target.nodeCount += sign * value.nodeCount;
+    target.completedCount += sign * value.completedCount;
+    target.overdueCount += sign * value.overdueCount;
+    target.documentCount += sign * value.documentCount;
+}
+
+int NodeRollup::CompletionPercent() const
+{
+    return nodeCount > 0 ? completedCount * 100 / nodeCount : 0;
+}
+
+NodeTree::NodeTree()
+{
+
+}
+
+void NodeTree::Build(const QVector<ProjectNode>& nodes, const QHash<int, int>& documentCounts)
+{
+    Clear();
+    _referenceTime = QDateTime::currentDateTime();
+
+    const int count = nodes.size();
+    QHash<int, int> inputIndex;
+    inputIndex.reserve(count);
+    for(int i = 0; i < count; ++i)
+    {
+        inputIndex.insert(nodes[i].id, i);
+    }
+
+    // 按ID排序，同级节点按创建顺序排列
+    QVector<int> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&nodes](int a, int b) {
+        return nodes[a].id < nodes[b].id;
+    });
+
+    // 输入数组中的父子关系，同样按 CSR 存放
+    QVector<int> inputParents(count, -1);
+    QVector<int> inputOffsets(count + 1, 0);
+    for(int i = 0; i < count; ++i)
+    {
+        const ProjectNode& node = nodes[i];
+        if(node.parentId > 0 && node.parentId != node.id)
+        {
+            int parent = inputIndex.value(node.parentId, -1);
+            inputParents[i] = parent;
+            if(parent >= 0)
+            {
+                ++inputOffsets[parent + 1];
+            }
+        }
+    }
+    for(int i = 0; i < count; ++i)
+    {
+        inputOffsets[i + 1] += inputOffsets[i];
+    }
+    QVector<int> inputChildren(inputOffsets[count]);
+    QVector<int> positions = inputOffsets;
+    for(int i : order)
+    {
+        if(inputParents[i] >= 0)
+        {
+            inputChildren[positions[inputParents[i]]++] = i;
+        }
+    }
+
+    _nodes.reserve(count);
+    _parents.reserve(count);
+    _depths.reserve(count);
+    _documentCounts.reserve(count);
+    _indexById.reserve(count);
+
+    // 用显式栈做先序遍历，层次很深时也不会栈溢出
+    QVector<bool> visited(count, false);
+    QVector<QPair<int, int>> stack;     // 输入下标，父节点的先序下标
+    auto visit = [&](int root) {
+        stack.append(qMakePair(root, -1));
+        while(!stack.isEmpty())
+        {
+            QPair<int, int> item = stack.takeLast();
+            int input = item.first;
+            int parent = item.second;
+            if(visited[input])
+            {
+                continue;
+            }
+            visited[input] = true;
+
+            int index = _nodes.size();
+            _nodes.append(nodes[input]);
+            _parents.append(parent);
+            _depths.append(parent >= 0 ? _depths[parent] + 1 : 0);
+            _documentCounts.append(documentCounts.value(nodes[input].id, 0));
+            _indexById.insert(nodes[input].id, index);
+            if(parent < 0)
+            {
+                _roots.append(index);
+            }
+
+            // 逆序入栈，出栈时按ID顺序
+            for(int k = inputOffsets[input + 1] - 1; k >= inputOffsets[input]; --k)
+            {
+                stack.append(qMakePair(inputChildren[k], index));
+            }
+        }
+    };
+
+    for(int i : order)
+    {
+        if(inputParents[i] < 0)
+        {
+            visit(i);
+        }
+    }
+    // 剩下的节点在环上，从环上ID最小的节点断开，作为顶级节点
+    for(int i : order)
+    {
+        if(!visited[i])
+        {
+            visit(i);
+        }
+    }
+
+    // 父节点的下标总是小于子节点，逆序遍历一次即可自底向上得到子树大小和汇总
+    const int size = _nodes.size();
+    QVector<int> subtreeSizes(size, 1);
+    _subtreeEnds.resize(size);
+    _rollups.resize(size);
+    for(int i = size - 1; i >= 0; --i)
+    {
+        _subtreeEnds[i] = i + subtreeSizes[i];
+        Accumulate(_rollups[i], OwnRollup(i));
+
+        int parent = _parents[i];
+        if(parent >= 0)
+        {
+            subtreeSizes[parent] += subtreeSizes[i];
+            Accumulate(_rollups[parent], _rollups[i]);
+        }
+        else
+        {
+            Accumulate(_total, _rollups[i]);
+        }
+    }
+
+    // 先序下标上的子节点列表，每个节点的子节点按下标递增
+    _childOffsets.fill(0, size + 1);
+    for(int i = 0; i < size; ++i)
+    {
+        if(_parents[i] >= 0)
+        {
+            ++_childOffsets[_parents[i] + 1];
+        }
+    }
+    for(int i = 0; i < size; ++i)
+    {
+        _childOffsets[i + 1] += _childOffsets[i];
+    }
+    _children.resize(_childOffsets[size]);
+    positions = _childOffsets;
+    for(int i = 0; i < size; ++i)
+    {
+        if(_parents[i] >= 0)
+        {
+            _children[positions[_parents[i]]++] = i;
+        }
+    }
+}
+
+void NodeTree::Clear()
+{
+    _nodes.clear();
+    _parents.clear();
+    _depths.clear();
+    _subtreeEnds.clear();
+    _childOffsets.clear();
+    _children.clear();
+    _roots.clear();
+    _documentCounts.clear();
+    _rollups.clear();
+    _indexById.clear();
+    _total = NodeRollup();
+}
+
+int NodeTree::Size() const
+{
+    return _nodes.size();
+}
+
+bool NodeTree::IsEmpty() const
+{
+    return _nodes.isEmpty();
+}
+
+int NodeTree::IndexOf(int nodeId) const
+{
+    return _indexById.value(nodeId, -1);
+}
+
+const ProjectNode& NodeTree::NodeAt(int index) const
+{
+    return _nodes[index];
+}
+
+const ProjectNode* NodeTree::Find(int nodeId) const
+{
+    int index = IndexOf(nodeId);
+    return index >= 0 ? &_nodes[index] : nullptr;
+}
+
+int NodeTree::ParentIndex(int index) const
+{
+    return _parents[index];
+}
+
+int NodeTree::Depth(int index) const
+{
+    return _depths[index];
+}
+
+int NodeTree::ChildCount(int index) const
+{
+    return _childOffsets[index + 1] - _childOffsets[index];
+}
+
+int NodeTree::ChildAt(int index, int position) const
+{
+    return _children[_childOffsets[index] + position];
+}
+
+const QVector<int>& NodeTree::Roots() const
+{
+    return _roots;
+}
+
+int NodeTree::SubtreeEnd(int index) const
+{
+    return _subtreeEnds[index];
+}
+
+bool NodeTree::IsInSubtree(int index, int rootIndex) const
+{
+    return index >= rootIndex && index < _subtreeEnds[rootIndex];
+}
+
+int NodeTree::DocumentCount(int index) const
+{
+    return _documentCounts[index];
+}
+
+NodeRollup NodeTree::Rollup(int index) const
+{
+    return _rollups[index];
+}
+
+NodeRollup NodeTree::Total() const
+{
+    return _total;
+}
+
+bool NodeTree::Add(const ProjectNode& node)
+{
+    if(node.id <= 0 || _indexById.contains(node.id))
+    {
+        return false;
+    }
+    if(node.parentId > 0 && !_indexById.contains(node.parentId))
+    {
+        return false;
+    }
+
+    QVector<ProjectNode> nodes = _nodes;
+    nodes.append(node);
+    Build(nodes, DocumentCounts());
+    return true;
+}
+
+bool NodeTree::Update(const ProjectNode& node)
+{
+    int index = IndexOf(node.id);
+    if(index < 0)
+    {
+        return false;
+    }
+
+    // 父节点改变时子树的下标区间整体移动，重新构建
+    int parent = node.parentId > 0 ? IndexOf(node.parentId) : -1;
+    if(parent != _parents[index])
+    {
+        QVector<ProjectNode> nodes = _nodes;
+        nodes[index] = node;
+        Build(nodes, DocumentCounts());
+        return true;
+    }
+
+    NodeRollup before = OwnRollup(index);
+    _nodes[index] = node;
+    ApplyDelta(index, before, OwnRollup(index));
+    return true;
+}
+
+bool NodeTree::Remove(int nodeId)
+{
+    int index = IndexOf(nodeId);
+    if(index < 0)
+    {
+        return false;
+    }
+
+    QVector<ProjectNode> nodes;
+    nodes.reserve(_nodes.size() - (_subtreeEnds[index] - index));
+    nodes.append(_nodes.mid(0, index));
+    nodes.append(_nodes.mid(_subtreeEnds[index]));
+    Build(nodes, DocumentCounts());
+    return true;
+}
+
+bool NodeTree::SetDocumentCount(int nodeId, int count)
+{
+    int index = IndexOf(nodeId);
+    if(index < 0)
+    {
+        return false;
+    }
+
+    NodeRollup before = OwnRollup(index);
+    _documentCounts[index] = count;
+    ApplyDelta(index, before, OwnRollup(index));
+    return true;
+}
+
+NodeRollup NodeTree::OwnRollup(int index) const
+{
+    const ProjectNode& node = _nodes[index];
+    NodeRollup rollup;
+    rollup.nodeCount = 1;
+    rollup.completedCount = node.isCompleted ? 1 : 0;
+    rollup.overdueCount = (!node.isCompleted && node.estimatedCompletionTime.isValid() &&
+                           node.estimatedCompletionTime < _referenceTime) ? 1 : 0;
+    rollup.documentCount = _documentCounts[index];
+    return rollup;
+}
+
+void NodeTree::ApplyDelta(int index, const NodeRollup& before, const NodeRollup& after)
+{
+    // 只影响该节点和它的祖先
+    for(int i = index; i >= 0; i = _parents[i])
+    {
+        Accumulate(_rollups[i], before, -1);
+        Accumulate(_rollups[i], after);
+    }
+    Accumulate(_total, before, -1);
+    Accumulate(_total, after);
+}
+
+QHash<int, int> NodeTree::DocumentCounts() const
+{
+    QHash<int, int> counts;
+    counts.reserve(_nodes.size());
+    for(int i = 0; i < _nodes.size(); ++i)
+    {
+        if(_documentCounts[i] > 0)
+        {
+            counts.insert(_nodes[i].id, _documentCounts[i]);
+        }
+    }
+    return counts;
+}
@@ -0,0 +1,88 @@
+#ifndef NODETREE_H
+#define NODETREE_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QVector>
+#include "DBModels.h"
+
+// 子树汇总，包括子树的根节点本身
+struct NodeRollup
+{
+    int nodeCount = 0;
+    int completedCount = 0;
+    int overdueCount = 0;           // 未完成且已过预计完成时间
+    int documentCount = 0;          // 各节点关联的文件数之和
+
+    // 已完成节点的百分比，没有节点时为0
+    int CompletionPercent() const;
+};
+
+// 项目节点树
+// 节点按先序（深度优先）存放在连续数组中，下标即显示顺序，每个节点的子树占据一段连续下标。
+// 子节点按 CSR 方式存放：_children 中 [_childOffsets[i], _childOffsets[i + 1]) 为节点 i 的子节点。
+// 节点ID到下标、深度、子树范围和子树汇总都在构建时计算好，查询都是 O(1)。
+// 只修改节点属性时沿祖先链更新汇总；添加、删除和改变父节点时在内存中重新构建，不再查询数据库。
+class NodeTree
+{
+public:
+    NodeTree();
+
+    // 根据项目的全部节点构建，documentCounts 为节点ID到关联文件数的映射。
+    // 父节点不存在或父子关系形成环的节点作为顶级节点，同级节点按ID排列
+    void Build(const QVector<ProjectNode>& nodes, const QHash<int, int>& documentCounts = QHash<int, int>());
+    void Clear();
+
+    int Size() const;
+    bool IsEmpty() const;
+
+    // 节点ID对应的下标，不存在时返回-1
+    int IndexOf(int nodeId) const;
+    const ProjectNode& NodeAt(int index) const;
+    // 不存在时返回nullptr
+    const ProjectNode* Find(int nodeId) const;
+
+    // 顶级节点的父节点下标为-1，深度为0
+    int ParentIndex(int index) const;
+    int Depth(int index) const;
+    int ChildCount(int index) const;
+    int ChildAt(int index, int position) const;
+    const QVector<int>& Roots() const;
+
+    // 子树占据下标 [index, SubtreeEnd(index))
+    int SubtreeEnd(int index) const;
+    bool IsInSubtree(int index, int rootIndex) const;
+
+    int DocumentCount(int index) const;
+    NodeRollup Rollup(int index) const;
+    NodeRollup Total() const;
+
+    // 添加节点，ID已存在或父节点不存在时返回false
+    bool Add(const ProjectNode& node);
+    // 更新节点，不存在时返回false
+    bool Update(const ProjectNode& node);
+    // 删除节点及其子树，与数据库的级联删除一致
+    bool Remove(int nodeId);
+    bool SetDocumentCount(int nodeId, int count);
+
+private:
+    NodeRollup OwnRollup(int index) const;
+    void ApplyDelta(int index, const NodeRollup& before, const NodeRollup& after);
+    QHash<int, int> DocumentCounts() const;
+
+private:
+    QVector<ProjectNode> _nodes;
+    QVector<int> _parents;
+    QVector<int> _depths;
+    QVector<int> _subtreeEnds;
+    QVector<int> _childOffsets;
+    QVector<int> _children;
+    QVector<int> _roots;
+    QVector<int> _documentCounts;
+    QVector<NodeRollup> _rollups;
+    QHash<int, int> _indexById;
+    NodeRollup _total;
+    QDateTime _referenceTime;       // 构建时的时间，用于判断是否逾期
+};
+
+#endif // NODETREE_H
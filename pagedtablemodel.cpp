@@ -0,0 +1,82 @@
+#include "pagedtablemodel.h"
+
+// 每次多显示的行数
+static const int kBatchSize = 256;
+
+PagedTableModel::PagedTableModel(QObject* parent)
+    : QAbstractTableModel(parent)
+    , _availableRows(0)
+    , _visibleRows(0)
+    , _appendingRows(0)
+{
+
+}
+
+int PagedTableModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : _visibleRows;
+}
+
+bool PagedTableModel::canFetchMore(const QModelIndex& parent) const
+{
+    if(parent.isValid())
+    {
+        return false;
+    }
+
+    return _visibleRows < _availableRows || CanFetchNextPage();
+}
+
+void PagedTableModel::fetchMore(const QModelIndex& parent)
+{
+    if(parent.isValid())
+    {
+        return;
+    }
+
+    int count = qMin(kBatchSize, _availableRows - _visibleRows);
+    if(count <= 0)
+    {
+        // 已加载的行都已显示，继续从数据库加载
+        if(CanFetchNextPage())
+        {
+            FetchNextPage();
+        }
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), _visibleRows, _visibleRows + count - 1);
+    _visibleRows += count;
+    endInsertRows();
+}
+
+void PagedTableModel::ResetRowCount(int availableRows)
+{
+    _availableRows = availableRows;
+    _visibleRows = qMin(kBatchSize, availableRows);
+}
+
+bool PagedTableModel::CanFetchNextPage() const
+{
+    return false;
+}
+
+void PagedTableModel::FetchNextPage()
+{
+
+}
+
+void PagedTableModel::BeginAppendRows(int count)
+{
+    // 新页追加在已加载行之后，并直接显示
+    _appendingRows = count;
+    beginInsertRows(QModelIndex(), _availableRows, _availableRows + count - 1);
+}
+
+void PagedTableModel::EndAppendRows()
+{
+    _availableRows += _appendingRows;
+    _visibleRows = _availableRows;
+    _appendingRows = 0;
+    endInsertRows();
+}
@@ -0,0 +1,39 @@
+#ifndef PAGEDTABLEMODEL_H
+#define PAGEDTABLEMODEL_H
+
+#include <QAbstractTableModel>
+
+// 分批显示的表格模型基类
+// 派生类保存紧凑的行数据并实现 columnCount/data/headerData。视图只对 rowCount() 范围内的行布局，
+// 滚动到底部时通过 canFetchMore/fetchMore 每次多显示一批，大表格首次显示只需处理第一批行。
+// 按页从数据库加载的派生类重写 CanFetchNextPage/FetchNextPage，数据返回后用
+// BeginAppendRows/EndAppendRows 追加，内存中只保存已经滚动到的页。
+class PagedTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit PagedTableModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+protected:
+    // 在 beginResetModel/endResetModel 之间调用，设置可显示的总行数并只显示第一批
+    void ResetRowCount(int availableRows);
+
+    // 已加载的行全部显示后，是否还能从数据库加载下一页
+    virtual bool CanFetchNextPage() const;
+    virtual void FetchNextPage();
+
+    // 追加新加载的一页，count 为该页行数
+    void BeginAppendRows(int count);
+    void EndAppendRows();
+
+private:
+    int _availableRows;
+    int _visibleRows;
+    int _appendingRows;
+};
+
+#endif // PAGEDTABLEMODEL_H
@@ -1,5 +1,9 @@
 #include "projectmanagementwidget.h"
 #include "Databasemanagement.h"
+#include "databaseexecutor.h"
+#include "filetransfer.h"
+#include "nodetablemodel.h"
+#include "projecttablemodel.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QHeaderView>
@@ -13,14 +17,33 @@
 #include <QDateEdit>
 #include <QTextEdit>
 #include <QGroupBox>
+#include <QListWidget>
+#include <QColor>
 #include <QDesktopServices>
+#include <QDir>
 #include <QSqlQuery>
 #include <QDebug>
+#include <QThread>
+#include <algorithm>
+
+static QString FormatScheduleDate(const QDate& date)
+{
+    return date.isValid() ? date.toString("yyyy-MM-dd") : QString("-");
+}
+
+// 数值列按数值排序
+static QTableWidgetItem* NumberItem(int value)
+{
+    QTableWidgetItem* item = new QTableWidgetItem();
+    item->setData(Qt::DisplayRole, value);
+    return item;
+}
 
 ProjectManagementWidget::ProjectManagementWidget(QWidget *parent)
     : QWidget(parent)
     , _currentUser()
     , _currentProject()
+    , _detailGeneration(0)
 {
     setupUI();
     updateUIBasedOnRole();
@@ -63,6 +86,12 @@ void ProjectManagementWidget::setupProjectListView()
     _searchBox->setPlaceholderText("搜索项目...");
     _searchBox->setClearButtonEnabled(true);
     connect(_searchBox, &QLineEdit::returnPressed, this, &ProjectManagementWidget::searchProjects);
+    // 输入停顿后自动搜索，回车立即搜索
+    _searchTimer = new QTimer(this);
+    _searchTimer->setSingleShot(true);
+    _searchTimer->setInterval(300);
+    connect(_searchTimer, &QTimer::timeout, this, &ProjectManagementWidget::searchProjects);
+    connect(_searchBox, &QLineEdit::textChanged, _searchTimer, qOverload<>(&QTimer::start));
     topLayout->addWidget(_searchBox);
     
     _statusFilter = new QComboBox();
@@ -77,7 +106,9 @@ void ProjectManagementWidget::setupProjectListView()
     _editProjectButton = new QPushButton("编辑项目");
     _deleteProjectButton = new QPushButton("删除项目");
     QPushButton* refreshButton = new QPushButton("刷新");
+    QPushButton* portfolioButton = new QPushButton("进度分析");
     
+    connect(portfolioButton, &QPushButton::clicked, this, &ProjectManagementWidget::onShowPortfolioSchedule);
     connect(_addProjectButton, &QPushButton::clicked, this, &ProjectManagementWidget::onAddProject);
     connect(_editProjectButton, &QPushButton::clicked, this, &ProjectManagementWidget::onEditProject);
     connect(_deleteProjectButton, &QPushButton::clicked, this, &ProjectManagementWidget::onDeleteProject);
@@ -87,21 +118,22 @@ void ProjectManagementWidget::setupProjectListView()
     topLayout->addWidget(_editProjectButton);
     topLayout->addWidget(_deleteProjectButton);
     topLayout->addWidget(refreshButton);
+    topLayout->addWidget(portfolioButton);
     
     layout->addLayout(topLayout);
     
     // 项目表格
-    _projectsTable = new QTableWidget();
-    _projectsTable->setColumnCount(6);
-    _projectsTable->setHorizontalHeaderLabels({"ID", "项目名称", "项目经理", "创建时间", "预计完成时间", "状态"});
+    _projectsModel = new ProjectTableModel(this);
+    _projectsTable = new QTableView();
+    _projectsTable->setModel(_projectsModel);
     _projectsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     _projectsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     _projectsTable->setSelectionMode(QAbstractItemView::SingleSelection);
     _projectsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     _projectsTable->verticalHeader()->setVisible(false);
     
-    connect(_projectsTable, &QTableWidget::cellDoubleClicked, [this](int row, int column) {
-        int projectId = _projectsTable->item(row, 0)->text().toInt();
+    connect(_projectsTable, &QTableView::doubleClicked, [this](const QModelIndex& index) {
+        int projectId = _projectsModel->ProjectIdAt(index.row());
         onViewProjectDetail(projectId);
     });
     
@@ -173,7 +205,9 @@ void ProjectManagementWidget::setupProjectDetailView()
     _addNodeButton = new QPushButton("添加节点");
     _editNodeButton = new QPushButton("编辑节点");
     _deleteNodeButton = new QPushButton("删除节点");
+    QPushButton* scheduleButton = new QPushButton("进度计划");
     
+    connect(scheduleButton, &QPushButton::clicked, this, &ProjectManagementWidget::onShowSchedule);
     connect(_addNodeButton, &QPushButton::clicked, this, &ProjectManagementWidget::onAddNode);
     connect(_editNodeButton, &QPushButton::clicked, this, &ProjectManagementWidget::onEditNode);
     connect(_deleteNodeButton, &QPushButton::clicked, this, &ProjectManagementWidget::onDeleteNode);
@@ -182,21 +216,22 @@ void ProjectManagementWidget::setupProjectDetailView()
     nodeButtonLayout->addWidget(_addNodeButton);
     nodeButtonLayout->addWidget(_editNodeButton);
     nodeButtonLayout->addWidget(_deleteNodeButton);
+    nodeButtonLayout->addWidget(scheduleButton);
     nodesLayout->addLayout(nodeButtonLayout);
     
-    _projectNodesTable = new QTableWidget();
-    _projectNodesTable->setColumnCount(5);
-    _projectNodesTable->setHorizontalHeaderLabels({"ID", "节点名称", "创建时间", "预计完成时间", "状态"});
+    _projectNodesModel = new NodeTableModel(this);
+    _projectNodesTable = new QTableView();
+    _projectNodesTable->setModel(_projectNodesModel);
     _projectNodesTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     _projectNodesTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     _projectNodesTable->setSelectionMode(QAbstractItemView::SingleSelection);
     _projectNodesTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     _projectNodesTable->verticalHeader()->setVisible(false);
     
-    connect(_projectNodesTable, &QTableWidget::cellDoubleClicked, [this](int row, int column) {
-        if(column == 4) { // 状态列
-            int nodeId = _projectNodesTable->item(row, 0)->text().toInt();
-            bool isCompleted = _projectNodesTable->item(row, 4)->text() == "已完成";
+    connect(_projectNodesTable, &QTableView::doubleClicked, [this](const QModelIndex& index) {
+        if(index.column() == 4) { // 状态列
+            int nodeId = _projectNodesModel->NodeIdAt(index.row());
+            bool isCompleted = _projectNodesModel->IsCompletedAt(index.row());
             onNodeStatusChanged(nodeId, !isCompleted);
         }
     });
@@ -244,62 +279,67 @@ void ProjectManagementWidget::setupProjectDetailView()
 
 void ProjectManagementWidget::loadProjectData(const QString& status, const QString& search)
 {
-    _projectsTable->setRowCount(0);
-    
-    QVector<Project> projects = DataBaseManagement::Instance()->GetAllProjects();
-    
-    // 过滤项目状态
-    int filterStatus = _statusFilter->currentData().toInt();
-    if(filterStatus != -1) {
-        QVector<Project> filteredProjects;
-        for(const Project& project : projects) {
-            if((filterStatus == 1 && project.isCompleted) || 
-               (filterStatus == 0 && !project.isCompleted)) {
-                filteredProjects.append(project);
-            }
-        }
-        projects = filteredProjects;
-    }
-    
-    // 搜索过滤
-    QString searchText = _searchBox->text().trimmed();
-    if(!searchText.isEmpty()) {
-        QVector<Project> filteredProjects;
-        for(const Project& project : projects) {
-            if(project.name.contains(searchText, Qt::CaseInsensitive) || 
-               project.description.contains(searchText, Qt::CaseInsensitive) ||
-               project.managerName.contains(searchText, Qt::CaseInsensitive)) {
-                filteredProjects.append(project);
-            }
-        }
-        projects = filteredProjects;
+    // 状态和搜索过滤在数据库中完成，表格只加载滚动到的页
+    ProjectQuery query;
+    query.completed = _statusFilter->currentData().toInt();
+    query.searchText = _searchBox->text().trimmed();
+    _projectsModel->SetQuery(query);
+}
+
+// 在数据库线程上查询项目详情页需要的全部数据
+static ProjectDetailData QueryProjectDetail(DataBaseManagement* db, int projectId)
+{
+    ProjectDetailData detail{};
+    detail.project = db->GetProjectById(projectId);
+    if(detail.project.id == -1) {
+        return detail;
     }
     
-    // 填充表格
-    for(const Project& project : projects) {
-        int row = _projectsTable->rowCount();
-        _projectsTable->insertRow(row);
-        
-        _projectsTable->setItem(row, 0, new QTableWidgetItem(QString::number(project.id)));
-        _projectsTable->setItem(row, 1, new QTableWidgetItem(project.name));
-        _projectsTable->setItem(row, 2, new QTableWidgetItem(project.managerName));
-        _projectsTable->setItem(row, 3, new QTableWidgetItem(project.createTime.toString("yyyy-MM-dd")));
-        _projectsTable->setItem(row, 4, new QTableWidgetItem(project.estimatedCompleteTime.toString("yyyy-MM-dd")));
-        _projectsTable->setItem(row, 5, new QTableWidgetItem(project.isCompleted ? "已完成" : "进行中"));
-        
-        // 已完成项目行使用不同的背景色
-        if(project.isCompleted) {
-            for(int col = 0; col < _projectsTable->columnCount(); col++) {
-                QTableWidgetItem* item = _projectsTable->item(row, col);
-                item->setBackground(QColor(200, 255, 200)); // 浅绿色
-            }
+    detail.members = db->GetProjectUsers(projectId);
+    
+    // 项目经理可能不在项目成员中，需要单独查询
+    bool hasManager = false;
+    for(const User& user : detail.members) {
+        if(user.id == detail.project.managerId) {
+            hasManager = true;
+            break;
+        }
+    }
+    if(!hasManager) {
+        User manager = db->GetUserById(detail.project.managerId);
+        if(manager.id != -1) {
+            detail.manager = manager;
         }
     }
+    
+    detail.nodes = db->GetProjectNodes(projectId);
+    detail.documents = db->GetProjectDocumentsWithNodes(projectId);
+    detail.dependencies = db->GetProjectDependencies(projectId);
+    
+    return detail;
 }
 
 void ProjectManagementWidget::loadProjectDetail(int projectId)
 {
-    _currentProject = DataBaseManagement::Instance()->GetProjectById(projectId);
+    // 切换到其它项目时，在数据返回前禁用详情页，避免对上一个项目进行操作
+    if(projectId != _currentProject.id) {
+        _projectDetailView->setEnabled(false);
+    }
+    
+    // 在只读连接上查询，导入等写操作进行时不用排队。读取可能并行完成，只使用最后一次加载的结果
+    quint64 generation = ++_detailGeneration;
+    DataBaseExecutor::Instance()->RunRead(
+        [projectId](DataBaseManagement* db) { return QueryProjectDetail(db, projectId); },
+        this, [this, generation](const ProjectDetailData& detail) {
+            if(generation == _detailGeneration)
+                populateProjectDetail(detail);
+        });
+}
+
+void ProjectManagementWidget::populateProjectDetail(const ProjectDetailData& detail)
+{
+    _currentProject = detail.project;
+    _projectDetailView->setEnabled(true);
     
     if(_currentProject.id == -1) {
         QMessageBox::warning(this, "错误", "无法加载项目详情，项目可能已被删除。");
@@ -319,13 +359,10 @@ void ProjectManagementWidget::loadProjectDetail(int projectId)
     // 加载项目成员
     _projectMembersTable->setRowCount(0);
     
-    // 使用GetProjectUsers获取项目的所有成员
-    QVector<User> projectUsers = DataBaseManagement::Instance()->GetProjectUsers(projectId);
-    
     // 添加项目经理（可能不在GetProjectUsers返回的结果中）
     bool hasManager = false;
     
-    for(const User& user : projectUsers) {
+    for(const User& user : detail.members) {
         int row = _projectMembersTable->rowCount();
         _projectMembersTable->insertRow(row);
         
@@ -350,74 +387,82 @@ void ProjectManagementWidget::loadProjectDetail(int projectId)
     }
     
     // 如果项目经理不在项目成员列表中，单独添加
-    if(!hasManager) {
-        // 获取所有用户，找到项目经理
-        QVector<User> allUsers = DataBaseManagement::Instance()->GetAllUsers();
-        for(const User& user : allUsers) {
-            if(user.id == _currentProject.managerId) {
-                int row = _projectMembersTable->rowCount();
-                _projectMembersTable->insertRow(row);
-                
-                _projectMembersTable->setItem(row, 0, new QTableWidgetItem(QString::number(user.id)));
-                _projectMembersTable->setItem(row, 1, new QTableWidgetItem(user.userName));
-                _projectMembersTable->setItem(row, 2, new QTableWidgetItem("项目经理"));
-                break;
-            }
-        }
+    if(!hasManager && detail.manager.id == _currentProject.managerId) {
+        int row = _projectMembersTable->rowCount();
+        _projectMembersTable->insertRow(row);
+        
+        _projectMembersTable->setItem(row, 0, new QTableWidgetItem(QString::number(detail.manager.id)));
+        _projectMembersTable->setItem(row, 1, new QTableWidgetItem(detail.manager.userName));
+        _projectMembersTable->setItem(row, 2, new QTableWidgetItem("项目经理"));
     }
     
-    // 加载项目节点
-    _projectNodesTable->setRowCount(0);
-    QVector<ProjectNode> nodes = DataBaseManagement::Instance()->GetProjectNodes(projectId);
-    
-    for(const ProjectNode& node : nodes) {
-        int row = _projectNodesTable->rowCount();
-        _projectNodesTable->insertRow(row);
-        
-        _projectNodesTable->setItem(row, 0, new QTableWidgetItem(QString::number(node.id)));
-        _projectNodesTable->setItem(row, 1, new QTableWidgetItem(node.name));
-        _projectNodesTable->setItem(row, 2, new QTableWidgetItem(node.creationTime.toString("yyyy-MM-dd")));
-        _projectNodesTable->setItem(row, 3, new QTableWidgetItem(node.estimatedCompletionTime.toString("yyyy-MM-dd")));
-        _projectNodesTable->setItem(row, 4, new QTableWidgetItem(node.isCompleted ? "已完成" : "进行中"));
-        
-        // 已完成节点使用不同的背景色
-        if(node.isCompleted) {
-            for(int col = 0; col < _projectNodesTable->columnCount(); col++) {
-                QTableWidgetItem* item = _projectNodesTable->item(row, col);
-                item->setBackground(QColor(200, 255, 200)); // 浅绿色
-            }
-        }
+    // 加载项目节点，统计每个节点关联的文件数用于汇总
+    QHash<int, int> documentCounts;
+    for(const NodeDocument& document : detail.documents) {
+        ++documentCounts[document.nodeId];
     }
+    _nodeTree.Build(detail.nodes, documentCounts);
+    _schedule.Build(detail.nodes, detail.dependencies);
+    refreshNodes();
     
     // 加载项目文档
+    _documents = detail.documents;
+    refreshDocuments();
+    
+    // 更新按钮权限
+    updateUIBasedOnRole();
+}
+
+void ProjectManagementWidget::refreshNodes()
+{
+    _projectNodesModel->SetNodes(_nodeTree);
+}
+
+void ProjectManagementWidget::refreshDocuments()
+{
     _projectDocsTable->setRowCount(0);
 
-    // 需要遍历所有项目节点，获取每个节点关联的文件
-    QSet<int> loadedFileIds; // 用于避免重复添加相同的文件
-    for(const ProjectNode& node : nodes) {
-        QVector<FileInfo> nodeFiles = DataBaseManagement::Instance()->GetNodeFiles(node.id);
+    // 同一文件关联多个节点时只显示第一个节点
+    QSet<int> loadedFileIds;
+    for(const NodeDocument& document : _documents) {
+        const FileInfo& file = document.file;
+        if(loadedFileIds.contains(file.id)) {
+            continue;
+        }
         
-        for(const FileInfo& file : nodeFiles) {
-            // 如果该文件已经添加过，则跳过
-            if(loadedFileIds.contains(file.id)) {
-                continue;
-            }
-            
-            int row = _projectDocsTable->rowCount();
-            _projectDocsTable->insertRow(row);
-            
-            _projectDocsTable->setItem(row, 0, new QTableWidgetItem(QString::number(file.id)));
-            _projectDocsTable->setItem(row, 1, new QTableWidgetItem(file.fileName));
-            _projectDocsTable->setItem(row, 2, new QTableWidgetItem(file.uploaderName));
-            _projectDocsTable->setItem(row, 3, new QTableWidgetItem(node.name));
-            _projectDocsTable->setItem(row, 4, new QTableWidgetItem(file.uploadTime.toString("yyyy-MM-dd HH:mm")));
-            
-            loadedFileIds.insert(file.id);
+        int row = _projectDocsTable->rowCount();
+        _projectDocsTable->insertRow(row);
+        
+        _projectDocsTable->setItem(row, 0, new QTableWidgetItem(QString::number(file.id)));
+        _projectDocsTable->setItem(row, 1, new QTableWidgetItem(file.fileName));
+        _projectDocsTable->setItem(row, 2, new QTableWidgetItem(file.uploaderName));
+        _projectDocsTable->setItem(row, 3, new QTableWidgetItem(document.nodeName));
+        _projectDocsTable->setItem(row, 4, new QTableWidgetItem(file.uploadTime.toString("yyyy-MM-dd HH:mm")));
+        
+        loadedFileIds.insert(file.id);
+    }
+}
+
+void ProjectManagementWidget::refreshNodeDocuments(int nodeId)
+{
+    int count = std::count_if(_documents.begin(), _documents.end(), [nodeId](const NodeDocument& document) {
+        return document.nodeId == nodeId;
+    });
+    _nodeTree.SetDocumentCount(nodeId, count);
+    refreshNodes();
+    refreshDocuments();
+}
+
+void ProjectManagementWidget::addNodeItems(QComboBox* combo, int excludedNodeId)
+{
+    int excludedIndex = _nodeTree.IndexOf(excludedNodeId);
+    for(int i = 0; i < _nodeTree.Size(); ++i) {
+        if(excludedIndex >= 0 && _nodeTree.IsInSubtree(i, excludedIndex)) {
+            continue;
         }
+        const ProjectNode& node = _nodeTree.NodeAt(i);
+        combo->addItem(QString(_nodeTree.Depth(i) * 4, QChar(' ')) + node.name, node.id);
     }
-    
-    // 更新按钮权限
-    updateUIBasedOnRole();
 }
 
 void ProjectManagementWidget::updateUIBasedOnRole()
@@ -574,14 +619,14 @@ void ProjectManagementWidget::onEditProject()
         return;
     }
     
-    QList<QTableWidgetItem*> selectedItems = _projectsTable->selectedItems();
-    if(selectedItems.count() == 0) {
+    QModelIndexList selectedRows = _projectsTable->selectionModel()->selectedRows();
+    if(selectedRows.isEmpty()) {
         QMessageBox::warning(this, "提示", "请先选择要编辑的项目。");
         return;
     }
     
-    int row = selectedItems.first()->row();
-    int projectId = _projectsTable->item(row, 0)->text().toInt();
+    int row = selectedRows.first().row();
+    int projectId = _projectsModel->ProjectIdAt(row);
     
     Project project = DataBaseManagement::Instance()->GetProjectById(projectId);
     if(project.id == -1) {
@@ -724,15 +769,15 @@ void ProjectManagementWidget::onDeleteProject()
         return;
     }
     
-    QList<QTableWidgetItem*> selectedItems = _projectsTable->selectedItems();
-    if(selectedItems.isEmpty()) {
+    QModelIndexList selectedRows = _projectsTable->selectionModel()->selectedRows();
+    if(selectedRows.isEmpty()) {
         QMessageBox::warning(this, "提示", "请先选择要删除的项目。");
         return;
     }
     
-    int row = selectedItems.first()->row();
-    int projectId = _projectsTable->item(row, 0)->text().toInt();
-    QString projectName = _projectsTable->item(row, 1)->text();
+    int row = selectedRows.first().row();
+    int projectId = _projectsModel->ProjectIdAt(row);
+    QString projectName = _projectsModel->ProjectNameAt(row);
     
     QMessageBox::StandardButton reply = QMessageBox::question(
         this, "确认删除", 
@@ -758,6 +803,7 @@ void ProjectManagementWidget::onSearchProject()
 void ProjectManagementWidget::onRefreshProjects()
 {
     _searchBox->clear();
+    _searchTimer->stop();
     _statusFilter->setCurrentIndex(0);
     loadProjectData();
 }
@@ -890,11 +936,7 @@ void ProjectManagementWidget::onAddNode()
     // 父节点选择（可选）
     QComboBox* parentNodeCombo = new QComboBox();
     parentNodeCombo->addItem("无（顶级节点）", -1);
-    
-    QVector<ProjectNode> nodes = DataBaseManagement::Instance()->GetProjectNodes(_currentProject.id);
-    for(const ProjectNode& node : nodes) {
-        parentNodeCombo->addItem(node.name, node.id);
-    }
+    addNodeItems(parentNodeCombo);
     
     formLayout->addRow("父节点:", parentNodeCombo);
     
@@ -929,9 +971,14 @@ void ProjectManagementWidget::onAddNode()
         newNode.estimatedCompletionTime = estimatedCompletionTime;
         newNode.isCompleted = false;
         
-        if(DataBaseManagement::Instance()->AddProjectNode(newNode)) {
+        QVector<int> nodeIds = DataBaseManagement::Instance()->AddProjectNodes(QVector<ProjectNode>{newNode});
+        if(!nodeIds.isEmpty()) {
+            newNode.id = nodeIds.first();
+            newNode.creationTime = QDateTime::currentDateTime();
+            _nodeTree.Add(newNode);
+            _schedule.AddNode(newNode);
+            refreshNodes();
             QMessageBox::information(this, "成功", "项目节点创建成功。");
-            loadProjectDetail(_currentProject.id);
         } else {
             QMessageBox::critical(this, "错误", "项目节点创建失败。");
         }
@@ -946,30 +993,22 @@ void ProjectManagementWidget::onEditNode()
         return;
     }
     
-    QList<QTableWidgetItem*> selectedItems = _projectNodesTable->selectedItems();
-    if(selectedItems.isEmpty()) {
+    QModelIndexList selectedRows = _projectNodesTable->selectionModel()->selectedRows();
+    if(selectedRows.isEmpty()) {
         QMessageBox::warning(this, "提示", "请先选择要编辑的项目节点。");
         return;
     }
     
-    int row = selectedItems.first()->row();
-    int nodeId = _projectNodesTable->item(row, 0)->text().toInt();
+    int row = selectedRows.first().row();
+    int nodeId = _projectNodesModel->NodeIdAt(row);
     
     // 获取节点信息
-    QVector<ProjectNode> nodes = DataBaseManagement::Instance()->GetProjectNodes(_currentProject.id);
-    ProjectNode currentNode;
-    
-    for(const ProjectNode& node : nodes) {
-        if(node.id == nodeId) {
-            currentNode = node;
-            break;
-        }
-    }
-    
-    if(currentNode.id == 0) {
+    const ProjectNode* node = _nodeTree.Find(nodeId);
+    if(!node) {
         QMessageBox::warning(this, "错误", "无法加载节点信息。");
         return;
     }
+    ProjectNode currentNode = *node;
     
     QDialog dialog(this);
     dialog.setWindowTitle("编辑项目节点");
@@ -989,13 +1028,11 @@ void ProjectManagementWidget::onEditNode()
     QComboBox* parentNodeCombo = new QComboBox();
     parentNodeCombo->addItem("无（顶级节点）", -1);
     
-    for(const ProjectNode& node : nodes) {
-        if(node.id != nodeId) { // 不能选择自己作为父节点
-            parentNodeCombo->addItem(node.name, node.id);
-            if(node.id == currentNode.parentId) {
-                parentNodeCombo->setCurrentIndex(parentNodeCombo->count() - 1);
-            }
-        }
+    // 不能选择自己或自己的子节点作为父节点
+    addNodeItems(parentNodeCombo, nodeId);
+    int parentIndex = parentNodeCombo->findData(currentNode.parentId);
+    if(parentIndex >= 0) {
+        parentNodeCombo->setCurrentIndex(parentIndex);
     }
     
     formLayout->addRow("父节点:", parentNodeCombo);
@@ -1008,6 +1045,24 @@ void ProjectManagementWidget::onEditNode()
     completedCheck->setChecked(currentNode.isCompleted);
     formLayout->addRow("", completedCheck);
     
+    // 前置节点：完成后本节点才能开始，会形成循环依赖的节点不能选择
+    QVector<int> predecessorIds = _schedule.Predecessors(nodeId);
+    QListWidget* predecessorList = new QListWidget();
+    for(int i = 0; i < _nodeTree.Size(); ++i) {
+        const ProjectNode& candidate = _nodeTree.NodeAt(i);
+        if(candidate.id == nodeId) {
+            continue;
+        }
+        QListWidgetItem* item = new QListWidgetItem(QString(_nodeTree.Depth(i) * 4, QChar(' ')) + candidate.name);
+        item->setData(Qt::UserRole, candidate.id);
+        item->setCheckState(predecessorIds.contains(candidate.id) ? Qt::Checked : Qt::Unchecked);
+        if(!predecessorIds.contains(candidate.id) && _schedule.WouldCreateCycle(candidate.id, nodeId)) {
+            item->setFlags(item->flags() & ~Qt::ItemIsEnabled);
+        }
+        predecessorList->addItem(item);
+    }
+    formLayout->addRow("前置节点:", predecessorList);
+    
     layout->addLayout(formLayout);
     
     QDialogButtonBox* buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
@@ -1022,6 +1077,14 @@ void ProjectManagementWidget::onEditNode()
         QDateTime estimatedCompletionTime = dateEdit->dateTime();
         bool isCompleted = completedCheck->isChecked();
         
+        QVector<int> selectedPredecessors;
+        for(int i = 0; i < predecessorList->count(); ++i) {
+            QListWidgetItem* item = predecessorList->item(i);
+            if(item->checkState() == Qt::Checked) {
+                selectedPredecessors.append(item->data(Qt::UserRole).toInt());
+            }
+        }
+        
         if(name.isEmpty()) {
             QMessageBox::warning(this, "错误", "节点名称不能为空。");
             return;
@@ -1034,8 +1097,21 @@ void ProjectManagementWidget::onEditNode()
         currentNode.isCompleted = isCompleted;
         
         if(DataBaseManagement::Instance()->UpdateProjectNode(currentNode)) {
+            _nodeTree.Update(currentNode);
+            _schedule.UpdateNode(currentNode);
+            
+            std::sort(predecessorIds.begin(), predecessorIds.end());
+            std::sort(selectedPredecessors.begin(), selectedPredecessors.end());
+            if(selectedPredecessors != predecessorIds) {
+                if(DataBaseManagement::Instance()->SetNodePredecessors(nodeId, selectedPredecessors)) {
+                    _schedule.SetPredecessors(nodeId, selectedPredecessors);
+                } else {
+                    QMessageBox::warning(this, "错误", "前置节点更新失败。");
+                }
+            }
+            
+            refreshNodes();
             QMessageBox::information(this, "成功", "项目节点更新成功。");
-            loadProjectDetail(_currentProject.id);
         } else {
             QMessageBox::critical(this, "错误", "项目节点更新失败。");
         }
@@ -1050,26 +1126,47 @@ void ProjectManagementWidget::onDeleteNode()
         return;
     }
     
-    QList<QTableWidgetItem*> selectedItems = _projectNodesTable->selectedItems();
-    if(selectedItems.isEmpty()) {
+    QModelIndexList selectedRows = _projectNodesTable->selectionModel()->selectedRows();
+    if(selectedRows.isEmpty()) {
         QMessageBox::warning(this, "提示", "请先选择要删除的项目节点。");
         return;
     }
     
-    int row = selectedItems.first()->row();
-    int nodeId = _projectNodesTable->item(row, 0)->text().toInt();
-    QString nodeName = _projectNodesTable->item(row, 1)->text();
+    int row = selectedRows.first().row();
+    int nodeId = _projectNodesModel->NodeIdAt(row);
+    QString nodeName = _projectNodesModel->NodeNameAt(row);
+    
+    // 子节点和子树内的文件关联会一起删除
+    NodeRollup rollup;
+    int index = _nodeTree.IndexOf(nodeId);
+    if(index >= 0) {
+        rollup = _nodeTree.Rollup(index);
+    }
     
     QMessageBox::StandardButton reply = QMessageBox::question(
         this, "确认删除", 
-        QString("确定要删除项目节点 \"%1\" 吗？\n\n注意：删除节点可能会影响项目结构。").arg(nodeName),
+        QString("确定要删除项目节点 \"%1\" 吗？\n\n注意：将同时删除 %2 个子节点，并解除 %3 个文档关联。")
+            .arg(nodeName).arg(qMax(rollup.nodeCount - 1, 0)).arg(rollup.documentCount),
         QMessageBox::Yes | QMessageBox::No
     );
     
     if(reply == QMessageBox::Yes) {
         if(DataBaseManagement::Instance()->DeleteProjectNode(nodeId)) {
+            // 在本地删除子树，不重新加载整个项目
+            QSet<int> removedIds;
+            if(index >= 0) {
+                for(int i = index; i < _nodeTree.SubtreeEnd(index); ++i) {
+                    removedIds.insert(_nodeTree.NodeAt(i).id);
+                }
+            }
+            _nodeTree.Remove(nodeId);
+            _schedule.RemoveNodes(removedIds.values());
+            _documents.removeIf([&removedIds](const NodeDocument& document) {
+                return removedIds.contains(document.nodeId);
+            });
+            refreshNodes();
+            refreshDocuments();
             QMessageBox::information(this, "成功", "项目节点已成功删除。");
-            loadProjectDetail(_currentProject.id);
         } else {
             QMessageBox::critical(this, "错误", "删除项目节点失败。");
         }
@@ -1086,30 +1183,166 @@ void ProjectManagementWidget::onNodeStatusChanged(int nodeId, bool completed)
     }
     
     // 获取节点信息
-    QVector<ProjectNode> nodes = DataBaseManagement::Instance()->GetProjectNodes(_currentProject.id);
-    ProjectNode currentNode;
-    
-    for(const ProjectNode& node : nodes) {
-        if(node.id == nodeId) {
-            currentNode = node;
-            break;
-        }
-    }
-    
-    if(currentNode.id == 0) {
+    const ProjectNode* node = _nodeTree.Find(nodeId);
+    if(!node) {
         QMessageBox::warning(this, "错误", "无法加载节点信息。");
         return;
     }
     
+    ProjectNode currentNode = *node;
     currentNode.isCompleted = completed;
     
     if(DataBaseManagement::Instance()->UpdateProjectNode(currentNode)) {
-        loadProjectDetail(_currentProject.id);
+        // 只更新该节点和祖先的汇总，进度计划只重算受影响的节点
+        _nodeTree.Update(currentNode);
+        _schedule.UpdateNode(currentNode);
+        refreshNodes();
     } else {
         QMessageBox::critical(this, "错误", "更新节点状态失败。");
     }
 }
 
+void ProjectManagementWidget::onShowSchedule()
+{
+    if(_nodeTree.IsEmpty()) {
+        QMessageBox::information(this, "进度计划", "该项目还没有创建任何节点。");
+        return;
+    }
+    
+    QDialog dialog(this);
+    dialog.setWindowTitle(QString("进度计划 - %1").arg(_currentProject.name));
+    dialog.resize(900, 600);
+    
+    QVBoxLayout* layout = new QVBoxLayout(&dialog);
+    
+    ProjectScheduleSummary summary = _schedule.Summary();
+    QString summaryText = QString("计划完成: %1 | 推算完成: %2 | 关键节点: %3 个")
+                              .arg(FormatScheduleDate(summary.plannedFinish))
+                              .arg(FormatScheduleDate(summary.projectedFinish))
+                              .arg(summary.criticalCount);
+    if(summary.delayDays > 0) {
+        summaryText += QString(" | 预计延期 %1 天").arg(summary.delayDays);
+    }
+    if(summary.unscheduledCount > 0) {
+        summaryText += QString(" | %1 个节点存在循环依赖，未参与计算").arg(summary.unscheduledCount);
+    }
+    layout->addWidget(new QLabel(summaryText));
+    
+    QTableWidget* table = new QTableWidget(_nodeTree.Size(), 8);
+    table->setHorizontalHeaderLabels(QStringList() << "节点名称" << "预计完成" << "最早开始" << "最早完成"
+                                                   << "最晚开始" << "最晚完成" << "总时差(天)" << "关键");
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    table->verticalHeader()->setVisible(false);
+    
+    // 按节点树的顺序显示，关键节点使用不同的背景色
+    for(int row = 0; row < _nodeTree.Size(); ++row) {
+        const ProjectNode& node = _nodeTree.NodeAt(row);
+        NodeSchedule schedule = _schedule.Schedule(node.id);
+        
+        table->setItem(row, 0, new QTableWidgetItem(QString(_nodeTree.Depth(row) * 4, QChar(' ')) + node.name));
+        table->setItem(row, 1, new QTableWidgetItem(FormatScheduleDate(node.estimatedCompletionTime.date())));
+        if(!schedule.scheduled) {
+            table->setItem(row, 2, new QTableWidgetItem("循环依赖"));
+            continue;
+        }
+        table->setItem(row, 2, new QTableWidgetItem(FormatScheduleDate(schedule.earliestStart)));
+        table->setItem(row, 3, new QTableWidgetItem(FormatScheduleDate(schedule.earliestFinish)));
+        table->setItem(row, 4, new QTableWidgetItem(FormatScheduleDate(schedule.latestStart)));
+        table->setItem(row, 5, new QTableWidgetItem(FormatScheduleDate(schedule.latestFinish)));
+        table->setItem(row, 6, NumberItem(schedule.slackDays));
+        table->setItem(row, 7, new QTableWidgetItem(schedule.critical ? "是" : ""));
+        
+        if(schedule.critical) {
+            for(int column = 0; column < table->columnCount(); ++column) {
+                table->item(row, column)->setBackground(QColor(255, 220, 220)); // 浅红色
+            }
+        }
+    }
+    layout->addWidget(table);
+    
+    QDialogButtonBox* buttonBox = new QDialogButtonBox(QDialogButtonBox::Close);
+    connect(buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    layout->addWidget(buttonBox);
+    
+    dialog.exec();
+}
+
+void ProjectManagementWidget::onShowPortfolioSchedule()
+{
+    // 两次查询取出所有项目的节点和依赖，各项目的进度在线程池中并行计算
+    DataBaseExecutor::Instance()->RunRead([](DataBaseManagement* db) {
+        PortfolioSchedule portfolio;
+        portfolio.projects = db->GetAllProjects();
+        portfolio.nodes = db->GetAllProjectNodes();
+        portfolio.dependencies = db->GetAllNodeDependencies();
+        return portfolio;
+    }).then(QtFuture::Launch::Async, [](PortfolioSchedule portfolio) {
+        portfolio.summaries = ScheduleEngine::AnalyzePortfolio(portfolio.nodes, portfolio.dependencies);
+        portfolio.nodes.clear();
+        portfolio.dependencies.clear();
+        return portfolio;
+    }).then(this, [this](const PortfolioSchedule& portfolio) {
+        // 以 this 为上下文的延续在界面线程执行
+        showPortfolioSchedule(portfolio);
+    });
+}
+
+void ProjectManagementWidget::showPortfolioSchedule(const PortfolioSchedule& portfolio)
+{
+    Q_ASSERT(QThread::currentThread() == thread());
+
+    QHash<int, ProjectScheduleSummary> summaries;
+    for(const ProjectScheduleSummary& summary : portfolio.summaries) {
+        summaries.insert(summary.projectId, summary);
+    }
+    
+    // 不在延续中进入嵌套事件循环，关闭时自动释放
+    QDialog* dialog = new QDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle("项目进度分析");
+    dialog->resize(900, 600);
+    
+    QVBoxLayout* layout = new QVBoxLayout(dialog);
+    
+    QTableWidget* table = new QTableWidget(portfolio.projects.size(), 8);
+    table->setHorizontalHeaderLabels(QStringList() << "项目名称" << "节点数" << "关键节点" << "开始"
+                                                   << "计划完成" << "推算完成" << "延期(天)" << "循环依赖节点");
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    table->verticalHeader()->setVisible(false);
+    
+    for(int row = 0; row < portfolio.projects.size(); ++row) {
+        const Project& project = portfolio.projects[row];
+        ProjectScheduleSummary summary = summaries.value(project.id);
+        
+        table->setItem(row, 0, new QTableWidgetItem(project.name));
+        table->setItem(row, 1, NumberItem(summary.nodeCount));
+        table->setItem(row, 2, NumberItem(summary.criticalCount));
+        table->setItem(row, 3, new QTableWidgetItem(FormatScheduleDate(summary.start)));
+        table->setItem(row, 4, new QTableWidgetItem(FormatScheduleDate(summary.plannedFinish)));
+        table->setItem(row, 5, new QTableWidgetItem(FormatScheduleDate(summary.projectedFinish)));
+        table->setItem(row, 6, NumberItem(summary.delayDays));
+        table->setItem(row, 7, NumberItem(summary.unscheduledCount));
+        
+        if(summary.delayDays > 0) {
+            table->item(row, 6)->setForeground(QColor(Qt::red));
+        }
+    }
+    // 默认按延期天数从多到少排列
+    table->setSortingEnabled(true);
+    table->sortItems(6, Qt::DescendingOrder);
+    layout->addWidget(table);
+    
+    QDialogButtonBox* buttonBox = new QDialogButtonBox(QDialogButtonBox::Close);
+    connect(buttonBox, &QDialogButtonBox::rejected, dialog, &QDialog::reject);
+    layout->addWidget(buttonBox);
+    
+    dialog->open();
+}
+
 // 项目文档管理方法
 void ProjectManagementWidget::onAddDocument()
 {
@@ -1121,8 +1354,7 @@ void ProjectManagementWidget::onAddDocument()
     }
     
     // 首先检查项目是否有节点
-    QVector<ProjectNode> projectNodes = DataBaseManagement::Instance()->GetProjectNodes(_currentProject.id);
-    if(projectNodes.isEmpty()) {
+    if(_nodeTree.IsEmpty()) {
         QMessageBox::warning(this, "无法添加文档", "该项目还没有创建任何节点，请先创建项目节点。");
         return;
     }
@@ -1137,9 +1369,7 @@ void ProjectManagementWidget::onAddDocument()
     // 添加节点选择下拉框
     QFormLayout* formLayout = new QFormLayout();
     QComboBox* nodeComboBox = new QComboBox();
-    for(const ProjectNode& node : projectNodes) {
-        nodeComboBox->addItem(node.name, node.id);
-    }
+    addNodeItems(nodeComboBox);
     formLayout->addRow("选择项目节点:", nodeComboBox);
     layout->addLayout(formLayout);
     
@@ -1213,9 +1443,25 @@ void ProjectManagementWidget::onAddDocument()
         }
         
         if(!selectedFileIds.isEmpty()) {
-            if(DataBaseManagement::Instance()->AssignFilesToNode(nodeId, selectedFileIds)) {
+            if(DataBaseManagement::Instance()->AddFilesToNode(nodeId, selectedFileIds)) {
+                // 在本地加入新的关联，与数据库一样忽略已有的关联，保持按节点ID、文件ID排列
+                const ProjectNode* node = _nodeTree.Find(nodeId);
+                for(const FileInfo& file : availableFiles) {
+                    if(!selectedFileIds.contains(file.id)) {
+                        continue;
+                    }
+                    bool linked = std::any_of(_documents.begin(), _documents.end(), [nodeId, &file](const NodeDocument& document) {
+                        return document.nodeId == nodeId && document.file.id == file.id;
+                    });
+                    if(!linked) {
+                        _documents.append(NodeDocument{nodeId, node ? node->name : QString(), file});
+                    }
+                }
+                std::sort(_documents.begin(), _documents.end(), [](const NodeDocument& a, const NodeDocument& b) {
+                    return a.nodeId != b.nodeId ? a.nodeId < b.nodeId : a.file.id < b.file.id;
+                });
+                refreshNodeDocuments(nodeId);
                 QMessageBox::information(this, "成功", QString("已添加 %1 个文档到项目节点。").arg(selectedFileIds.size()));
-                loadProjectDetail(_currentProject.id); // 重新加载项目详情以显示更新
             } else {
                 QMessageBox::critical(this, "错误", "添加文档到项目节点失败。");
             }
@@ -1243,13 +1489,6 @@ void ProjectManagementWidget::onRemoveDocument()
     int fileId = _projectDocsTable->item(row, 0)->text().toInt();
     QString fileName = _projectDocsTable->item(row, 1)->text();
     
-    // 获取所有项目节点
-    QVector<ProjectNode> projectNodes = DataBaseManagement::Instance()->GetProjectNodes(_currentProject.id);
-    if(projectNodes.isEmpty()) {
-        QMessageBox::warning(this, "警告", "该项目没有任何节点。");
-        return;
-    }
-    
     // 创建对话框，让用户选择从哪个节点移除文档
     QDialog dialog(this);
     dialog.setWindowTitle("选择要移除文档的节点");
@@ -1261,19 +1500,10 @@ void ProjectManagementWidget::onRemoveDocument()
     layout->addWidget(label);
     
     QComboBox* nodeComboBox = new QComboBox();
-    for(const ProjectNode& node : projectNodes) {
-        // 检查该节点是否关联了该文档
-        QVector<FileInfo> nodeFiles = DataBaseManagement::Instance()->GetNodeFiles(node.id);
-        bool hasFile = false;
-        for(const FileInfo& file : nodeFiles) {
-            if(file.id == fileId) {
-                hasFile = true;
-                break;
-            }
-        }
-        
-        if(hasFile) {
-            nodeComboBox->addItem(node.name, node.id);
+    for(const NodeDocument& document : _documents) {
+        // 只列出关联了该文档的节点，使用加载详情时已经取得的关联，不再查询
+        if(document.file.id == fileId) {
+            nodeComboBox->addItem(document.nodeName, document.nodeId);
         }
     }
     
@@ -1292,19 +1522,13 @@ void ProjectManagementWidget::onRemoveDocument()
     if(dialog.exec() == QDialog::Accepted) {
         int nodeId = nodeComboBox->currentData().toInt();
         
-        // 获取节点当前关联的所有文件
-        QVector<FileInfo> nodeFiles = DataBaseManagement::Instance()->GetNodeFiles(nodeId);
-        QVector<int> fileIds;
-        for(const FileInfo& file : nodeFiles) {
-            if(file.id != fileId) { // 排除要移除的文件
-                fileIds.append(file.id);
-            }
-        }
-        
-        // 更新节点关联的文件
-        if(DataBaseManagement::Instance()->AssignFilesToNode(nodeId, fileIds)) {
+        // 只删除这一条关联，节点与回收站中文件的关联保持不变
+        if(DataBaseManagement::Instance()->RemoveFilesFromNode(nodeId, {fileId})) {
+            _documents.removeIf([nodeId, fileId](const NodeDocument& document) {
+                return document.nodeId == nodeId && document.file.id == fileId;
+            });
+            refreshNodeDocuments(nodeId);
             QMessageBox::information(this, "成功", QString("文档已从节点 %1 中移除。").arg(nodeComboBox->currentText()));
-            loadProjectDetail(_currentProject.id);
         } else {
             QMessageBox::warning(this, "警告", "移除文档失败，请稍后重试。");
         }
@@ -1313,24 +1537,36 @@ void ProjectManagementWidget::onRemoveDocument()
 
 void ProjectManagementWidget::openDocument(int fileId)
 {
-    // 使用GetAllFiles获取所有文件，然后找出指定ID的文件
-    QVector<FileInfo> allFiles = DataBaseManagement::Instance()->GetAllFiles();
-    FileInfo targetFile;
+    // 按主键查询指定ID的文件
+    FileInfo targetFile = DataBaseManagement::Instance()->GetFileById(fileId);
     
-    for(const FileInfo& file : allFiles) {
-        if(file.id == fileId) {
-            targetFile = file;
-            break;
-        }
-    }
-    
-    if(targetFile.id == 0) {
+    if(targetFile.id < 0 || targetFile.status != FileStatus::NORMAL) {
         QMessageBox::warning(this, "错误", "无法打开文档，文档可能已被删除。");
         return;
     }
     
     // 调用系统默认程序打开文档
-    QDesktopServices::openUrl(QUrl::fromLocalFile(targetFile.filePath));
+    if(targetFile.contentHash.isEmpty()) {
+        QDesktopServices::openUrl(QUrl::fromLocalFile(targetFile.filePath));
+        return;
+    }
+
+    // 存储区中的文件没有扩展名，且被内容相同的文件共用，不能原地编辑。
+    // 在后台线程复制到临时目录并使用原始文件名后再打开
+    QString tempDir = QDir::tempPath() + QString("/ProjectManagement/%1").arg(targetFile.id);
+    QString openPath = tempDir + "/" + targetFile.fileName;
+    if(!QDir().mkpath(tempDir)) {
+        QMessageBox::warning(this, "错误", "无法打开文档，没有足够的权限创建临时文件。");
+        return;
+    }
+    CopyFileInBackground(this, "正在打开文档...", targetFile.filePath, openPath,
+                         [this, openPath](const FileTransferResult& result) {
+        if(result.success) {
+            QDesktopServices::openUrl(QUrl::fromLocalFile(openPath));
+        } else {
+            QMessageBox::warning(this, "错误", "无法打开文档，文件不存在或没有足够的权限。");
+        }
+    });
 }
 
 void ProjectManagementWidget::onAssociateFiles()
@@ -1398,21 +1634,23 @@ void ProjectManagementWidget::onAssociateFiles()
     layout->addWidget(buttonBox);
     
     if(dialog.exec() == QDialog::Accepted) {
-        // 收集已选择的文件
+        // 收集已选择的文件，以及对话框中列出的全部文件
         QVector<int> selectedFileIds;
+        QVector<int> shownFileIds;
         
         for(int row = 0; row < filesTable->rowCount(); row++) {
+            int fileId = filesTable->item(row, 0)->text().toInt();
+            shownFileIds.append(fileId);
             QCheckBox* checkBox = qobject_cast<QCheckBox*>(filesTable->cellWidget(row, 3));
             if(checkBox && checkBox->isChecked()) {
-                int fileId = filesTable->item(row, 0)->text().toInt();
                 selectedFileIds.append(fileId);
             }
         }
         
         qDebug() << "更新项目关联文件，项目ID: " << _currentProject.id << ", 选择的文件数: " << selectedFileIds.size();
         
-        // 更新项目关联文件
-        if(DataBaseManagement::Instance()->UpdateProjectFiles(_currentProject.id, selectedFileIds)) {
+        // 只更新对话框中列出的文件，回收站和归档文件的关联不受影响
+        if(DataBaseManagement::Instance()->UpdateProjectFiles(_currentProject.id, selectedFileIds, shownFileIds)) {
             QMessageBox::information(this, "成功", QString("已更新项目关联文件，共 %1 个文件。").arg(selectedFileIds.size()));
             loadProjectDetail(_currentProject.id); // 重新加载项目详情以显示更新
         } else {
@@ -1428,5 +1666,6 @@ void ProjectManagementWidget::filterProjects()
 
 void ProjectManagementWidget::searchProjects()
 {
+    _searchTimer->stop();
     loadProjectData();
 } 
@@ -4,6 +4,7 @@
 #include <QWidget>
 #include <QStackedWidget>
 #include <QTableWidget>
+#include <QTableView>
 #include <QLineEdit>
 #include <QPushButton>
 #include <QLabel>
@@ -15,10 +16,37 @@
 #include <QDialogButtonBox>
 #include <QDateEdit>
 #include <QTextEdit>
+#include <QTimer>
 #include <QGroupBox>
 #include <QDesktopServices>
 #include <QUrl>
+#include <QVector>
 #include "DBModels.h"
+#include "nodetree.h"
+#include "scheduleengine.h"
+
+class ProjectTableModel;
+class NodeTableModel;
+
+// 项目详情页一次加载所需的数据
+struct ProjectDetailData
+{
+    Project project;
+    QVector<User> members;
+    User manager;                          // 项目经理不在成员中时单独查询
+    QVector<ProjectNode> nodes;
+    QVector<NodeDocument> documents;       // 节点关联的文件
+    QVector<NodeDependency> dependencies;  // 节点前置依赖
+};
+
+// 项目组合进度分析的数据，在只读线程查询，在线程池中计算
+struct PortfolioSchedule
+{
+    QVector<Project> projects;
+    QVector<ProjectNode> nodes;
+    QVector<NodeDependency> dependencies;
+    QVector<ProjectScheduleSummary> summaries;
+};
 
 class ProjectManagementWidget : public QWidget
 {
@@ -39,6 +67,17 @@ private:
     // 数据加载
     void loadProjectData(const QString& status = "", const QString& search = "");
     void loadProjectDetail(int projectId);
+    void populateProjectDetail(const ProjectDetailData& detail);
+    // 显示项目组合进度分析的结果，只能在界面线程调用
+    void showPortfolioSchedule(const PortfolioSchedule& portfolio);
+    // 节点树修改后刷新节点表格
+    void refreshNodes();
+    // 按 _documents 刷新文档表格
+    void refreshDocuments();
+    // _documents 中节点的关联改变后，更新节点树中该节点的文档数并刷新两个表格
+    void refreshNodeDocuments(int nodeId);
+    // 按树的层次添加节点选项，跳过 excludedNodeId 及其子树
+    void addNodeItems(QComboBox* combo, int excludedNodeId = 0);
     void updateUIBasedOnRole();
     
     // 用户操作响应
@@ -59,6 +98,9 @@ private:
     void onEditNode();
     void onDeleteNode();
     void onNodeStatusChanged(int nodeId, bool completed);
+    void onShowSchedule();
+    // 所有项目的进度汇总
+    void onShowPortfolioSchedule();
     
     // 项目文档管理
     void onAddDocument();
@@ -78,8 +120,10 @@ private:
     
     // 项目列表视图
     QWidget* _projectListView;
-    QTableWidget* _projectsTable;
+    QTableView* _projectsTable;
+    ProjectTableModel* _projectsModel;
     QLineEdit* _searchBox;
+    QTimer* _searchTimer;
     QComboBox* _statusFilter;
     QPushButton* _addProjectButton;
     QPushButton* _editProjectButton;
@@ -93,7 +137,8 @@ private:
     QLabel* _projectDescLabel;
     QTableWidget* _projectMembersTable;
     QPushButton* _assignUsersButton;
-    QTableWidget* _projectNodesTable;
+    QTableView* _projectNodesTable;
+    NodeTableModel* _projectNodesModel;
     QPushButton* _addNodeButton;
     QPushButton* _editNodeButton;
     QPushButton* _deleteNodeButton;
@@ -104,6 +149,10 @@ private:
     // 数据
     User _currentUser;
     Project _currentProject;
+    quint64 _detailGeneration;             // 每次加载项目详情时递增，丢弃过期的结果
+    NodeTree _nodeTree;                    // 当前项目的节点树
+    ScheduleEngine _schedule;              // 当前项目的进度计划
+    QVector<NodeDocument> _documents;      // 当前项目节点关联的文件
 };
 
 #endif // PROJECTMANAGEMENTWIDGET_H 
@@ -0,0 +1,140 @@
+#include <QColor>
+#include <QStringList>
+#include "projecttablemodel.h"
+#include "databaseexecutor.h"
+
+ProjectTableModel::ProjectTableModel(QObject* parent)
+    : PagedTableModel(parent)
+    , _hasMorePages(false)
+    , _fetching(false)
+    , _generation(0)
+{
+
+}
+
+void ProjectTableModel::SetQuery(const ProjectQuery& query)
+{
+    beginResetModel();
+
+    ++_generation;
+    _query = query;
+    _query.after = PageCursor();
+    _hasMorePages = true;
+    _fetching = false;
+
+    _rows.clear();
+    ResetRowCount(0);
+    endResetModel();
+
+    FetchNextPage();
+}
+
+bool ProjectTableModel::CanFetchNextPage() const
+{
+    return _hasMorePages && !_fetching;
+}
+
+void ProjectTableModel::FetchNextPage()
+{
+    _fetching = true;
+
+    ProjectQuery query = _query;
+    quint64 generation = _generation;
+    DataBaseExecutor::Instance()->RunRead(
+        [query](DataBaseManagement* db) { return db->QueryProjects(query); },
+        this, [this, generation](const ProjectPage& page) { AppendPage(page, generation); });
+}
+
+void ProjectTableModel::AppendPage(const ProjectPage& page, quint64 generation)
+{
+    if(generation != _generation)
+    {
+        return;
+    }
+
+    _fetching = false;
+    _hasMorePages = page.hasMore;
+    _query.after = page.next;
+
+    if(page.projects.isEmpty())
+    {
+        return;
+    }
+
+    BeginAppendRows(page.projects.size());
+    for(const Project& project : page.projects)
+    {
+        _rows.append(MakeRow(project));
+    }
+    EndAppendRows();
+}
+
+ProjectTableModel::Row ProjectTableModel::MakeRow(const Project& project)
+{
+    Row row;
+    row.id = project.id;
+    row.isCompleted = project.isCompleted;
+    row.createTime = project.createTime;
+    row.estimatedCompleteTime = project.estimatedCompleteTime;
+    row.name = project.name;
+    row.managerName = project.managerName;
+    return row;
+}
+
+int ProjectTableModel::ProjectIdAt(int row) const
+{
+    return (row >= 0 && row < _rows.size()) ? _rows[row].id : -1;
+}
+
+QString ProjectTableModel::ProjectNameAt(int row) const
+{
+    return (row >= 0 && row < _rows.size()) ? _rows[row].name : QString();
+}
+
+int ProjectTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : 6;
+}
+
+QVariant ProjectTableModel::data(const QModelIndex& index, int role) const
+{
+    if(!index.isValid() || index.row() >= rowCount())
+    {
+        return QVariant();
+    }
+
+    const Row& row = _rows[index.row()];
+
+    // 已完成项目行使用不同的背景色
+    if(role == Qt::BackgroundRole)
+    {
+        return row.isCompleted ? QVariant(QColor(200, 255, 200)) : QVariant(); // 浅绿色
+    }
+
+    if(role != Qt::DisplayRole)
+    {
+        return QVariant();
+    }
+
+    switch(index.column())
+    {
+        case 0: return row.id;
+        case 1: return row.name;
+        case 2: return row.managerName;
+        case 3: return row.createTime.toString("yyyy-MM-dd");
+        case 4: return row.estimatedCompleteTime.toString("yyyy-MM-dd");
+        case 5: return row.isCompleted ? QString("已完成") : QString("进行中");
+        default: return QVariant();
+    }
+}
+
+QVariant ProjectTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    static const QStringList headers = {"ID", "项目名称", "项目经理", "创建时间", "预计完成时间", "状态"};
+    if(orientation == Qt::Horizontal && role == Qt::DisplayRole && section < headers.size())
+    {
+        return headers[section];
+    }
+
+    return PagedTableModel::headerData(section, orientation, role);
+}
@@ -0,0 +1,55 @@
+#ifndef PROJECTTABLEMODEL_H
+#define PROJECTTABLEMODEL_H
+
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+#include "pagedtablemodel.h"
+#include "DBModels.h"
+
+// 项目列表表格模型
+class ProjectTableModel : public PagedTableModel
+{
+    Q_OBJECT
+public:
+    explicit ProjectTableModel(QObject* parent = nullptr);
+
+    // 按查询条件分页加载，每页在数据库线程查询，滚动到底部时加载下一页
+    void SetQuery(const ProjectQuery& query);
+
+    int ProjectIdAt(int row) const;
+    QString ProjectNameAt(int row) const;
+
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+protected:
+    bool CanFetchNextPage() const override;
+    void FetchNextPage() override;
+
+private:
+    void AppendPage(const ProjectPage& page, quint64 generation);
+
+    struct Row
+    {
+        int id;
+        bool isCompleted;
+        QDateTime createTime;
+        QDateTime estimatedCompleteTime;
+        QString name;
+        QString managerName;
+    };
+
+    static Row MakeRow(const Project& project);
+
+    QVector<Row> _rows;
+
+    // 分页加载状态，_generation 用于丢弃查询条件变化前发出的请求结果
+    ProjectQuery _query;
+    bool _hasMorePages;
+    bool _fetching;
+    quint64 _generation;
+};
+
+#endif // PROJECTTABLEMODEL_H
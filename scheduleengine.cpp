@@ -0,0 +1,553 @@
+#include <QMap>
+#include <QSet>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include "scheduleengine.h"
+
+// 一个项目的节点和依赖，AnalyzePortfolio 按项目分组后并行计算
+struct ProjectScheduleInput
+{
+    QVector<ProjectNode> nodes;
+    QVector<NodeDependency> dependencies;
+};
+
+ScheduleEngine::ScheduleEngine()
+    : _projectStart(0)
+    , _projectFinish(0)
+{
+
+}
+
+void ScheduleEngine::Build(const QVector<ProjectNode>& nodes, const QVector<NodeDependency>& dependencies)
+{
+    Clear();
+    _nodes = nodes;
+    _dependencies = dependencies;
+
+    const int count = _nodes.size();
+    _indexById.reserve(count);
+    for(int i = 0; i < count; ++i)
+    {
+        _indexById.insert(_nodes[i].id, i);
+    }
+
+    _release.resize(count);
+    _durations.resize(count);
+    for(int i = 0; i < count; ++i)
+    {
+        LoadNode(i, _nodes[i]);
+    }
+
+    // 遍历两类边，第一遍计数，第二遍填入 CSR
+    auto forEachEdge = [this](const std::function<void(int, int, EdgeType)>& visit) {
+        for(const NodeDependency& dependency : _dependencies)
+        {
+            int predecessor = _indexById.value(dependency.predecessorId, -1);
+            int successor = _indexById.value(dependency.successorId, -1);
+            if(predecessor >= 0 && successor >= 0 && predecessor != successor)
+            {
+                visit(predecessor, successor, FinishToStart);
+            }
+        }
+        for(int i = 0; i < _nodes.size(); ++i)
+        {
+            int parent = _nodes[i].parentId > 0 ? _indexById.value(_nodes[i].parentId, -1) : -1;
+            if(parent >= 0 && parent != i)
+            {
+                visit(i, parent, FinishToFinish);
+            }
+        }
+    };
+
+    _successorOffsets.fill(0, count + 1);
+    _predecessorOffsets.fill(0, count + 1);
+    forEachEdge([this](int from, int to, EdgeType) {
+        ++_successorOffsets[from + 1];
+        ++_predecessorOffsets[to + 1];
+    });
+    for(int i = 0; i < count; ++i)
+    {
+        _successorOffsets[i + 1] += _successorOffsets[i];
+        _predecessorOffsets[i + 1] += _predecessorOffsets[i];
+    }
+    _successors.resize(_successorOffsets[count]);
+    _predecessors.resize(_predecessorOffsets[count]);
+    QVector<int> successorPositions = _successorOffsets;
+    QVector<int> predecessorPositions = _predecessorOffsets;
+    forEachEdge([&](int from, int to, EdgeType type) {
+        _successors[successorPositions[from]++] = Edge{to, type};
+        _predecessors[predecessorPositions[to]++] = Edge{from, type};
+    });
+
+    // Kahn 拓扑排序，入度始终不为0的节点在环上，不参与计算
+    QVector<int> inDegrees(count);
+    for(int i = 0; i < count; ++i)
+    {
+        inDegrees[i] = _predecessorOffsets[i + 1] - _predecessorOffsets[i];
+    }
+    _order.reserve(count);
+    for(int i = 0; i < count; ++i)
+    {
+        if(inDegrees[i] == 0)
+        {
+            _order.append(i);
+        }
+    }
+    for(int head = 0; head < _order.size(); ++head)
+    {
+        int index = _order[head];
+        for(int k = _successorOffsets[index]; k < _successorOffsets[index + 1]; ++k)
+        {
+            if(--inDegrees[_successors[k].target] == 0)
+            {
+                _order.append(_successors[k].target);
+            }
+        }
+    }
+    _positions.fill(-1, count);
+    for(int position = 0; position < _order.size(); ++position)
+    {
+        _positions[_order[position]] = position;
+    }
+
+    _earliestStart.fill(0, count);
+    _earliestFinish.fill(0, count);
+    _latestStart.fill(0, count);
+    _latestFinish.fill(0, count);
+    ForwardPass();
+    UpdateProjectFinish();
+    BackwardPass();
+}
+
+void ScheduleEngine::Clear()
+{
+    _nodes.clear();
+    _dependencies.clear();
+    _indexById.clear();
+    _successorOffsets.clear();
+    _successors.clear();
+    _predecessorOffsets.clear();
+    _predecessors.clear();
+    _order.clear();
+    _positions.clear();
+    _release.clear();
+    _durations.clear();
+    _earliestStart.clear();
+    _earliestFinish.clear();
+    _latestStart.clear();
+    _latestFinish.clear();
+    _projectStart = 0;
+    _projectFinish = 0;
+}
+
+bool ScheduleEngine::UpdateNode(const ProjectNode& node)
+{
+    int index = _indexById.value(node.id, -1);
+    if(index < 0)
+    {
+        return false;
+    }
+
+    // 层次关系改变时依赖图的边改变，重新构建
+    if(node.parentId != _nodes[index].parentId)
+    {
+        QVector<ProjectNode> nodes = _nodes;
+        QVector<NodeDependency> dependencies = _dependencies;
+        nodes[index] = node;
+        Build(nodes, dependencies);
+        return true;
+    }
+
+    _nodes[index] = node;
+    LoadNode(index, node);
+    if(_positions[index] < 0)
+    {
+        return true;
+    }
+
+    // 正推：按拓扑位置从前往后，只处理最早日期发生变化的节点的后继
+    const int count = _nodes.size();
+    QVector<bool> queued(count, false);
+    std::priority_queue<int, std::vector<int>, std::greater<int>> forward;
+    forward.push(_positions[index]);
+    queued[index] = true;
+    while(!forward.empty())
+    {
+        int current = _order[forward.top()];
+        forward.pop();
+        queued[current] = false;
+        if(!ComputeEarliest(current))
+        {
+            continue;
+        }
+        for(int k = _successorOffsets[current]; k < _successorOffsets[current + 1]; ++k)
+        {
+            int successor = _successors[k].target;
+            if(_positions[successor] >= 0 && !queued[successor])
+            {
+                forward.push(_positions[successor]);
+                queued[successor] = true;
+            }
+        }
+    }
+
+    // 项目完成日期改变时所有节点的最晚日期都会改变，完整逆推
+    if(UpdateProjectFinish())
+    {
+        BackwardPass();
+        return true;
+    }
+
+    // 逆推：最晚日期只取决于工期和后继，从该节点开始按拓扑位置从后往前处理前驱
+    std::priority_queue<int> backward;
+    backward.push(_positions[index]);
+    queued[index] = true;
+    while(!backward.empty())
+    {
+        int current = _order[backward.top()];
+        backward.pop();
+        queued[current] = false;
+        if(!ComputeLatest(current))
+        {
+            continue;
+        }
+        for(int k = _predecessorOffsets[current]; k < _predecessorOffsets[current + 1]; ++k)
+        {
+            int predecessor = _predecessors[k].target;
+            if(_positions[predecessor] >= 0 && !queued[predecessor])
+            {
+                backward.push(_positions[predecessor]);
+                queued[predecessor] = true;
+            }
+        }
+    }
+    return true;
+}
+
+bool ScheduleEngine::AddNode(const ProjectNode& node)
+{
+    if(_indexById.contains(node.id))
+    {
+        return false;
+    }
+
+    QVector<ProjectNode> nodes = _nodes;
+    QVector<NodeDependency> dependencies = _dependencies;
+    nodes.append(node);
+    Build(nodes, dependencies);
+    return true;
+}
+
+void ScheduleEngine::SetPredecessors(int nodeId, const QVector<int>& predecessorIds)
+{
+    QVector<ProjectNode> nodes = _nodes;
+    QVector<NodeDependency> dependencies;
+    dependencies.reserve(_dependencies.size() + predecessorIds.size());
+    for(const NodeDependency& dependency : _dependencies)
+    {
+        if(dependency.successorId != nodeId)
+        {
+            dependencies.append(dependency);
+        }
+    }
+    for(int predecessorId : predecessorIds)
+    {
+        dependencies.append(NodeDependency{predecessorId, nodeId});
+    }
+    Build(nodes, dependencies);
+}
+
+void ScheduleEngine::RemoveNodes(const QVector<int>& nodeIds)
+{
+    QSet<int> removed(nodeIds.begin(), nodeIds.end());
+    QVector<ProjectNode> nodes;
+    nodes.reserve(_nodes.size());
+    for(const ProjectNode& node : _nodes)
+    {
+        if(!removed.contains(node.id))
+        {
+            nodes.append(node);
+        }
+    }
+    QVector<NodeDependency> dependencies;
+    dependencies.reserve(_dependencies.size());
+    for(const NodeDependency& dependency : _dependencies)
+    {
+        if(!removed.contains(dependency.predecessorId) && !removed.contains(dependency.successorId))
+        {
+            dependencies.append(dependency);
+        }
+    }
+    Build(nodes, dependencies);
+}
+
+QVector<int> ScheduleEngine::Predecessors(int nodeId) const
+{
+    QVector<int> nodeIds;
+    int index = _indexById.value(nodeId, -1);
+    if(index < 0)
+    {
+        return nodeIds;
+    }
+
+    for(int k = _predecessorOffsets[index]; k < _predecessorOffsets[index + 1]; ++k)
+    {
+        if(_predecessors[k].type == FinishToStart)
+        {
+            nodeIds.append(_nodes[_predecessors[k].target].id);
+        }
+    }
+    return nodeIds;
+}
+
+int ScheduleEngine::Size() const
+{
+    return _nodes.size();
+}
+
+bool ScheduleEngine::Contains(int nodeId) const
+{
+    return _indexById.contains(nodeId);
+}
+
+NodeSchedule ScheduleEngine::Schedule(int nodeId) const
+{
+    NodeSchedule schedule;
+    schedule.nodeId = nodeId;
+    int index = _indexById.value(nodeId, -1);
+    if(index < 0 || _positions[index] < 0)
+    {
+        return schedule;
+    }
+
+    schedule.scheduled = true;
+    schedule.earliestStart = QDate::fromJulianDay(_earliestStart[index]);
+    schedule.earliestFinish = QDate::fromJulianDay(_earliestFinish[index]);
+    schedule.latestStart = QDate::fromJulianDay(_latestStart[index]);
+    schedule.latestFinish = QDate::fromJulianDay(_latestFinish[index]);
+    schedule.slackDays = static_cast<int>(_latestFinish[index] - _earliestFinish[index]);
+    schedule.critical = !_nodes[index].isCompleted && schedule.slackDays == 0;
+    return schedule;
+}
+
+QVector<int> ScheduleEngine::CriticalPath() const
+{
+    QVector<int> nodeIds;
+    for(int index : _order)
+    {
+        if(!_nodes[index].isCompleted && _latestFinish[index] == _earliestFinish[index])
+        {
+            nodeIds.append(_nodes[index].id);
+        }
+    }
+    return nodeIds;
+}
+
+QDate ScheduleEngine::ProjectStart() const
+{
+    return _order.isEmpty() ? QDate() : QDate::fromJulianDay(_projectStart);
+}
+
+QDate ScheduleEngine::ProjectFinish() const
+{
+    return _order.isEmpty() ? QDate() : QDate::fromJulianDay(_projectFinish);
+}
+
+ProjectScheduleSummary ScheduleEngine::Summary() const
+{
+    ProjectScheduleSummary summary;
+    summary.projectId = _nodes.isEmpty() ? 0 : _nodes.first().projectId;
+    summary.nodeCount = _nodes.size();
+    summary.criticalCount = CriticalPath().size();
+    summary.unscheduledCount = _nodes.size() - _order.size();
+    summary.start = ProjectStart();
+    summary.projectedFinish = ProjectFinish();
+
+    for(const ProjectNode& node : _nodes)
+    {
+        QDate planned = node.estimatedCompletionTime.date();
+        if(planned.isValid() && (!summary.plannedFinish.isValid() || planned > summary.plannedFinish))
+        {
+            summary.plannedFinish = planned;
+        }
+    }
+    if(summary.plannedFinish.isValid() && summary.projectedFinish.isValid())
+    {
+        summary.delayDays = qMax<qint64>(0, summary.plannedFinish.daysTo(summary.projectedFinish));
+    }
+    return summary;
+}
+
+bool ScheduleEngine::WouldCreateCycle(int predecessorId, int successorId) const
+{
+    int predecessor = _indexById.value(predecessorId, -1);
+    int successor = _indexById.value(successorId, -1);
+    if(predecessor < 0 || successor < 0)
+    {
+        return false;
+    }
+    if(predecessor == successor)
+    {
+        return true;
+    }
+
+    // 从后继出发能到达前置节点时，新边会闭合成环
+    QVector<bool> visited(_nodes.size(), false);
+    QVector<int> stack;
+    stack.append(successor);
+    visited[successor] = true;
+    while(!stack.isEmpty())
+    {
+        int current = stack.takeLast();
+        for(int k = _successorOffsets[current]; k < _successorOffsets[current + 1]; ++k)
+        {
+            int next = _successors[k].target;
+            if(next == predecessor)
+            {
+                return true;
+            }
+            if(!visited[next])
+            {
+                visited[next] = true;
+                stack.append(next);
+            }
+        }
+    }
+    return false;
+}
+
+QVector<ProjectScheduleSummary> ScheduleEngine::AnalyzePortfolio(const QVector<ProjectNode>& nodes,
+                                                                 const QVector<NodeDependency>& dependencies)
+{
+    QMap<int, ProjectScheduleInput> inputs;
+    QHash<int, int> projectOfNode;
+    projectOfNode.reserve(nodes.size());
+    for(const ProjectNode& node : nodes)
+    {
+        inputs[node.projectId].nodes.append(node);
+        projectOfNode.insert(node.id, node.projectId);
+    }
+    for(const NodeDependency& dependency : dependencies)
+    {
+        auto it = inputs.find(projectOfNode.value(dependency.successorId, -1));
+        if(it != inputs.end())
+        {
+            it->dependencies.append(dependency);
+        }
+    }
+
+    const QList<ProjectScheduleInput> projects = inputs.values();
+    return QtConcurrent::blockingMapped<QVector<ProjectScheduleSummary>>(projects,
+        [](const ProjectScheduleInput& input) {
+            ScheduleEngine engine;
+            engine.Build(input.nodes, input.dependencies);
+            return engine.Summary();
+        });
+}
+
+void ScheduleEngine::LoadNode(int index, const ProjectNode& node)
+{
+    QDate created = node.creationTime.isValid() ? node.creationTime.date() : QDate::currentDate();
+    _release[index] = created.toJulianDay();
+
+    QDate planned = node.estimatedCompletionTime.date();
+    if(node.isCompleted)
+    {
+        _durations[index] = 0;
+    }
+    else if(planned.isValid())
+    {
+        _durations[index] = qMax<qint64>(1, created.daysTo(planned));
+    }
+    else
+    {
+        _durations[index] = 1;
+    }
+}
+
+bool ScheduleEngine::ComputeEarliest(int index)
+{
+    qint64 start = _release[index];
+    qint64 finish = std::numeric_limits<qint64>::min();
+    for(int k = _predecessorOffsets[index]; k < _predecessorOffsets[index + 1]; ++k)
+    {
+        const Edge& edge = _predecessors[k];
+        if(_positions[edge.target] < 0)
+        {
+            continue;
+        }
+        if(edge.type == FinishToStart)
+        {
+            start = qMax(start, _earliestFinish[edge.target]);
+        }
+        else
+        {
+            finish = qMax(finish, _earliestFinish[edge.target]);
+        }
+    }
+    finish = qMax(finish, start + _durations[index]);
+
+    bool changed = start != _earliestStart[index] || finish != _earliestFinish[index];
+    _earliestStart[index] = start;
+    _earliestFinish[index] = finish;
+    return changed;
+}
+
+bool ScheduleEngine::ComputeLatest(int index)
+{
+    qint64 finish = _projectFinish;
+    for(int k = _successorOffsets[index]; k < _successorOffsets[index + 1]; ++k)
+    {
+        const Edge& edge = _successors[k];
+        if(_positions[edge.target] < 0)
+        {
+            continue;
+        }
+        finish = qMin(finish, edge.type == FinishToStart ? _latestStart[edge.target] : _latestFinish[edge.target]);
+    }
+    qint64 start = finish - _durations[index];
+
+    bool changed = start != _latestStart[index] || finish != _latestFinish[index];
+    _latestStart[index] = start;
+    _latestFinish[index] = finish;
+    return changed;
+}
+
+void ScheduleEngine::ForwardPass()
+{
+    for(int index : _order)
+    {
+        ComputeEarliest(index);
+    }
+}
+
+void ScheduleEngine::BackwardPass()
+{
+    for(int position = _order.size() - 1; position >= 0; --position)
+    {
+        ComputeLatest(_order[position]);
+    }
+}
+
+bool ScheduleEngine::UpdateProjectFinish()
+{
+    qint64 start = std::numeric_limits<qint64>::max();
+    qint64 finish = std::numeric_limits<qint64>::min();
+    for(int index : _order)
+    {
+        start = qMin(start, _earliestStart[index]);
+        finish = qMax(finish, _earliestFinish[index]);
+    }
+    if(_order.isEmpty())
+    {
+        start = finish = 0;
+    }
+
+    bool changed = finish != _projectFinish;
+    _projectStart = start;
+    _projectFinish = finish;
+    return changed;
+}
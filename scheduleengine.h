@@ -0,0 +1,120 @@
+#ifndef SCHEDULEENGINE_H
+#define SCHEDULEENGINE_H
+
+#include <QDate>
+#include <QHash>
+#include <QVector>
+#include "DBModels.h"
+
+// 节点的进度计划，日期按天计算
+struct NodeSchedule
+{
+    int nodeId = 0;
+    bool scheduled = false;         // 节点处在依赖环中时为false，其它字段无效
+    QDate earliestStart;
+    QDate earliestFinish;           // 按依赖推算的最早完成日期，晚于预计完成时间说明会延期
+    QDate latestStart;
+    QDate latestFinish;             // 不推迟项目完成的最晚完成日期
+    int slackDays = 0;              // 总时差
+    bool critical = false;          // 未完成且总时差为0
+};
+
+// 单个项目的进度汇总，用于项目组合视图
+struct ProjectScheduleSummary
+{
+    int projectId = 0;
+    int nodeCount = 0;
+    int criticalCount = 0;
+    int unscheduledCount = 0;       // 处在依赖环中的节点数
+    QDate start;
+    QDate plannedFinish;            // 各节点预计完成时间的最大值
+    QDate projectedFinish;          // 按依赖推算的完成日期
+    int delayDays = 0;              // projectedFinish 晚于 plannedFinish 的天数
+};
+
+// 进度计划引擎（关键路径法）
+// 节点的工期为创建日期到预计完成日期的天数（至少1天），已完成节点工期为0，最早从创建日期开始。
+// 依赖图包括两类边：前置依赖（前置节点完成后后继才能开始）和节点层次（子节点完成后父节点才能完成）。
+// 拓扑排序、正推和逆推都是 O(V+E)；修改单个节点的日期时只沿受影响的后继和前驱重新计算。
+class ScheduleEngine
+{
+public:
+    ScheduleEngine();
+
+    void Build(const QVector<ProjectNode>& nodes, const QVector<NodeDependency>& dependencies);
+    void Clear();
+
+    // 节点的日期或完成状态改变时增量重算；父节点改变时重新构建。不存在时返回false
+    bool UpdateNode(const ProjectNode& node);
+    // 添加节点或修改前置依赖后重新构建
+    bool AddNode(const ProjectNode& node);
+    void SetPredecessors(int nodeId, const QVector<int>& predecessorIds);
+    // 删除节点及与其相关的前置依赖后重新构建
+    void RemoveNodes(const QVector<int>& nodeIds);
+    // 节点的前置节点ID，不包括层次关系
+    QVector<int> Predecessors(int nodeId) const;
+
+    int Size() const;
+    bool Contains(int nodeId) const;
+    NodeSchedule Schedule(int nodeId) const;
+
+    // 关键节点，按拓扑顺序排列
+    QVector<int> CriticalPath() const;
+    QDate ProjectStart() const;
+    QDate ProjectFinish() const;
+    ProjectScheduleSummary Summary() const;
+
+    // 添加 predecessorId -> successorId 的依赖是否会形成环
+    bool WouldCreateCycle(int predecessorId, int successorId) const;
+
+    // 按项目分组后在线程池中并行计算各项目的进度汇总，结果按项目ID排序
+    static QVector<ProjectScheduleSummary> AnalyzePortfolio(const QVector<ProjectNode>& nodes,
+                                                            const QVector<NodeDependency>& dependencies);
+
+private:
+    // 边的类型
+    enum EdgeType : quint8
+    {
+        FinishToStart,              // 前置依赖
+        FinishToFinish              // 子节点到父节点
+    };
+
+    struct Edge
+    {
+        int target;
+        EdgeType type;
+    };
+
+    void LoadNode(int index, const ProjectNode& node);
+    bool ComputeEarliest(int index);
+    bool ComputeLatest(int index);
+    void ForwardPass();
+    void BackwardPass();
+    bool UpdateProjectFinish();
+
+private:
+    QVector<ProjectNode> _nodes;
+    QVector<NodeDependency> _dependencies;
+    QHash<int, int> _indexById;
+
+    // 后继和前驱都按 CSR 存放
+    QVector<int> _successorOffsets;
+    QVector<Edge> _successors;
+    QVector<int> _predecessorOffsets;
+    QVector<Edge> _predecessors;
+
+    QVector<int> _order;            // 拓扑顺序，不含环上的节点
+    QVector<int> _positions;        // 节点在 _order 中的位置，环上的节点为-1
+
+    // 儒略日
+    QVector<qint64> _release;
+    QVector<qint64> _durations;
+    QVector<qint64> _earliestStart;
+    QVector<qint64> _earliestFinish;
+    QVector<qint64> _latestStart;
+    QVector<qint64> _latestFinish;
+    qint64 _projectStart;
+    qint64 _projectFinish;
+};
+
+#endif // SCHEDULEENGINE_H
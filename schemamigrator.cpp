@@ -0,0 +1,121 @@
+#include <QDebug>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <algorithm>
+#include "schemamigrator.h"
+
+SchemaMigrator::SchemaMigrator(const QSqlDatabase& db) : _db(db)
+{
+
+}
+
+void SchemaMigrator::AddMigration(int version, const QString& description, const QStringList& statements)
+{
+    SchemaMigration migration;
+    migration.version = version;
+    migration.description = description;
+    migration.statements = statements;
+    _migrations.append(migration);
+}
+
+int SchemaMigrator::CurrentVersion() const
+{
+    QSqlQuery query(_db);
+    if(!query.exec("PRAGMA user_version") || !query.next())
+    {
+        qDebug() << "Failed to read schema version: " << query.lastError().text();
+        return -1;
+    }
+
+    return query.value(0).toInt();
+}
+
+int SchemaMigrator::LatestVersion() const
+{
+    int latest = 0;
+    for(const SchemaMigration& migration : _migrations)
+    {
+        latest = qMax(latest, migration.version);
+    }
+
+    return latest;
+}
+
+bool SchemaMigrator::Migrate()
+{
+    int currentVersion = CurrentVersion();
+    if(currentVersion < 0)
+    {
+        return false;
+    }
+
+    if(currentVersion > LatestVersion())
+    {
+        qDebug() << "数据库结构版本" << currentVersion << "高于程序支持的版本" << LatestVersion();
+        return false;
+    }
+
+    std::sort(_migrations.begin(), _migrations.end(),
+              [](const SchemaMigration& a, const SchemaMigration& b) {
+                  return a.version < b.version;
+              });
+
+    for(const SchemaMigration& migration : _migrations)
+    {
+        if(migration.version <= currentVersion)
+        {
+            continue;
+        }
+
+        if(!ApplyMigration(migration))
+        {
+            return false;
+        }
+
+        qDebug() << "数据库结构已升级到版本" << migration.version << ":" << migration.description;
+        currentVersion = migration.version;
+    }
+
+    return true;
+}
+
+bool SchemaMigrator::ApplyMigration(const SchemaMigration& migration)
+{
+    if(!_db.transaction())
+    {
+        qDebug() << "Failed to begin migration" << migration.version << ": " << _db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(_db);
+    for(const QString& statement : migration.statements)
+    {
+        if(!query.exec(statement))
+        {
+            qDebug() << "Failed to apply migration" << migration.version << ": " << query.lastError().text();
+            qDebug() << "SQL: " << statement;
+            query.finish();
+            _db.rollback();
+            return false;
+        }
+    }
+
+    // user_version 与迁移内容在同一事务中提交
+    if(!query.exec(QString("PRAGMA user_version = %1").arg(migration.version)))
+    {
+        qDebug() << "Failed to update schema version: " << query.lastError().text();
+        query.finish();
+        _db.rollback();
+        return false;
+    }
+
+    query.finish();
+    if(!_db.commit())
+    {
+        qDebug() << "Failed to commit migration" << migration.version << ": " << _db.lastError().text();
+        _db.rollback();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef SCHEMAMIGRATOR_H
+#define SCHEMAMIGRATOR_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// 单个版本的迁移步骤
+struct SchemaMigration
+{
+    int version;            // 迁移完成后的 PRAGMA user_version
+    QString description;    // 迁移说明，用于日志
+    QStringList statements; // 按顺序执行的SQL语句
+};
+
+// 基于 PRAGMA user_version 的数据库结构迁移
+// 启动时按版本号顺序执行所有高于当前版本的迁移，每个版本在单独的事务中完成，
+// 失败时回滚该版本，数据库停留在上一个版本。
+class SchemaMigrator
+{
+public:
+    explicit SchemaMigrator(const QSqlDatabase& db);
+
+    void AddMigration(int version, const QString& description, const QStringList& statements);
+
+    // 数据库当前的结构版本
+    int CurrentVersion() const;
+
+    // 已注册迁移中的最高版本
+    int LatestVersion() const;
+
+    // 执行所有未应用的迁移
+    bool Migrate();
+
+private:
+    bool ApplyMigration(const SchemaMigration& migration);
+
+private:
+    QSqlDatabase _db;
+    QVector<SchemaMigration> _migrations;
+};
+
+#endif // SCHEMAMIGRATOR_H
@@ -0,0 +1,64 @@
+#include <QDebug>
+#include <QSqlError>
+#include "statementcache.h"
+
+StatementCache::StatementCache()
+    : _failedQuery(nullptr)
+    , _hits(0)
+    , _misses(0)
+{
+
+}
+
+StatementCache::~StatementCache()
+{
+    Clear();
+}
+
+void StatementCache::SetDatabase(const QSqlDatabase& db)
+{
+    Clear();
+    _db = db;
+}
+
+QSqlQuery& StatementCache::Prepare(const QString& id, const QString& sql)
+{
+    auto it = _queries.find(id);
+    if(it != _queries.end())
+    {
+        ++_hits;
+        // 释放上一次执行残留的结果集，保留预编译的语句
+        it.value()->finish();
+        return *it.value();
+    }
+
+    ++_misses;
+    QSqlQuery* query = new QSqlQuery(_db);
+    if(!query->prepare(sql))
+    {
+        qDebug() << "Failed to prepare statement" << id << ": " << query->lastError().text();
+        delete _failedQuery;
+        _failedQuery = query;
+        return *_failedQuery;
+    }
+
+    _queries.insert(id, query);
+    return *query;
+}
+
+void StatementCache::Clear()
+{
+    qDeleteAll(_queries);
+    _queries.clear();
+    delete _failedQuery;
+    _failedQuery = nullptr;
+}
+
+StatementCacheStats StatementCache::Stats() const
+{
+    StatementCacheStats stats;
+    stats.hits = _hits;
+    stats.misses = _misses;
+    stats.size = _queries.size();
+    return stats;
+}
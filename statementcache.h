@@ -0,0 +1,50 @@
+#ifndef STATEMENTCACHE_H
+#define STATEMENTCACHE_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QHash>
+#include <QString>
+
+// 语句缓存统计信息
+struct StatementCacheStats
+{
+    quint64 hits;    // 命中次数
+    quint64 misses;  // 未命中（需要重新预编译）次数
+    int size;        // 当前缓存的语句数量
+};
+
+// 预编译语句缓存
+// 每个数据库连接持有一份，按语句ID缓存已prepare的QSqlQuery，
+// 之后的调用只需重新绑定参数即可执行，省去SQLite的解析与查询计划开销。
+// 注意：同一语句ID的查询结果在下一次Prepare同一ID时会被释放，
+// 因此遍历结果集的过程中不能再次使用同一个语句ID。
+class StatementCache
+{
+public:
+    StatementCache();
+    ~StatementCache();
+
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    // 绑定数据库连接，会清空已有缓存
+    void SetDatabase(const QSqlDatabase& db);
+
+    // 获取语句ID对应的预编译语句，未命中时使用sql预编译并缓存
+    QSqlQuery& Prepare(const QString& id, const QString& sql);
+
+    // 释放所有缓存的语句，必须在关闭数据库连接之前调用
+    void Clear();
+
+    StatementCacheStats Stats() const;
+
+private:
+    QSqlDatabase _db;
+    QHash<QString, QSqlQuery*> _queries;
+    QSqlQuery* _failedQuery; // 预编译失败的语句不进入缓存
+    quint64 _hits;
+    quint64 _misses;
+};
+
+#endif // STATEMENTCACHE_H
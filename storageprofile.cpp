@@ -0,0 +1,148 @@
+#include <QDebug>
+#include <QSqlQuery>
+#include <QSqlError>
+#include "storageprofile.h"
+
+static bool ExecPragma(QSqlQuery& query, const QString& pragma)
+{
+    if(!query.exec("PRAGMA " + pragma))
+    {
+        qDebug() << "Failed to apply PRAGMA" << pragma << ": " << query.lastError().text();
+        return false;
+    }
+
+    query.finish();
+    return true;
+}
+
+bool ApplyStorageProfile(const QSqlDatabase& db, const StorageProfile& profile, bool readOnly)
+{
+    QSqlQuery query(db);
+
+    // foreign_keys 在事务中设置无效，必须在连接打开后第一时间设置
+    if(!ExecPragma(query, QString("foreign_keys = %1").arg(profile.foreignKeys ? "ON" : "OFF")))
+        return false;
+
+    if(!ExecPragma(query, QString("busy_timeout = %1").arg(profile.busyTimeoutMs)))
+        return false;
+
+    if(readOnly)
+    {
+        // journal_mode 由写连接设置并持久化在数据库文件中，只读连接只需设置缓存相关参数
+        return ExecPragma(query, "query_only = ON") &&
+               ExecPragma(query, QString("cache_size = %1").arg(-profile.cacheSizeKiB)) &&
+               ExecPragma(query, QString("mmap_size = %1").arg(profile.mmapSizeBytes)) &&
+               ExecPragma(query, QString("temp_store = %1").arg(profile.tempStore));
+    }
+
+    // journal_mode 返回实际生效的模式，例如网络文件系统上可能无法启用WAL
+    if(!query.exec(QString("PRAGMA journal_mode = %1").arg(profile.journalMode)) || !query.next())
+    {
+        qDebug() << "Failed to set journal mode: " << query.lastError().text();
+        return false;
+    }
+    QString journalMode = query.value(0).toString();
+    query.finish();
+    if(journalMode.compare(profile.journalMode, Qt::CaseInsensitive) != 0)
+    {
+        qDebug() << "journal_mode" << profile.journalMode << "未生效，当前模式: " << journalMode;
+    }
+
+    if(!ExecPragma(query, QString("synchronous = %1").arg(profile.synchronous)))
+        return false;
+
+    // cache_size 为负数时单位是KiB
+    if(!ExecPragma(query, QString("cache_size = %1").arg(-profile.cacheSizeKiB)))
+        return false;
+
+    if(!ExecPragma(query, QString("mmap_size = %1").arg(profile.mmapSizeBytes)))
+        return false;
+
+    if(!ExecPragma(query, QString("temp_store = %1").arg(profile.tempStore)))
+        return false;
+
+    if(!ExecPragma(query, QString("wal_autocheckpoint = %1").arg(profile.walAutoCheckpointPages)))
+        return false;
+
+    return true;
+}
+
+WalCheckpointScheduler::WalCheckpointScheduler(QObject* parent)
+    : QObject(parent)
+    , _truncatePages(0)
+    , _busyTimeoutMs(0)
+{
+    connect(&_timer, &QTimer::timeout, this, &WalCheckpointScheduler::checkpointDue);
+}
+
+void WalCheckpointScheduler::Start(const StorageProfile& profile)
+{
+    _truncatePages = profile.checkpointTruncatePages;
+    _busyTimeoutMs = profile.busyTimeoutMs;
+
+    if(profile.checkpointIntervalMs <= 0 ||
+       profile.journalMode.compare("WAL", Qt::CaseInsensitive) != 0)
+    {
+        return;
+    }
+
+    _timer.start(profile.checkpointIntervalMs);
+}
+
+void WalCheckpointScheduler::Stop()
+{
+    _timer.stop();
+}
+
+bool WalCheckpointScheduler::Checkpoint(const QSqlDatabase& db, bool truncate) const
+{
+    if(!db.isOpen())
+    {
+        return false;
+    }
+
+    int logPages = 0;
+    int checkpointedPages = 0;
+    if(!RunCheckpoint(db, truncate ? "TRUNCATE" : "PASSIVE", &logPages, &checkpointedPages))
+    {
+        return false;
+    }
+
+    if(!truncate && _truncatePages > 0 && logPages >= _truncatePages && checkpointedPages == logPages)
+    {
+        // 所有页都已写回，截断WAL文件回收空间。TRUNCATE 需要等待所有读连接离开WAL，
+        // 定时检查点不等待，读连接繁忙时留到下一次
+        QSqlQuery query(db);
+        query.exec("PRAGMA busy_timeout = 0");
+        bool truncated = RunCheckpoint(db, "TRUNCATE", &logPages, &checkpointedPages);
+        query.exec(QString("PRAGMA busy_timeout = %1").arg(_busyTimeoutMs));
+        return truncated;
+    }
+
+    return true;
+}
+
+bool WalCheckpointScheduler::RunCheckpoint(const QSqlDatabase& db, const QString& mode,
+                                           int* logPages, int* checkpointedPages) const
+{
+    QSqlQuery query(db);
+    if(!query.exec(QString("PRAGMA wal_checkpoint(%1)").arg(mode)) || !query.next())
+    {
+        qDebug() << "WAL checkpoint failed: " << query.lastError().text();
+        return false;
+    }
+
+    // 返回 (busy, WAL总页数, 已写回页数)
+    bool busy = query.value(0).toInt() != 0;
+    *logPages = query.value(1).toInt();
+    *checkpointedPages = query.value(2).toInt();
+    query.finish();
+
+    if(busy)
+    {
+        qDebug() << "WAL检查点未完成，WAL页数:" << *logPages << "已写回:" << *checkpointedPages;
+        return false;
+    }
+
+    return true;
+}
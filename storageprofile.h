@@ -0,0 +1,64 @@
+#ifndef STORAGEPROFILE_H
+#define STORAGEPROFILE_H
+
+#include <QObject>
+#include <QSqlDatabase>
+#include <QString>
+#include <QTimer>
+
+// SQLite存储参数，每次打开连接时应用
+struct StorageProfile
+{
+    QString journalMode = "WAL";         // WAL模式下读不阻塞写、写不阻塞读
+    QString synchronous = "NORMAL";      // WAL下NORMAL只在检查点时fsync，断电不会损坏数据库
+    int cacheSizeKiB = 64 * 1024;        // 每个连接的页缓存大小
+    qint64 mmapSizeBytes = 256LL * 1024 * 1024; // 内存映射读取的上限，0表示关闭
+    QString tempStore = "MEMORY";        // 排序、临时索引放在内存中
+    bool foreignKeys = true;             // 表结构依赖ON DELETE CASCADE，必须开启
+    int busyTimeoutMs = 5000;            // 遇到其它连接持有写锁时的等待时间
+
+    // WAL检查点策略
+    int walAutoCheckpointPages = 1000;   // 提交时自动执行PASSIVE检查点的WAL页数阈值
+    int checkpointIntervalMs = 30000;    // 后台检查点间隔，0表示关闭后台检查点
+    int checkpointTruncatePages = 4096;  // WAL超过该页数时截断WAL文件，避免文件持续增大
+
+    // 连接池
+    int readerPoolSize = 4;              // 同时进行只读查询的连接数
+};
+
+// 在已打开的连接上应用存储参数
+// 只读连接不修改 journal_mode 等持久化设置，并开启 query_only
+bool ApplyStorageProfile(const QSqlDatabase& db, const StorageProfile& profile, bool readOnly = false);
+
+// WAL后台检查点调度
+// 定时发出 checkpointDue，由接收方在持有写连接的数据库线程上调用 Checkpoint，计时器所在线程不访问数据库。
+// PASSIVE检查点把WAL中的页写回主数据库文件，不等待读写锁，因此不会阻塞正在进行的读写；
+// WAL积累过多时再尝试TRUNCATE以回收磁盘空间，有读连接正在使用WAL时放弃，不等待 busy_timeout。
+class WalCheckpointScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WalCheckpointScheduler(QObject* parent = nullptr);
+
+    void Start(const StorageProfile& profile);
+    void Stop();
+
+    // 在写连接 db 上立即执行一次检查点，truncate为true时截断WAL文件，
+    // 需要等待读连接时最多等待 busy_timeout
+    bool Checkpoint(const QSqlDatabase& db, bool truncate = false) const;
+
+signals:
+    // 到达检查点间隔
+    void checkpointDue();
+
+private:
+    // 执行 PRAGMA wal_checkpoint，返回是否完成及WAL页数
+    bool RunCheckpoint(const QSqlDatabase& db, const QString& mode, int* logPages, int* checkpointedPages) const;
+
+private:
+    QTimer _timer;
+    int _truncatePages;
+    int _busyTimeoutMs;
+};
+
+#endif // STORAGEPROFILE_H
@@ -0,0 +1,16 @@
+QT       += core testlib
+QT       -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_contenthash
+
+INCLUDEPATH += ../..
+
+# tst_contenthash.cpp 直接包含 contenthash.cpp，不再单独编译
+SOURCES += \
+    tst_contenthash.cpp
+
+HEADERS += \
+    ../../contenthash.h
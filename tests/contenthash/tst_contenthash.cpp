@@ -0,0 +1,128 @@
+#include <QtTest>
+// 包含实现文件，测试可以直接调用两种压缩函数，不受启动时选择的实现影响
+#include "contenthash.cpp"
+
+// FIPS 180-2 附录B的测试向量分别交给标量实现和 SHA-NI 实现压缩，
+// 再按不同的分段大小调用 AddData，覆盖缓冲区补满、整组直接压缩和剩余字节的各种组合
+class TestContentHash : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void compressScalar_data();
+    void compressScalar();
+    void compressShaNi_data();
+    void compressShaNi();
+    void addDataSplits_data();
+    void addDataSplits();
+
+private:
+    static void AddVectors();
+    // 按 FIPS 180-2 填充后一次交给 compress 压缩全部分组
+    static QByteArray Digest(CompressFunction compress, const QByteArray& message);
+};
+
+void TestContentHash::AddVectors()
+{
+    QTest::addColumn<QByteArray>("message");
+    QTest::addColumn<QByteArray>("digest");
+
+    QTest::newRow("empty") << QByteArray()
+        << QByteArray("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    QTest::newRow("abc") << QByteArray("abc")
+        << QByteArray("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    QTest::newRow("448 bits") << QByteArray("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")
+        << QByteArray("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    QTest::newRow("million a") << QByteArray(1000000, 'a')
+        << QByteArray("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+QByteArray TestContentHash::Digest(CompressFunction compress, const QByteArray& message)
+{
+    QByteArray padded = message;
+    padded.append(char(0x80));
+    while(padded.size() % 64 != 56)
+    {
+        padded.append(char(0));
+    }
+    QByteArray length(8, Qt::Uninitialized);
+    qToBigEndian<quint64>(quint64(message.size()) * 8, length.data());
+    padded.append(length);
+
+    quint32 state[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    compress(state, reinterpret_cast<const uchar*>(padded.constData()), padded.size() / 64);
+
+    QByteArray digest(32, Qt::Uninitialized);
+    for(int i = 0; i < 8; ++i)
+    {
+        qToBigEndian<quint32>(state[i], digest.data() + i * 4);
+    }
+    return digest.toHex();
+}
+
+void TestContentHash::compressScalar_data()
+{
+    AddVectors();
+}
+
+void TestContentHash::compressScalar()
+{
+    QFETCH(QByteArray, message);
+    QFETCH(QByteArray, digest);
+
+    QCOMPARE(Digest(CompressScalar, message), digest);
+}
+
+void TestContentHash::compressShaNi_data()
+{
+    AddVectors();
+}
+
+void TestContentHash::compressShaNi()
+{
+#ifdef CONTENTHASH_SHA_NI
+    if(!CpuHasShaNi())
+    {
+        QSKIP("处理器不支持 SHA 扩展指令");
+    }
+
+    QFETCH(QByteArray, message);
+    QFETCH(QByteArray, digest);
+
+    QCOMPARE(Digest(CompressShaNi, message), digest);
+#else
+    QSKIP("编译器或平台不支持 SHA 扩展指令");
+#endif
+}
+
+void TestContentHash::addDataSplits_data()
+{
+    AddVectors();
+}
+
+void TestContentHash::addDataSplits()
+{
+    QFETCH(QByteArray, message);
+    QFETCH(QByteArray, digest);
+
+    QCOMPARE(Sha256::Hash(message).toHex(), digest);
+
+    // 分段大小与64字节的分组错开，同一个对象 Reset 后重复使用
+    Sha256 hasher;
+    const int chunkSizes[] = {1, 3, 55, 63, 64, 65, 127, 1000};
+    for(int chunkSize : chunkSizes)
+    {
+        hasher.Reset();
+        for(qsizetype offset = 0; offset < message.size(); offset += chunkSize)
+        {
+            hasher.AddData(QByteArrayView(message).mid(offset, chunkSize));
+        }
+        QVERIFY2(hasher.Result().toHex() == digest, qPrintable(QString("chunk size %1").arg(chunkSize)));
+    }
+}
+
+QTEST_APPLESS_MAIN(TestContentHash)
+
+#include "tst_contenthash.moc"
@@ -0,0 +1,24 @@
+QT       += core concurrent testlib
+QT       -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_docxmerger
+
+# 与主程序相同：Windows 使用 Qt 自带的 zlib，其它平台链接系统 zlib
+win32: QT += zlib-private
+else: LIBS += -lz
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../docxmerger.cpp \
+    ../../zipreader.cpp \
+    ../../zipwriter.cpp \
+    tst_docxmerger.cpp
+
+HEADERS += \
+    ../../docxmerger.h \
+    ../../zipreader.h \
+    ../../zipwriter.h
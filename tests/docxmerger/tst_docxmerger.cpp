@@ -0,0 +1,190 @@
+#include <QTemporaryDir>
+#include <QXmlStreamReader>
+#include <QtTest>
+#include "docxmerger.h"
+#include "zipreader.h"
+
+// fixtures 中的文档：
+// base.docx    样式 Normal、Heading1、Shared（名称 Shared Base），编号 abstractNum 0 / num 1，
+//              分隔线脚注 -1、0 和普通脚注 1，正文一段引用 num 1、脚注 1 和书签 0
+// second.docx  与 base 的编号、脚注和书签ID相同，样式 Shared（名称 Shared Second）与 base 冲突，
+//              另有 SecondOnly
+// broken.docx  编号、样式（BrokenOnly）和脚注都能解析，正文中途截断，合并到最后一步才失败
+// notadocx.docx 不是ZIP文件
+class TestDocxMerger : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void renumbersCollidingIds();
+    void failedSourceIsRolledBack();
+    void unreadableInputsLeaveTargetUnchanged();
+    void cancelLeavesTargetUnchanged();
+
+private:
+    QString Fixture(const QString& fileName) const;
+    QString OutputPath(const QString& fileName) const;
+    static QByteArray ReadPart(const QString& docxPath, const QString& partName);
+    // xml 中所有 Word 命名空间下 element 元素的 attribute 属性值，按出现顺序排列
+    static QStringList WordAttributes(const QByteArray& xml, const QString& element, const QString& attribute);
+    static void WriteFile(const QString& path, const QByteArray& data);
+    static QByteArray ReadFile(const QString& path);
+
+private:
+    QString _fixtures;
+    QTemporaryDir _outputDir;
+};
+
+static const QString kWordNs = "http://schemas.openxmlformats.org/wordprocessingml/2006/main";
+
+void TestDocxMerger::initTestCase()
+{
+    _fixtures = QFINDTESTDATA("fixtures");
+    QVERIFY(!_fixtures.isEmpty());
+    QVERIFY(_outputDir.isValid());
+}
+
+QString TestDocxMerger::Fixture(const QString& fileName) const
+{
+    return _fixtures + "/" + fileName;
+}
+
+QString TestDocxMerger::OutputPath(const QString& fileName) const
+{
+    return _outputDir.filePath(fileName);
+}
+
+QByteArray TestDocxMerger::ReadPart(const QString& docxPath, const QString& partName)
+{
+    ZipReader zip;
+    QByteArray data;
+    if(!zip.Open(docxPath) || !zip.Read(partName, data))
+        qWarning() << docxPath << partName << zip.ErrorString();
+    return data;
+}
+
+QStringList TestDocxMerger::WordAttributes(const QByteArray& xml, const QString& element, const QString& attribute)
+{
+    QStringList values;
+    QXmlStreamReader reader(xml);
+    while(!reader.atEnd())
+    {
+        if(reader.readNext() == QXmlStreamReader::StartElement &&
+           reader.namespaceUri() == kWordNs && reader.name() == element)
+        {
+            values << reader.attributes().value(kWordNs, attribute).toString();
+        }
+    }
+    if(reader.hasError())
+        qWarning() << reader.errorString();
+    return values;
+}
+
+void TestDocxMerger::WriteFile(const QString& path, const QByteArray& data)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QCOMPARE(file.write(data), data.size());
+}
+
+QByteArray TestDocxMerger::ReadFile(const QString& path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+void TestDocxMerger::renumbersCollidingIds()
+{
+    QString output = OutputPath("renumbered.docx");
+    DocxMerger merger;
+    QVERIFY2(merger.Merge({{Fixture("base.docx"), "基础"}, {Fixture("second.docx"), "第二"}}, output),
+             qPrintable(merger.ErrorString()));
+    QVERIFY(merger.Warnings().isEmpty());
+
+    // 编号：第二个文档的 abstractNum 和 num 接在基础文档之后，num 指向改名后的 abstractNum
+    QByteArray numbering = ReadPart(output, "word/numbering.xml");
+    QCOMPARE(WordAttributes(numbering, "abstractNum", "abstractNumId"), QStringList({"0", "1"}));
+    QCOMPARE(WordAttributes(numbering, "num", "numId"), QStringList({"1", "2"}));
+    QCOMPARE(WordAttributes(numbering, "abstractNumId", "val"), QStringList({"0", "1"}));
+
+    // 样式：同名样式以基础文档为准，只添加新的样式
+    QByteArray styles = ReadPart(output, "word/styles.xml");
+    QCOMPARE(WordAttributes(styles, "style", "styleId"), QStringList({"Normal", "Heading1", "Shared", "SecondOnly"}));
+    QStringList styleNames = WordAttributes(styles, "name", "val");
+    QVERIFY(styleNames.contains("Shared Base"));
+    QVERIFY(!styleNames.contains("Shared Second"));
+
+    // 脚注：分隔线只保留基础文档的，普通脚注重新编号
+    QByteArray footnotes = ReadPart(output, "word/footnotes.xml");
+    QCOMPARE(WordAttributes(footnotes, "footnote", "id"), QStringList({"-1", "0", "1", "2"}));
+    QVERIFY(footnotes.contains("BASE NOTE"));
+    QVERIFY(footnotes.contains("SECOND NOTE"));
+
+    // 正文中的引用与改名后的编号一致，书签ID不重复
+    QByteArray document = ReadPart(output, "word/document.xml");
+    QCOMPARE(WordAttributes(document, "numId", "val"), QStringList({"1", "2"}));
+    QCOMPARE(WordAttributes(document, "footnoteReference", "id"), QStringList({"1", "2"}));
+    QCOMPARE(WordAttributes(document, "bookmarkStart", "id"), QStringList({"0", "1"}));
+    QCOMPARE(WordAttributes(document, "pStyle", "val"), QStringList({"Heading1", "Shared", "Heading1", "SecondOnly"}));
+}
+
+void TestDocxMerger::failedSourceIsRolledBack()
+{
+    QString expectedPath = OutputPath("expected.docx");
+    DocxMerger expectedMerger;
+    QVERIFY(expectedMerger.Merge({{Fixture("base.docx"), QString()}, {Fixture("second.docx"), QString()}},
+                                 expectedPath));
+
+    // 中间的文档在合并正文时失败，之前合并的编号、样式和脚注必须撤销，
+    // 后面的文档与没有这个文档时得到相同的编号
+    QString output = OutputPath("rolledback.docx");
+    DocxMerger merger;
+    QVERIFY2(merger.Merge({{Fixture("base.docx"), QString()}, {Fixture("broken.docx"), QString()},
+                           {Fixture("second.docx"), QString()}}, output),
+             qPrintable(merger.ErrorString()));
+    QCOMPARE(merger.Warnings().size(), 1);
+    QVERIFY(merger.Warnings().first().contains("broken.docx"));
+
+    const QStringList mergedParts = {"word/numbering.xml", "word/styles.xml", "word/footnotes.xml"};
+    for(const QString& part : mergedParts)
+    {
+        QByteArray actual = ReadPart(output, part);
+        QVERIFY(!actual.isEmpty());
+        QCOMPARE(actual, ReadPart(expectedPath, part));
+    }
+
+    QByteArray document = ReadPart(output, "word/document.xml");
+    QVERIFY(!document.contains("BROKEN"));
+    QVERIFY(document.contains("SECOND TEXT"));
+    QCOMPARE(WordAttributes(document, "numId", "val"), QStringList({"1", "2"}));
+    QCOMPARE(WordAttributes(document, "footnoteReference", "id"), QStringList({"1", "2"}));
+}
+
+void TestDocxMerger::unreadableInputsLeaveTargetUnchanged()
+{
+    QString output = OutputPath("unchanged.docx");
+    WriteFile(output, "original");
+
+    DocxMerger merger;
+    QVERIFY(!merger.Merge({{Fixture("notadocx.docx"), QString()}, {Fixture("missing.docx"), QString()}}, output));
+    QVERIFY(!merger.ErrorString().isEmpty());
+    QCOMPARE(merger.Warnings().size(), 2);
+    QCOMPARE(ReadFile(output), QByteArray("original"));
+}
+
+void TestDocxMerger::cancelLeavesTargetUnchanged()
+{
+    QString output = OutputPath("cancelled.docx");
+    WriteFile(output, "original");
+
+    DocxMerger merger;
+    merger.SetProgressCallback([](int finished, int) { return finished < 2; });
+    QVERIFY(!merger.Merge({{Fixture("base.docx"), QString()}, {Fixture("second.docx"), QString()}}, output));
+    QCOMPARE(merger.ErrorString(), QString("合并已取消"));
+    QCOMPARE(ReadFile(output), QByteArray("original"));
+}
+
+QTEST_APPLESS_MAIN(TestDocxMerger)
+
+#include "tst_docxmerger.moc"
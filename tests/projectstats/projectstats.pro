@@ -0,0 +1,29 @@
+QT       += core sql concurrent testlib
+QT       -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_projectstats
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../Databasemanagement.cpp \
+    ../../connectionpool.cpp \
+    ../../databaseexecutor.cpp \
+    ../../entitycache.cpp \
+    ../../schemamigrator.cpp \
+    ../../statementcache.cpp \
+    ../../storageprofile.cpp \
+    tst_projectstats.cpp
+
+HEADERS += \
+    ../../DBModels.h \
+    ../../Databasemanagement.h \
+    ../../connectionpool.h \
+    ../../databaseexecutor.h \
+    ../../entitycache.h \
+    ../../schemamigrator.h \
+    ../../statementcache.h \
+    ../../storageprofile.h
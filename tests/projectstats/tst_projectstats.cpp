@@ -0,0 +1,278 @@
+#include <QRandomGenerator>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QTemporaryDir>
+#include <QtTest>
+#include "Databasemanagement.h"
+
+// 随机增删改项目、节点、文件及其关联后，触发器维护的汇总表
+// （project_stats、project_due_stats）必须与按明细表 GROUP BY 重新统计的结果一致
+class TestProjectStats : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void summaryMatchesRecount_data();
+    void summaryMatchesRecount();
+
+private:
+    // 查询结果的所有行，每行各列用逗号连接，便于比较和输出差异
+    QStringList Rows(const QString& sql);
+    QVector<int> Ids(const QString& sql);
+    static QDateTime RandomDueTime(QRandomGenerator& random);
+    void CompareSummary();
+
+private:
+    QTemporaryDir _dataDir;
+    QString _previousPath;
+    int _adminId = 0;
+    QSqlDatabase _verify;
+};
+
+void TestProjectStats::initTestCase()
+{
+    // 数据库建在当前目录下，切换到临时目录
+    QVERIFY(_dataDir.isValid());
+    _previousPath = QDir::currentPath();
+    QVERIFY(QDir::setCurrent(_dataDir.path()));
+
+    StorageProfile profile;
+    profile.checkpointIntervalMs = 0;
+    QVERIFY(DataBaseManagement::Instance()->Initialize(profile));
+
+    // 重新统计使用单独的只读连接，不经过被测代码的缓存
+    _verify = QSqlDatabase::addDatabase("QSQLITE", "verify");
+    _verify.setDatabaseName(_dataDir.filePath("projectmanager.db"));
+    _verify.setConnectOptions("QSQLITE_OPEN_READONLY");
+    QVERIFY2(_verify.open(), qPrintable(_verify.lastError().text()));
+
+    _adminId = DataBaseManagement::Instance()->GetUserbyUserName("admin").id;
+    QVERIFY(_adminId > 0);
+}
+
+void TestProjectStats::cleanupTestCase()
+{
+    _verify.close();
+    _verify = QSqlDatabase();
+    QSqlDatabase::removeDatabase("verify");
+
+    DataBaseManagement::Instance()->Shutdown();
+    QDir::setCurrent(_previousPath);
+}
+
+QStringList TestProjectStats::Rows(const QString& sql)
+{
+    QStringList rows;
+    QSqlQuery query(_verify);
+    if(!query.exec(sql))
+    {
+        qWarning() << sql << query.lastError().text();
+        return rows;
+    }
+    const int columns = query.record().count();
+    while(query.next())
+    {
+        QStringList values;
+        for(int column = 0; column < columns; ++column)
+            values << query.value(column).toString();
+        rows << values.join(',');
+    }
+    return rows;
+}
+
+QVector<int> TestProjectStats::Ids(const QString& sql)
+{
+    QVector<int> ids;
+    QSqlQuery query(_verify);
+    if(query.exec(sql))
+    {
+        while(query.next())
+            ids.append(query.value(0).toInt());
+    }
+    return ids;
+}
+
+QDateTime TestProjectStats::RandomDueTime(QRandomGenerator& random)
+{
+    // 约八分之一没有预计完成时间；小时随机，同一天的节点应计入同一行
+    if(random.bounded(8) == 0)
+        return QDateTime();
+    QDate date(2024, random.bounded(1, 4), random.bounded(1, 29));
+    return QDateTime(date, QTime(random.bounded(24), 0));
+}
+
+void TestProjectStats::CompareSummary()
+{
+    QStringList stats = Rows(
+        "SELECT project_id, node_count, completed_count, file_count, total_bytes "
+        "FROM project_stats ORDER BY project_id");
+    QStringList recount = Rows(
+        "SELECT p.id, "
+        "(SELECT COUNT(*) FROM project_nodes n WHERE n.project_id = p.id), "
+        "(SELECT COUNT(*) FROM project_nodes n WHERE n.project_id = p.id AND n.is_completed != 0), "
+        "(SELECT COUNT(*) FROM project_file pf INNER JOIN files f ON f.id = pf.file_id "
+        "WHERE pf.project_id = p.id AND f.status = 0), "
+        "(SELECT IFNULL(SUM(f.file_size), 0) FROM project_file pf INNER JOIN files f ON f.id = pf.file_id "
+        "WHERE pf.project_id = p.id AND f.status = 0) "
+        "FROM projects p ORDER BY p.id");
+    QCOMPARE(stats, recount);
+
+    // 未完成数降为0的日期行应当删除
+    QStringList dueStats = Rows(
+        "SELECT project_id, due_date, open_count FROM project_due_stats ORDER BY project_id, due_date");
+    QStringList dueRecount = Rows(
+        "SELECT project_id, date(estimated_completion_time), COUNT(*) FROM project_nodes "
+        "WHERE is_completed = 0 AND date(estimated_completion_time) IS NOT NULL "
+        "GROUP BY project_id, date(estimated_completion_time) ORDER BY 1, 2");
+    QCOMPARE(dueStats, dueRecount);
+}
+
+void TestProjectStats::summaryMatchesRecount_data()
+{
+    QTest::addColumn<quint32>("seed");
+
+    QTest::newRow("seed 1") << 1u;
+    QTest::newRow("seed 2") << 2u;
+    QTest::newRow("seed 3") << 3u;
+}
+
+void TestProjectStats::summaryMatchesRecount()
+{
+    QFETCH(quint32, seed);
+
+    DataBaseManagement* db = DataBaseManagement::Instance();
+    QRandomGenerator random(seed);
+
+    for(int step = 0; step < 300; ++step)
+    {
+        const QVector<int> projectIds = Ids("SELECT id FROM projects");
+        const QVector<int> nodeIds = Ids("SELECT id FROM project_nodes");
+        const QVector<int> fileIds = Ids("SELECT id FROM files");
+        auto pick = [&random](const QVector<int>& ids) { return ids[random.bounded(ids.size())]; };
+
+        int operation = random.bounded(12);
+        if(projectIds.isEmpty() || operation == 0)
+        {
+            Project project;
+            project.name = QString("项目%1").arg(step);
+            project.managerId = _adminId;
+            project.isCompleted = false;
+            QVERIFY(db->AddProject(project) > 0);
+        }
+        else if(operation == 1)
+        {
+            // 删除项目较少，避免数据量太小
+            if(random.bounded(4) == 0)
+                QVERIFY(db->DeleteProject(pick(projectIds)));
+        }
+        else if(operation <= 3)
+        {
+            ProjectNode node;
+            node.id = -1;
+            node.projectId = pick(projectIds);
+            node.name = QString("节点%1").arg(step);
+            node.parentId = 0;
+            const QVector<int> siblings = Ids(QString("SELECT id FROM project_nodes WHERE project_id = %1")
+                                              .arg(node.projectId));
+            if(!siblings.isEmpty() && random.bounded(2) == 0)
+                node.parentId = pick(siblings);
+            node.estimatedCompletionTime = RandomDueTime(random);
+            node.isCompleted = random.bounded(3) == 0;
+            QCOMPARE(db->AddProjectNodes({node}).size(), 1);
+        }
+        else if(operation == 4 && !nodeIds.isEmpty())
+        {
+            QVector<ProjectNode> nodes = db->GetProjectNodes(
+                Ids(QString("SELECT project_id FROM project_nodes WHERE id = %1").arg(pick(nodeIds))).value(0));
+            QVERIFY(!nodes.isEmpty());
+            ProjectNode node = nodes[random.bounded(nodes.size())];
+            node.estimatedCompletionTime = RandomDueTime(random);
+            node.isCompleted = random.bounded(3) == 0;
+            QVERIFY(db->UpdateProjectNode(node));
+        }
+        else if(operation == 5 && !nodeIds.isEmpty())
+        {
+            // 子树内的节点由外键级联删除，每个都要从汇总中扣除
+            QVERIFY(db->DeleteProjectNode(pick(nodeIds)));
+        }
+        else if(operation == 6)
+        {
+            FileInfo file;
+            file.fileName = QString("文件%1.docx").arg(step);
+            file.filePath = file.fileName;
+            file.fileExtension = "docx";
+            file.fileSize = random.bounded(1, 100000);
+            file.uploaderId = _adminId;
+            file.fileType = FileType::DOCUMENT;
+            file.status = FileStatus::NORMAL;
+            file.projectId = -1;
+            file.isProcessDocument = false;
+            file.pageCount = 0;
+            file.wordCount = 0;
+            file.characterCount = 0;
+            QCOMPARE(db->AddFiles({file}).size(), 1);
+        }
+        else if(operation == 7 && !fileIds.isEmpty())
+        {
+            QVERIFY(db->AssignFilesToProject(pick(projectIds), {pick(fileIds), pick(fileIds)}));
+        }
+        else if(operation == 8 && !fileIds.isEmpty())
+        {
+            // 只保留一部分关联，其余由 SyncAssociations 删除
+            int projectId = pick(projectIds);
+            QVector<int> kept;
+            for(int fileId : Ids(QString("SELECT file_id FROM project_file WHERE project_id = %1").arg(projectId)))
+            {
+                if(random.bounded(2) == 0)
+                    kept.append(fileId);
+            }
+            QVERIFY(db->UpdateProjectFiles(projectId, kept));
+        }
+        else if(operation == 9 && !fileIds.isEmpty())
+        {
+            // 移入回收站、恢复或归档，只有正常状态的文件计入汇总
+            int fileId = pick(fileIds);
+            int choice = random.bounded(3);
+            if(choice == 0)
+            {
+                db->DeleteFile(fileId);
+            }
+            else if(choice == 1)
+            {
+                db->RestoreFile(fileId);
+            }
+            else
+            {
+                FileInfo file = db->GetFileById(fileId);
+                file.status = FileStatus::ARCHIVED;
+                QVERIFY(db->UpdateFile(file));
+            }
+        }
+        else if(operation == 10 && !fileIds.isEmpty())
+        {
+            FileInfo file = db->GetFileById(pick(fileIds));
+            file.fileSize = random.bounded(1, 100000);
+            QVERIFY(db->UpdateFile(file));
+        }
+        else if(operation == 11 && !fileIds.isEmpty())
+        {
+            // 永久删除时关联由外键级联删除
+            QVERIFY(db->DeleteFile(pick(fileIds), true));
+        }
+
+        CompareSummary();
+        if(QTest::currentTestFailed())
+        {
+            qWarning() << "第" << step << "步操作" << operation << "后汇总不一致";
+            return;
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(TestProjectStats)
+
+#include "tst_projectstats.moc"
@@ -0,0 +1,17 @@
+QT       += core concurrent testlib
+QT       -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_scheduleengine
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../scheduleengine.cpp \
+    tst_scheduleengine.cpp
+
+HEADERS += \
+    ../../DBModels.h \
+    ../../scheduleengine.h
@@ -0,0 +1,227 @@
+#include <QRandomGenerator>
+#include <QtTest>
+#include "scheduleengine.h"
+
+// 随机修改节点后，增量更新的结果必须与按同样的数据重新构建的结果一致
+class TestScheduleEngine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void incrementalMatchesRebuild_data();
+    void incrementalMatchesRebuild();
+    void dependencyCycleIsUnscheduled();
+
+private:
+    static QVector<ProjectNode> RandomNodes(QRandomGenerator& random, int count);
+    static QVector<NodeDependency> RandomDependencies(QRandomGenerator& random, int count, int dependencyCount);
+    static void RandomizeDates(QRandomGenerator& random, ProjectNode& node);
+    static void CompareEngines(const ScheduleEngine& actual, const ScheduleEngine& expected,
+                               const QVector<ProjectNode>& nodes);
+};
+
+// 所有日期都在这一天之后的半年内
+static const QDate kBaseDate(2024, 1, 1);
+
+QVector<ProjectNode> TestScheduleEngine::RandomNodes(QRandomGenerator& random, int count)
+{
+    QVector<ProjectNode> nodes;
+    for(int i = 0; i < count; ++i)
+    {
+        ProjectNode node;
+        node.id = i + 1;
+        node.projectId = 1;
+        node.name = QString("节点%1").arg(node.id);
+        // 父节点ID小于子节点ID，约三分之一是顶级节点
+        node.parentId = (i == 0 || random.bounded(3) == 0) ? 0 : random.bounded(1, node.id);
+        RandomizeDates(random, node);
+        nodes.append(node);
+    }
+    return nodes;
+}
+
+QVector<NodeDependency> TestScheduleEngine::RandomDependencies(QRandomGenerator& random, int count, int dependencyCount)
+{
+    // 前置依赖与层次关系的方向不同，可能形成环，用来覆盖环上节点的处理
+    QVector<NodeDependency> dependencies;
+    for(int i = 0; i < dependencyCount; ++i)
+    {
+        int predecessor = random.bounded(1, count + 1);
+        int successor = random.bounded(1, count + 1);
+        if(predecessor != successor)
+        {
+            dependencies.append(NodeDependency{predecessor, successor});
+        }
+    }
+    return dependencies;
+}
+
+void TestScheduleEngine::RandomizeDates(QRandomGenerator& random, ProjectNode& node)
+{
+    QDate created = kBaseDate.addDays(random.bounded(60));
+    node.creationTime = QDateTime(created, QTime(9, 0));
+    // 偶尔没有预计完成时间，或预计完成时间早于创建时间
+    int choice = random.bounded(10);
+    if(choice == 0)
+        node.estimatedCompletionTime = QDateTime();
+    else if(choice == 1)
+        node.estimatedCompletionTime = QDateTime(created.addDays(-random.bounded(1, 10)), QTime(18, 0));
+    else
+        node.estimatedCompletionTime = QDateTime(created.addDays(random.bounded(1, 120)), QTime(18, 0));
+    node.isCompleted = random.bounded(5) == 0;
+}
+
+void TestScheduleEngine::CompareEngines(const ScheduleEngine& actual, const ScheduleEngine& expected,
+                                        const QVector<ProjectNode>& nodes)
+{
+    QCOMPARE(actual.Size(), expected.Size());
+    for(const ProjectNode& node : nodes)
+    {
+        NodeSchedule a = actual.Schedule(node.id);
+        NodeSchedule e = expected.Schedule(node.id);
+        QVERIFY2(a.scheduled == e.scheduled, qPrintable(QString("节点 %1").arg(node.id)));
+        if(!e.scheduled)
+            continue;
+        QCOMPARE(a.earliestStart, e.earliestStart);
+        QCOMPARE(a.earliestFinish, e.earliestFinish);
+        QCOMPARE(a.latestStart, e.latestStart);
+        QCOMPARE(a.latestFinish, e.latestFinish);
+        QCOMPARE(a.slackDays, e.slackDays);
+        QCOMPARE(a.critical, e.critical);
+    }
+    QCOMPARE(actual.CriticalPath(), expected.CriticalPath());
+    QCOMPARE(actual.ProjectStart(), expected.ProjectStart());
+    QCOMPARE(actual.ProjectFinish(), expected.ProjectFinish());
+
+    ProjectScheduleSummary a = actual.Summary();
+    ProjectScheduleSummary e = expected.Summary();
+    QCOMPARE(a.criticalCount, e.criticalCount);
+    QCOMPARE(a.unscheduledCount, e.unscheduledCount);
+    QCOMPARE(a.plannedFinish, e.plannedFinish);
+    QCOMPARE(a.delayDays, e.delayDays);
+}
+
+void TestScheduleEngine::incrementalMatchesRebuild_data()
+{
+    QTest::addColumn<quint32>("seed");
+    QTest::addColumn<int>("nodeCount");
+    QTest::addColumn<int>("dependencyCount");
+
+    QTest::newRow("small") << 1u << 8 << 6;
+    QTest::newRow("no dependencies") << 2u << 40 << 0;
+    QTest::newRow("sparse") << 3u << 60 << 30;
+    QTest::newRow("dense") << 4u << 60 << 200;
+    QTest::newRow("large") << 5u << 500 << 400;
+}
+
+void TestScheduleEngine::incrementalMatchesRebuild()
+{
+    QFETCH(quint32, seed);
+    QFETCH(int, nodeCount);
+    QFETCH(int, dependencyCount);
+
+    QRandomGenerator random(seed);
+    QVector<ProjectNode> nodes = RandomNodes(random, nodeCount);
+    QVector<NodeDependency> dependencies = RandomDependencies(random, nodeCount, dependencyCount);
+
+    ScheduleEngine engine;
+    engine.Build(nodes, dependencies);
+
+    for(int step = 0; step < 300; ++step)
+    {
+        ProjectNode& node = nodes[random.bounded(nodes.size())];
+        const int nodeId = node.id;
+
+        // 大部分修改走增量路径，少量修改父节点、前置依赖或添加节点，走重新构建的路径
+        int operation = random.bounded(20);
+        if(operation == 0)
+        {
+            node.parentId = random.bounded(2) == 0 ? 0 : random.bounded(1, nodes.size() + 1);
+            QVERIFY(engine.UpdateNode(node));
+        }
+        else if(operation == 1)
+        {
+            QVector<int> predecessorIds;
+            for(int k = random.bounded(3); k > 0; --k)
+            {
+                int predecessorId = random.bounded(1, nodes.size() + 1);
+                if(predecessorId != node.id && !predecessorIds.contains(predecessorId))
+                    predecessorIds.append(predecessorId);
+            }
+            dependencies.removeIf([&node](const NodeDependency& dependency) {
+                return dependency.successorId == node.id;
+            });
+            for(int predecessorId : predecessorIds)
+                dependencies.append(NodeDependency{predecessorId, node.id});
+            engine.SetPredecessors(node.id, predecessorIds);
+        }
+        else if(operation == 2)
+        {
+            ProjectNode added;
+            added.id = nodes.size() + 1;
+            added.projectId = 1;
+            added.name = QString("节点%1").arg(added.id);
+            added.parentId = random.bounded(1, added.id);
+            RandomizeDates(random, added);
+            // 添加后 node 引用失效，之后只使用 nodeId
+            nodes.append(added);
+            QVERIFY(engine.AddNode(added));
+        }
+        else
+        {
+            // 只改日期或完成状态
+            if(random.bounded(3) == 0)
+                node.isCompleted = !node.isCompleted;
+            else
+                RandomizeDates(random, node);
+            QVERIFY(engine.UpdateNode(node));
+        }
+
+        ScheduleEngine rebuilt;
+        rebuilt.Build(nodes, dependencies);
+        CompareEngines(engine, rebuilt, nodes);
+        if(QTest::currentTestFailed())
+        {
+            qWarning() << "第" << step << "步修改节点" << nodeId << "后结果不一致";
+            return;
+        }
+    }
+}
+
+void TestScheduleEngine::dependencyCycleIsUnscheduled()
+{
+    QVector<ProjectNode> nodes;
+    for(int id = 1; id <= 4; ++id)
+    {
+        ProjectNode node;
+        node.id = id;
+        node.projectId = 1;
+        node.parentId = 0;
+        node.creationTime = QDateTime(kBaseDate, QTime(9, 0));
+        node.estimatedCompletionTime = QDateTime(kBaseDate.addDays(id), QTime(18, 0));
+        node.isCompleted = false;
+        nodes.append(node);
+    }
+    // 1 -> 2 -> 3 -> 2 成环，4 不受影响
+    QVector<NodeDependency> dependencies = {{1, 2}, {2, 3}, {3, 2}};
+
+    ScheduleEngine engine;
+    engine.Build(nodes, dependencies);
+    QVERIFY(engine.Schedule(1).scheduled);
+    QVERIFY(!engine.Schedule(2).scheduled);
+    QVERIFY(!engine.Schedule(3).scheduled);
+    QVERIFY(engine.Schedule(4).scheduled);
+    QCOMPARE(engine.Summary().unscheduledCount, 2);
+    QVERIFY(!engine.WouldCreateCycle(4, 1));
+
+    // 修改环上的节点不影响其它节点
+    nodes[1].estimatedCompletionTime = QDateTime(kBaseDate.addDays(30), QTime(18, 0));
+    QVERIFY(engine.UpdateNode(nodes[1]));
+    ScheduleEngine rebuilt;
+    rebuilt.Build(nodes, dependencies);
+    CompareEngines(engine, rebuilt, nodes);
+}
+
+QTEST_APPLESS_MAIN(TestScheduleEngine)
+
+#include "tst_scheduleengine.moc"
@@ -0,0 +1,8 @@
+# 单元测试，在仓库根目录执行 qmake tests/tests.pro && make && make check
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    contenthash \
+    docxmerger \
+    projectstats \
+    scheduleengine
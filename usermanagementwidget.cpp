@@ -1,5 +1,7 @@
 #include "usermanagementwidget.h"
 #include "Databasemanagement.h"
+#include "databaseexecutor.h"
+#include "usertablemodel.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QHeaderView>
@@ -9,7 +11,7 @@
 #include <QVariant>
 #include <functional>
 
-UserManagementWidget::UserManagementWidget(QWidget *parent) : QWidget(parent)
+UserManagementWidget::UserManagementWidget(QWidget *parent) : QWidget(parent), _loadGeneration(0)
 {
     setupUI();
 }
@@ -78,9 +80,9 @@ void UserManagementWidget::setupUI()
     mainLayout->addLayout(toolLayout);
     
     // 创建用户表格
-    _usersTable = new QTableWidget(this);
-    _usersTable->setColumnCount(5);
-    _usersTable->setHorizontalHeaderLabels({"ID", "用户名", "密码", "角色", "创建时间"});
+    _usersModel = new UserTableModel(this);
+    _usersTable = new QTableView(this);
+    _usersTable->setModel(_usersModel);
     _usersTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     _usersTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     _usersTable->setSelectionMode(QAbstractItemView::SingleSelection);
@@ -95,15 +97,24 @@ void UserManagementWidget::setupUI()
 
 void UserManagementWidget::loadUserData()
 {
-    _usersTable->setRowCount(0);
-    
-    // 获取所有用户
-    QVector<User> users = DataBaseManagement::Instance()->GetAllUsers();
-    
+    // 在只读连接上获取所有用户，完成后回到界面线程填充表格。
+    // 读取可能并行完成，只使用最后一次加载的结果
+    quint64 generation = ++_loadGeneration;
+    DataBaseExecutor::Instance()->RunRead(
+        [](DataBaseManagement* db) { return db->GetAllUsers(); },
+        this, [this, generation](const QVector<User>& users) {
+            if(generation == _loadGeneration)
+                populateUserTable(users);
+        });
+}
+
+void UserManagementWidget::populateUserTable(const QVector<User>& users)
+{
     // 应用筛选
     int roleFilter = _roleFilter->currentData().toInt();
     QString searchText = _searchBox->text().trimmed().toLower();
     
+    QVector<User> filteredUsers;
     for(const User& user : users)
     {
         // 应用角色筛选
@@ -114,37 +125,10 @@ void UserManagementWidget::loadUserData()
         if(!searchText.isEmpty() && !user.userName.toLower().contains(searchText))
             continue;
         
-        int row = _usersTable->rowCount();
-        _usersTable->insertRow(row);
-        
-        _usersTable->setItem(row, 0, new QTableWidgetItem(QString::number(user.id)));
-        _usersTable->setItem(row, 1, new QTableWidgetItem(user.userName));
-        
-        // 密码显示为*号
-        QString maskedPassword;
-        for(int i = 0; i < user.password.length(); i++)
-            maskedPassword += "*";
-        _usersTable->setItem(row, 2, new QTableWidgetItem(maskedPassword));
-        
-        // 角色名称
-        QString roleName;
-        switch(user.role)
-        {
-            case UserRole::ADMINISTRATOR:
-                roleName = "管理员";
-                break;
-            case UserRole::PROJECTMANAGER:
-                roleName = "项目负责人";
-                break;
-            case UserRole::NORMALUSER:
-                roleName = "普通用户";
-                break;
-        }
-        _usersTable->setItem(row, 3, new QTableWidgetItem(roleName));
-        
-        // 创建时间
-        _usersTable->setItem(row, 4, new QTableWidgetItem(user.createTime.toString("yyyy-MM-dd hh:mm:ss")));
+        filteredUsers.append(user);
     }
+    
+    _usersModel->SetUsers(filteredUsers);
 }
 
 void UserManagementWidget::updateUIBasedOnRole()
@@ -236,7 +220,7 @@ void UserManagementWidget::onEditUser()
     }
     
     // 获取选中行
-    int row = _usersTable->currentRow();
+    int row = _usersTable->currentIndex().row();
     if(row < 0)
     {
         QMessageBox::warning(this, "提示", "请先选择要编辑的用户！");
@@ -244,8 +228,8 @@ void UserManagementWidget::onEditUser()
     }
     
     // 获取用户ID
-    int userId = _usersTable->item(row, 0)->text().toInt();
-    QString currentUsername = _usersTable->item(row, 1)->text();
+    int userId = _usersModel->UserIdAt(row);
+    QString currentUsername = _usersModel->UserNameAt(row);
     
     // 获取用户信息
     User user = DataBaseManagement::Instance()->GetUserbyUserName(currentUsername);
@@ -305,7 +289,7 @@ void UserManagementWidget::onDeleteUser()
     }
     
     // 获取选中行
-    int row = _usersTable->currentRow();
+    int row = _usersTable->currentIndex().row();
     if(row < 0)
     {
         QMessageBox::warning(this, "提示", "请先选择要删除的用户！");
@@ -313,8 +297,8 @@ void UserManagementWidget::onDeleteUser()
     }
     
     // 获取用户ID
-    int userId = _usersTable->item(row, 0)->text().toInt();
-    QString username = _usersTable->item(row, 1)->text();
+    int userId = _usersModel->UserIdAt(row);
+    QString username = _usersModel->UserNameAt(row);
     
     // 不能删除当前登录用户
     if(username == _currentUser.userName)
@@ -323,6 +307,17 @@ void UserManagementWidget::onDeleteUser()
         return;
     }
     
+    // 上传的文件和负责的项目会随用户一起删除，先要求转移或删除
+    UserOwnership ownership = DataBaseManagement::Instance()->GetUserOwnership(userId);
+    if(ownership.fileCount > 0 || ownership.projectCount > 0)
+    {
+        QMessageBox::warning(this, "无法删除",
+                             QString("用户'%1'上传了 %2 个文件（包括回收站和归档中的文件），负责 %3 个项目。\n"
+                                     "请先删除这些文件，并将项目转交给其他项目经理后再删除该用户。")
+                                 .arg(username).arg(ownership.fileCount).arg(ownership.projectCount));
+        return;
+    }
+    
     // 确认删除
     QMessageBox::StandardButton reply;
     reply = QMessageBox::question(this, "确认删除", 
@@ -341,7 +336,7 @@ void UserManagementWidget::onDeleteUser()
     }
     else
     {
-        QMessageBox::warning(this, "错误", "删除用户失败！可能是系统管理员或该用户有关联的项目。");
+        QMessageBox::warning(this, "错误", "删除用户失败！可能是系统管理员，或该用户有上传的文件或负责的项目。");
     }
 }
 
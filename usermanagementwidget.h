@@ -2,13 +2,15 @@
 #define USERMANAGEMENTWIDGET_H
 
 #include <QWidget>
-#include <QTableWidget>
+#include <QTableView>
 #include <QPushButton>
 #include <QComboBox>
 #include <QLineEdit>
 #include <QLabel>
 #include "DBModels.h"
 
+class UserTableModel;
+
 class UserManagementWidget : public QWidget
 {
     Q_OBJECT
@@ -28,11 +30,14 @@ private slots:
 private:
     void setupUI();
     void loadUserData();
+    void populateUserTable(const QVector<User>& users);
     void updateUIBasedOnRole();
 
 private:
     User _currentUser;
-    QTableWidget* _usersTable;
+    quint64 _loadGeneration;        // 每次加载用户列表时递增，丢弃过期的结果
+    QTableView* _usersTable;
+    UserTableModel* _usersModel;
     QPushButton* _addButton;
     QPushButton* _editButton;
     QPushButton* _deleteButton;
@@ -0,0 +1,89 @@
+#include <QStringList>
+#include "usertablemodel.h"
+
+UserTableModel::UserTableModel(QObject* parent) : PagedTableModel(parent)
+{
+
+}
+
+void UserTableModel::SetUsers(const QVector<User>& users)
+{
+    beginResetModel();
+
+    _rows.clear();
+    _rows.reserve(users.size());
+    for(const User& user : users)
+    {
+        Row row;
+        row.id = user.id;
+        row.passwordLength = user.password.length();
+        row.role = user.role;
+        row.createTime = user.createTime;
+        row.userName = user.userName;
+        _rows.append(row);
+    }
+
+    ResetRowCount(_rows.size());
+    endResetModel();
+}
+
+int UserTableModel::UserIdAt(int row) const
+{
+    return (row >= 0 && row < _rows.size()) ? _rows[row].id : -1;
+}
+
+QString UserTableModel::UserNameAt(int row) const
+{
+    return (row >= 0 && row < _rows.size()) ? _rows[row].userName : QString();
+}
+
+int UserTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : 5;
+}
+
+QVariant UserTableModel::data(const QModelIndex& index, int role) const
+{
+    if(!index.isValid() || role != Qt::DisplayRole || index.row() >= rowCount())
+    {
+        return QVariant();
+    }
+
+    const Row& row = _rows[index.row()];
+    switch(index.column())
+    {
+        case 0:
+            return row.id;
+        case 1:
+            return row.userName;
+        case 2:
+            // 密码显示为*号
+            return QString(row.passwordLength, '*');
+        case 3:
+            switch(row.role)
+            {
+                case UserRole::ADMINISTRATOR:
+                    return QString("管理员");
+                case UserRole::PROJECTMANAGER:
+                    return QString("项目负责人");
+                case UserRole::NORMALUSER:
+                    return QString("普通用户");
+            }
+            return QVariant();
+        case 4:
+            return row.createTime.toString("yyyy-MM-dd hh:mm:ss");
+        default:
+            return QVariant();
+    }
+}
+
+QVariant UserTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    static const QStringList headers = {"ID", "用户名", "密码", "角色", "创建时间"};
+    if(orientation == Qt::Horizontal && role == Qt::DisplayRole && section < headers.size())
+    {
+        return headers[section];
+    }
+
+    return PagedTableModel::headerData(section, orientation, role);
+}
@@ -0,0 +1,40 @@
+#ifndef USERTABLEMODEL_H
+#define USERTABLEMODEL_H
+
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+#include "pagedtablemodel.h"
+#include "DBModels.h"
+
+// 用户列表表格模型
+class UserTableModel : public PagedTableModel
+{
+    Q_OBJECT
+public:
+    explicit UserTableModel(QObject* parent = nullptr);
+
+    void SetUsers(const QVector<User>& users);
+
+    int UserIdAt(int row) const;
+    QString UserNameAt(int row) const;
+
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    // 密码只保存长度，用于显示同样数量的*号
+    struct Row
+    {
+        int id;
+        int passwordLength;
+        UserRole role;
+        QDateTime createTime;
+        QString userName;
+    };
+
+    QVector<Row> _rows;
+};
+
+#endif // USERTABLEMODEL_H
@@ -0,0 +1,467 @@
+#include <QtEndian>
+#include <cstring>
+#include "zipreader.h"
+
+#ifdef Q_OS_WIN
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+namespace
+{
+    const quint32 kLocalHeaderSignature = 0x04034b50;
+    const quint32 kCentralHeaderSignature = 0x02014b50;
+    const quint32 kEndOfCentralDirectorySignature = 0x06054b50;
+
+    const int kLocalHeaderSize = 30;
+    const int kCentralHeaderSize = 46;
+    const int kEndOfCentralDirectorySize = 22;
+
+    const quint16 kMethodStored = 0;
+    const quint16 kMethodDeflated = 8;
+
+    const quint16 kFlagEncrypted = 0x0001;
+    const quint16 kFlagUtf8 = 0x0800;
+
+    // 单个条目解压后的大小上限，防止损坏或恶意的压缩包耗尽内存
+    const quint64 kMaxEntrySize = 512ull * 1024 * 1024;
+
+    quint16 ReadU16(const uchar* p)
+    {
+        return qFromLittleEndian<quint16>(p);
+    }
+
+    quint32 ReadU32(const uchar* p)
+    {
+        return qFromLittleEndian<quint32>(p);
+    }
+
+    // ZIP 中的 deflate 数据没有 zlib 头，使用负的窗口位数按原始流解压
+    bool InflateRaw(const uchar* src, quint64 srcSize, char* dst, quint64 dstSize)
+    {
+        z_stream stream = {};
+        if(inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+            return false;
+
+        stream.next_in = const_cast<Bytef*>(src);
+        stream.avail_in = static_cast<uInt>(srcSize);
+        stream.next_out = reinterpret_cast<Bytef*>(dst);
+        stream.avail_out = static_cast<uInt>(dstSize);
+
+        int ret = inflate(&stream, Z_FINISH);
+        bool ok = ret == Z_STREAM_END && stream.total_out == dstSize;
+        inflateEnd(&stream);
+        return ok;
+    }
+}
+
+ZipEntryReader::ZipEntryReader(const ZipEntry& entry, const uchar* data)
+    : _entry(entry)
+    , _data(data)
+    , _consumed(0)
+    , _produced(0)
+    , _crc(::crc32(0L, Z_NULL, 0))
+    , _failed(false)
+{
+
+}
+
+ZipEntryReader::~ZipEntryReader()
+{
+    if(_stream)
+        inflateEnd(_stream.get());
+}
+
+bool ZipEntryReader::Start()
+{
+    if(_entry.method == kMethodDeflated)
+    {
+        auto stream = std::make_unique<z_stream>();
+        if(inflateInit2(stream.get(), -MAX_WBITS) != Z_OK)
+            return false;
+        stream->next_in = const_cast<Bytef*>(_data);
+        stream->avail_in = static_cast<uInt>(_entry.compressedSize);
+        _stream = std::move(stream);
+    }
+    return open(QIODevice::ReadOnly);
+}
+
+bool ZipEntryReader::HasError() const
+{
+    return _failed;
+}
+
+bool ZipEntryReader::isSequential() const
+{
+    return true;
+}
+
+qint64 ZipEntryReader::size() const
+{
+    return static_cast<qint64>(_entry.uncompressedSize);
+}
+
+qint64 ZipEntryReader::bytesAvailable() const
+{
+    return QIODevice::bytesAvailable() + static_cast<qint64>(_entry.uncompressedSize - _produced);
+}
+
+qint64 ZipEntryReader::readData(char* data, qint64 maxSize)
+{
+    if(_failed)
+        return -1;
+
+    quint64 remaining = _entry.uncompressedSize - _produced;
+    if(remaining == 0 || maxSize <= 0)
+        return 0;
+
+    uInt wanted = static_cast<uInt>(qMin<quint64>(qMin<quint64>(static_cast<quint64>(maxSize), remaining), 1u << 30));
+    uInt produced = wanted;
+    if(_entry.method == kMethodStored)
+    {
+        memcpy(data, _data + _consumed, wanted);
+        _consumed += wanted;
+    }
+    else
+    {
+        _stream->next_out = reinterpret_cast<Bytef*>(data);
+        _stream->avail_out = wanted;
+        int ret = inflate(_stream.get(), Z_NO_FLUSH);
+        produced = wanted - _stream->avail_out;
+        if((ret != Z_OK && ret != Z_STREAM_END) || produced == 0 ||
+           (ret == Z_STREAM_END && _produced + produced != _entry.uncompressedSize))
+        {
+            _failed = true;
+            setErrorString(QString("解压失败: %1").arg(_entry.name));
+            return -1;
+        }
+    }
+
+    _crc = ::crc32(_crc, reinterpret_cast<const Bytef*>(data), produced);
+    _produced += produced;
+    if(_produced == _entry.uncompressedSize && _crc != _entry.crc32)
+    {
+        _failed = true;
+        setErrorString(QString("CRC校验失败: %1").arg(_entry.name));
+        return -1;
+    }
+    return produced;
+}
+
+qint64 ZipEntryReader::writeData(const char*, qint64)
+{
+    return -1;
+}
+
+ZipReader::ZipReader()
+    : _data(nullptr)
+    , _size(0)
+{
+
+}
+
+ZipReader::~ZipReader()
+{
+    Close();
+}
+
+bool ZipReader::Open(const QString& filePath)
+{
+    Close();
+
+    _file.setFileName(filePath);
+    if(!_file.open(QIODevice::ReadOnly))
+    {
+        _error = _file.errorString();
+        return false;
+    }
+
+    _size = _file.size();
+    _data = _file.map(0, _size);
+    if(!_data)
+    {
+        // 部分文件系统不支持映射，退回一次性读入内存
+        _buffer = _file.readAll();
+        _data = reinterpret_cast<const uchar*>(_buffer.constData());
+        _size = _buffer.size();
+    }
+
+    if(!ParseCentralDirectory())
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void ZipReader::Close()
+{
+    if(_file.isOpen())
+    {
+        if(_buffer.isEmpty() && _data)
+            _file.unmap(const_cast<uchar*>(_data));
+        _file.close();
+    }
+
+    _buffer.clear();
+    _data = nullptr;
+    _size = 0;
+    _entries.clear();
+    _index.clear();
+}
+
+bool ZipReader::IsOpen() const
+{
+    return _data != nullptr;
+}
+
+QString ZipReader::ErrorString() const
+{
+    return _error;
+}
+
+const QVector<ZipEntry>& ZipReader::Entries() const
+{
+    return _entries;
+}
+
+bool ZipReader::Contains(const QString& name) const
+{
+    return _index.contains(name);
+}
+
+bool ZipReader::Read(const QString& name, QByteArray& data)
+{
+    data.clear();
+
+    auto it = _index.constFind(name);
+    if(it == _index.constEnd())
+    {
+        _error = QString("条目不存在: %1").arg(name);
+        return false;
+    }
+
+    const ZipEntry& entry = _entries.at(it.value());
+    if(entry.flags & kFlagEncrypted)
+    {
+        _error = QString("不支持加密的条目: %1").arg(name);
+        return false;
+    }
+
+    if(entry.uncompressedSize > kMaxEntrySize)
+    {
+        _error = QString("条目过大: %1").arg(name);
+        return false;
+    }
+
+    const uchar* src = EntryData(entry);
+    if(!src)
+        return false;
+
+    data.resize(static_cast<qsizetype>(entry.uncompressedSize));
+    if(entry.method == kMethodStored)
+    {
+        if(entry.compressedSize != entry.uncompressedSize)
+        {
+            _error = QString("条目大小不一致: %1").arg(name);
+            return false;
+        }
+        memcpy(data.data(), src, entry.uncompressedSize);
+    }
+    else if(entry.method == kMethodDeflated)
+    {
+        if(entry.uncompressedSize > 0 &&
+           !InflateRaw(src, entry.compressedSize, data.data(), entry.uncompressedSize))
+        {
+            data.clear();
+            _error = QString("解压失败: %1").arg(name);
+            return false;
+        }
+    }
+    else
+    {
+        data.clear();
+        _error = QString("不支持的压缩方式 %1: %2").arg(entry.method).arg(name);
+        return false;
+    }
+
+    quint32 crc = ::crc32(0L, reinterpret_cast<const Bytef*>(data.constData()), static_cast<uInt>(data.size()));
+    if(crc != entry.crc32)
+    {
+        data.clear();
+        _error = QString("CRC校验失败: %1").arg(name);
+        return false;
+    }
+
+    return true;
+}
+
+std::unique_ptr<ZipEntryReader> ZipReader::OpenEntry(const QString& name)
+{
+    auto it = _index.constFind(name);
+    if(it == _index.constEnd())
+    {
+        _error = QString("条目不存在: %1").arg(name);
+        return nullptr;
+    }
+
+    const ZipEntry& entry = _entries.at(it.value());
+    if(entry.flags & kFlagEncrypted)
+    {
+        _error = QString("不支持加密的条目: %1").arg(name);
+        return nullptr;
+    }
+
+    if(entry.method != kMethodStored && entry.method != kMethodDeflated)
+    {
+        _error = QString("不支持的压缩方式 %1: %2").arg(entry.method).arg(name);
+        return nullptr;
+    }
+
+    if(entry.method == kMethodStored && entry.compressedSize != entry.uncompressedSize)
+    {
+        _error = QString("条目大小不一致: %1").arg(name);
+        return nullptr;
+    }
+
+    const uchar* src = EntryData(entry);
+    if(!src)
+        return nullptr;
+
+    std::unique_ptr<ZipEntryReader> device(new ZipEntryReader(entry, src));
+    if(!device->Start())
+    {
+        _error = QString("解压失败: %1").arg(name);
+        return nullptr;
+    }
+    return device;
+}
+
+bool ZipReader::ReadCompressed(const QString& name, ZipEntry& entry, QByteArray& data)
+{
+    data.clear();
+
+    auto it = _index.constFind(name);
+    if(it == _index.constEnd())
+    {
+        _error = QString("条目不存在: %1").arg(name);
+        return false;
+    }
+
+    entry = _entries.at(it.value());
+    const uchar* src = EntryData(entry);
+    if(!src)
+        return false;
+
+    data = QByteArray::fromRawData(reinterpret_cast<const char*>(src), static_cast<qsizetype>(entry.compressedSize));
+    return true;
+}
+
+bool ZipReader::ParseCentralDirectory()
+{
+    if(_size < kEndOfCentralDirectorySize)
+    {
+        _error = "文件过小，不是ZIP文件";
+        return false;
+    }
+
+    // 中央目录结束记录位于文件末尾，后面可能跟着最长 65535 字节的注释
+    qint64 minPos = qMax<qint64>(0, _size - kEndOfCentralDirectorySize - 0xFFFF);
+    qint64 eocd = -1;
+    for(qint64 pos = _size - kEndOfCentralDirectorySize; pos >= minPos; --pos)
+    {
+        if(ReadU32(_data + pos) == kEndOfCentralDirectorySignature)
+        {
+            eocd = pos;
+            break;
+        }
+    }
+
+    if(eocd < 0)
+    {
+        _error = "找不到中央目录，不是ZIP文件";
+        return false;
+    }
+
+    quint16 entryCount = ReadU16(_data + eocd + 10);
+    quint32 directorySize = ReadU32(_data + eocd + 12);
+    quint32 directoryOffset = ReadU32(_data + eocd + 16);
+
+    if(entryCount == 0xFFFF || directoryOffset == 0xFFFFFFFF)
+    {
+        _error = "不支持ZIP64格式";
+        return false;
+    }
+
+    if(quint64(directoryOffset) + directorySize > quint64(eocd))
+    {
+        _error = "中央目录位置无效";
+        return false;
+    }
+
+    _entries.reserve(entryCount);
+    _index.reserve(entryCount);
+
+    qint64 pos = directoryOffset;
+    for(int i = 0; i < entryCount; ++i)
+    {
+        if(pos + kCentralHeaderSize > eocd || ReadU32(_data + pos) != kCentralHeaderSignature)
+        {
+            _error = "中央目录记录损坏";
+            return false;
+        }
+
+        const uchar* header = _data + pos;
+        quint16 nameLength = ReadU16(header + 28);
+        quint16 extraLength = ReadU16(header + 30);
+        quint16 commentLength = ReadU16(header + 32);
+        if(pos + kCentralHeaderSize + nameLength > eocd)
+        {
+            _error = "中央目录记录损坏";
+            return false;
+        }
+
+        ZipEntry entry;
+        entry.flags = ReadU16(header + 8);
+        entry.method = ReadU16(header + 10);
+        entry.crc32 = ReadU32(header + 16);
+        entry.compressedSize = ReadU32(header + 20);
+        entry.uncompressedSize = ReadU32(header + 24);
+        entry.localHeaderOffset = ReadU32(header + 42);
+
+        const char* name = reinterpret_cast<const char*>(header + kCentralHeaderSize);
+        entry.name = (entry.flags & kFlagUtf8) ? QString::fromUtf8(name, nameLength)
+                                               : QString::fromLatin1(name, nameLength);
+
+        _index.insert(entry.name, _entries.size());
+        _entries.append(entry);
+
+        pos += kCentralHeaderSize + nameLength + extraLength + commentLength;
+    }
+
+    return true;
+}
+
+const uchar* ZipReader::EntryData(const ZipEntry& entry)
+{
+    qint64 pos = static_cast<qint64>(entry.localHeaderOffset);
+    if(pos + kLocalHeaderSize > _size || ReadU32(_data + pos) != kLocalHeaderSignature)
+    {
+        _error = QString("本地文件头损坏: %1").arg(entry.name);
+        return nullptr;
+    }
+
+    // 本地文件头的扩展字段长度可能与中央目录不同，必须以本地文件头为准
+    quint16 nameLength = ReadU16(_data + pos + 26);
+    quint16 extraLength = ReadU16(_data + pos + 28);
+    qint64 dataPos = pos + kLocalHeaderSize + nameLength + extraLength;
+    if(dataPos + static_cast<qint64>(entry.compressedSize) > _size)
+    {
+        _error = QString("条目数据超出文件范围: %1").arg(entry.name);
+        return nullptr;
+    }
+
+    return _data + dataPos;
+}
@@ -0,0 +1,109 @@
+#ifndef ZIPREADER_H
+#define ZIPREADER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QIODevice>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+// ZIP 条目信息，来自中央目录
+struct ZipEntry
+{
+    QString name;
+    quint16 flags;              // 通用标志位，bit0 表示加密
+    quint16 method;             // 压缩方式，0 为存储，8 为 deflate
+    quint32 crc32;
+    quint64 compressedSize;
+    quint64 uncompressedSize;
+    quint64 localHeaderOffset;  // 本地文件头在文件中的偏移
+};
+
+struct z_stream_s;
+
+// 按需解压一个条目的只读顺序设备，由 ZipReader::OpenEntry 创建。
+// 每次 read 只解压请求的数据量，读完返回0，解压或CRC校验失败时返回-1
+class ZipEntryReader : public QIODevice
+{
+public:
+    ~ZipEntryReader() override;
+
+    // 解压失败或CRC校验不一致。QXmlStreamReader 等读取方把 -1 当作数据结束，读完后需要检查
+    bool HasError() const;
+
+    bool isSequential() const override;
+    qint64 size() const override;
+    qint64 bytesAvailable() const override;
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 size) override;
+
+private:
+    friend class ZipReader;
+    ZipEntryReader(const ZipEntry& entry, const uchar* data);
+    bool Start();
+
+private:
+    ZipEntry _entry;
+    const uchar* _data;
+    quint64 _consumed;
+    quint64 _produced;
+    quint32 _crc;
+    std::unique_ptr<z_stream_s> _stream;    // 仅 deflate 条目使用
+    bool _failed;
+};
+
+// 只读ZIP包读取器，用于读取 .docx 等 OOXML 文档
+// 打开时把整个文件映射到内存并解析中央目录，建立按名称查找的索引，
+// 条目内容在读取时才解压，未读取的条目不产生任何开销。
+// 大条目用 OpenEntry 边读边解压，只占用调用方的读缓冲。
+class ZipReader
+{
+public:
+    ZipReader();
+    ~ZipReader();
+
+    ZipReader(const ZipReader&) = delete;
+    ZipReader& operator=(const ZipReader&) = delete;
+
+    bool Open(const QString& filePath);
+    void Close();
+    bool IsOpen() const;
+
+    // 最近一次失败的原因
+    QString ErrorString() const;
+
+    const QVector<ZipEntry>& Entries() const;
+    bool Contains(const QString& name) const;
+
+    // 解压整个条目到 data 并校验CRC，失败时返回false并设置错误信息
+    bool Read(const QString& name, QByteArray& data);
+
+    // 以流的方式打开条目，读取时才解压。设备直接读取映射的文件内容，
+    // 必须在 ZipReader 关闭前销毁。失败时返回空指针
+    std::unique_ptr<ZipEntryReader> OpenEntry(const QString& name);
+
+    // 条目的原始压缩数据，不解压也不复制，data 直接指向映射的文件内容，
+    // 只在 ZipReader 关闭前有效。用于把条目原样复制到另一个ZIP包
+    bool ReadCompressed(const QString& name, ZipEntry& entry, QByteArray& data);
+
+private:
+    bool ParseCentralDirectory();
+
+    // 条目压缩数据的起始位置，本地文件头无效时返回 nullptr
+    const uchar* EntryData(const ZipEntry& entry);
+
+private:
+    QFile _file;
+    QByteArray _buffer;         // 无法映射时读入内存
+    const uchar* _data;
+    qint64 _size;
+    QVector<ZipEntry> _entries;
+    QHash<QString, int> _index;
+    QString _error;
+};
+
+#endif // ZIPREADER_H
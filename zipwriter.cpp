@@ -0,0 +1,541 @@
+#include <QDateTime>
+#include <QtConcurrent/QtConcurrent>
+#include <QtEndian>
+#include "zipwriter.h"
+
+#ifdef Q_OS_WIN
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+namespace
+{
+    const quint32 kLocalHeaderSignature = 0x04034b50;
+    const quint32 kCentralHeaderSignature = 0x02014b50;
+    const quint32 kEndOfCentralDirectorySignature = 0x06054b50;
+
+    const quint16 kVersion = 20;
+    const quint16 kMethodStored = 0;
+    const quint16 kMethodDeflated = 8;
+    const quint16 kFlagUtf8 = 0x0800;
+
+    // 不使用ZIP64扩展，超出限制时报错
+    const quint64 kMaxZipOffset = 0xFFFFFFFFull;
+    const int kMaxZipEntries = 0xFFFF;
+
+    void AppendU16(QByteArray& out, quint16 value)
+    {
+        char buffer[2];
+        qToLittleEndian(value, buffer);
+        out.append(buffer, 2);
+    }
+
+    void AppendU32(QByteArray& out, quint32 value)
+    {
+        char buffer[4];
+        qToLittleEndian(value, buffer);
+        out.append(buffer, 4);
+    }
+
+    // 流式写入时每次压缩输出的缓冲大小
+    const int kStreamChunkSize = 64 * 1024;
+
+    // ZIP 中的 deflate 数据不带 zlib 头，使用负的窗口位数生成原始流
+    bool DeflateRaw(const QByteArray& src, QByteArray& dst)
+    {
+        z_stream stream = {};
+        if(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            return false;
+
+        dst.resize(static_cast<qsizetype>(deflateBound(&stream, static_cast<uLong>(src.size()))));
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(src.constData()));
+        stream.avail_in = static_cast<uInt>(src.size());
+        stream.next_out = reinterpret_cast<Bytef*>(dst.data());
+        stream.avail_out = static_cast<uInt>(dst.size());
+
+        bool ok = deflate(&stream, Z_FINISH) == Z_STREAM_END;
+        if(ok)
+            dst.resize(static_cast<qsizetype>(stream.total_out));
+        deflateEnd(&stream);
+        return ok;
+    }
+
+    // 压缩一个条目，不访问 ZipWriter 的状态，可以在任意线程调用。
+    // 压缩后没有变小的数据（如图片）直接存储
+    bool CompressEntry(const QString& name, const QByteArray& data, ZipEntry& entry, QByteArray& compressed)
+    {
+        entry.name = name;
+        entry.flags = kFlagUtf8;
+        entry.crc32 = ::crc32(0L, reinterpret_cast<const Bytef*>(data.constData()), static_cast<uInt>(data.size()));
+        entry.uncompressedSize = static_cast<quint64>(data.size());
+        entry.localHeaderOffset = 0;
+
+        if(!DeflateRaw(data, compressed))
+            return false;
+
+        if(compressed.size() >= data.size())
+        {
+            entry.method = kMethodStored;
+            compressed = data;
+        }
+        else
+        {
+            entry.method = kMethodDeflated;
+        }
+        entry.compressedSize = static_cast<quint64>(compressed.size());
+        return true;
+    }
+}
+
+// 流式写入的条目，写入的数据立即压缩并追加到文件，结束时回填本地文件头中的CRC和大小
+class ZipEntryStream : public QIODevice
+{
+public:
+    ZipEntryStream(QSaveFile& file, const ZipEntry& entry)
+        : _file(file)
+        , _entry(entry)
+        , _deflating(false)
+    {
+        _stream = {};
+    }
+
+    ~ZipEntryStream() override
+    {
+        if(_deflating)
+            deflateEnd(&_stream);
+    }
+
+    bool Start()
+    {
+        if(deflateInit2(&_stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            return false;
+        _deflating = true;
+        return open(QIODevice::WriteOnly);
+    }
+
+    // 输出剩余的压缩数据，返回完成的条目
+    bool Finish(ZipEntry& entry)
+    {
+        bool ok = Deflate(nullptr, 0, Z_FINISH);
+        deflateEnd(&_stream);
+        _deflating = false;
+
+        QString error = errorString();
+        close();
+        if(!ok)
+            setErrorString(error);
+        entry = _entry;
+        return ok;
+    }
+
+    bool isSequential() const override
+    {
+        return true;
+    }
+
+protected:
+    qint64 readData(char*, qint64) override
+    {
+        return -1;
+    }
+
+    qint64 writeData(const char* data, qint64 size) override
+    {
+        qint64 written = 0;
+        while(written < size)
+        {
+            uInt chunk = static_cast<uInt>(qMin<qint64>(size - written, 1 << 30));
+            _entry.crc32 = ::crc32(_entry.crc32, reinterpret_cast<const Bytef*>(data + written), chunk);
+            if(!Deflate(data + written, chunk, Z_NO_FLUSH))
+                return -1;
+            written += chunk;
+        }
+        _entry.uncompressedSize += static_cast<quint64>(size);
+        return size;
+    }
+
+private:
+    bool Deflate(const char* data, uInt size, int flush)
+    {
+        char buffer[kStreamChunkSize];
+        _stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        _stream.avail_in = size;
+        do
+        {
+            _stream.next_out = reinterpret_cast<Bytef*>(buffer);
+            _stream.avail_out = kStreamChunkSize;
+            if(deflate(&_stream, flush) == Z_STREAM_ERROR)
+            {
+                setErrorString(QString("压缩失败: %1").arg(_entry.name));
+                return false;
+            }
+
+            qint64 have = kStreamChunkSize - _stream.avail_out;
+            if(have > 0 && _file.write(buffer, have) != have)
+            {
+                setErrorString(_file.errorString());
+                return false;
+            }
+            _entry.compressedSize += static_cast<quint64>(have);
+        } while(_stream.avail_out == 0);
+        return true;
+    }
+
+private:
+    QSaveFile& _file;
+    ZipEntry _entry;
+    z_stream _stream;
+    bool _deflating;
+};
+
+ZipWriter::ZipWriter()
+    : _dosTime(0)
+    , _dosDate(0)
+{
+
+}
+
+ZipWriter::~ZipWriter()
+{
+    if(_file.isOpen())
+        Abort();
+}
+
+bool ZipWriter::Open(const QString& filePath)
+{
+    _entries.clear();
+    _names.clear();
+
+    _file.setFileName(filePath);
+    if(!_file.open(QIODevice::WriteOnly))
+    {
+        _error = _file.errorString();
+        return false;
+    }
+
+    // 所有条目使用同一个修改时间，DOS时间格式精度为2秒
+    QDateTime now = QDateTime::currentDateTime();
+    QDate date = now.date();
+    QTime time = now.time();
+    _dosTime = static_cast<quint16>((time.hour() << 11) | (time.minute() << 5) | (time.second() / 2));
+    _dosDate = static_cast<quint16>(((qMax(date.year(), 1980) - 1980) << 9) | (date.month() << 5) | date.day());
+    return true;
+}
+
+bool ZipWriter::AddEntry(const QString& name, const QByteArray& data)
+{
+    ZipEntry entry;
+    QByteArray compressed;
+    if(!CompressEntry(name, data, entry, compressed))
+    {
+        _error = QString("压缩失败: %1").arg(name);
+        return false;
+    }
+    return WriteEntry(entry, compressed);
+}
+
+bool ZipWriter::AddEntry(const QString& name, QIODevice* source)
+{
+    QIODevice* stream = BeginEntry(name);
+    if(!stream)
+        return false;
+
+    QByteArray buffer(kStreamChunkSize, Qt::Uninitialized);
+    qint64 length = 0;
+    while((length = source->read(buffer.data(), buffer.size())) > 0)
+    {
+        if(stream->write(buffer.constData(), length) != length)
+        {
+            // 写了一半的条目不进入中央目录，不影响已写入的其它条目
+            _error = stream->errorString();
+            _stream.reset();
+            return false;
+        }
+    }
+
+    if(length < 0)
+    {
+        _error = source->errorString();
+        _stream.reset();
+        return false;
+    }
+    return FinishEntry();
+}
+
+bool ZipWriter::AddEntries(const QVector<QPair<QString, QByteArray>>& entries)
+{
+    struct CompressedEntry
+    {
+        ZipEntry entry;
+        QByteArray data;
+        bool ok;
+    };
+
+    QVector<CompressedEntry> compressed = QtConcurrent::blockingMapped<QVector<CompressedEntry>>(
+        entries, [](const QPair<QString, QByteArray>& source) {
+            CompressedEntry result;
+            result.ok = CompressEntry(source.first, source.second, result.entry, result.data);
+            return result;
+        });
+
+    for(const CompressedEntry& result : compressed)
+    {
+        if(!result.ok)
+        {
+            _error = QString("压缩失败: %1").arg(result.entry.name);
+            return false;
+        }
+        if(!WriteEntry(result.entry, result.data))
+            return false;
+    }
+    return true;
+}
+
+QIODevice* ZipWriter::BeginEntry(const QString& name)
+{
+    if(!CheckNewEntry(name, 0))
+        return nullptr;
+
+    ZipEntry entry;
+    entry.name = name;
+    entry.flags = kFlagUtf8;
+    entry.method = kMethodDeflated;
+    entry.crc32 = ::crc32(0L, Z_NULL, 0);
+    entry.compressedSize = 0;
+    entry.uncompressedSize = 0;
+    entry.localHeaderOffset = static_cast<quint64>(_file.pos());
+
+    // CRC和大小先写0，FinishEntry 时回填
+    QByteArray header = LocalHeader(entry);
+    if(_file.write(header) != header.size())
+    {
+        _error = _file.errorString();
+        return nullptr;
+    }
+
+    auto stream = std::make_unique<ZipEntryStream>(_file, entry);
+    if(!stream->Start())
+    {
+        _error = QString("压缩失败: %1").arg(name);
+        return nullptr;
+    }
+    _stream = std::move(stream);
+    return _stream.get();
+}
+
+bool ZipWriter::FinishEntry()
+{
+    if(!_stream)
+    {
+        _error = "没有正在写入的条目";
+        return false;
+    }
+
+    ZipEntry entry;
+    bool ok = _stream->Finish(entry);
+    if(!ok)
+        _error = _stream->errorString();
+    _stream.reset();
+    if(!ok)
+        return false;
+
+    if(entry.uncompressedSize > kMaxZipOffset || quint64(_file.pos()) > kMaxZipOffset)
+    {
+        _error = "超出ZIP格式的大小限制";
+        return false;
+    }
+
+    // 回填本地文件头中的CRC和大小
+    QByteArray sizes;
+    AppendU32(sizes, entry.crc32);
+    AppendU32(sizes, static_cast<quint32>(entry.compressedSize));
+    AppendU32(sizes, static_cast<quint32>(entry.uncompressedSize));
+    qint64 end = _file.pos();
+    if(!_file.seek(static_cast<qint64>(entry.localHeaderOffset) + 14) || _file.write(sizes) != sizes.size() ||
+       !_file.seek(end))
+    {
+        _error = _file.errorString();
+        return false;
+    }
+
+    _names.insert(entry.name);
+    _entries.append(entry);
+    return true;
+}
+
+bool ZipWriter::AddCompressedEntry(const QString& name, const ZipEntry& entry, const QByteArray& compressedData)
+{
+    if(entry.flags & 0x0001)
+    {
+        _error = QString("不支持加密的条目: %1").arg(entry.name);
+        return false;
+    }
+
+    ZipEntry copy = entry;
+    copy.name = name;
+    // 大小和CRC已写在本地文件头中，不再使用数据描述符
+    copy.flags = kFlagUtf8;
+    return WriteEntry(copy, compressedData);
+}
+
+bool ZipWriter::Contains(const QString& name) const
+{
+    return _names.contains(name);
+}
+
+bool ZipWriter::CheckNewEntry(const QString& name, quint64 dataSize)
+{
+    if(!_file.isOpen())
+    {
+        _error = "ZIP文件未打开";
+        return false;
+    }
+
+    if(_stream)
+    {
+        _error = "上一个条目尚未写完";
+        return false;
+    }
+
+    if(_names.contains(name))
+    {
+        _error = QString("条目重复: %1").arg(name);
+        return false;
+    }
+
+    if(_entries.size() >= kMaxZipEntries || quint64(_file.pos()) + dataSize > kMaxZipOffset)
+    {
+        _error = "超出ZIP格式的大小限制";
+        return false;
+    }
+    return true;
+}
+
+QByteArray ZipWriter::LocalHeader(const ZipEntry& entry) const
+{
+    QByteArray name = entry.name.toUtf8();
+    QByteArray header;
+    header.reserve(30 + name.size());
+    AppendU32(header, kLocalHeaderSignature);
+    AppendU16(header, kVersion);
+    AppendU16(header, entry.flags);
+    AppendU16(header, entry.method);
+    AppendU16(header, _dosTime);
+    AppendU16(header, _dosDate);
+    AppendU32(header, entry.crc32);
+    AppendU32(header, static_cast<quint32>(entry.compressedSize));
+    AppendU32(header, static_cast<quint32>(entry.uncompressedSize));
+    AppendU16(header, static_cast<quint16>(name.size()));
+    AppendU16(header, 0);
+    header.append(name);
+    return header;
+}
+
+bool ZipWriter::WriteEntry(ZipEntry entry, const QByteArray& compressedData)
+{
+    if(!CheckNewEntry(entry.name, static_cast<quint64>(compressedData.size())))
+        return false;
+
+    if(entry.uncompressedSize > kMaxZipOffset)
+    {
+        _error = "超出ZIP格式的大小限制";
+        return false;
+    }
+
+    entry.localHeaderOffset = static_cast<quint64>(_file.pos());
+    QByteArray header = LocalHeader(entry);
+    if(_file.write(header) != header.size() || _file.write(compressedData) != compressedData.size())
+    {
+        _error = _file.errorString();
+        return false;
+    }
+
+    _names.insert(entry.name);
+    _entries.append(entry);
+    return true;
+}
+
+bool ZipWriter::Close()
+{
+    if(!_file.isOpen())
+    {
+        _error = "ZIP文件未打开";
+        return false;
+    }
+
+    if(_stream)
+    {
+        _error = "条目尚未写完";
+        Abort();
+        return false;
+    }
+
+    quint64 directoryOffset = static_cast<quint64>(_file.pos());
+    QByteArray directory;
+    for(const ZipEntry& entry : _entries)
+    {
+        QByteArray name = entry.name.toUtf8();
+        AppendU32(directory, kCentralHeaderSignature);
+        AppendU16(directory, kVersion);
+        AppendU16(directory, kVersion);
+        AppendU16(directory, entry.flags);
+        AppendU16(directory, entry.method);
+        AppendU16(directory, _dosTime);
+        AppendU16(directory, _dosDate);
+        AppendU32(directory, entry.crc32);
+        AppendU32(directory, static_cast<quint32>(entry.compressedSize));
+        AppendU32(directory, static_cast<quint32>(entry.uncompressedSize));
+        AppendU16(directory, static_cast<quint16>(name.size()));
+        AppendU16(directory, 0);    // 扩展字段长度
+        AppendU16(directory, 0);    // 注释长度
+        AppendU16(directory, 0);    // 起始磁盘号
+        AppendU16(directory, 0);    // 内部属性
+        AppendU32(directory, 0);    // 外部属性
+        AppendU32(directory, static_cast<quint32>(entry.localHeaderOffset));
+        directory.append(name);
+    }
+
+    if(directoryOffset + directory.size() > kMaxZipOffset)
+    {
+        _error = "超出ZIP格式的大小限制";
+        Abort();
+        return false;
+    }
+
+    quint32 directorySize = static_cast<quint32>(directory.size());
+    AppendU32(directory, kEndOfCentralDirectorySignature);
+    AppendU16(directory, 0);
+    AppendU16(directory, 0);
+    AppendU16(directory, static_cast<quint16>(_entries.size()));
+    AppendU16(directory, static_cast<quint16>(_entries.size()));
+    AppendU32(directory, directorySize);
+    AppendU32(directory, static_cast<quint32>(directoryOffset));
+    AppendU16(directory, 0);
+
+    if(_file.write(directory) != directory.size() || !_file.commit())
+    {
+        _error = _file.errorString();
+        Abort();
+        return false;
+    }
+
+    return true;
+}
+
+void ZipWriter::Abort()
+{
+    _stream.reset();
+    if(_file.isOpen())
+    {
+        _file.cancelWriting();
+        _file.commit();
+    }
+    _entries.clear();
+    _names.clear();
+}
+
+QString ZipWriter::ErrorString() const
+{
+    return _error;
+}
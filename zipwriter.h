@@ -0,0 +1,72 @@
+#ifndef ZIPWRITER_H
+#define ZIPWRITER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QPair>
+#include <QSaveFile>
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include <memory>
+#include "zipreader.h"
+
+class ZipEntryStream;
+
+// ZIP包写入器，用于生成 .docx 等 OOXML 文档
+// 内容先写入临时文件，Close 成功后才替换目标文件，中途失败或 Abort 时目标文件保持不变。
+// 条目可以整块写入、流式写入，或者多个条目在线程池中并行压缩后按顺序写入。
+class ZipWriter
+{
+public:
+    ZipWriter();
+    ~ZipWriter();
+
+    ZipWriter(const ZipWriter&) = delete;
+    ZipWriter& operator=(const ZipWriter&) = delete;
+
+    bool Open(const QString& filePath);
+
+    // 压缩并写入一个条目
+    bool AddEntry(const QString& name, const QByteArray& data);
+
+    // 从设备读取数据，边压缩边写入
+    bool AddEntry(const QString& name, QIODevice* source);
+
+    // 多个相互独立的条目在线程池中并行压缩，再按给定顺序写入
+    bool AddEntries(const QVector<QPair<QString, QByteArray>>& entries);
+
+    // 开始流式写入一个条目，写入返回设备的数据边压缩边写入文件，
+    // FinishEntry 之前不能写入其它条目。设备归 ZipWriter 所有，FinishEntry 后失效
+    QIODevice* BeginEntry(const QString& name);
+    bool FinishEntry();
+
+    // 写入已压缩的条目（来自 ZipReader::ReadCompressed），不解压也不重新压缩
+    bool AddCompressedEntry(const QString& name, const ZipEntry& entry, const QByteArray& compressedData);
+
+    bool Contains(const QString& name) const;
+
+    // 写入中央目录并提交文件
+    bool Close();
+
+    // 放弃写入，删除临时文件
+    void Abort();
+
+    QString ErrorString() const;
+
+private:
+    bool CheckNewEntry(const QString& name, quint64 dataSize);
+    QByteArray LocalHeader(const ZipEntry& entry) const;
+    bool WriteEntry(ZipEntry entry, const QByteArray& compressedData);
+
+private:
+    QSaveFile _file;
+    std::unique_ptr<ZipEntryStream> _stream;  // 正在流式写入的条目
+    QVector<ZipEntry> _entries;
+    QSet<QString> _names;
+    quint16 _dosTime;
+    quint16 _dosDate;
+    QString _error;
+};
+
+#endif // ZIPWRITER_H